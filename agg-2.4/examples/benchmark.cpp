@@ -0,0 +1,1653 @@
+//----------------------------------------------------------------------------
+// A headless benchmark of the rendering pipeline. It doesn't use
+// platform_support and renders into memory only. Every scene is
+// processed stage by stage and the time of each stage is reported,
+// so that the regressions can be tracked down to a particular stage:
+//
+//   flatten - curve4_div, the vertices of the curves
+//   stroke  - vcgen_stroke, the vertices of the stroked outlines
+//   cells   - rasterizer::add_path(), clipping and cell generation
+//   sort    - rasterizer::sort(), sorting the cells
+//   sweep   - rasterizer::sweep_scanline() into scanline_p8
+//   blend   - blending the recorded scanlines into an rgba32 buffer,
+//             counted in the covered pixels
+//   span_*  - image transformations, span generation and blending
+//   dbl_*   - the double vertex pipeline (path_storage, conv_transform,
+//             conv_curve, conv_stroke) into rasterizer::add_path()
+//   int_*   - the same with the integer pipeline (path_storage_int,
+//             conv_transform_int, conv_curve_int, conv_stroke_int)
+//             into rasterizer::add_path_int()
+//   heap    - many small paths, each built in its own path storage and
+//             rasterized by its own rasterizer, with pod_allocator
+//   arena   - the same with arena_allocator (agg_arena.h)
+//   full    - the lion redrawn in full, as after every change
+//   dirty_N - only the dirty rectangles (agg_dirty_rects.h) redrawn
+//             after an edit of an N x N pixel area that moves over
+//             the frame, counted in the redrawn pixels
+//   pairwise - the union of many small footprints with a chain of
+//              sbool_unite_shapes_aa(), as in scanline_boolean2.cpp
+//   nary    - the same union with sbool_unite_nary_aa in one sweep
+//   nary_mt - the same in bands, in one thread per processor
+//   or, and, xor, a_b - the Boolean operations on the map of Great
+//             Britain and the arrows, as in gpc_test.cpp, with
+//             conv_polygon_bool, counted in the vertices of the result
+//   gpc_*   - the same with conv_gpc, if built with AGG_USE_GPC
+//   mask_u8, mask_rle - the clip mask of many ellipses rendered into
+//             alpha_mask_gray8 and alpha_mask_rle, counted in bytes
+//   amask_u8, amask_rle - the lion blended through pixfmt_amask_adaptor
+//             with these masks, counted in the pixels of the spans
+//   mclip_N, indexed_N - the lion blended through renderer_mclip and
+//             renderer_mclip_indexed with a grid of N clip boxes
+//   polyline_N - N short segments drawn one by one with
+//             rasterizer_outline_aa and renderer_outline_aa
+//   batch_N, batch_mt_N - the same with rasterizer_outline_aa_batch,
+//             in one thread and in one thread per processor
+//
+// Usage: benchmark [options]
+//   -scene NAME    Run only one scene: lion, gb_poly, text, curves, image,
+//                  map, alloc, dirty, sbool, polybool, amask, mclip,
+//                  outline
+//   -iter N        Fixed number of iterations (default is by time)
+//   -time MS       Minimal time per scene in milliseconds (default 300)
+//   -size WxH      The size of the frame (default 800x600)
+//   -json          JSON output instead of CSV
+//
+// The CSV output has the columns:
+//   scene,stage,iterations,ms,count,unit
+// where ms is the average time of one iteration and count is the amount
+// of work per iteration, in units of unit.
+//----------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_p.h"
+#include "agg_renderer_base.h"
+#include "agg_renderer_scanline.h"
+#include "agg_pixfmt_rgba.h"
+#include "agg_display_list.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_conv_stroke.h"
+#include "agg_conv_curve.h"
+#include "agg_curves.h"
+#include "agg_gsv_text.h"
+#include "agg_bounding_rect.h"
+#include "agg_span_allocator.h"
+#include "agg_span_interpolator_linear.h"
+#include "agg_span_image_filter_rgba.h"
+#include "agg_image_accessors.h"
+#include "agg_image_filters.h"
+#include "agg_path_storage_int.h"
+#include "agg_conv_transform_int.h"
+#include "agg_conv_curve_int.h"
+#include "agg_conv_stroke_int.h"
+#include "agg_arena.h"
+#include "agg_dirty_rects.h"
+#include "agg_scanline_u.h"
+#include "agg_scanline_storage_aa.h"
+#include "agg_scanline_boolean_algebra.h"
+#include "agg_scanline_boolean_nary.h"
+#include "agg_conv_polygon_bool.h"
+#include "agg_ellipse.h"
+#include "agg_pixfmt_gray.h"
+#include "agg_alpha_mask_u8.h"
+#include "agg_alpha_mask_rle.h"
+#include "agg_pixfmt_amask_adaptor.h"
+#include "agg_renderer_mclip.h"
+#include "agg_renderer_mclip_indexed.h"
+#include "agg_renderer_outline_aa.h"
+#include "agg_rasterizer_outline_aa.h"
+#include "agg_rasterizer_outline_aa_batch.h"
+#ifdef AGG_USE_GPC
+#include "agg_conv_gpc.h"
+#endif
+
+typedef agg::pixfmt_bgra32                 pixfmt;
+typedef agg::renderer_base<pixfmt>         renderer_base;
+typedef agg::rgba8                         color_type;
+typedef agg::rasterizer_scanline_aa<>      rasterizer;
+
+unsigned parse_lion(agg::path_storage& ps, agg::srgba8* colors, unsigned* path_idx);
+void make_gb_poly(agg::path_storage& ps);
+void make_arrows(agg::path_storage& ps);
+
+
+//----------------------------------------------------------------------------
+class bench_timer
+{
+public:
+    void start() { m_start = now(); }
+    double elapsed() const { return now() - m_start; }
+
+    // Milliseconds from an arbitrary point
+    static double now()
+    {
+#if defined(_WIN32)
+        LARGE_INTEGER freq, t;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&t);
+        return double(t.QuadPart) * 1000.0 / double(freq.QuadPart);
+#else
+        timeval tv;
+        gettimeofday(&tv, 0);
+        return double(tv.tv_sec) * 1000.0 + double(tv.tv_usec) / 1000.0;
+#endif
+    }
+
+private:
+    double m_start;
+};
+
+
+//----------------------------------------------------------------------------
+// The accumulated time and work of one stage of a scene.
+struct stage_stat
+{
+    const char* name;
+    const char* unit;
+    double      ms;
+    double      count;
+};
+
+
+//----------------------------------------------------------------------------
+class bench_report
+{
+public:
+    bench_report(bool json) : m_json(json), m_num(0)
+    {
+        if(m_json) printf("{\n  \"results\": [");
+        else       printf("scene,stage,iterations,ms,count,unit\n");
+    }
+
+    ~bench_report()
+    {
+        if(m_json) printf("\n  ]\n}\n");
+    }
+
+    void add(const char* scene, const stage_stat& s, unsigned iterations)
+    {
+        double ms    = s.ms / iterations;
+        double count = s.count / iterations;
+        if(m_json)
+        {
+            printf("%s\n    {\"scene\": \"%s\", \"stage\": \"%s\", "
+                   "\"iterations\": %u, \"ms\": %.4f, "
+                   "\"count\": %.0f, \"unit\": \"%s\"}",
+                   m_num ? "," : "",
+                   scene, s.name, iterations, ms, count, s.unit);
+        }
+        else
+        {
+            printf("%s,%s,%u,%.4f,%.0f,%s\n",
+                   scene, s.name, iterations, ms, count, s.unit);
+        }
+        fflush(stdout);
+        ++m_num;
+    }
+
+private:
+    bool     m_json;
+    unsigned m_num;
+};
+
+
+//----------------------------------------------------------------------------
+struct bench_options
+{
+    const char* scene;
+    unsigned    iterations;
+    double      min_time;
+    unsigned    width;
+    unsigned    height;
+    bool        json;
+};
+
+
+//----------------------------------------------------------------------------
+// The styles of the display list, used for the blend stage.
+struct color_styles
+{
+    const color_type* colors;
+
+    bool       is_solid(unsigned) const    { return true; }
+    color_type color(unsigned style) const { return colors[style]; }
+    void generate_span(color_type*, int, int, unsigned, unsigned) {}
+};
+
+
+//----------------------------------------------------------------------------
+// Discards the vertices, counting them, so that the compiler can't
+// remove the vertex generation.
+template<class VertexSource> double count_vertices(VertexSource& vs,
+                                                   unsigned path_id = 0)
+{
+    double x, y;
+    double n = 0;
+    vs.rewind(path_id);
+    while(!agg::is_stop(vs.vertex(&x, &y))) n += 1;
+    return n;
+}
+
+
+//----------------------------------------------------------------------------
+// Runs the cells, sort, sweep and blend stages for all the paths of the
+// scene. The Scene provides:
+//
+//   unsigned   num_paths() const;
+//   color_type color(unsigned i) const;
+//   void add_path(rasterizer& ras, unsigned i);
+//----------------------------------------------------------------------------
+template<class Scene>
+void bench_raster(Scene& scene, renderer_base& rb,
+                  stage_stat* st, agg::display_list<>& dl)
+{
+    rasterizer ras;
+    agg::scanline_p8 sl;
+    bench_timer t;
+    unsigned i;
+
+    ras.clip_box(0, 0, rb.width(), rb.height());
+    dl.remove_all();
+    for(i = 0; i < scene.num_paths(); i++)
+    {
+        t.start();
+        ras.reset();
+        scene.add_path(ras, i);
+        st[0].ms += t.elapsed();
+
+        t.start();
+        ras.sort();
+        st[1].ms += t.elapsed();
+
+        t.start();
+        if(ras.rewind_scanlines())
+        {
+            sl.reset(ras.min_x(), ras.max_x());
+            while(ras.sweep_scanline(sl))
+            {
+                st[2].count += sl.num_spans();
+                agg::scanline_p8::const_iterator span = sl.begin();
+                unsigned num_spans = sl.num_spans();
+                do
+                {
+                    st[3].count += abs(span->len);
+                    ++span;
+                }
+                while(--num_spans);
+            }
+        }
+        st[2].ms += t.elapsed();
+
+        dl.add(ras, i);
+    }
+    st[0].count += scene.num_paths();
+    st[1].count += scene.num_paths();
+
+    color_styles styles;
+    styles.colors = scene.colors();
+    rb.clear(agg::rgba(1, 1, 1));
+    t.start();
+    dl.render(rb, styles);
+    st[3].ms += t.elapsed();
+}
+
+
+//----------------------------------------------------------------------------
+template<class Scene>
+void run_scene(const char* name, Scene& scene, const bench_options& opt,
+               bench_report& report)
+{
+    if(opt.scene && strcmp(opt.scene, name) != 0) return;
+
+    agg::pod_array<agg::int8u> buf(opt.width * opt.height * 4);
+    agg::rendering_buffer rbuf(buf.data(), opt.width, opt.height, opt.width * 4);
+    pixfmt pixf(rbuf);
+    renderer_base rb(pixf);
+    agg::display_list<> dl;
+
+    stage_stat st[8];
+    unsigned num_stages = scene.stages(st);
+    unsigned i;
+    for(i = 0; i < num_stages; i++) st[i].ms = st[i].count = 0;
+
+    // One iteration to warm up the caches and the allocators
+    scene.run(rb, st, dl);
+    for(i = 0; i < num_stages; i++) st[i].ms = st[i].count = 0;
+
+    unsigned iterations = 0;
+    bench_timer t;
+    t.start();
+    for(;;)
+    {
+        scene.run(rb, st, dl);
+        ++iterations;
+        if(opt.iterations)
+        {
+            if(iterations >= opt.iterations) break;
+        }
+        else
+        {
+            if(iterations >= 3 && t.elapsed() >= opt.min_time) break;
+        }
+    }
+
+    for(i = 0; i < num_stages; i++) report.add(name, st[i], iterations);
+}
+
+
+//----------------------------------------------------------------------------
+// The stages of the vector scenes: stroke (if any), then the raster ones.
+unsigned raster_stages(stage_stat* st, bool stroke)
+{
+    static const stage_stat raster[] =
+    {
+        { "cells", "paths",  0, 0 },
+        { "sort",  "paths",  0, 0 },
+        { "sweep", "spans",  0, 0 },
+        { "blend", "pixels", 0, 0 }
+    };
+    unsigned n = 0;
+    if(stroke)
+    {
+        stage_stat s = { "stroke", "vertices", 0, 0 };
+        st[n++] = s;
+    }
+    unsigned i;
+    for(i = 0; i < 4; i++) st[n++] = raster[i];
+    return n;
+}
+
+
+//----------------------------------------------------------------------------
+// The lion, filled, scaled to the frame. The stroke stage strokes
+// the same paths with width 1.
+class lion_scene
+{
+public:
+    lion_scene(unsigned w, unsigned h)
+    {
+        m_num = parse_lion(m_path, m_srgb, m_path_idx);
+        unsigned i;
+        for(i = 0; i < m_num; i++) m_colors[i] = color_type(m_srgb[i]);
+
+        double x1, y1, x2, y2;
+        agg::pod_array_adaptor<unsigned> path_idx(m_path_idx, 100);
+        agg::bounding_rect(m_path, path_idx, 0, m_num, &x1, &y1, &x2, &y2);
+        double scale = w / (x2 - x1);
+        if(h / (y2 - y1) < scale) scale = h / (y2 - y1);
+        m_mtx *= agg::trans_affine_translation(-x1, -y1);
+        m_mtx *= agg::trans_affine_scaling(scale);
+    }
+
+    unsigned stages(stage_stat* st) { return raster_stages(st, true); }
+    unsigned num_paths() const { return m_num; }
+    const color_type* colors() const { return m_colors; }
+
+    void add_path(rasterizer& ras, unsigned i)
+    {
+        agg::conv_transform<agg::path_storage> trans(m_path, m_mtx);
+        ras.add_path(trans, m_path_idx[i]);
+    }
+
+    void run(renderer_base& rb, stage_stat* st, agg::display_list<>& dl)
+    {
+        agg::conv_transform<agg::path_storage> trans(m_path, m_mtx);
+        agg::conv_stroke<agg::conv_transform<agg::path_storage> > stroke(trans);
+        bench_timer t;
+        unsigned i;
+        t.start();
+        for(i = 0; i < m_num; i++) st[0].count += count_vertices(stroke, m_path_idx[i]);
+        st[0].ms += t.elapsed();
+        bench_raster(*this, rb, st + 1, dl);
+    }
+
+private:
+    agg::path_storage m_path;
+    agg::srgba8       m_srgb[100];
+    color_type        m_colors[100];
+    unsigned          m_path_idx[100];
+    unsigned          m_num;
+    agg::trans_affine m_mtx;
+};
+
+
+//----------------------------------------------------------------------------
+// The map of Great Britain, a polygon with many vertices, filled and
+// stroked with width 2.
+class gb_poly_scene
+{
+public:
+    gb_poly_scene(unsigned w, unsigned h)
+    {
+        make_gb_poly(m_path);
+        double x1, y1, x2, y2;
+        agg::bounding_rect_single(m_path, 0, &x1, &y1, &x2, &y2);
+        double scale = w / (x2 - x1);
+        if(h / (y2 - y1) < scale) scale = h / (y2 - y1);
+        m_mtx *= agg::trans_affine_translation(-x1, -y1);
+        m_mtx *= agg::trans_affine_scaling(scale);
+        m_colors[0] = color_type(127, 127, 0, 64);
+        m_colors[1] = color_type(0, 0, 0);
+    }
+
+    unsigned stages(stage_stat* st) { return raster_stages(st, true); }
+    unsigned num_paths() const { return 2; }
+    const color_type* colors() const { return m_colors; }
+
+    void add_path(rasterizer& ras, unsigned i)
+    {
+        agg::conv_transform<agg::path_storage> trans(m_path, m_mtx);
+        if(i == 0)
+        {
+            ras.add_path(trans);
+        }
+        else
+        {
+            agg::conv_stroke<agg::conv_transform<agg::path_storage> > stroke(trans);
+            stroke.width(2.0);
+            ras.add_path(stroke);
+        }
+    }
+
+    void run(renderer_base& rb, stage_stat* st, agg::display_list<>& dl)
+    {
+        agg::conv_transform<agg::path_storage> trans(m_path, m_mtx);
+        agg::conv_stroke<agg::conv_transform<agg::path_storage> > stroke(trans);
+        stroke.width(2.0);
+        bench_timer t;
+        t.start();
+        st[0].count += count_vertices(stroke);
+        st[0].ms += t.elapsed();
+        bench_raster(*this, rb, st + 1, dl);
+    }
+
+private:
+    agg::path_storage m_path;
+    color_type        m_colors[2];
+    agg::trans_affine m_mtx;
+};
+
+
+//----------------------------------------------------------------------------
+// Lines of gsv_text, stroked, as in the captions of the demos.
+class text_scene
+{
+public:
+    enum { num_lines = 40 };
+
+    text_scene(unsigned w, unsigned h) : m_height(h / double(num_lines))
+    {
+        m_colors[0] = color_type(0, 0, 0);
+        (void)w;
+    }
+
+    unsigned stages(stage_stat* st) { return raster_stages(st, true); }
+    unsigned num_paths() const { return num_lines; }
+    const color_type* colors() const { return m_colors; }
+
+    void add_path(rasterizer& ras, unsigned i)
+    {
+        agg::gsv_text txt;
+        setup(txt, i);
+        agg::conv_stroke<agg::gsv_text> stroke(txt);
+        stroke.width(m_height * 0.08);
+        ras.add_path(stroke);
+    }
+
+    void run(renderer_base& rb, stage_stat* st, agg::display_list<>& dl)
+    {
+        bench_timer t;
+        unsigned i;
+        t.start();
+        for(i = 0; i < num_lines; i++)
+        {
+            agg::gsv_text txt;
+            setup(txt, i);
+            agg::conv_stroke<agg::gsv_text> stroke(txt);
+            stroke.width(m_height * 0.08);
+            st[0].count += count_vertices(stroke);
+        }
+        st[0].ms += t.elapsed();
+        bench_raster(*this, rb, st + 1, dl);
+    }
+
+private:
+    void setup(agg::gsv_text& txt, unsigned i) const
+    {
+        txt.size(m_height * 0.6);
+        txt.start_point(2.0, m_height * (i + 0.8));
+        txt.text("The quick brown fox jumps over the lazy dog 0123456789 "
+                 "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG");
+    }
+
+    double     m_height;
+    color_type m_colors[1];
+};
+
+
+//----------------------------------------------------------------------------
+// Random translucent shapes made of cubic curves. The flatten stage
+// runs curve4_div for all the curves alone.
+class curves_scene
+{
+public:
+    enum { num_shapes = 200, num_curves = 4 };
+
+    curves_scene(unsigned w, unsigned h)
+    {
+        srand(1234);
+        unsigned i, j;
+        for(i = 0; i < num_shapes; i++)
+        {
+            double cx = rand() % w;
+            double cy = rand() % h;
+            double r  = rand() % 100 + 10;
+            m_colors[i] = color_type(rand() & 0xFF, rand() & 0xFF,
+                                     rand() & 0xFF, rand() & 0x7F);
+            m_path.start_new_path();
+            m_path.move_to(cx + r, cy);
+            for(j = 0; j < num_curves; j++)
+            {
+                double a = agg::pi * 2.0 * (j + 1) / num_curves;
+                m_path.curve4(cx + (rand() % 400 - 200), cy + (rand() % 400 - 200),
+                              cx + (rand() % 400 - 200), cy + (rand() % 400 - 200),
+                              cx + r * cos(a), cy + r * sin(a));
+            }
+            m_path.close_polygon();
+            m_path_idx[i] = m_path.total_vertices() - (num_curves * 3 + 2);
+        }
+    }
+
+    unsigned stages(stage_stat* st)
+    {
+        stage_stat s = { "flatten", "vertices", 0, 0 };
+        st[0] = s;
+        return raster_stages(st + 1, false) + 1;
+    }
+
+    unsigned num_paths() const { return num_shapes; }
+    const color_type* colors() const { return m_colors; }
+
+    void add_path(rasterizer& ras, unsigned i)
+    {
+        agg::conv_curve<agg::path_storage> curve(m_path);
+        ras.add_path(curve, m_path_idx[i]);
+    }
+
+    void run(renderer_base& rb, stage_stat* st, agg::display_list<>& dl)
+    {
+        bench_timer t;
+        agg::curve4_div c;
+        unsigned i;
+        t.start();
+        for(i = 0; i < m_path.total_vertices(); i++)
+        {
+            double x1, y1;
+            double x2, y2;
+            double x3, y3;
+            double x4, y4;
+            if(!agg::is_curve4(m_path.vertex(i, &x1, &y1))) continue;
+            m_path.vertex(i - 1, &x1, &y1);
+            m_path.vertex(i,     &x2, &y2);
+            m_path.vertex(i + 1, &x3, &y3);
+            m_path.vertex(i + 2, &x4, &y4);
+            c.init(x1, y1, x2, y2, x3, y3, x4, y4);
+            st[0].count += count_vertices(c);
+            i += 2;
+        }
+        st[0].ms += t.elapsed();
+        bench_raster(*this, rb, st + 1, dl);
+    }
+
+private:
+    agg::path_storage m_path;
+    color_type        m_colors[num_shapes];
+    unsigned          m_path_idx[num_shapes];
+};
+
+
+//----------------------------------------------------------------------------
+// A procedural image, rotated and scaled over the whole frame with
+// the bilinear and the bicubic filters.
+class image_scene
+{
+public:
+    enum { img_size = 256 };
+
+    image_scene(unsigned w, unsigned h) :
+        m_img(img_size * img_size * 4),
+        m_rbuf(m_img.data(), img_size, img_size, img_size * 4),
+        m_filter(agg::image_filter_bicubic())
+    {
+        unsigned x, y;
+        for(y = 0; y < img_size; y++)
+        {
+            agg::int8u* p = m_rbuf.row_ptr(y);
+            for(x = 0; x < img_size; x++)
+            {
+                p[agg::order_bgra::R] = agg::int8u(x);
+                p[agg::order_bgra::G] = agg::int8u(y);
+                p[agg::order_bgra::B] = agg::int8u(((x >> 4) ^ (y >> 4)) & 1 ? 255 : 0);
+                p[agg::order_bgra::A] = 255;
+                p += 4;
+            }
+        }
+        m_mtx *= agg::trans_affine_translation(-img_size / 2.0, -img_size / 2.0);
+        m_mtx *= agg::trans_affine_rotation(0.3);
+        m_mtx *= agg::trans_affine_scaling(w / double(img_size));
+        m_mtx *= agg::trans_affine_translation(w / 2.0, h / 2.0);
+        m_mtx.invert();
+    }
+
+    unsigned stages(stage_stat* st)
+    {
+        stage_stat s1 = { "span_bilinear", "pixels", 0, 0 };
+        stage_stat s2 = { "span_bicubic",  "pixels", 0, 0 };
+        st[0] = s1;
+        st[1] = s2;
+        return 2;
+    }
+
+    void run(renderer_base& rb, stage_stat* st, agg::display_list<>&)
+    {
+        typedef agg::span_interpolator_linear<> interpolator_type;
+        typedef agg::image_accessor_clip<pixfmt> img_source_type;
+        typedef agg::span_image_filter_rgba_bilinear<img_source_type,
+                                                     interpolator_type> bilinear_type;
+        typedef agg::span_image_filter_rgba<img_source_type,
+                                            interpolator_type> bicubic_type;
+
+        pixfmt img_pixf(m_rbuf);
+        img_source_type img_src(img_pixf, agg::rgba(1, 1, 1));
+        interpolator_type interpolator(m_mtx);
+        agg::span_allocator<color_type> sa;
+        rasterizer ras;
+        agg::scanline_p8 sl;
+        double w = rb.width();
+        double h = rb.height();
+        bench_timer t;
+
+        ras.move_to_d(0, 0);
+        ras.line_to_d(w, 0);
+        ras.line_to_d(w, h);
+        ras.line_to_d(0, h);
+
+        bilinear_type sg1(img_src, interpolator);
+        t.start();
+        agg::render_scanlines_aa(ras, sl, rb, sa, sg1);
+        st[0].ms += t.elapsed();
+        st[0].count += w * h;
+
+        bicubic_type sg2(img_src, interpolator, m_filter);
+        t.start();
+        agg::render_scanlines_aa(ras, sl, rb, sa, sg2);
+        st[1].ms += t.elapsed();
+        st[1].count += w * h;
+    }
+
+private:
+    agg::pod_array<agg::int8u> m_img;
+    agg::rendering_buffer      m_rbuf;
+    agg::image_filter_lut      m_filter;
+    agg::trans_affine          m_mtx;
+};
+
+
+//----------------------------------------------------------------------------
+// A map layer: many random polylines with some conic curves, stored both
+// in path_storage and in path_storage_int, transformed, flattened and
+// either filled or stroked into the cells. Only the vertex pipeline and
+// the cell generation are measured, counted in the source vertices.
+class map_scene
+{
+public:
+    enum { num_lines = 2000, num_segments = 50 };
+
+    map_scene(unsigned w, unsigned h)
+    {
+        srand(4321);
+        double mw = w * 5.0;
+        double mh = h * 5.0;
+        unsigned i, j;
+        for(i = 0; i < num_lines; i++)
+        {
+            double x = rand() % int(mw);
+            double y = rand() % int(mh);
+            m_dbl.move_to(x, y);
+            m_int.move_to(to_int(x), to_int(y));
+            for(j = 0; j < num_segments; j++)
+            {
+                double nx = x + rand() % 41 - 20;
+                double ny = y + rand() % 41 - 20;
+                if(j % 10 == 5)
+                {
+                    double cx = x + rand() % 61 - 30;
+                    double cy = y + rand() % 61 - 30;
+                    m_dbl.curve3(cx, cy, nx, ny);
+                    m_int.curve3(to_int(cx), to_int(cy), to_int(nx), to_int(ny));
+                }
+                else
+                {
+                    m_dbl.line_to(nx, ny);
+                    m_int.line_to(to_int(nx), to_int(ny));
+                }
+                x = nx;
+                y = ny;
+            }
+        }
+        m_mtx *= agg::trans_affine_translation(-mw / 2, -mh / 2);
+        m_mtx *= agg::trans_affine_rotation(0.1);
+        m_mtx *= agg::trans_affine_scaling(0.2);
+        m_mtx *= agg::trans_affine_translation(w / 2.0, h / 2.0);
+        m_mtx_int.set(m_mtx);
+    }
+
+    unsigned stages(stage_stat* st)
+    {
+        static const stage_stat s[] =
+        {
+            { "dbl_fill",   "vertices", 0, 0 },
+            { "int_fill",   "vertices", 0, 0 },
+            { "dbl_stroke", "vertices", 0, 0 },
+            { "int_stroke", "vertices", 0, 0 }
+        };
+        unsigned i;
+        for(i = 0; i < 4; i++) st[i] = s[i];
+        return 4;
+    }
+
+    void run(renderer_base& rb, stage_stat* st, agg::display_list<>&)
+    {
+        typedef agg::conv_transform<agg::path_storage>     dbl_trans_type;
+        typedef agg::conv_curve<dbl_trans_type>            dbl_curve_type;
+        typedef agg::conv_transform_int<agg::path_storage_int> int_trans_type;
+        typedef agg::conv_curve_int<int_trans_type>        int_curve_type;
+
+        rasterizer ras;
+        bench_timer t;
+        double n = m_dbl.total_vertices();
+        ras.clip_box(0, 0, rb.width(), rb.height());
+
+        dbl_trans_type dbl_trans(m_dbl, m_mtx);
+        dbl_curve_type dbl_curve(dbl_trans);
+        dbl_curve.approximation_method(agg::curve_inc);
+        agg::conv_stroke<dbl_curve_type> dbl_stroke(dbl_curve);
+        dbl_stroke.width(0.7);
+
+        int_trans_type int_trans(m_int, m_mtx_int);
+        int_curve_type int_curve(int_trans);
+        agg::conv_stroke_int<int_curve_type> int_stroke(int_curve);
+        int_stroke.width(0.7);
+
+        ras.reset();
+        t.start();
+        ras.add_path(dbl_curve);
+        st[0].ms += t.elapsed();
+        st[0].count += n;
+
+        ras.reset();
+        t.start();
+        ras.add_path_int(int_curve);
+        st[1].ms += t.elapsed();
+        st[1].count += n;
+
+        ras.reset();
+        t.start();
+        ras.add_path(dbl_stroke);
+        st[2].ms += t.elapsed();
+        st[2].count += n;
+
+        ras.reset();
+        t.start();
+        ras.add_path_int(int_stroke);
+        st[3].ms += t.elapsed();
+        st[3].count += n;
+    }
+
+private:
+    static int to_int(double v) { return agg::iround(v * agg::poly_subpixel_scale); }
+
+    agg::path_storage      m_dbl;
+    agg::path_storage_int  m_int;
+    agg::trans_affine      m_mtx;
+    agg::trans_affine_int  m_mtx_int;
+};
+
+
+//----------------------------------------------------------------------------
+// Per-frame allocations: every small path gets its own path storage and
+// rasterizer, created and destroyed in the frame, as when the shapes are
+// generated on the fly. The same with the heap and with an arena that is
+// reset once per frame. With glibc malloc the two are within the noise of
+// each other, the allocations take a small part of the time.
+class alloc_scene
+{
+public:
+    enum { num_shapes = 3000, num_vertices = 8 };
+
+    alloc_scene(unsigned w, unsigned h) : m_width(w), m_height(h) {}
+
+    unsigned stages(stage_stat* st)
+    {
+        static const stage_stat s[] =
+        {
+            { "heap",  "paths", 0, 0 },
+            { "arena", "paths", 0, 0 }
+        };
+        st[0] = s[0];
+        st[1] = s[1];
+        return 2;
+    }
+
+    void run(renderer_base&, stage_stat* st, agg::display_list<>&)
+    {
+        bench_timer t;
+
+        t.start();
+        render_shapes<agg::pod_allocator>();
+        st[0].ms += t.elapsed();
+        st[0].count += num_shapes;
+
+        t.start();
+        {
+            agg::arena_scope scope(m_arena);
+            render_shapes<agg::arena_allocator>();
+        }
+        m_arena.reset();
+        st[1].ms += t.elapsed();
+        st[1].count += num_shapes;
+    }
+
+private:
+    template<template<class> class Allocator> void render_shapes()
+    {
+        typedef agg::path_base<agg::vertex_block_storage<double, 8, 256, 
+                                                         Allocator> > path_type;
+        typedef agg::rasterizer_scanline_aa<agg::rasterizer_sl_clip_int,
+                                            agg::cell_sorter_qsort<agg::cell_aa>,
+                                            Allocator> rasterizer_type;
+        agg::scanline_p8 sl;
+        unsigned i, j;
+        srand(1234);
+        for(i = 0; i < num_shapes; i++)
+        {
+            path_type path;
+            rasterizer_type ras;
+            double x = rand() % m_width;
+            double y = rand() % m_height;
+            path.move_to(x, y);
+            for(j = 0; j < num_vertices; j++)
+            {
+                path.line_to(x + rand() % 20, y + rand() % 20);
+            }
+            ras.add_path(path);
+            if(ras.rewind_scanlines())
+            {
+                sl.reset(ras.min_x(), ras.max_x());
+                while(ras.sweep_scanline(sl)) {}
+            }
+        }
+    }
+
+    unsigned          m_width;
+    unsigned          m_height;
+    agg::memory_arena m_arena;
+};
+
+
+//----------------------------------------------------------------------------
+// Interactive editing of the lion: an area of N x N pixels changes in
+// every frame, moving over the picture. The full redraw clears the
+// frame and renders all the paths, the dirty one redraws the old and 
+// the new places of the area and only the paths that overlap them.
+class dirty_scene
+{
+public:
+    enum { num_sizes = 4, num_frames = 16 };
+
+    dirty_scene(unsigned w, unsigned h) : m_width(w), m_height(h)
+    {
+        m_num = parse_lion(m_path, m_srgb, m_path_idx);
+        double x1, y1, x2, y2;
+        agg::pod_array_adaptor<unsigned> path_idx(m_path_idx, 100);
+        agg::bounding_rect(m_path, path_idx, 0, m_num, &x1, &y1, &x2, &y2);
+        double scale = w / (x2 - x1);
+        if(h / (y2 - y1) < scale) scale = h / (y2 - y1);
+        m_mtx *= agg::trans_affine_translation(-x1, -y1);
+        m_mtx *= agg::trans_affine_scaling(scale);
+
+        agg::conv_transform<agg::path_storage> trans(m_path, m_mtx);
+        unsigned i;
+        for(i = 0; i < m_num; i++)
+        {
+            m_colors[i] = color_type(m_srgb[i]);
+            agg::bounding_rect_single(trans, m_path_idx[i], 
+                                      &m_bbox[i].x1, &m_bbox[i].y1,
+                                      &m_bbox[i].x2, &m_bbox[i].y2);
+        }
+        m_dirty.bounds(0, 0, w - 1, h - 1);
+    }
+
+    unsigned stages(stage_stat* st)
+    {
+        static const stage_stat s[] =
+        {
+            { "full",      "pixels", 0, 0 },
+            { "dirty_8",   "pixels", 0, 0 },
+            { "dirty_32",  "pixels", 0, 0 },
+            { "dirty_128", "pixels", 0, 0 },
+            { "dirty_512", "pixels", 0, 0 }
+        };
+        unsigned i;
+        for(i = 0; i <= num_sizes; i++) st[i] = s[i];
+        return num_sizes + 1;
+    }
+
+    void run(renderer_base& rb, stage_stat* st, agg::display_list<>&)
+    {
+        rasterizer ras;
+        bench_timer t;
+        unsigned i, j;
+
+        t.start();
+        for(j = 0; j < num_frames; j++)
+        {
+            rb.clear(agg::rgba(1, 1, 1));
+            agg::rect_i r(0, 0, m_width - 1, m_height - 1);
+            draw(ras, rb, r);
+        }
+        st[0].ms += t.elapsed();
+        st[0].count += double(m_width) * m_height * num_frames;
+
+        for(i = 0; i < num_sizes; i++)
+        {
+            int size = 8 << (i * 2);
+            t.start();
+            for(j = 0; j < num_frames; j++)
+            {
+                m_dirty.clear();
+                m_dirty.add(edit_rect(j, size));
+                m_dirty.add(edit_rect(j + 1, size));
+                agg::render_dirty_rects(m_dirty, ras, rb, 
+                                        color_type(255, 255, 255), *this);
+                st[i + 1].count += m_dirty.area();
+            }
+            st[i + 1].ms += t.elapsed();
+        }
+    }
+
+    void draw(rasterizer& ras, renderer_base& rb, const agg::rect_i& r)
+    {
+        agg::conv_transform<agg::path_storage> trans(m_path, m_mtx);
+        agg::scanline_p8 sl;
+        agg::rect_d rd(r.x1, r.y1, r.x2 + 1, r.y2 + 1);
+        unsigned i;
+        for(i = 0; i < m_num; i++)
+        {
+            if(!m_bbox[i].overlaps(rd)) continue;
+            ras.reset();
+            ras.add_path(trans, m_path_idx[i]);
+            agg::render_scanlines_aa_solid(ras, sl, rb, m_colors[i]);
+        }
+    }
+
+private:
+    // The edited area of the frame, moving along the diagonal
+    agg::rect_i edit_rect(unsigned frame, int size) const
+    {
+        int x = (int(m_width)  - size) * int(frame) / num_frames;
+        int y = (int(m_height) - size) * int(frame) / num_frames;
+        return agg::rect_i(x, y, x + size - 1, y + size - 1);
+    }
+
+    unsigned          m_width;
+    unsigned          m_height;
+    agg::path_storage m_path;
+    agg::srgba8       m_srgb[100];
+    color_type        m_colors[100];
+    unsigned          m_path_idx[100];
+    agg::rect_d       m_bbox[100];
+    unsigned          m_num;
+    agg::trans_affine m_mtx;
+    agg::dirty_rects  m_dirty;
+};
+
+
+//----------------------------------------------------------------------------
+// The union of many building footprints, rendered into scanline storages
+// once. The pairwise union unites them one by one through an intermediate
+// storage, the n-ary one merges all of them in one sweep. All the stages
+// render the union into the frame.
+class sbool_scene
+{
+public:
+    enum { num_shapes = 500 };
+
+    sbool_scene(unsigned w, unsigned h)
+    {
+        rasterizer ras;
+        agg::scanline_u8 sl;
+        unsigned i;
+        srand(4321);
+        for(i = 0; i < num_shapes; i++)
+        {
+            double x = rand() % w;
+            double y = rand() % h;
+            double dx = 8 + rand() % 40;
+            double dy = 8 + rand() % 40;
+            double a = (rand() % 360) * agg::pi / 180.0;
+            agg::path_storage ps;
+            ps.move_to(0, 0);
+            ps.line_to(dx, 0);
+            ps.line_to(dx, dy * 0.5);
+            ps.line_to(dx * 0.5, dy * 0.5);
+            ps.line_to(dx * 0.5, dy);
+            ps.line_to(0, dy);
+            ps.close_polygon();
+            agg::trans_affine mtx = agg::trans_affine_rotation(a) *
+                                    agg::trans_affine_translation(x, y);
+            agg::conv_transform<agg::path_storage> trans(ps, mtx);
+            ras.reset();
+            ras.add_path(trans);
+            m_shapes[i].prepare();
+            agg::render_scanlines(ras, sl, m_shapes[i]);
+            m_union.add(m_shapes[i]);
+        }
+    }
+
+    unsigned stages(stage_stat* st)
+    {
+        static const stage_stat s[] =
+        {
+            { "pairwise", "shapes", 0, 0 },
+            { "nary",     "shapes", 0, 0 },
+            { "nary_mt",  "shapes", 0, 0 }
+        };
+        st[0] = s[0];
+        st[1] = s[1];
+        st[2] = s[2];
+        return 3;
+    }
+
+    void run(renderer_base& rb, stage_stat* st, agg::display_list<>&)
+    {
+        agg::renderer_scanline_aa_solid<renderer_base> ren(rb);
+        agg::scanline_u8 sl, sl1, sl2;
+        bench_timer t;
+        unsigned i;
+        ren.color(color_type(0, 0, 0));
+
+        rb.clear(agg::rgba(1, 1, 1));
+        t.start();
+        m_result[0].prepare();
+        agg::render_scanlines(m_shapes[0], sl, m_result[0]);
+        for(i = 1; i < num_shapes; i++)
+        {
+            m_result[i & 1].prepare();
+            agg::sbool_unite_shapes_aa(m_result[(i - 1) & 1], m_shapes[i],
+                                       sl1, sl2, sl, m_result[i & 1]);
+        }
+        agg::render_scanlines(m_result[(num_shapes - 1) & 1], sl, ren);
+        st[0].ms += t.elapsed();
+        st[0].count += num_shapes;
+
+        rb.clear(agg::rgba(1, 1, 1));
+        t.start();
+        m_union.render(sl, ren);
+        st[1].ms += t.elapsed();
+        st[1].count += num_shapes;
+
+        rb.clear(agg::rgba(1, 1, 1));
+        t.start();
+        m_union.render_parallel(sl, ren);
+        st[2].ms += t.elapsed();
+        st[2].count += num_shapes;
+    }
+
+private:
+    agg::scanline_storage_aa8 m_shapes[num_shapes];
+    agg::scanline_storage_aa8 m_result[2];
+    agg::sbool_unite_nary_aa<agg::scanline_storage_aa8> m_union;
+};
+
+
+//----------------------------------------------------------------------------
+// The Boolean operations on two polygons with many vertices and many
+// intersections: the map of Great Britain and the arrows over it.
+class polybool_scene
+{
+    typedef agg::conv_transform<agg::path_storage> trans_type;
+
+public:
+    polybool_scene(unsigned, unsigned) :
+        m_trans_gb(m_gb, m_mtx_gb),
+        m_trans_arrows(m_arrows, m_mtx_arrows)
+    {
+        make_gb_poly(m_gb);
+        make_arrows(m_arrows);
+        m_mtx_gb *= agg::trans_affine_translation(-1150, -1150);
+        m_mtx_gb *= agg::trans_affine_scaling(2.0);
+        m_mtx_arrows = m_mtx_gb;
+        m_mtx_arrows *= agg::trans_affine_translation(50, 30);
+    }
+
+    unsigned stages(stage_stat* st)
+    {
+        static const stage_stat s[] =
+        {
+            { "or",      "vertices", 0, 0 },
+            { "and",     "vertices", 0, 0 },
+            { "xor",     "vertices", 0, 0 },
+            { "a_b",     "vertices", 0, 0 },
+            { "gpc_or",  "vertices", 0, 0 },
+            { "gpc_and", "vertices", 0, 0 },
+            { "gpc_xor", "vertices", 0, 0 },
+            { "gpc_a_b", "vertices", 0, 0 }
+        };
+        unsigned n = 4;
+#ifdef AGG_USE_GPC
+        n = 8;
+#endif
+        unsigned i;
+        for(i = 0; i < n; i++) st[i] = s[i];
+        return n;
+    }
+
+    void run(renderer_base&, stage_stat* st, agg::display_list<>&)
+    {
+        static const agg::polygon_bool_op_e ops[] =
+        {
+            agg::polygon_bool_or,
+            agg::polygon_bool_and,
+            agg::polygon_bool_xor,
+            agg::polygon_bool_a_minus_b
+        };
+        bench_timer t;
+        unsigned i;
+        for(i = 0; i < 4; i++)
+        {
+            agg::conv_polygon_bool<trans_type, trans_type>
+                pb(m_trans_gb, m_trans_arrows, ops[i]);
+            t.start();
+            st[i].count += count_vertices(pb);
+            st[i].ms += t.elapsed();
+        }
+
+#ifdef AGG_USE_GPC
+        static const agg::gpc_op_e gpc_ops[] =
+        {
+            agg::gpc_or,
+            agg::gpc_and,
+            agg::gpc_xor,
+            agg::gpc_a_minus_b
+        };
+        for(i = 0; i < 4; i++)
+        {
+            agg::conv_gpc<trans_type, trans_type>
+                gpc(m_trans_gb, m_trans_arrows, gpc_ops[i]);
+            t.start();
+            st[i + 4].count += count_vertices(gpc);
+            st[i + 4].ms += t.elapsed();
+        }
+#endif
+    }
+
+private:
+    agg::path_storage m_gb;
+    agg::path_storage m_arrows;
+    agg::trans_affine m_mtx_gb;
+    agg::trans_affine m_mtx_arrows;
+    trans_type        m_trans_gb;
+    trans_type        m_trans_arrows;
+};
+
+
+//----------------------------------------------------------------------------
+// The lion scaled to the frame and rasterized into scanline storages
+// once, for the scenes that measure the blending only.
+class lion_storages
+{
+public:
+    lion_storages(unsigned w, unsigned h) : m_pixels(0)
+    {
+        m_num = parse_lion(m_path, m_srgb, m_path_idx);
+        unsigned i;
+        for(i = 0; i < m_num; i++) m_colors[i] = color_type(m_srgb[i]);
+
+        double x1, y1, x2, y2;
+        agg::pod_array_adaptor<unsigned> path_idx(m_path_idx, 100);
+        agg::bounding_rect(m_path, path_idx, 0, m_num, &x1, &y1, &x2, &y2);
+        double scale = w / (x2 - x1);
+        if(h / (y2 - y1) < scale) scale = h / (y2 - y1);
+        agg::trans_affine mtx;
+        mtx *= agg::trans_affine_translation(-x1, -y1);
+        mtx *= agg::trans_affine_scaling(scale);
+
+        rasterizer ras;
+        agg::scanline_u8 sl;
+        agg::scanline_p8 slp;
+        agg::conv_transform<agg::path_storage> trans(m_path, mtx);
+        for(i = 0; i < m_num; i++)
+        {
+            ras.reset();
+            ras.add_path(trans, m_path_idx[i]);
+            m_lion[i].prepare();
+            agg::render_scanlines(ras, sl, m_lion[i]);
+
+            if(m_lion[i].rewind_scanlines())
+            {
+                slp.reset(m_lion[i].min_x(), m_lion[i].max_x());
+                while(m_lion[i].sweep_scanline(slp))
+                {
+                    agg::scanline_p8::const_iterator span = slp.begin();
+                    unsigned num_spans = slp.num_spans();
+                    do
+                    {
+                        m_pixels += abs(span->len);
+                        ++span;
+                    }
+                    while(--num_spans);
+                }
+            }
+        }
+    }
+
+    // The pixels of all the spans
+    unsigned pixels() const { return m_pixels; }
+
+    template<class BaseRenderer> void render(BaseRenderer& rb)
+    {
+        agg::renderer_scanline_aa_solid<BaseRenderer> ren(rb);
+        agg::scanline_u8 sl;
+        unsigned i;
+        for(i = 0; i < m_num; i++)
+        {
+            ren.color(m_colors[i]);
+            agg::render_scanlines(m_lion[i], sl, ren);
+        }
+    }
+
+private:
+    agg::path_storage         m_path;
+    agg::srgba8               m_srgb[100];
+    color_type                m_colors[100];
+    unsigned                  m_path_idx[100];
+    unsigned                  m_num;
+    agg::scanline_storage_aa8 m_lion[100];
+    unsigned                  m_pixels;
+};
+
+
+//----------------------------------------------------------------------------
+// A clip mask of many overlapping ellipses, mostly fully covered or
+// empty, as a byte per pixel and as runs. The amask stages measure
+// the blending of the pre-rasterized lion through the mask.
+class amask_scene
+{
+    typedef agg::pixfmt_amask_adaptor<pixfmt, agg::alpha_mask_gray8> amask_u8_type;
+    typedef agg::pixfmt_amask_adaptor<pixfmt, agg::alpha_mask_rle>   amask_rle_type;
+
+public:
+    enum { num_ellipses = 40 };
+
+    amask_scene(unsigned w, unsigned h) :
+        m_lion(w, h),
+        m_buf(w * h),
+        m_rbuf(m_buf.data(), w, h, w),
+        m_mask_u8(m_rbuf)
+    {
+        unsigned i;
+        srand(1234);
+        for(i = 0; i < num_ellipses; i++)
+        {
+            agg::ellipse e(rand() % w, rand() % h,
+                           20 + rand() % (w / 4), 20 + rand() % (h / 4), 100);
+            m_ellipses.concat_path(e);
+        }
+    }
+
+    unsigned stages(stage_stat* st)
+    {
+        static const stage_stat s[] =
+        {
+            { "mask_u8",   "bytes",  0, 0 },
+            { "mask_rle",  "bytes",  0, 0 },
+            { "amask_u8",  "pixels", 0, 0 },
+            { "amask_rle", "pixels", 0, 0 }
+        };
+        unsigned i;
+        for(i = 0; i < 4; i++) st[i] = s[i];
+        return 4;
+    }
+
+    void run(renderer_base& rb, stage_stat* st, agg::display_list<>&)
+    {
+        rasterizer ras;
+        agg::scanline_u8 sl;
+        bench_timer t;
+
+        ras.clip_box(0, 0, rb.width(), rb.height());
+        ras.add_path(m_ellipses);
+        ras.sort();
+
+        t.start();
+        agg::pixfmt_gray8 pixg(m_rbuf);
+        agg::renderer_base<agg::pixfmt_gray8> rbg(pixg);
+        agg::renderer_scanline_aa_solid<agg::renderer_base<agg::pixfmt_gray8> > reng(rbg);
+        rbg.clear(agg::gray8(0));
+        reng.color(agg::gray8(255));
+        agg::render_scanlines(ras, sl, reng);
+        st[0].ms += t.elapsed();
+        st[0].count += m_buf.size();
+
+        t.start();
+        agg::render_scanlines(ras, sl, m_mask_rle);
+        st[1].ms += t.elapsed();
+        st[1].count += m_mask_rle.byte_size();
+
+        amask_u8_type pfu8(rb.ren(), m_mask_u8);
+        agg::renderer_base<amask_u8_type> rbu8(pfu8);
+        rb.clear(agg::rgba(1, 1, 1));
+        t.start();
+        m_lion.render(rbu8);
+        st[2].ms += t.elapsed();
+        st[2].count += m_lion.pixels();
+
+        amask_rle_type pfrle(rb.ren(), m_mask_rle);
+        agg::renderer_base<amask_rle_type> rbrle(pfrle);
+        rb.clear(agg::rgba(1, 1, 1));
+        t.start();
+        m_lion.render(rbrle);
+        st[3].ms += t.elapsed();
+        st[3].count += m_lion.pixels();
+    }
+
+private:
+    lion_storages              m_lion;
+    agg::path_storage          m_ellipses;
+    agg::pod_array<agg::int8u> m_buf;
+    agg::rendering_buffer      m_rbuf;
+    agg::alpha_mask_gray8      m_mask_u8;
+    agg::alpha_mask_rle        m_mask_rle;
+};
+
+
+//----------------------------------------------------------------------------
+// The pre-rasterized lion clipped by a grid of boxes with gaps, as in
+// multi_clip.cpp, with thousands of boxes.
+class mclip_scene
+{
+public:
+    mclip_scene(unsigned w, unsigned h) : m_lion(w, h) {}
+
+    unsigned stages(stage_stat* st)
+    {
+        static const stage_stat s[] =
+        {
+            { "mclip_100",    "pixels", 0, 0 },
+            { "indexed_100",  "pixels", 0, 0 },
+            { "mclip_1000",   "pixels", 0, 0 },
+            { "indexed_1000", "pixels", 0, 0 },
+            { "mclip_4000",   "pixels", 0, 0 },
+            { "indexed_4000", "pixels", 0, 0 }
+        };
+        unsigned i;
+        for(i = 0; i < 6; i++) st[i] = s[i];
+        return 6;
+    }
+
+    void run(renderer_base& rb, stage_stat* st, agg::display_list<>&)
+    {
+        static const unsigned nx[] = { 10, 40, 80 };
+        static const unsigned ny[] = { 10, 25, 50 };
+        agg::renderer_mclip<pixfmt>         mclip(rb.ren());
+        agg::renderer_mclip_indexed<pixfmt> indexed(rb.ren());
+        bench_timer t;
+        unsigned i;
+        for(i = 0; i < 3; i++)
+        {
+            add_boxes(mclip,   nx[i], ny[i]);
+            add_boxes(indexed, nx[i], ny[i]);
+
+            rb.clear(agg::rgba(1, 1, 1));
+            t.start();
+            m_lion.render(mclip);
+            st[i * 2].ms += t.elapsed();
+            st[i * 2].count += m_lion.pixels();
+
+            rb.clear(agg::rgba(1, 1, 1));
+            t.start();
+            m_lion.render(indexed);
+            st[i * 2 + 1].ms += t.elapsed();
+            st[i * 2 + 1].count += m_lion.pixels();
+        }
+    }
+
+private:
+    template<class Renderer>
+    static void add_boxes(Renderer& r, unsigned nx, unsigned ny)
+    {
+        r.reset_clipping(false);
+        unsigned x, y;
+        for(y = 0; y < ny; y++)
+        {
+            for(x = 0; x < nx; x++)
+            {
+                int x1 = int(r.width()  * x / nx);
+                int y1 = int(r.height() * y / ny);
+                int x2 = int(r.width()  * (x + 1) / nx);
+                int y2 = int(r.height() * (y + 1) / ny);
+                r.add_clip_box(x1 + 2, y1 + 2, x2 - 2, y2 - 2);
+            }
+        }
+    }
+
+    lion_storages m_lion;
+};
+
+
+//----------------------------------------------------------------------------
+// The edges of a large graph, short random segments of 1.5 pixels wide
+// outlines with round caps in random translucent colors. The polyline
+// stages draw every segment through rasterizer_outline_aa, the batch ones
+// through rasterizer_outline_aa_batch, in one thread and in one thread
+// per processor.
+class outline_scene
+{
+    typedef agg::renderer_outline_aa<renderer_base> renderer_type;
+
+public:
+    outline_scene(unsigned w, unsigned h) :
+        m_xy(num_1m * 4),
+        m_colors(num_1m)
+    {
+        m_profile.width(1.5);
+        srand(2024);
+        unsigned i;
+        for(i = 0; i < num_1m; i++)
+        {
+            double x = rand() % w;
+            double y = rand() % h;
+            m_xy[i * 4]     = x;
+            m_xy[i * 4 + 1] = y;
+            m_xy[i * 4 + 2] = x + (rand() % 4000) / 100.0 - 20.0;
+            m_xy[i * 4 + 3] = y + (rand() % 4000) / 100.0 - 20.0;
+            m_colors[i] = color_type(rand() & 0x7F, rand() & 0x7F,
+                                     rand() & 0x7F, 0x80 + (rand() & 0x7F));
+        }
+    }
+
+    unsigned stages(stage_stat* st)
+    {
+        static const stage_stat s[] =
+        {
+            { "polyline_100k", "segments", 0, 0 },
+            { "batch_100k",    "segments", 0, 0 },
+            { "batch_mt_100k", "segments", 0, 0 },
+            { "polyline_1m",   "segments", 0, 0 },
+            { "batch_1m",      "segments", 0, 0 },
+            { "batch_mt_1m",   "segments", 0, 0 }
+        };
+        unsigned i;
+        for(i = 0; i < 6; i++) st[i] = s[i];
+        return 6;
+    }
+
+    void run(renderer_base& rb, stage_stat* st, agg::display_list<>&)
+    {
+        run_size(rb, st,     num_100k);
+        run_size(rb, st + 3, num_1m);
+    }
+
+private:
+    enum
+    {
+        num_100k = 100000,
+        num_1m   = 1000000
+    };
+
+    void run_size(renderer_base& rb, stage_stat* st, unsigned num)
+    {
+        renderer_type ren(rb, m_profile);
+        agg::rasterizer_outline_aa<renderer_type> ras(ren);
+        agg::rasterizer_outline_aa_batch<renderer_type> batch(ren);
+        bench_timer t;
+        unsigned i;
+        ras.round_cap(true);
+        batch.round_cap(true);
+
+        rb.clear(agg::rgba(1, 1, 1));
+        t.start();
+        for(i = 0; i < num; i++)
+        {
+            const double* xy = &m_xy[i * 4];
+            ren.color(m_colors[i]);
+            ras.move_to_d(xy[0], xy[1]);
+            ras.line_to_d(xy[2], xy[3]);
+            ras.render(false);
+        }
+        st[0].ms += t.elapsed();
+        st[0].count += num;
+
+        rb.clear(agg::rgba(1, 1, 1));
+        t.start();
+        for(i = 0; i < num; i++)
+        {
+            const double* xy = &m_xy[i * 4];
+            batch.add_segment_d(xy[0], xy[1], xy[2], xy[3], m_colors[i]);
+        }
+        batch.render();
+        st[1].ms += t.elapsed();
+        st[1].count += num;
+
+        rb.clear(agg::rgba(1, 1, 1));
+        t.start();
+        batch.render_parallel();
+        st[2].ms += t.elapsed();
+        st[2].count += num;
+    }
+
+    agg::line_profile_aa      m_profile;
+    agg::pod_array<double>    m_xy;
+    agg::pod_array<color_type> m_colors;
+};
+
+
+//----------------------------------------------------------------------------
+static void usage()
+{
+    fprintf(stderr,
+            "Usage: benchmark [-scene lion|gb_poly|text|curves|image|map|alloc|dirty|\n"
+            "                         sbool|polybool|amask|mclip|outline]\n"
+            "                 [-iter N] [-time MS] [-size WxH] [-json]\n");
+}
+
+
+int main(int argc, char* argv[])
+{
+    bench_options opt;
+    opt.scene      = 0;
+    opt.iterations = 0;
+    opt.min_time   = 300.0;
+    opt.width      = 800;
+    opt.height     = 600;
+    opt.json       = false;
+
+    int i;
+    for(i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "-scene") == 0 && i + 1 < argc)
+        {
+            opt.scene = argv[++i];
+        }
+        else if(strcmp(argv[i], "-iter") == 0 && i + 1 < argc)
+        {
+            opt.iterations = unsigned(atoi(argv[++i]));
+        }
+        else if(strcmp(argv[i], "-time") == 0 && i + 1 < argc)
+        {
+            opt.min_time = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+        {
+            unsigned w, h;
+            if(sscanf(argv[++i], "%ux%u", &w, &h) != 2 || w == 0 || h == 0)
+            {
+                usage();
+                return 1;
+            }
+            opt.width  = w;
+            opt.height = h;
+        }
+        else if(strcmp(argv[i], "-json") == 0)
+        {
+            opt.json = true;
+        }
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    bench_report report(opt.json);
+
+    lion_scene     lion(opt.width, opt.height);
+    gb_poly_scene  gb_poly(opt.width, opt.height);
+    text_scene     text(opt.width, opt.height);
+    curves_scene   curves(opt.width, opt.height);
+    image_scene    image(opt.width, opt.height);
+    map_scene      map(opt.width, opt.height);
+    alloc_scene    alloc(opt.width, opt.height);
+    dirty_scene    dirty(opt.width, opt.height);
+    sbool_scene    sbool(opt.width, opt.height);
+    polybool_scene polybool(opt.width, opt.height);
+    amask_scene    amask(opt.width, opt.height);
+    mclip_scene    mclip(opt.width, opt.height);
+    outline_scene  outline(opt.width, opt.height);
+
+    run_scene("lion",     lion,     opt, report);
+    run_scene("gb_poly",  gb_poly,  opt, report);
+    run_scene("text",     text,     opt, report);
+    run_scene("curves",   curves,   opt, report);
+    run_scene("image",    image,    opt, report);
+    run_scene("map",      map,      opt, report);
+    run_scene("alloc",    alloc,    opt, report);
+    run_scene("dirty",    dirty,    opt, report);
+    run_scene("sbool",    sbool,    opt, report);
+    run_scene("polybool", polybool, opt, report);
+    run_scene("amask",    amask,    opt, report);
+    run_scene("mclip",    mclip,    opt, report);
+    run_scene("outline",  outline,  opt, report);
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_scanline_p.h"
+#include "agg_renderer_scanline.h"
+#include "agg_span_allocator.h"
+#include "agg_span_gradient.h"
+#include "agg_span_interpolator_linear.h"
+#include "agg_ellipse.h"
+#include "agg_simd.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGRA32
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+
+//----------------------------------------------------------------------------
+// Random translucent ellipses, filled with solid colors, which goes
+// to blend_solid_hspan(), and with gradients, which goes to
+// blend_color_hspan().
+class ellipses_scene
+{
+public:
+    typedef agg::gradient_linear_color<color_type> color_func_type;
+    typedef agg::span_interpolator_linear<> interpolator_type;
+    typedef agg::span_gradient<color_type,
+                               interpolator_type,
+                               agg::gradient_x,
+                               color_func_type> span_gradient_type;
+
+    enum { num_ellipses = 400 };
+
+    void generate(double w, double h)
+    {
+        srand(100);
+        unsigned i;
+        for(i = 0; i < num_ellipses; i++)
+        {
+            m_x[i]  = rand() % int(w);
+            m_y[i]  = rand() % int(h);
+            m_rx[i] = rand() % 100 + 5;
+            m_ry[i] = rand() % 100 + 5;
+            m_c1[i] = color_type(rand() & 0xFF, rand() & 0xFF,
+                                 rand() & 0xFF, rand() & 0xFF);
+            m_c2[i] = color_type(rand() & 0xFF, rand() & 0xFF,
+                                 rand() & 0xFF, rand() & 0xFF);
+        }
+    }
+
+    template<class Rasterizer, class Scanline, class BaseRenderer>
+    void render(Rasterizer& ras, Scanline& sl, BaseRenderer& ren)
+    {
+        agg::span_allocator<color_type> alloc;
+        agg::gradient_x gradient_func;
+        unsigned i;
+        for(i = 0; i < num_ellipses; i++)
+        {
+            agg::ellipse e(m_x[i], m_y[i], m_rx[i], m_ry[i], 100);
+            ras.reset();
+            ras.add_path(e);
+            if(i & 1)
+            {
+                agg::trans_affine mtx;
+                mtx *= agg::trans_affine_scaling(m_rx[i] / 50.0);
+                mtx *= agg::trans_affine_translation(m_x[i] - m_rx[i], m_y[i]);
+                mtx.invert();
+                interpolator_type inter(mtx);
+                color_func_type colors(m_c1[i], m_c2[i]);
+                span_gradient_type sg(inter, gradient_func, colors, 0, 100);
+                agg::render_scanlines_aa(ras, sl, ren, alloc, sg);
+            }
+            else
+            {
+                agg::render_scanlines_aa_solid(ras, sl, ren, m_c1[i]);
+            }
+        }
+    }
+
+private:
+    double     m_x[num_ellipses];
+    double     m_y[num_ellipses];
+    double     m_rx[num_ellipses];
+    double     m_ry[num_ellipses];
+    color_type m_c1[num_ellipses];
+    color_type m_c2[num_ellipses];
+};
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::rbox_ctrl<color_type> m_format;
+    agg::cbox_ctrl<color_type> m_simd;
+    agg::cbox_ctrl<color_type> m_test;
+    ellipses_scene             m_scene;
+
+public:
+    typedef agg::renderer_base<pixfmt>     renderer_base;
+    typedef agg::renderer_base<pixfmt_pre> renderer_base_pre;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_format(5.0, 5.0, 150.0, 45.0, !flip_y),
+        m_simd(160.0, 5.0, "Use SIMD", !flip_y),
+        m_test(160.0, 25.0, "Test Performance", !flip_y)
+    {
+        m_format.add_item("Plain Colors");
+        m_format.add_item("Premultiplied Colors");
+        m_format.cur_item(0);
+        add_ctrl(m_format);
+        m_format.no_transform();
+
+        m_simd.status(true);
+        add_ctrl(m_simd);
+        m_simd.no_transform();
+
+        add_ctrl(m_test);
+        m_test.text_size(9.0, 7.0);
+        m_test.no_transform();
+    }
+
+    virtual void on_init()
+    {
+        m_scene.generate(width(), height());
+    }
+
+    template<class PixFmt> void draw(agg::rendering_buffer& rbuf)
+    {
+        PixFmt pixf(rbuf);
+        agg::renderer_base<PixFmt> rb(pixf);
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        rb.clear(agg::rgba(1, 1, 1));
+        m_scene.render(ras, sl, rb);
+    }
+
+    void draw(agg::rendering_buffer& rbuf)
+    {
+        if(m_format.cur_item() == 0) draw<pixfmt>(rbuf);
+        else                         draw<pixfmt_pre>(rbuf);
+    }
+
+    virtual void on_draw()
+    {
+        agg::simd_level(m_simd.status() ? agg::simd_avx2 : agg::simd_none);
+        draw(rbuf_window());
+
+        pixfmt pixf(rbuf_window());
+        renderer_base rb(pixf);
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_p8 sl;
+        agg::render_ctrl(ras, sl, rb, m_format);
+        agg::render_ctrl(ras, sl, rb, m_simd);
+        agg::render_ctrl(ras, sl, rb, m_test);
+    }
+
+    virtual void on_ctrl_change()
+    {
+        if(m_test.status())
+        {
+            // Render the scene with the plain C++ blenders and with the
+            // best SIMD version the processor supports, compare the results
+            // and measure the time.
+            unsigned w = rbuf_window().width();
+            unsigned h = rbuf_window().height();
+            unsigned stride = w * pixfmt::pix_width;
+            agg::pod_array<agg::int8u> buf1(stride * h);
+            agg::pod_array<agg::int8u> buf2(stride * h);
+            agg::rendering_buffer rbuf1(buf1.data(), w, h, stride);
+            agg::rendering_buffer rbuf2(buf2.data(), w, h, stride);
+            unsigned i;
+
+            agg::simd_level(agg::simd_none);
+            start_timer();
+            for(i = 0; i < 10; i++) draw(rbuf1);
+            double t1 = elapsed_time() / 10;
+
+            agg::simd_level(agg::simd_avx2);
+            agg::simd_level_e level = agg::simd_level();
+            start_timer();
+            for(i = 0; i < 10; i++) draw(rbuf2);
+            double t2 = elapsed_time() / 10;
+
+            bool identical = memcmp(buf1.data(), buf2.data(), stride * h) == 0;
+
+            static const char* level_names[] = { "None", "SSE2", "AVX2" };
+            m_test.status(false);
+            force_redraw();
+            char buf[256];
+            sprintf(buf, "C++=%.2fms, %s=%.2fms, Output %s",
+                    t1, level_names[level], t2,
+                    identical ? "identical" : "DIFFERS");
+            message(buf);
+        }
+    }
+};
+
+
+int agg_main(int, char*[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. SIMD Span Blending");
+
+    if(app.init(800, 600, 0))
+    {
+        return app.run();
+    }
+    return 1;
+}
@@ -0,0 +1,199 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_p.h"
+#include "agg_renderer_base.h"
+#include "agg_renderer_scanline.h"
+#include "agg_ellipse.h"
+#include "agg_blur_parallel.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGRA32
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+
+class the_application : public agg::platform_support
+{
+    agg::rbox_ctrl<color_type>   m_method;
+    agg::slider_ctrl<color_type> m_radius;
+    agg::cbox_ctrl<color_type>   m_threads;
+    agg::cbox_ctrl<color_type>   m_test;
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_method(10.0, 10.0, 170.0, 70.0, !flip_y),
+        m_radius(180.0, 14.0, 480.0, 22.0, !flip_y),
+        m_threads(180.0, 30.0, "Use Threads", !flip_y),
+        m_test(180.0, 50.0, "Test Performance", !flip_y)
+    {
+        m_method.text_size(8);
+        m_method.add_item("stack_blur_rgba32()");
+        m_method.add_item("stack_blur");
+        m_method.add_item("recursive_blur");
+        m_method.cur_item(0);
+        add_ctrl(m_method);
+        m_method.no_transform();
+
+        m_radius.range(0.0, 80.0);
+        m_radius.value(20.0);
+        m_radius.label("Blur Radius=%1.2f");
+        add_ctrl(m_radius);
+        m_radius.no_transform();
+
+        m_threads.status(true);
+        add_ctrl(m_threads);
+        m_threads.no_transform();
+
+        add_ctrl(m_test);
+        m_test.text_size(9.0, 7.0);
+        m_test.no_transform();
+    }
+
+    void draw_scene(agg::rendering_buffer& rbuf)
+    {
+        pixfmt pixf(rbuf);
+        renderer_base rb(pixf);
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_p8 sl;
+        rb.clear(agg::rgba(1, 1, 1));
+
+        srand(100);
+        unsigned i;
+        for(i = 0; i < 200; i++)
+        {
+            agg::ellipse e(rand() % rbuf.width(), rand() % rbuf.height(),
+                           rand() % 60 + 5, rand() % 60 + 5, 100);
+            ras.reset();
+            ras.add_path(e);
+            agg::render_scanlines_aa_solid(ras, sl, rb,
+                agg::rgba8(rand() & 0xFF, rand() & 0xFF,
+                           rand() & 0xFF, (rand() & 0x7F) + 0x80));
+        }
+    }
+
+    // Blurs the image with the serial or with the parallel version
+    // of the selected method.
+    void blur(agg::rendering_buffer& rbuf, bool parallel, unsigned num_threads)
+    {
+        pixfmt pixf(rbuf);
+        double r = m_radius.value();
+        switch(m_method.cur_item())
+        {
+        case 0:
+            if(parallel)
+            {
+                agg::stack_blur_rgba32_parallel(pixf, agg::uround(r),
+                                                agg::uround(r), num_threads);
+            }
+            else
+            {
+                agg::stack_blur_rgba32(pixf, agg::uround(r), agg::uround(r));
+            }
+            break;
+
+        case 1:
+            if(parallel)
+            {
+                agg::stack_blur_parallel<color_type,
+                    agg::stack_blur_calc_rgba<> > sb(num_threads);
+                sb.blur(pixf, agg::uround(r));
+            }
+            else
+            {
+                agg::stack_blur<color_type, agg::stack_blur_calc_rgba<> > sb;
+                sb.blur(pixf, agg::uround(r));
+            }
+            break;
+
+        case 2:
+            if(parallel)
+            {
+                agg::recursive_blur_parallel<color_type,
+                    agg::recursive_blur_calc_rgba<> > rb(num_threads);
+                rb.blur(pixf, r);
+            }
+            else
+            {
+                agg::recursive_blur<color_type,
+                                    agg::recursive_blur_calc_rgba<> > rb;
+                rb.blur(pixf, r);
+            }
+            break;
+        }
+    }
+
+    virtual void on_draw()
+    {
+        draw_scene(rbuf_window());
+        blur(rbuf_window(), true, m_threads.status() ? 0 : 1);
+
+        pixfmt pixf(rbuf_window());
+        renderer_base rb(pixf);
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_p8 sl;
+        agg::render_ctrl(ras, sl, rb, m_method);
+        agg::render_ctrl(ras, sl, rb, m_radius);
+        agg::render_ctrl(ras, sl, rb, m_threads);
+        agg::render_ctrl(ras, sl, rb, m_test);
+    }
+
+    virtual void on_ctrl_change()
+    {
+        if(m_test.status())
+        {
+            // Blur the same image with the serial version and with the
+            // parallel one, compare the results and measure the time.
+            unsigned w = rbuf_window().width();
+            unsigned h = rbuf_window().height();
+            unsigned stride = w * pixfmt::pix_width;
+            agg::pod_array<agg::int8u> buf1(stride * h);
+            agg::pod_array<agg::int8u> buf2(stride * h);
+            agg::rendering_buffer rbuf1(buf1.data(), w, h, stride);
+            agg::rendering_buffer rbuf2(buf2.data(), w, h, stride);
+            draw_scene(rbuf1);
+            draw_scene(rbuf2);
+
+            start_timer();
+            blur(rbuf1, false, 1);
+            double t1 = elapsed_time();
+
+            start_timer();
+            blur(rbuf2, true, m_threads.status() ? 0 : 1);
+            double t2 = elapsed_time();
+
+            bool identical = memcmp(buf1.data(), buf2.data(), stride * h) == 0;
+
+            m_test.status(false);
+            force_redraw();
+            char buf[256];
+            sprintf(buf, "Serial=%.2fms, Parallel=%.2fms (%u CPUs), Output %s",
+                    t1, t2, agg::num_cpus(),
+                    identical ? "identical" : "DIFFERS");
+            message(buf);
+        }
+    }
+};
+
+
+int agg_main(int, char*[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Parallel Blur");
+
+    if(app.init(800, 600, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
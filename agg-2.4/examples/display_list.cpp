@@ -0,0 +1,316 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_p.h"
+#include "agg_renderer_scanline.h"
+#include "agg_display_list.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_bounding_rect.h"
+#include "agg_ellipse.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGRA32
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+agg::path_storage g_path;
+agg::srgba8       g_colors[100];
+unsigned          g_path_idx[100];
+unsigned          g_npaths = 0;
+double            g_x1 = 0;
+double            g_y1 = 0;
+double            g_x2 = 0;
+double            g_y2 = 0;
+
+unsigned parse_lion(agg::path_storage& ps, agg::srgba8* colors, unsigned* path_idx);
+void parse_lion()
+{
+    g_npaths = parse_lion(g_path, g_colors, g_path_idx);
+    agg::pod_array_adaptor<unsigned> path_idx(g_path_idx, 100);
+    agg::bounding_rect(g_path, path_idx, 0, g_npaths, &g_x1, &g_y1, &g_x2, &g_y2);
+}
+
+
+//----------------------------------------------------------------------------
+// The styles of the display list are the indices of the lion colors.
+class lion_styles
+{
+public:
+    bool       is_solid(unsigned) const      { return true; }
+    color_type color(unsigned style) const   { return color_type(g_colors[style]); }
+    void generate_span(color_type*, int, int, unsigned, unsigned) {}
+};
+
+
+//----------------------------------------------------------------------------
+// A grid of lions, the static layer. It's either rendered directly, or
+// recorded into a display list, with the path index as the style.
+class lion_grid
+{
+public:
+    lion_grid(unsigned num) : m_num(num) {}
+
+    template<class Rasterizer, class Target>
+    void render(Rasterizer& ras, double w, double h, Target& target)
+    {
+        double cell_w = w / m_num;
+        double cell_h = h / m_num;
+        double scale = cell_w / (g_x2 - g_x1);
+        if(cell_h / (g_y2 - g_y1) < scale) scale = cell_h / (g_y2 - g_y1);
+
+        ras.clip_box(0, 0, w, h);
+
+        unsigned i, j, k;
+        for(i = 0; i < m_num; i++)
+        {
+            for(j = 0; j < m_num; j++)
+            {
+                agg::trans_affine mtx;
+                mtx *= agg::trans_affine_translation(-(g_x1 + g_x2) / 2,
+                                                     -(g_y1 + g_y2) / 2);
+                mtx *= agg::trans_affine_rotation(agg::pi);
+                mtx *= agg::trans_affine_scaling(scale * 1.2);
+                mtx *= agg::trans_affine_translation(cell_w * (j + 0.5),
+                                                     cell_h * (i + 0.5));
+
+                agg::conv_transform<agg::path_storage, agg::trans_affine> trans(g_path, mtx);
+                for(k = 0; k < g_npaths; k++)
+                {
+                    ras.reset();
+                    ras.add_path(trans, g_path_idx[k]);
+                    target.path(ras, k);
+                }
+            }
+        }
+    }
+
+private:
+    unsigned m_num;
+};
+
+
+//----------------------------------------------------------------------------
+template<class BaseRenderer> class direct_target
+{
+public:
+    direct_target(BaseRenderer& ren) : m_ren(&ren) {}
+
+    template<class Rasterizer> void path(Rasterizer& ras, unsigned k)
+    {
+        agg::render_scanlines_aa_solid(ras, m_sl, *m_ren, g_colors[k]);
+    }
+
+private:
+    BaseRenderer*    m_ren;
+    agg::scanline_p8 m_sl;
+};
+
+
+//----------------------------------------------------------------------------
+class record_target
+{
+public:
+    record_target(agg::display_list<>& dl) : m_dl(&dl) {}
+
+    template<class Rasterizer> void path(Rasterizer& ras, unsigned k)
+    {
+        m_dl->add(ras, k);
+    }
+
+private:
+    agg::display_list<>* m_dl;
+};
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::slider_ctrl<color_type> m_num_lions;
+    agg::slider_ctrl<color_type> m_num_threads;
+    agg::cbox_ctrl<color_type>   m_test;
+    agg::display_list<>          m_layer;
+    unsigned                     m_layer_num;
+    unsigned                     m_layer_width;
+    unsigned                     m_layer_height;
+    double                       m_x;
+    double                       m_y;
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_num_lions  (5, 5,    340, 12,    !flip_y),
+        m_num_threads(5, 5+20, 340, 12+20, !flip_y),
+        m_test(350, 5, "Test Performance", !flip_y),
+        m_layer_num(0),
+        m_layer_width(0),
+        m_layer_height(0),
+        m_x(100),
+        m_y(100)
+    {
+        parse_lion();
+
+        add_ctrl(m_num_lions);
+        m_num_lions.range(1.0, 20.0);
+        m_num_lions.num_steps(19);
+        m_num_lions.value(6.0);
+        m_num_lions.label("Lions per Row=%.0f");
+        m_num_lions.no_transform();
+
+        add_ctrl(m_num_threads);
+        m_num_threads.range(1.0, 32.0);
+        m_num_threads.num_steps(31);
+        m_num_threads.value(4.0);
+        m_num_threads.label("Threads=%.0f");
+        m_num_threads.no_transform();
+
+        add_ctrl(m_test);
+        m_test.text_size(9.0, 7.0);
+        m_test.no_transform();
+    }
+
+    // Records the lions again only when the layer changes.
+    void update_layer()
+    {
+        unsigned num = unsigned(m_num_lions.value() + 0.5);
+        if(num == m_layer_num &&
+           m_layer_width  == rbuf_window().width() &&
+           m_layer_height == rbuf_window().height()) return;
+
+        m_layer_num    = num;
+        m_layer_width  = rbuf_window().width();
+        m_layer_height = rbuf_window().height();
+
+        m_layer.remove_all();
+        agg::rasterizer_scanline_aa<> ras;
+        record_target target(m_layer);
+        lion_grid(num).render(ras, m_layer_width, m_layer_height, target);
+    }
+
+    virtual void on_draw()
+    {
+        update_layer();
+
+        pixfmt pixf(rbuf_window());
+        renderer_base rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        lion_styles styles;
+        m_layer.render_parallel(rb, styles,
+                                unsigned(m_num_threads.value() + 0.5));
+
+        // The dynamic content over the static layer
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_p8 sl;
+        agg::ellipse e(m_x, m_y, 40, 40, 100);
+        ras.add_path(e);
+        agg::render_scanlines_aa_solid(ras, sl, rb, agg::rgba(0, 0.4, 0.8, 0.5));
+
+        agg::render_ctrl(ras, sl, rb, m_num_lions);
+        agg::render_ctrl(ras, sl, rb, m_num_threads);
+        agg::render_ctrl(ras, sl, rb, m_test);
+    }
+
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            m_x = x;
+            m_y = y;
+            force_redraw();
+        }
+    }
+
+    virtual void on_mouse_move(int x, int y, unsigned flags)
+    {
+        on_mouse_button_down(x, y, flags);
+    }
+
+    virtual void on_ctrl_change()
+    {
+        if(m_test.status())
+        {
+            // Render the layer directly, replay the display list serially
+            // and in parallel, compare the results and measure the time.
+            unsigned w = rbuf_window().width();
+            unsigned h = rbuf_window().height();
+            unsigned stride = w * pixfmt::pix_width;
+            agg::pod_array<agg::int8u> buf1(stride * h);
+            agg::pod_array<agg::int8u> buf2(stride * h);
+            agg::pod_array<agg::int8u> buf3(stride * h);
+            agg::rendering_buffer rbuf1(buf1.data(), w, h, stride);
+            agg::rendering_buffer rbuf2(buf2.data(), w, h, stride);
+            agg::rendering_buffer rbuf3(buf3.data(), w, h, stride);
+            pixfmt pixf1(rbuf1);
+            pixfmt pixf2(rbuf2);
+            pixfmt pixf3(rbuf3);
+            renderer_base rb1(pixf1);
+            renderer_base rb2(pixf2);
+            renderer_base rb3(pixf3);
+
+            update_layer();
+            lion_grid scene(m_layer_num);
+            agg::rasterizer_scanline_aa<> ras;
+            direct_target<renderer_base> target(rb1);
+            lion_styles styles;
+            unsigned num_threads = unsigned(m_num_threads.value() + 0.5);
+            unsigned i;
+
+            start_timer();
+            for(i = 0; i < 10; i++)
+            {
+                rb1.clear(agg::rgba(1, 1, 1));
+                scene.render(ras, w, h, target);
+            }
+            double t1 = elapsed_time() / 10;
+
+            start_timer();
+            for(i = 0; i < 10; i++)
+            {
+                rb2.clear(agg::rgba(1, 1, 1));
+                m_layer.render(rb2, styles);
+            }
+            double t2 = elapsed_time() / 10;
+
+            start_timer();
+            for(i = 0; i < 10; i++)
+            {
+                rb3.clear(agg::rgba(1, 1, 1));
+                m_layer.render_parallel(rb3, styles, num_threads);
+            }
+            double t3 = elapsed_time() / 10;
+
+            bool identical = memcmp(buf1.data(), buf2.data(), stride * h) == 0 &&
+                             memcmp(buf1.data(), buf3.data(), stride * h) == 0;
+
+            m_test.status(false);
+            force_redraw();
+            char buf[256];
+            sprintf(buf, "Direct=%.2fms, Replay=%.2fms, Parallel Replay=%.2fms, "
+                         "Output %s",
+                    t1, t2, t3, identical ? "identical" : "DIFFERS");
+            message(buf);
+        }
+    }
+};
+
+
+int agg_main(int, char*[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Display List");
+
+    if(app.init(512, 400, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
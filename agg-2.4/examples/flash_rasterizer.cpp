@@ -12,6 +12,7 @@
 #include "agg_scanline_u.h"
 #include "agg_scanline_bin.h"
 #include "agg_renderer_scanline.h"
+#include "agg_renderer_scanline_parallel.h"
 #include "agg_rasterizer_scanline_aa.h"
 #include "agg_rasterizer_compound_aa.h"
 #include "agg_span_allocator.h"
@@ -287,12 +288,14 @@ public:
     int                        m_point_idx;
     int                        m_hit_x;
     int                        m_hit_y;
+    bool                       m_parallel;
 
     the_application(agg::pix_format_e format, bool flip_y) :
         agg::platform_support(format, flip_y),
         m_point_idx(-1),
         m_hit_x(-1),
-        m_hit_y(-1)
+        m_hit_y(-1),
+        m_parallel(false)
     {
         for(unsigned i = 0; i < 100; i++)
         {
@@ -370,7 +373,15 @@ public:
                 rasc.add_path(shape, m_shape.style(i).path_id);
             }
         }
-        agg::render_scanlines_compound(rasc, sl, sl_bin, ren_base, alloc, style_handler);
+        if(m_parallel)
+        {
+            agg::render_scanlines_compound_parallel(rasc, sl, sl_bin, ren_base, 
+                                                    alloc, style_handler);
+        }
+        else
+        {
+            agg::render_scanlines_compound(rasc, sl, sl_bin, ren_base, alloc, style_handler);
+        }
         double tfill = elapsed_time();
 
         // Hit-test test
@@ -417,10 +428,12 @@ public:
 
         sprintf(buf, "Fill=%.2fms (%dFPS) Stroke=%.2fms (%dFPS) Total=%.2fms (%dFPS)\n\n"
                      "Space: Next Shape\n\n"
-                     "+/- : ZoomIn/ZoomOut (with respect to the mouse pointer)",
+                     "+/- : ZoomIn/ZoomOut (with respect to the mouse pointer)\n\n"
+                     "P: Parallel Fill (%u threads) %s",
                      tfill, int(1000.0 / tfill),
                      tstroke, int(1000.0 / tstroke),
-                     tfill+tstroke, int(1000.0 / (tfill+tstroke)));
+                     tfill+tstroke, int(1000.0 / (tfill+tstroke)),
+                     agg::num_cpus(), m_parallel ? "On" : "Off");
 
         t.start_point(10.0, 20.0);
         t.text(buf);
@@ -440,6 +453,12 @@ public:
             force_redraw();
         }
 
+        if(key == 'p' || key == 'P')
+        {
+            m_parallel = !m_parallel;
+            force_redraw();
+        }
+
         if(key == '+' || key == agg::key_kp_plus)
         {
             m_scale *= agg::trans_affine_translation(-x, -y);
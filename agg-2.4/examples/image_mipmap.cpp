@@ -0,0 +1,265 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_span_allocator.h"
+#include "agg_span_interpolator_linear.h"
+#include "agg_span_interpolator_persp.h"
+#include "agg_span_image_filter_rgba.h"
+#include "agg_image_accessors.h"
+#include "agg_image_mipmap.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGRA32
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+
+class the_application : public agg::platform_support
+{
+    typedef agg::renderer_base<pixfmt_pre>        renderer_base_pre;
+    typedef agg::image_accessor_clone<pixfmt_pre> img_accessor_type;
+    typedef agg::image_mipmap<pixfmt_pre>         mipmap_type;
+
+    agg::slider_ctrl<color_type> m_scale;
+    agg::slider_ctrl<color_type> m_angle;
+    agg::rbox_ctrl<color_type>   m_method;
+    agg::cbox_ctrl<color_type>   m_perspective;
+    agg::cbox_ctrl<color_type>   m_test;
+    agg::image_filter_lut        m_filter;
+    mipmap_type                  m_mipmap;
+
+public:
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_scale(115, 5,    400, 11,    !flip_y),
+        m_angle(115, 5+15, 400, 11+15, !flip_y),
+        m_method(0.0, 0.0, 110.0, 60.0, !flip_y),
+        m_perspective(8.0, 65.0, "Perspective", !flip_y),
+        m_test       (8.0, 80.0, "Test Performance", !flip_y),
+        m_filter(agg::image_filter_bilinear(), true)
+    {
+        add_ctrl(m_scale);
+        add_ctrl(m_angle);
+        add_ctrl(m_method);
+        add_ctrl(m_perspective);
+        add_ctrl(m_test);
+
+        m_scale.label("Scale=%.3f");
+        m_scale.range(0.02, 2.0);
+        m_scale.value(0.2);
+        m_angle.label("Angle=%.1f");
+        m_angle.range(-180.0, 180.0);
+        m_angle.value(15.0);
+
+        m_method.add_item("bilinear");
+        m_method.add_item("resample");
+        m_method.add_item("mipmap");
+        m_method.cur_item(2);
+        m_method.border_width(0, 0);
+        m_method.background_color(agg::rgba(0.0, 0.0, 0.0, 0.1));
+        m_method.text_size(6.0);
+        m_method.text_thickness(0.85);
+
+        m_perspective.text_size(7.5);
+        m_test.text_size(7.5);
+    }
+
+    virtual void on_init()
+    {
+        m_mipmap.attach(rbuf_img(0));
+    }
+
+    // The image rectangle transformed; with the perspective
+    // the top side is shortened.
+    agg::trans_affine image_mtx()
+    {
+        double w = rbuf_img(0).width();
+        double h = rbuf_img(0).height();
+        agg::trans_affine mtx;
+        mtx *= agg::trans_affine_translation(-w / 2, -h / 2);
+        mtx *= agg::trans_affine_rotation(agg::deg2rad(m_angle.value()));
+        mtx *= agg::trans_affine_scaling(m_scale.value());
+        mtx *= agg::trans_affine_translation(width() / 2, height() / 2);
+        return mtx;
+    }
+
+    void calc_quad(double* quad)
+    {
+        double w = rbuf_img(0).width();
+        double h = rbuf_img(0).height();
+        double k = m_perspective.status() ? 0.15 : 1.0;
+        quad[0] = w / 2 - w * k / 2; quad[1] = 0;
+        quad[2] = w / 2 + w * k / 2; quad[3] = 0;
+        quad[4] = w;                 quad[5] = h;
+        quad[6] = 0;                 quad[7] = h;
+        agg::trans_affine mtx = image_mtx();
+        unsigned i;
+        for(i = 0; i < 8; i += 2) mtx.transform(quad + i, quad + i + 1);
+    }
+
+    template<class SpanGenerator>
+    void render_quad(agg::rendering_buffer& rbuf, const double* quad,
+                     SpanGenerator& sg)
+    {
+        pixfmt_pre pixf(rbuf);
+        renderer_base_pre rb(pixf);
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::span_allocator<color_type> sa;
+
+        ras.move_to_d(quad[0], quad[1]);
+        ras.line_to_d(quad[2], quad[3]);
+        ras.line_to_d(quad[4], quad[5]);
+        ras.line_to_d(quad[6], quad[7]);
+        agg::render_scanlines_aa(ras, sl, rb, sa, sg);
+    }
+
+    void render_image(agg::rendering_buffer& rbuf, unsigned method)
+    {
+        double quad[8];
+        calc_quad(quad);
+
+        pixfmt_pre img_pixf(rbuf_img(0));
+        img_accessor_type ia(img_pixf);
+
+        if(m_perspective.status())
+        {
+            typedef agg::span_interpolator_persp_lerp<> interpolator_type;
+            interpolator_type interpolator(0, 0,
+                                           rbuf_img(0).width(),
+                                           rbuf_img(0).height(), quad);
+            if(!interpolator.is_valid()) return;
+
+            if(method == 0)
+            {
+                agg::span_image_filter_rgba_bilinear<img_accessor_type,
+                                                     interpolator_type> sg(ia, interpolator);
+                render_quad(rbuf, quad, sg);
+            }
+            if(method == 1)
+            {
+                agg::span_image_resample_rgba<img_accessor_type,
+                                              interpolator_type> sg(ia, interpolator, m_filter);
+                render_quad(rbuf, quad, sg);
+            }
+            if(method == 2)
+            {
+                agg::span_image_mipmap_rgba<mipmap_type,
+                                            interpolator_type> sg(m_mipmap, interpolator);
+                render_quad(rbuf, quad, sg);
+            }
+        }
+        else
+        {
+            agg::trans_affine mtx = image_mtx();
+            mtx.invert();
+            typedef agg::span_interpolator_linear<> interpolator_type;
+            interpolator_type interpolator(mtx);
+
+            if(method == 0)
+            {
+                agg::span_image_filter_rgba_bilinear<img_accessor_type,
+                                                     interpolator_type> sg(ia, interpolator);
+                render_quad(rbuf, quad, sg);
+            }
+            if(method == 1)
+            {
+                agg::span_image_resample_rgba_affine<img_accessor_type> sg(ia, interpolator, m_filter);
+                render_quad(rbuf, quad, sg);
+            }
+            if(method == 2)
+            {
+                agg::span_image_mipmap_rgba_affine<mipmap_type> sg(m_mipmap, interpolator);
+                render_quad(rbuf, quad, sg);
+            }
+        }
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt pixf(rbuf_window());
+        agg::renderer_base<pixfmt> rb(pixf);
+        rb.clear(agg::rgba(1.0, 1.0, 1.0));
+
+        render_image(rbuf_window(), m_method.cur_item());
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::render_ctrl(ras, sl, rb, m_scale);
+        agg::render_ctrl(ras, sl, rb, m_angle);
+        agg::render_ctrl(ras, sl, rb, m_method);
+        agg::render_ctrl(ras, sl, rb, m_perspective);
+        agg::render_ctrl(ras, sl, rb, m_test);
+    }
+
+    virtual void on_ctrl_change()
+    {
+        if(m_test.status())
+        {
+            unsigned w = rbuf_window().width();
+            unsigned h = rbuf_window().height();
+            agg::pod_array<agg::int8u> buf(w * h * 4);
+            agg::rendering_buffer rbuf(buf.data(), w, h, w * 4);
+            double t[3];
+            unsigned i, j;
+
+            // The levels are built once, out of the timing
+            m_mipmap.build();
+            for(j = 0; j < 3; j++)
+            {
+                start_timer();
+                for(i = 0; i < 10; i++) render_image(rbuf, j);
+                t[j] = elapsed_time() / 10;
+            }
+
+            m_test.status(false);
+            force_redraw();
+            char msg[256];
+            sprintf(msg, "Bilinear=%.2fms, Resample=%.2fms, Mipmap=%.2fms",
+                    t[0], t[1], t[2]);
+            message(msg);
+        }
+    }
+};
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Mipmapped Image Minification");
+
+    const char* img_name = "spheres";
+    if(argc >= 2) img_name = argv[1];
+    if(!app.load_img(0, img_name))
+    {
+        char buf[256];
+        if(strcmp(img_name, "spheres") == 0)
+        {
+            sprintf(buf, "File not found: %s%s. Download http://www.antigrain.com/%s%s\n"
+                         "or copy it from another directory if available.",
+                    img_name, app.img_ext(), img_name, app.img_ext());
+        }
+        else
+        {
+            sprintf(buf, "File not found: %s%s", img_name, app.img_ext());
+        }
+        app.message(buf);
+        return 1;
+    }
+
+    if(app.init(600, 500, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
@@ -0,0 +1,243 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_span_allocator.h"
+#include "agg_span_interpolator_linear.h"
+#include "agg_span_image_filter_rgba.h"
+#include "agg_image_accessors.h"
+#include "agg_image_resample_separable.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGRA32
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+
+class the_application : public agg::platform_support
+{
+    typedef agg::renderer_base<pixfmt_pre> renderer_base_pre;
+
+    agg::slider_ctrl<color_type> m_scale_x;
+    agg::slider_ctrl<color_type> m_scale_y;
+    agg::slider_ctrl<color_type> m_num_threads;
+    agg::rbox_ctrl<color_type>   m_filters;
+    agg::cbox_ctrl<color_type>   m_test;
+    agg::image_filter_lut        m_filter;
+
+public:
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_scale_x    (115, 5,    400, 11,    !flip_y),
+        m_scale_y    (115, 5+15, 400, 11+15, !flip_y),
+        m_num_threads(115, 5+30, 400, 11+30, !flip_y),
+        m_filters(0.0, 0.0, 110.0, 120.0, !flip_y),
+        m_test(8.0, 125.0, "Test Performance", !flip_y)
+    {
+        add_ctrl(m_scale_x);
+        add_ctrl(m_scale_y);
+        add_ctrl(m_num_threads);
+        add_ctrl(m_filters);
+        add_ctrl(m_test);
+
+        m_scale_x.label("Scale X=%.3f");
+        m_scale_x.range(0.05, 3.0);
+        m_scale_x.value(0.5);
+        m_scale_y.label("Scale Y=%.3f");
+        m_scale_y.range(0.05, 3.0);
+        m_scale_y.value(0.5);
+        m_num_threads.label("Threads=%.0f");
+        m_num_threads.range(1.0, 16.0);
+        m_num_threads.num_steps(15);
+        m_num_threads.value(4.0);
+
+        m_filters.add_item("bilinear");
+        m_filters.add_item("bicubic");
+        m_filters.add_item("spline36");
+        m_filters.add_item("gaussian");
+        m_filters.add_item("sinc");
+        m_filters.add_item("lanczos");
+        m_filters.add_item("blackman");
+        m_filters.cur_item(1);
+        m_filters.border_width(0, 0);
+        m_filters.background_color(agg::rgba(0.0, 0.0, 0.0, 0.1));
+        m_filters.text_size(6.0);
+        m_filters.text_thickness(0.85);
+
+        m_test.text_size(7.5);
+    }
+
+    void calculate_filter()
+    {
+        switch(m_filters.cur_item())
+        {
+        case 0: m_filter.calculate(agg::image_filter_bilinear());  break;
+        case 1: m_filter.calculate(agg::image_filter_bicubic());   break;
+        case 2: m_filter.calculate(agg::image_filter_spline36());  break;
+        case 3: m_filter.calculate(agg::image_filter_gaussian());  break;
+        case 4: m_filter.calculate(agg::image_filter_sinc(4.0));   break;
+        case 5: m_filter.calculate(agg::image_filter_lanczos(4.0)); break;
+        case 6: m_filter.calculate(agg::image_filter_blackman(4.0)); break;
+        }
+    }
+
+    agg::trans_affine image_mtx() const
+    {
+        return agg::trans_affine_scaling(m_scale_x.value(), m_scale_y.value());
+    }
+
+    unsigned dst_width()
+    {
+        return unsigned(rbuf_img(0).width() * m_scale_x.value() + 0.5) + 1;
+    }
+
+    unsigned dst_height()
+    {
+        return unsigned(rbuf_img(0).height() * m_scale_y.value() + 0.5) + 1;
+    }
+
+    // The reference, the 2D span generator over the whole destination
+    void render_span(agg::rendering_buffer& rbuf)
+    {
+        typedef agg::image_accessor_clone<pixfmt_pre> img_accessor_type;
+        typedef agg::span_interpolator_linear<> interpolator_type;
+        typedef agg::span_image_resample_rgba_affine<img_accessor_type> span_gen_type;
+
+        agg::trans_affine mtx = image_mtx();
+        mtx.invert();
+
+        pixfmt_pre img_pixf(rbuf_img(0));
+        img_accessor_type ia(img_pixf);
+        interpolator_type interpolator(mtx);
+        span_gen_type sg(ia, interpolator, m_filter);
+        agg::span_allocator<color_type> sa;
+
+        pixfmt_pre pixf(rbuf);
+        renderer_base_pre rb(pixf);
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        ras.move_to_d(0, 0);
+        ras.line_to_d(rbuf.width(), 0);
+        ras.line_to_d(rbuf.width(), rbuf.height());
+        ras.line_to_d(0, rbuf.height());
+        agg::render_scanlines_aa(ras, sl, rb, sa, sg);
+    }
+
+    void render_separable(agg::rendering_buffer& rbuf)
+    {
+        pixfmt_pre img_pixf(rbuf_img(0));
+        pixfmt_pre pixf(rbuf);
+        agg::image_resample_separable resampler(m_filter,
+            unsigned(m_num_threads.value() + 0.5));
+        resampler.resample(pixf, img_pixf, image_mtx());
+    }
+
+    virtual void on_draw()
+    {
+        calculate_filter();
+
+        unsigned w = dst_width();
+        unsigned h = dst_height();
+        agg::pod_array<agg::int8u> buf(w * h * 4);
+        agg::rendering_buffer rbuf(buf.data(), w, h, w * 4);
+        render_separable(rbuf);
+
+        pixfmt pixf(rbuf_window());
+        agg::renderer_base<pixfmt> rb(pixf);
+        rb.clear(agg::rgba(1.0, 1.0, 1.0));
+        rb.copy_from(rbuf, 0, 110, 50);
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::render_ctrl(ras, sl, rb, m_scale_x);
+        agg::render_ctrl(ras, sl, rb, m_scale_y);
+        agg::render_ctrl(ras, sl, rb, m_num_threads);
+        agg::render_ctrl(ras, sl, rb, m_filters);
+        agg::render_ctrl(ras, sl, rb, m_test);
+    }
+
+    virtual void on_ctrl_change()
+    {
+        if(m_test.status())
+        {
+            // Resample with the span generator and with the separable
+            // resampler, compare the results and measure the time.
+            calculate_filter();
+
+            unsigned w = dst_width();
+            unsigned h = dst_height();
+            unsigned size = w * h * 4;
+            agg::pod_array<agg::int8u> buf1(size);
+            agg::pod_array<agg::int8u> buf2(size);
+            agg::rendering_buffer rbuf1(buf1.data(), w, h, w * 4);
+            agg::rendering_buffer rbuf2(buf2.data(), w, h, w * 4);
+            unsigned i;
+
+            start_timer();
+            for(i = 0; i < 10; i++) render_span(rbuf1);
+            double t1 = elapsed_time() / 10;
+
+            start_timer();
+            for(i = 0; i < 10; i++) render_separable(rbuf2);
+            double t2 = elapsed_time() / 10;
+
+            int max_diff = 0;
+            double sum = 0;
+            for(i = 0; i < size; i++)
+            {
+                int d = abs(int(buf1[i]) - int(buf2[i]));
+                if(d > max_diff) max_diff = d;
+                sum += d;
+            }
+
+            m_test.status(false);
+            force_redraw();
+            char buf[256];
+            sprintf(buf, "Span=%.2fms, Separable=%.2fms, "
+                         "Max Difference=%d, Average=%.3f",
+                    t1, t2, max_diff, sum / size);
+            message(buf);
+        }
+    }
+};
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Separable Image Resampling");
+
+    const char* img_name = "spheres";
+    if(argc >= 2) img_name = argv[1];
+    if(!app.load_img(0, img_name))
+    {
+        char buf[256];
+        if(strcmp(img_name, "spheres") == 0)
+        {
+            sprintf(buf, "File not found: %s%s. Download http://www.antigrain.com/%s%s\n"
+                         "or copy it from another directory if available.",
+                    img_name, app.img_ext(), img_name, app.img_ext());
+        }
+        else
+        {
+            sprintf(buf, "File not found: %s%s", img_name, app.img_ext());
+        }
+        app.message(buf);
+        return 1;
+    }
+
+    if(app.init(3 * app.rbuf_img(0).width() + 120,
+                3 * app.rbuf_img(0).height() + 60, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
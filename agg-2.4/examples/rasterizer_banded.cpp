@@ -0,0 +1,238 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_scanline_p.h"
+#include "agg_renderer_scanline.h"
+#include "agg_renderer_banded.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_bounding_rect.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGR24
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+agg::path_storage g_path;
+agg::srgba8       g_colors[100];
+unsigned          g_path_idx[100];
+unsigned          g_npaths = 0;
+double            g_x1 = 0;
+double            g_y1 = 0;
+double            g_x2 = 0;
+double            g_y2 = 0;
+
+unsigned parse_lion(agg::path_storage& ps, agg::srgba8* colors, unsigned* path_idx);
+void parse_lion()
+{
+    g_npaths = parse_lion(g_path, g_colors, g_path_idx);
+    agg::pod_array_adaptor<unsigned> path_idx(g_path_idx, 100);
+    agg::bounding_rect(g_path, path_idx, 0, g_npaths, &g_x1, &g_y1, &g_x2, &g_y2);
+}
+
+
+//----------------------------------------------------------------------------
+// A grid of lions. Every band replays all of them, the parts outside
+// the band are rejected by the rasterizer.
+class lion_grid
+{
+public:
+    lion_grid(unsigned num, double angle) : m_num(num), m_angle(angle) {}
+
+    template<class Rasterizer, class Scanline, class BaseRenderer>
+    void render(Rasterizer& ras, Scanline& sl, BaseRenderer& ren)
+    {
+        double w = ren.width();
+        double h = ren.height();
+        double cell_w = w / m_num;
+        double cell_h = h / m_num;
+        double scale = cell_w / (g_x2 - g_x1);
+        if(cell_h / (g_y2 - g_y1) < scale) scale = cell_h / (g_y2 - g_y1);
+
+        ras.clip_box(0, 0, w, h);
+
+        unsigned i, j, k;
+        for(i = 0; i < m_num; i++)
+        {
+            for(j = 0; j < m_num; j++)
+            {
+                agg::trans_affine mtx;
+                mtx *= agg::trans_affine_translation(-(g_x1 + g_x2) / 2,
+                                                     -(g_y1 + g_y2) / 2);
+                mtx *= agg::trans_affine_rotation(m_angle + agg::pi);
+                mtx *= agg::trans_affine_scaling(scale * 1.2);
+                mtx *= agg::trans_affine_translation(cell_w * (j + 0.5),
+                                                     cell_h * (i + 0.5));
+
+                agg::conv_transform<agg::path_storage, agg::trans_affine> trans(g_path, mtx);
+                for(k = 0; k < g_npaths; k++)
+                {
+                    ras.reset();
+                    ras.add_path(trans, g_path_idx[k]);
+                    agg::render_scanlines_aa_solid(ras, sl, ren, g_colors[k]);
+                }
+            }
+        }
+    }
+
+private:
+    unsigned m_num;
+    double   m_angle;
+};
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::slider_ctrl<color_type> m_num_lions;
+    agg::slider_ctrl<color_type> m_num_threads;
+    agg::slider_ctrl<color_type> m_band_height;
+    agg::cbox_ctrl<color_type>   m_test;
+    double                       m_angle;
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+    typedef agg::renderer_banded<renderer_base> renderer_banded;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_num_lions  (5, 5,    340, 12,   !flip_y),
+        m_num_threads(5, 5+20, 340, 12+20, !flip_y),
+        m_band_height(5, 5+40, 340, 12+40, !flip_y),
+        m_test(350, 5, "Test Performance", !flip_y),
+        m_angle(0.0)
+    {
+        parse_lion();
+
+        add_ctrl(m_num_lions);
+        m_num_lions.range(1.0, 20.0);
+        m_num_lions.num_steps(19);
+        m_num_lions.value(6.0);
+        m_num_lions.label("Lions per Row=%.0f");
+        m_num_lions.no_transform();
+
+        add_ctrl(m_num_threads);
+        m_num_threads.range(1.0, 32.0);
+        m_num_threads.num_steps(31);
+        m_num_threads.value(4.0);
+        m_num_threads.label("Threads=%.0f");
+        m_num_threads.no_transform();
+
+        add_ctrl(m_band_height);
+        m_band_height.range(4.0, 256.0);
+        m_band_height.value(32.0);
+        m_band_height.label("Band Height=%.0f");
+        m_band_height.no_transform();
+
+        add_ctrl(m_test);
+        m_test.text_size(9.0, 7.0);
+        m_test.no_transform();
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt pixf(rbuf_window());
+        renderer_base rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        lion_grid scene(unsigned(m_num_lions.value() + 0.5), m_angle);
+        renderer_banded ren(rb, unsigned(m_band_height.value()));
+        ren.render(scene, unsigned(m_num_threads.value() + 0.5));
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_p8 sl;
+        agg::render_ctrl(ras, sl, rb, m_num_lions);
+        agg::render_ctrl(ras, sl, rb, m_num_threads);
+        agg::render_ctrl(ras, sl, rb, m_band_height);
+        agg::render_ctrl(ras, sl, rb, m_test);
+    }
+
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            m_angle = atan2(y - height() / 2.0, x - width() / 2.0);
+            force_redraw();
+        }
+    }
+
+    virtual void on_mouse_move(int x, int y, unsigned flags)
+    {
+        on_mouse_button_down(x, y, flags);
+    }
+
+    virtual void on_ctrl_change()
+    {
+        if(m_test.status())
+        {
+            // Render the scene serially and by bands into two separate
+            // buffers, compare the results and measure the time.
+            unsigned w = rbuf_window().width();
+            unsigned h = rbuf_window().height();
+            unsigned stride = w * pixfmt::pix_width;
+            agg::pod_array<agg::int8u> buf1(stride * h);
+            agg::pod_array<agg::int8u> buf2(stride * h);
+            agg::rendering_buffer rbuf1(buf1.data(), w, h, stride);
+            agg::rendering_buffer rbuf2(buf2.data(), w, h, stride);
+            pixfmt pixf1(rbuf1);
+            pixfmt pixf2(rbuf2);
+            renderer_base rb1(pixf1);
+            renderer_base rb2(pixf2);
+
+            lion_grid scene(unsigned(m_num_lions.value() + 0.5), m_angle);
+            agg::rasterizer_scanline_aa<> ras;
+            agg::scanline_u8 sl;
+            renderer_banded ren(rb2, unsigned(m_band_height.value()));
+            unsigned num_threads = unsigned(m_num_threads.value() + 0.5);
+            unsigned i;
+
+            start_timer();
+            for(i = 0; i < 10; i++)
+            {
+                rb1.clear(agg::rgba(1, 1, 1));
+                scene.render(ras, sl, rb1);
+            }
+            double t1 = elapsed_time() / 10;
+
+            start_timer();
+            for(i = 0; i < 10; i++)
+            {
+                rb2.clear(agg::rgba(1, 1, 1));
+                ren.render(scene, num_threads);
+            }
+            double t2 = elapsed_time() / 10;
+
+            bool identical = memcmp(buf1.data(), buf2.data(), stride * h) == 0;
+
+            m_test.status(false);
+            force_redraw();
+            char buf[256];
+            sprintf(buf, "Serial=%.2fms, Banded(%u threads, %u CPUs)=%.2fms, "
+                         "Speedup=%.2f, Output %s",
+                    t1, num_threads, agg::num_cpus(), t2, t1 / t2,
+                    identical ? "identical" : "DIFFERS");
+            message(buf);
+        }
+    }
+};
+
+
+int agg_main(int, char*[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Banded Multithreaded Rasterization");
+
+    if(app.init(800, 600, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
+
@@ -0,0 +1,277 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_scanline_p.h"
+#include "agg_renderer_scanline.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_conv_stroke.h"
+#include "agg_bounding_rect.h"
+#include "agg_gsv_text.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGR24
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+agg::path_storage g_path;
+agg::srgba8       g_colors[100];
+unsigned          g_path_idx[100];
+unsigned          g_npaths = 0;
+double            g_x1 = 0;
+double            g_y1 = 0;
+double            g_x2 = 0;
+double            g_y2 = 0;
+
+unsigned parse_lion(agg::path_storage& ps, agg::srgba8* colors, unsigned* path_idx);
+void parse_lion()
+{
+    g_npaths = parse_lion(g_path, g_colors, g_path_idx);
+    agg::pod_array_adaptor<unsigned> path_idx(g_path_idx, 100);
+    agg::bounding_rect(g_path, path_idx, 0, g_npaths, &g_x1, &g_y1, &g_x2, &g_y2);
+}
+
+
+typedef agg::rasterizer_scanline_aa<agg::rasterizer_sl_clip_int,
+                                    agg::cell_sorter_qsort<agg::cell_aa> > rasterizer_qsort;
+typedef agg::rasterizer_scanline_aa<agg::rasterizer_sl_clip_int,
+                                    agg::cell_sorter_radix<agg::cell_aa> > rasterizer_radix;
+
+
+class the_application : public agg::platform_support
+{
+    agg::rbox_ctrl<color_type> m_scene;
+    agg::rbox_ctrl<color_type> m_sorter;
+    agg::cbox_ctrl<color_type> m_test;
+    agg::path_storage          m_random;
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_scene (5.0,   5.0, 150.0, 65.0, !flip_y),
+        m_sorter(155.0, 5.0, 300.0, 50.0, !flip_y),
+        m_test(310.0, 5.0, "Test Performance", !flip_y)
+    {
+        parse_lion();
+
+        m_scene.add_item("Lions");
+        m_scene.add_item("Text");
+        m_scene.add_item("Random Polygons");
+        m_scene.cur_item(0);
+        add_ctrl(m_scene);
+        m_scene.no_transform();
+
+        m_sorter.add_item("QSort Cells");
+        m_sorter.add_item("Radix Sort Cells");
+        m_sorter.cur_item(1);
+        add_ctrl(m_sorter);
+        m_sorter.no_transform();
+
+        add_ctrl(m_test);
+        m_test.text_size(9.0, 7.0);
+        m_test.no_transform();
+    }
+
+    virtual void on_init()
+    {
+        // A few large self-intersecting polygons produce long scanlines
+        // with many cells, which is the worst case for sorting.
+        unsigned i, j;
+        int w = int(width());
+        int h = int(height());
+        srand(1234);
+        m_random.remove_all();
+        for(i = 0; i < 10; i++)
+        {
+            m_random.move_to(rand() % w, rand() % h);
+            for(j = 0; j < 500; j++)
+            {
+                m_random.line_to(rand() % w, rand() % h);
+            }
+            m_random.close_polygon();
+        }
+    }
+
+    template<class Rasterizer, class Scanline>
+    void draw_lions(Rasterizer& ras, Scanline& sl, renderer_base& rb)
+    {
+        unsigned i, j, k;
+        double w = width() / 8.0;
+        double h = height() / 8.0;
+        for(i = 0; i < 8; i++)
+        {
+            for(j = 0; j < 8; j++)
+            {
+                agg::trans_affine mtx;
+                mtx *= agg::trans_affine_translation(-(g_x1 + g_x2) / 2,
+                                                     -(g_y1 + g_y2) / 2);
+                mtx *= agg::trans_affine_rotation(agg::pi);
+                mtx *= agg::trans_affine_scaling(h / (g_y2 - g_y1));
+                mtx *= agg::trans_affine_translation(w * (j + 0.5), h * (i + 0.5));
+                agg::conv_transform<agg::path_storage, agg::trans_affine> trans(g_path, mtx);
+                for(k = 0; k < g_npaths; k++)
+                {
+                    ras.reset();
+                    ras.add_path(trans, g_path_idx[k]);
+                    agg::render_scanlines_aa_solid(ras, sl, rb, g_colors[k]);
+                }
+            }
+        }
+    }
+
+    template<class Rasterizer, class Scanline>
+    void draw_text(Rasterizer& ras, Scanline& sl, renderer_base& rb)
+    {
+        agg::gsv_text txt;
+        agg::conv_stroke<agg::gsv_text> stroke(txt);
+        txt.size(6.0);
+        stroke.width(0.6);
+        ras.reset();
+        double y;
+        for(y = 10; y < height(); y += 9)
+        {
+            txt.start_point(5.0, y);
+            txt.text("The quick brown fox jumps over the lazy dog. "
+                     "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG. 0123456789");
+            ras.add_path(stroke);
+        }
+        agg::render_scanlines_aa_solid(ras, sl, rb, agg::rgba(0, 0, 0));
+    }
+
+    template<class Rasterizer, class Scanline>
+    void draw_random(Rasterizer& ras, Scanline& sl, renderer_base& rb)
+    {
+        ras.reset();
+        ras.filling_rule(agg::fill_even_odd);
+        ras.add_path(m_random);
+        agg::render_scanlines_aa_solid(ras, sl, rb, agg::rgba(0, 0.3, 0.5, 0.7));
+        ras.filling_rule(agg::fill_non_zero);
+    }
+
+    template<class Rasterizer, class Scanline>
+    void draw_scene(Rasterizer& ras, Scanline& sl, renderer_base& rb)
+    {
+        switch(m_scene.cur_item())
+        {
+        case 0: draw_lions(ras, sl, rb);  break;
+        case 1: draw_text(ras, sl, rb);   break;
+        case 2: draw_random(ras, sl, rb); break;
+        }
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt pixf(rbuf_window());
+        renderer_base rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        agg::scanline_u8 sl;
+        if(m_sorter.cur_item() == 0)
+        {
+            rasterizer_qsort ras;
+            draw_scene(ras, sl, rb);
+        }
+        else
+        {
+            rasterizer_radix ras;
+            draw_scene(ras, sl, rb);
+        }
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_p8 sl2;
+        agg::render_ctrl(ras, sl2, rb, m_scene);
+        agg::render_ctrl(ras, sl2, rb, m_sorter);
+        agg::render_ctrl(ras, sl2, rb, m_test);
+    }
+
+    // Sorting only, the cells are the same for both sorters, so
+    // the difference is all in rasterizer::sort().
+    template<class Rasterizer> double time_sort(Rasterizer& ras)
+    {
+        unsigned i;
+        double t = 0;
+        for(i = 0; i < 20; i++)
+        {
+            ras.reset();
+            ras.add_path(m_random);
+            start_timer();
+            ras.sort();
+            t += elapsed_time();
+        }
+        return t / 20;
+    }
+
+    virtual void on_ctrl_change()
+    {
+        if(m_test.status())
+        {
+            unsigned w = rbuf_window().width();
+            unsigned h = rbuf_window().height();
+            unsigned stride = w * pixfmt::pix_width;
+            agg::pod_array<agg::int8u> buf1(stride * h);
+            agg::pod_array<agg::int8u> buf2(stride * h);
+            agg::rendering_buffer rbuf1(buf1.data(), w, h, stride);
+            agg::rendering_buffer rbuf2(buf2.data(), w, h, stride);
+            pixfmt pixf1(rbuf1);
+            pixfmt pixf2(rbuf2);
+            renderer_base rb1(pixf1);
+            renderer_base rb2(pixf2);
+            rasterizer_qsort ras1;
+            rasterizer_radix ras2;
+            agg::scanline_u8 sl;
+            unsigned i;
+
+            start_timer();
+            for(i = 0; i < 10; i++)
+            {
+                rb1.clear(agg::rgba(1, 1, 1));
+                draw_scene(ras1, sl, rb1);
+            }
+            double t1 = elapsed_time() / 10;
+
+            start_timer();
+            for(i = 0; i < 10; i++)
+            {
+                rb2.clear(agg::rgba(1, 1, 1));
+                draw_scene(ras2, sl, rb2);
+            }
+            double t2 = elapsed_time() / 10;
+
+            double s1 = time_sort(ras1);
+            double s2 = time_sort(ras2);
+
+            bool identical = memcmp(buf1.data(), buf2.data(), stride * h) == 0;
+
+            m_test.status(false);
+            force_redraw();
+            char buf[256];
+            sprintf(buf, "Frame: QSort=%.2fms Radix=%.2fms, "
+                         "Sort Random Polygons: QSort=%.2fms Radix=%.2fms, Output %s",
+                    t1, t2, s1, s2, identical ? "identical" : "DIFFERS");
+            message(buf);
+        }
+    }
+};
+
+
+int agg_main(int, char*[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Cell Sorting Policies");
+
+    if(app.init(800, 600, 0))
+    {
+        return app.run();
+    }
+    return 1;
+}
+
@@ -109,6 +109,16 @@ namespace agg
 
     //------------------------------------------------------------------------------
 
+    static unsigned update_crc32(unsigned crc, const unsigned char* buf, unsigned size)
+    {
+        for(; size--; ++buf) 
+        {
+            crc = (crc >> 8) ^ crc32tab[(crc ^ *buf) & 0xff];
+        }
+        return crc;
+    }
+
+    //------------------------------------------------------------------------------
     static unsigned calc_crc32(const unsigned char* buf, unsigned size)
     {
         unsigned crc = (unsigned)~0;
@@ -506,6 +516,7 @@ namespace agg
         delete [] m_face_names;
         delete [] m_faces;
         delete [] m_signature;
+        delete [] m_cache_key;
         if(m_library_initialized) FT_Done_FreeType(m_library);
     }
 
@@ -521,6 +532,8 @@ namespace agg
         m_face_index(0),
         m_char_map(FT_ENCODING_NONE),
         m_signature(new char [256+256-16]),
+        m_cache_key(0),
+        m_cache_key_stamp(-1),
         m_height(0),
         m_width(0),
         m_hinting(true),
@@ -872,6 +885,49 @@ namespace agg
     }
 
 
+    //------------------------------------------------------------------------
+    const char* font_engine_freetype_base::cache_key()
+    {
+        if(m_cur_face == 0 || m_name == 0) return "";
+        if(m_cache_key == 0 || m_cache_key_stamp != m_change_stamp)
+        {
+            // FreeType either keeps the face in memory or reads the file,
+            // in the latter case the file is read again.
+            unsigned crc = (unsigned)~0;
+            unsigned long size = 0;
+            FT_Stream stream = m_cur_face->stream;
+            if(stream && stream->base)
+            {
+                crc = update_crc32(crc, stream->base, unsigned(stream->size));
+                size = stream->size;
+            }
+            else
+            {
+                FILE* fd = std::fopen(m_name, "rb");
+                if(fd)
+                {
+                    unsigned char buf[4096];
+                    size_t n;
+                    while((n = std::fread(buf, 1, sizeof(buf), fd)) > 0)
+                    {
+                        crc = update_crc32(crc, buf, unsigned(n));
+                        size += n;
+                    }
+                    std::fclose(fd);
+                }
+            }
+            // The signature starts with the face name, which is replaced
+            // with the checksum, so that the key doesn't depend on the path.
+            delete [] m_cache_key;
+            m_cache_key = new char [std::strlen(m_signature) + 32];
+            std::sprintf(m_cache_key, "%08X:%lu%s", ~crc, size, 
+                         m_signature + std::strlen(m_name));
+            m_cache_key_stamp = m_change_stamp;
+        }
+        return m_cache_key;
+    }
+
+
     //------------------------------------------------------------------------
     void font_engine_freetype_base::update_char_size()
     {
@@ -86,6 +86,12 @@ namespace agg
         bool        hinting()      const { return m_hinting;    }
         bool        flip_y()       const { return m_flip_y;     }
 
+        // The font signature with the checksum of the face file instead of
+        // its name. It identifies the glyphs in a persistent cache, see
+        // font_cache_file.
+        //--------------------------------------------------------------------
+        const char* cache_key();
+
 
         // Interface mandatory to implement for font_cache_manager
         //--------------------------------------------------------------------
@@ -119,6 +125,8 @@ namespace agg
         unsigned        m_face_index;
         FT_Encoding     m_char_map;
         char*           m_signature;
+        char*           m_cache_key;
+        int             m_cache_key_stamp;
         unsigned        m_height;
         unsigned        m_width;
         bool            m_hinting;
@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// alpha_mask_rle, an alpha mask kept as the runs of the scanlines
+//
+// The mask is built from the scanlines of a rasterizer or a
+// scanline_storage_aa. Every row keeps the runs sorted by X: a solid run
+// has one cover value for all its pixels, a partial run has its own cover
+// for every pixel (the anti-aliased edges). The pixels outside the runs
+// are transparent and take no memory at all, the sequences of equal
+// covers are turned into solid runs. So, a mask of a few large shapes
+// takes a few runs per row instead of a byte per pixel.
+//
+// It has the interface of alpha_mask_u8 and can be used with
+// pixfmt_amask_adaptor and scanline_u8_am. combine_hspan() does nothing
+// on the fully covered runs, clears the transparent ones and multiplies
+// the partial ones with SSE2.
+//
+// Usage:
+//   agg::alpha_mask_rle mask;
+//   agg::render_scanlines(ras, sl, mask);   // or mask.build(storage, sl);
+//   agg::pixfmt_amask_adaptor<pixfmt, agg::alpha_mask_rle> pfa(pixf, mask);
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_ALPHA_MASK_RLE_INCLUDED
+#define AGG_ALPHA_MASK_RLE_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_array.h"
+
+namespace agg
+{
+
+    //=========================================================alpha_mask_rle
+    //
+    // See Implementation agg_alpha_mask_rle.cpp
+    //
+    class alpha_mask_rle
+    {
+    public:
+        typedef int8u cover_type;
+        enum cover_scale_e
+        {
+            cover_shift = 8,
+            cover_none  = 0,
+            cover_full  = 255
+        };
+
+        // The runs of equal covers shorter than that are kept in the
+        // partial runs, so that the edges don't split into many runs.
+        enum solid_run_e { solid_run_min = 8 };
+
+    private:
+        struct run_data
+        {
+            int      x;
+            unsigned len;
+            int      covers_id; // The index in m_covers or -1 if solid
+            unsigned cover;     // The cover of a solid run
+        };
+
+        struct row_data
+        {
+            unsigned start_run;
+            unsigned num_runs;
+        };
+
+        // The partial runs are split to fit in the blocks of m_covers
+        enum partial_run_e { partial_run_max = 1 << 11 };
+
+    public:
+        alpha_mask_rle();
+
+        void remove_all();
+
+        //--------------------------------------------------------------------
+        // The Renderer interface of render_scanlines(). The scanlines must
+        // come in the increasing order of Y, as from one rasterizer; the
+        // rows that go back in Y are ignored. To build a mask of several
+        // rasterizers, unite them with the scanline Boolean algebra first.
+        // The mask isn't clipped, use the clip box of the rasterizer.
+        void prepare() { remove_all(); }
+
+        template<class Scanline> void render(const Scanline& sl)
+        {
+            if(!start_row(sl.y())) return;
+            typename Scanline::const_iterator span = sl.begin();
+            unsigned num_spans = sl.num_spans();
+            for(;;)
+            {
+                if(span->len < 0)
+                {
+                    add_solid(span->x, unsigned(-span->len), *span->covers);
+                }
+                else
+                {
+                    add_covers(span->x, unsigned(span->len), span->covers);
+                }
+                if(--num_spans == 0) break;
+                ++span;
+            }
+            finish_row();
+        }
+
+        //--------------------------------------------------------------------
+        // Builds the mask from a scanline_storage_aa, a rasterizer or
+        // anything else that has rewind_scanlines() and sweep_scanline(),
+        // through the given scanline, scanline_u8 or scanline_p8.
+        template<class ScanlineGen, class Scanline>
+        void build(ScanlineGen& sg, Scanline& sl)
+        {
+            remove_all();
+            if(sg.rewind_scanlines())
+            {
+                sl.reset(sg.min_x(), sg.max_x());
+                while(sg.sweep_scanline(sl))
+                {
+                    render(sl);
+                }
+            }
+        }
+
+        //--------------------------------------------------------------------
+        int min_y() const { return m_min_y; }
+        int max_y() const { return m_min_y + int(m_rows.size()) - 1; }
+        unsigned num_runs() const { return m_runs.size(); }
+
+        // The memory taken by the runs and the covers
+        unsigned byte_size() const
+        {
+            return m_rows.size()   * sizeof(row_data) +
+                   m_runs.size()   * sizeof(run_data) +
+                   m_covers.size() * sizeof(cover_type);
+        }
+
+        //--------------------------------------------------------------------
+        cover_type pixel(int x, int y) const;
+        cover_type combine_pixel(int x, int y, cover_type val) const;
+
+        void fill_hspan(int x, int y, cover_type* dst, int num_pix) const;
+        void combine_hspan(int x, int y, cover_type* dst, int num_pix) const;
+        void fill_vspan(int x, int y, cover_type* dst, int num_pix) const;
+        void combine_vspan(int x, int y, cover_type* dst, int num_pix) const;
+
+    private:
+        alpha_mask_rle(const alpha_mask_rle&);
+        const alpha_mask_rle& operator = (const alpha_mask_rle&);
+
+        bool start_row(int y);
+        void finish_row();
+        void add_solid(int x, unsigned len, unsigned cover);
+        void add_partial(int x, unsigned len, const cover_type* covers);
+        void add_covers(int x, unsigned len, const cover_type* covers);
+
+        const row_data* row(int y) const;
+        unsigned first_run(const row_data& r, int x) const;
+
+        pod_bvector<row_data, 8>    m_rows;
+        pod_bvector<run_data, 8>    m_runs;
+        pod_bvector<cover_type, 12> m_covers;
+        int                         m_min_y;
+        row_data                    m_cur_row;
+    };
+
+}
+
+#endif
@@ -0,0 +1,251 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Arena allocation for the short-lived containers.
+//
+// The containers that allocate their storage in blocks take the allocator
+// as the last template argument, pod_allocator by default:
+//
+//   pod_bvector<T, S, Allocator>
+//   vertex_block_storage<T, BlockShift, BlockPool, Allocator>
+//   rasterizer_cells_aa<Cell, Sorter, Allocator>
+//   rasterizer_scanline_aa<Clip, CellSorter, Allocator>
+//   rasterizer_scanline_aa_nogamma<Clip, CellSorter, Allocator>
+//   scanline_storage_aa<T, Allocator>
+//
+// With arena_allocator they take the memory from the memory_arena made
+// current for the thread by arena_scope. Only the last allocated memory
+// is given back on deallocation; memory_arena::reset() makes all of it
+// free at once, keeping the blocks for the next frame:
+//
+//   typedef agg::path_base<agg::vertex_block_storage<double, 8, 256,
+//                          agg::arena_allocator> > frame_path;
+//   agg::memory_arena arena;
+//   for(;;)
+//   {
+//       {
+//           agg::arena_scope scope(arena);
+//           frame_path path;
+//           agg::rasterizer_scanline_aa<agg::rasterizer_sl_clip_int,
+//                                       agg::cell_sorter_qsort<agg::cell_aa>,
+//                                       agg::arena_allocator> ras;
+//           . . .
+//       }
+//       arena.reset();
+//   }
+//
+// The containers must be created and destroyed within the scope and
+// must not live longer than until the reset().
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_ARENA_INCLUDED
+#define AGG_ARENA_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_array.h"
+
+#if defined(AGG_NO_THREADS)
+#define AGG_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define AGG_THREAD_LOCAL __declspec(thread)
+#else
+#define AGG_THREAD_LOCAL __thread
+#endif
+
+namespace agg
+{
+
+    //============================================================memory_arena
+    // Linear allocator. Unlike block_allocator, it keeps the blocks after
+    // reset() and allocates from them again, so after the first frames
+    // there are no calls to the system allocator at all. A request larger
+    // than the block size gets a block of its own, which is also reused.
+    //------------------------------------------------------------------------
+    class memory_arena
+    {
+        struct block_type
+        {
+            int8u*   data;
+            unsigned size;
+        };
+
+    public:
+        enum default_block_size_e
+        {
+            default_block_size = 256 * 1024
+        };
+
+        ~memory_arena() { free_all(); }
+
+        explicit memory_arena(unsigned block_size = default_block_size) :
+            m_block_size(block_size),
+            m_cur(-1),
+            m_ptr(0),
+            m_rest(0)
+        {
+        }
+
+        //--------------------------------------------------------------------
+        int8u* allocate(unsigned size, unsigned alignment = sizeof(double))
+        {
+            for(;;)
+            {
+                unsigned align =
+                    (alignment - unsigned((std::size_t)m_ptr % alignment)) % alignment;
+                if(m_cur >= 0 && align + size <= m_rest)
+                {
+                    int8u* ptr = m_ptr + align;
+                    m_ptr   = ptr + size;
+                    m_rest -= align + size;
+                    return ptr;
+                }
+                next_block(size + alignment - 1);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // Gives the memory back only if it's the last allocated one, so 
+        // that the containers created and destroyed in the stack order 
+        // within a frame reuse it. Otherwise it stays until reset().
+        void deallocate(int8u* ptr, unsigned size)
+        {
+            if(m_cur >= 0 && ptr + size == m_ptr && ptr >= m_blocks[m_cur].data)
+            {
+                m_ptr   = ptr;
+                m_rest += size;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // Makes all the memory free, in O(1). The blocks stay allocated.
+        void reset()
+        {
+            m_cur  = -1;
+            m_ptr  = 0;
+            m_rest = 0;
+        }
+
+        //--------------------------------------------------------------------
+        // Gives all the blocks back to the system
+        void free_all()
+        {
+            unsigned i;
+            for(i = 0; i < m_blocks.size(); i++)
+            {
+                pod_allocator<int8u>::deallocate(m_blocks[i].data, m_blocks[i].size);
+            }
+            m_blocks.free_all();
+            reset();
+        }
+
+        //--------------------------------------------------------------------
+        unsigned num_blocks() const { return m_blocks.size(); }
+
+        unsigned capacity() const
+        {
+            unsigned size = 0;
+            unsigned i;
+            for(i = 0; i < m_blocks.size(); i++) size += m_blocks[i].size;
+            return size;
+        }
+
+    private:
+        memory_arena(const memory_arena&);
+        const memory_arena& operator = (const memory_arena&);
+
+        //--------------------------------------------------------------------
+        // Goes to the next block that has the size, the smaller ones are
+        // skipped until the next reset().
+        void next_block(unsigned size)
+        {
+            while(++m_cur < int(m_blocks.size()))
+            {
+                if(m_blocks[m_cur].size >= size)
+                {
+                    m_ptr  = m_blocks[m_cur].data;
+                    m_rest = m_blocks[m_cur].size;
+                    return;
+                }
+            }
+            block_type blk;
+            blk.size = (size > m_block_size) ? size : m_block_size;
+            blk.data = pod_allocator<int8u>::allocate(blk.size);
+            m_blocks.add(blk);
+            m_cur  = m_blocks.size() - 1;
+            m_ptr  = blk.data;
+            m_rest = blk.size;
+        }
+
+        unsigned                   m_block_size;
+        pod_bvector<block_type, 4> m_blocks;
+        int                        m_cur;
+        int8u*                     m_ptr;
+        unsigned                   m_rest;
+    };
+
+
+    //=============================================================arena_scope
+    // Makes the arena current for the calling thread until the end of the
+    // scope. The scopes can be nested, the previous arena is restored.
+    //------------------------------------------------------------------------
+    class arena_scope
+    {
+    public:
+        explicit arena_scope(memory_arena& arena) : m_prev(current_ref())
+        {
+            current_ref() = &arena;
+        }
+
+        ~arena_scope()
+        {
+            current_ref() = m_prev;
+        }
+
+        static memory_arena* current() { return current_ref(); }
+
+    private:
+        arena_scope(const arena_scope&);
+        const arena_scope& operator = (const arena_scope&);
+
+        static memory_arena*& current_ref()
+        {
+            static AGG_THREAD_LOCAL memory_arena* arena = 0;
+            return arena;
+        }
+
+        memory_arena* m_prev;
+    };
+
+
+    //=========================================================arena_allocator
+    // The allocator policy for the containers above. Allocates from the
+    // current arena, which must exist.
+    //------------------------------------------------------------------------
+    template<class T> struct arena_allocator
+    {
+        static T* allocate(unsigned num)
+        {
+            return (T*)arena_scope::current()->allocate(num * sizeof(T));
+        }
+        static void deallocate(T* ptr, unsigned num)
+        {
+            memory_arena* arena = arena_scope::current();
+            if(arena) arena->deallocate((int8u*)ptr, num * sizeof(T));
+        }
+    };
+
+}
+
+#endif
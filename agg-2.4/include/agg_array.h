@@ -209,6 +209,14 @@ namespace agg
         void clear()              { m_size = 0; }
         void cut_at(unsigned num) { if(num < m_size) m_size = num; }
 
+        // Give the memory back, the capacity becomes zero.
+        void free_all()
+        {
+            pod_allocator<T>::deallocate(m_array, m_capacity);
+            m_array = 0;
+            m_size = m_capacity = 0;
+        }
+
     private:
         unsigned m_size;
         unsigned m_capacity;
@@ -322,8 +330,12 @@ namespace agg
     // to be extended (it happens very rarely). You can control the value 
     // of increment to reallocate the pointer buffer. See the second constructor.
     // By default, the incremeent value equals (1 << S), i.e., the block size.
+    //
+    // A is the allocator of the blocks, pod_allocator or arena_allocator 
+    // (agg_arena.h).
     //------------------------------------------------------------------------
-    template<class T, unsigned S=6> class pod_bvector
+    template<class T, unsigned S=6, template<class> class A=pod_allocator> 
+    class pod_bvector
     {
     public:
         enum block_scale_e
@@ -340,8 +352,8 @@ namespace agg
         pod_bvector(unsigned block_ptr_inc);
 
         // Copying
-        pod_bvector(const pod_bvector<T, S>& v);
-        const pod_bvector<T, S>& operator = (const pod_bvector<T, S>& v);
+        pod_bvector(const pod_bvector<T, S, A>& v);
+        const pod_bvector<T, S, A>& operator = (const pod_bvector<T, S, A>& v);
 
         void remove_all() { m_size = 0; }
         void clear()      { m_size = 0; }
@@ -511,35 +523,35 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> pod_bvector<T, S>::~pod_bvector()
+    template<class T, unsigned S, template<class> class A> pod_bvector<T, S, A>::~pod_bvector()
     {
         if(m_num_blocks)
         {
             T** blk = m_blocks + m_num_blocks - 1;
             while(m_num_blocks--)
             {
-                pod_allocator<T>::deallocate(*blk, block_size);
+                A<T>::deallocate(*blk, block_size);
                 --blk;
             }
         }
-        pod_allocator<T*>::deallocate(m_blocks, m_max_blocks);
+        A<T*>::deallocate(m_blocks, m_max_blocks);
     }
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> 
-    void pod_bvector<T, S>::free_tail(unsigned size)
+    template<class T, unsigned S, template<class> class A> 
+    void pod_bvector<T, S, A>::free_tail(unsigned size)
     {
         if(size < m_size)
         {
             unsigned nb = (size + block_mask) >> block_shift;
             while(m_num_blocks > nb)
             {
-                pod_allocator<T>::deallocate(m_blocks[--m_num_blocks], block_size);
+                A<T>::deallocate(m_blocks[--m_num_blocks], block_size);
             }
             if(m_num_blocks == 0)
             {
-                pod_allocator<T*>::deallocate(m_blocks, m_max_blocks);
+                A<T*>::deallocate(m_blocks, m_max_blocks);
                 m_blocks = 0;
                 m_max_blocks = 0;
             }
@@ -549,7 +561,7 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> pod_bvector<T, S>::pod_bvector() :
+    template<class T, unsigned S, template<class> class A> pod_bvector<T, S, A>::pod_bvector() :
         m_size(0),
         m_num_blocks(0),
         m_max_blocks(0),
@@ -560,8 +572,8 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> 
-    pod_bvector<T, S>::pod_bvector(unsigned block_ptr_inc) :
+    template<class T, unsigned S, template<class> class A> 
+    pod_bvector<T, S, A>::pod_bvector(unsigned block_ptr_inc) :
         m_size(0),
         m_num_blocks(0),
         m_max_blocks(0),
@@ -572,29 +584,29 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> 
-    pod_bvector<T, S>::pod_bvector(const pod_bvector<T, S>& v) :
+    template<class T, unsigned S, template<class> class A> 
+    pod_bvector<T, S, A>::pod_bvector(const pod_bvector<T, S, A>& v) :
         m_size(v.m_size),
         m_num_blocks(v.m_num_blocks),
         m_max_blocks(v.m_max_blocks),
         m_blocks(v.m_max_blocks ? 
-                 pod_allocator<T*>::allocate(v.m_max_blocks) : 
+                 A<T*>::allocate(v.m_max_blocks) : 
                  0),
         m_block_ptr_inc(v.m_block_ptr_inc)
     {
         unsigned i;
         for(i = 0; i < v.m_num_blocks; ++i)
         {
-            m_blocks[i] = pod_allocator<T>::allocate(block_size);
+            m_blocks[i] = A<T>::allocate(block_size);
             std::memcpy(m_blocks[i], v.m_blocks[i], block_size * sizeof(T));
         }
     }
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> 
-    const pod_bvector<T, S>& 
-    pod_bvector<T, S>::operator = (const pod_bvector<T, S>& v)
+    template<class T, unsigned S, template<class> class A> 
+    const pod_bvector<T, S, A>& 
+    pod_bvector<T, S, A>::operator = (const pod_bvector<T, S, A>& v)
     {
         unsigned i;
         for(i = m_num_blocks; i < v.m_num_blocks; ++i)
@@ -611,12 +623,12 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S>
-    void pod_bvector<T, S>::allocate_block(unsigned nb)
+    template<class T, unsigned S, template<class> class A>
+    void pod_bvector<T, S, A>::allocate_block(unsigned nb)
     {
         if(nb >= m_max_blocks) 
         {
-            T** new_blocks = pod_allocator<T*>::allocate(m_max_blocks + m_block_ptr_inc);
+            T** new_blocks = A<T*>::allocate(m_max_blocks + m_block_ptr_inc);
 
             if(m_blocks)
             {
@@ -624,20 +636,20 @@ namespace agg
                        m_blocks, 
                        m_num_blocks * sizeof(T*));
 
-                pod_allocator<T*>::deallocate(m_blocks, m_max_blocks);
+                A<T*>::deallocate(m_blocks, m_max_blocks);
             }
             m_blocks = new_blocks;
             m_max_blocks += m_block_ptr_inc;
         }
-        m_blocks[nb] = pod_allocator<T>::allocate(block_size);
+        m_blocks[nb] = A<T>::allocate(block_size);
         m_num_blocks++;
     }
 
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S>
-    inline T* pod_bvector<T, S>::data_ptr()
+    template<class T, unsigned S, template<class> class A>
+    inline T* pod_bvector<T, S, A>::data_ptr()
     {
         unsigned nb = m_size >> block_shift;
         if(nb >= m_num_blocks)
@@ -650,8 +662,8 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> 
-    inline void pod_bvector<T, S>::add(const T& val)
+    template<class T, unsigned S, template<class> class A> 
+    inline void pod_bvector<T, S, A>::add(const T& val)
     {
         *data_ptr() = val;
         ++m_size;
@@ -659,16 +671,16 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> 
-    inline void pod_bvector<T, S>::remove_last()
+    template<class T, unsigned S, template<class> class A> 
+    inline void pod_bvector<T, S, A>::remove_last()
     {
         if(m_size) --m_size;
     }
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> 
-    void pod_bvector<T, S>::modify_last(const T& val)
+    template<class T, unsigned S, template<class> class A> 
+    void pod_bvector<T, S, A>::modify_last(const T& val)
     {
         remove_last();
         add(val);
@@ -676,8 +688,8 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> 
-    int pod_bvector<T, S>::allocate_continuous_block(unsigned num_elements)
+    template<class T, unsigned S, template<class> class A> 
+    int pod_bvector<T, S, A>::allocate_continuous_block(unsigned num_elements)
     {
         if(num_elements < block_size)
         {
@@ -706,16 +718,16 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> 
-    unsigned pod_bvector<T, S>::byte_size() const
+    template<class T, unsigned S, template<class> class A> 
+    unsigned pod_bvector<T, S, A>::byte_size() const
     {
         return m_size * sizeof(T);
     }
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> 
-    void pod_bvector<T, S>::serialize(int8u* ptr) const
+    template<class T, unsigned S, template<class> class A> 
+    void pod_bvector<T, S, A>::serialize(int8u* ptr) const
     {
         unsigned i;
         for(i = 0; i < m_size; i++)
@@ -726,8 +738,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S> 
-    void pod_bvector<T, S>::deserialize(const int8u* data, unsigned byte_size)
+    template<class T, unsigned S, template<class> class A> 
+    void pod_bvector<T, S, A>::deserialize(const int8u* data, unsigned byte_size)
     {
         remove_all();
         byte_size /= sizeof(T);
@@ -743,8 +755,8 @@ namespace agg
 
     // Replace or add a number of elements starting from "start" position
     //------------------------------------------------------------------------
-    template<class T, unsigned S> 
-    void pod_bvector<T, S>::deserialize(unsigned start, const T& empty_val, 
+    template<class T, unsigned S, template<class> class A> 
+    void pod_bvector<T, S, A>::deserialize(unsigned start, const T& empty_val, 
                                         const int8u* data, unsigned byte_size)
     {
         while(m_size < start)
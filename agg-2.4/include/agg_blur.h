@@ -1064,6 +1064,47 @@ namespace agg
 
 
 
+    //======================================================recursive_blur_coef
+    // The coefficients of the recursive Gaussian filter for the given 
+    // radius, shared by recursive_blur and recursive_blur_parallel.
+    template<class T> struct recursive_blur_coef
+    {
+        T b, b1, b2, b3;
+
+        explicit recursive_blur_coef(double radius)
+        {
+            T s = T(radius * 0.5);
+            T q = T((s < 2.5) ?
+                    3.97156 - 4.14554 * std::sqrt(1 - 0.26891 * s) :
+                    0.98711 * s - 0.96330);
+
+            T q2 = T(q * q);
+            T q3 = T(q2 * q);
+
+            T b0 = T(1.0 / (1.578250 + 
+                            2.444130 * q + 
+                            1.428100 * q2 + 
+                            0.422205 * q3));
+
+            b1 = T( 2.44413 * q + 
+                    2.85619 * q2 + 
+                    1.26661 * q3);
+
+            b2 = T(-1.42810 * q2 + 
+                   -1.26661 * q3);
+
+            b3 = T(0.422205 * q3);
+
+            b  = T(1 - (b1 + b2 + b3) * b0);
+
+            b1 *= b0;
+            b2 *= b0;
+            b3 *= b0;
+        }
+    };
+
+
+
     //===========================================================recursive_blur
     template<class ColorT, class CalculatorT> class recursive_blur
     {
@@ -1079,33 +1120,11 @@ namespace agg
             if(radius < 0.62) return;
             if(img.width() < 3) return;
 
-            calc_type s = calc_type(radius * 0.5);
-            calc_type q = calc_type((s < 2.5) ?
-                                    3.97156 - 4.14554 * std::sqrt(1 - 0.26891 * s) :
-                                    0.98711 * s - 0.96330);
-
-            calc_type q2 = calc_type(q * q);
-            calc_type q3 = calc_type(q2 * q);
-
-            calc_type b0 = calc_type(1.0 / (1.578250 + 
-                                            2.444130 * q + 
-                                            1.428100 * q2 + 
-                                            0.422205 * q3));
-
-            calc_type b1 = calc_type( 2.44413 * q + 
-                                      2.85619 * q2 + 
-                                      1.26661 * q3);
-
-            calc_type b2 = calc_type(-1.42810 * q2 + 
-                                     -1.26661 * q3);
-
-            calc_type b3 = calc_type(0.422205 * q3);
-
-            calc_type b  = calc_type(1 - (b1 + b2 + b3) * b0);
-
-            b1 *= b0;
-            b2 *= b0;
-            b3 *= b0;
+            recursive_blur_coef<calc_type> k(radius);
+            calc_type b  = k.b;
+            calc_type b1 = k.b1;
+            calc_type b2 = k.b2;
+            calc_type b3 = k.b3;
 
             int w = img.width();
             int h = img.height();
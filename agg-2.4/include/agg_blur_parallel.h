@@ -0,0 +1,941 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Multithreaded versions of the blur algorithms from agg_blur.h.
+//
+// The horizontal pass splits the rows between the threads. The vertical
+// pass doesn't use pixfmt_transposer, which walks the memory with the
+// row stride for every single pixel. Instead, it processes a block of
+// adjacent columns at once, going down the rows, so that every row is
+// touched by whole cache lines. The blocks are split between the threads.
+//
+// The result is byte-identical to the serial functions and classes.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_BLUR_PARALLEL_INCLUDED
+#define AGG_BLUR_PARALLEL_INCLUDED
+
+#include <string.h>
+#include "agg_blur.h"
+#include "agg_simd.h"
+#include "agg_threads.h"
+
+namespace agg
+{
+
+#if defined(AGG_SIMD_SSE2)
+
+    //------------------------------------------------------------------------
+    // SIMD kernels of stack_blur_lines8<4>. One pixel is kept in four
+    // 32-bit lanes, so that the sums of r, g, b and a are processed at
+    // once. See stack_blur_lines8::blur_lines() for the plain C++ version.
+    //------------------------------------------------------------------------
+    inline __m128i stack_blur_load_rgba8_sse2(const int8u* p)
+    {
+        int v;
+        memcpy(&v, p, 4);
+        __m128i zero = _mm_setzero_si128();
+        return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero),
+                                  zero);
+    }
+
+    //------------------------------------------------------------------------
+    inline void stack_blur_lines_rgba8_sse2(int8u* p, unsigned len,
+                                            int pix_step, int line_step,
+                                            unsigned num_lines,
+                                            unsigned radius, unsigned div,
+                                            unsigned mul, unsigned shr,
+                                            unsigned xp, unsigned stack_ptr,
+                                            int8u* stack,
+                                            unsigned* sum,
+                                            unsigned* sum_in,
+                                            unsigned* sum_out)
+    {
+        __m128i v_sum[16];
+        __m128i v_sum_in[16];
+        __m128i v_sum_out[16];
+        __m128i v_mul  = _mm_cvtsi32_si128(int(mul));
+        __m128i v_shr  = _mm_cvtsi32_si128(int(shr));
+        unsigned lm = len - 1;
+        unsigned row_bytes = num_lines * 4;
+        unsigned x, l;
+
+        v_mul = _mm_shuffle_epi32(v_mul, 0);
+
+        for(l = 0; l < num_lines; l++)
+        {
+            v_sum[l]     = _mm_loadu_si128((const __m128i*)(sum     + l * 4));
+            v_sum_in[l]  = _mm_loadu_si128((const __m128i*)(sum_in  + l * 4));
+            v_sum_out[l] = _mm_loadu_si128((const __m128i*)(sum_out + l * 4));
+        }
+
+        int8u* dst = p;
+        for(x = 0; x < len; x++)
+        {
+            unsigned stack_start = stack_ptr + div - radius;
+            if(stack_start >= div) stack_start -= div;
+            if(++stack_ptr >= div) stack_ptr = 0;
+            if(xp < lm) ++xp;
+
+            int8u*       st_start = stack + stack_start * row_bytes;
+            const int8u* st_next  = stack + stack_ptr   * row_bytes;
+            const int8u* src      = p + int(xp) * pix_step;
+            int8u*       d        = dst;
+
+            for(l = 0; l < num_lines; l++)
+            {
+                __m128i s  = v_sum[l];
+                __m128i lo = _mm_srl_epi64(_mm_mul_epu32(s, v_mul), v_shr);
+                __m128i hi = _mm_srl_epi64(_mm_mul_epu32(_mm_srli_epi64(s, 32),
+                                                         v_mul), v_shr);
+                __m128i c  = _mm_or_si128(lo, _mm_slli_epi64(hi, 32));
+                c = _mm_packs_epi32(c, c);
+                c = _mm_packus_epi16(c, c);
+                int v = _mm_cvtsi128_si32(c);
+                memcpy(d, &v, 4);
+
+                __m128i so = _mm_sub_epi32(v_sum_out[l],
+                                           stack_blur_load_rgba8_sse2(st_start));
+                s = _mm_sub_epi32(s, v_sum_out[l]);
+
+                memcpy(st_start, src, 4);
+                __m128i si = _mm_add_epi32(v_sum_in[l],
+                                           stack_blur_load_rgba8_sse2(src));
+                s = _mm_add_epi32(s, si);
+
+                __m128i n = stack_blur_load_rgba8_sse2(st_next);
+                v_sum_out[l] = _mm_add_epi32(so, n);
+                v_sum_in[l]  = _mm_sub_epi32(si, n);
+                v_sum[l]     = s;
+
+                d        += line_step;
+                src      += line_step;
+                st_start += 4;
+                st_next  += 4;
+            }
+            dst += pix_step;
+        }
+    }
+
+#if defined(AGG_SIMD_AVX2)
+
+    //------------------------------------------------------------------------
+    AGG_SIMD_TARGET_AVX2
+    inline __m256i stack_blur_load2_rgba8_avx2(const int8u* p1, const int8u* p2)
+    {
+        int v1, v2;
+        memcpy(&v1, p1, 4);
+        memcpy(&v2, p2, 4);
+        return _mm256_cvtepu8_epi32(_mm_unpacklo_epi32(_mm_cvtsi32_si128(v1),
+                                                       _mm_cvtsi32_si128(v2)));
+    }
+
+    //------------------------------------------------------------------------
+    // Two pixels per register, that is, two lines at a time. An odd line
+    // left over is processed in the lower half with the same code.
+    AGG_SIMD_TARGET_AVX2
+    inline void stack_blur_lines_rgba8_avx2(int8u* p, unsigned len,
+                                            int pix_step, int line_step,
+                                            unsigned num_lines,
+                                            unsigned radius, unsigned div,
+                                            unsigned mul, unsigned shr,
+                                            unsigned xp, unsigned stack_ptr,
+                                            int8u* stack,
+                                            unsigned* sum,
+                                            unsigned* sum_in,
+                                            unsigned* sum_out)
+    {
+        __m256i v_sum[8];
+        __m256i v_sum_in[8];
+        __m256i v_sum_out[8];
+        __m256i v_mul = _mm256_set1_epi32(int(mul));
+        __m128i v_shr = _mm_cvtsi32_si128(int(shr));
+        unsigned num_pairs = (num_lines + 1) >> 1;
+        unsigned lm = len - 1;
+        unsigned row_bytes = num_lines * 4;
+        unsigned x, l;
+
+        // Loading the states of an odd number of lines reads 4 extra
+        // values, which the caller provides and never uses.
+        for(l = 0; l < num_pairs; l++)
+        {
+            v_sum[l]     = _mm256_loadu_si256((const __m256i*)(sum     + l * 8));
+            v_sum_in[l]  = _mm256_loadu_si256((const __m256i*)(sum_in  + l * 8));
+            v_sum_out[l] = _mm256_loadu_si256((const __m256i*)(sum_out + l * 8));
+        }
+
+        int8u* dst = p;
+        for(x = 0; x < len; x++)
+        {
+            unsigned stack_start = stack_ptr + div - radius;
+            if(stack_start >= div) stack_start -= div;
+            if(++stack_ptr >= div) stack_ptr = 0;
+            if(xp < lm) ++xp;
+
+            int8u*       st_start = stack + stack_start * row_bytes;
+            const int8u* st_next  = stack + stack_ptr   * row_bytes;
+            const int8u* src      = p + int(xp) * pix_step;
+            int8u*       d        = dst;
+
+            for(l = 0; l < num_pairs; l++)
+            {
+                // The second pixel of an odd last pair is a copy of
+                // the first one and isn't stored.
+                bool two = 2 * l + 1 < num_lines;
+                int  ls  = two ? line_step : 0;
+                int  ss  = two ? 4 : 0;
+
+                __m256i s = v_sum[l];
+                __m256i c = _mm256_srl_epi32(_mm256_mullo_epi32(s, v_mul), v_shr);
+                c = _mm256_packs_epi32(c, c);
+                c = _mm256_packus_epi16(c, c);
+                int v1 = _mm_cvtsi128_si32(_mm256_castsi256_si128(c));
+                int v2 = _mm_cvtsi128_si32(_mm256_extracti128_si256(c, 1));
+                memcpy(d, &v1, 4);
+                if(two) memcpy(d + ls, &v2, 4);
+
+                __m256i so = _mm256_sub_epi32(v_sum_out[l],
+                                 stack_blur_load2_rgba8_avx2(st_start, st_start + ss));
+                s = _mm256_sub_epi32(s, v_sum_out[l]);
+
+                __m256i pix = stack_blur_load2_rgba8_avx2(src, src + ls);
+                memcpy(st_start, src, 4);
+                if(two) memcpy(st_start + 4, src + ls, 4);
+                __m256i si = _mm256_add_epi32(v_sum_in[l], pix);
+                s = _mm256_add_epi32(s, si);
+
+                __m256i n = stack_blur_load2_rgba8_avx2(st_next, st_next + ss);
+                v_sum_out[l] = _mm256_add_epi32(so, n);
+                v_sum_in[l]  = _mm256_sub_epi32(si, n);
+                v_sum[l]     = s;
+
+                d        += 2 * line_step;
+                src      += 2 * line_step;
+                st_start += 8;
+                st_next  += 8;
+            }
+            dst += pix_step;
+        }
+    }
+
+#endif
+#endif
+
+
+    //=======================================================stack_blur_lines8
+    // Stack blur of several lines of pixels with 8-bit channels at once,
+    // exactly as stack_blur_gray8(), stack_blur_rgb24() and
+    // stack_blur_rgba32() do it for a single line. All the channels are
+    // processed in the same way, so the pixels are just Channels bytes,
+    // pix_step bytes apart. The lines start line_step bytes apart.
+    // When the lines are the adjacent columns line_step is the pixel width
+    // and pix_step is the row stride. Processing the lines together keeps
+    // the state of all of them in registers or the first level cache and
+    // gives the processor independent computations to overlap.
+    //------------------------------------------------------------------------
+    template<unsigned Channels> class stack_blur_lines8
+    {
+    public:
+        enum max_lines_e { max_lines = 16 };
+
+        //--------------------------------------------------------------------
+        stack_blur_lines8() : m_radius(0), m_div(1), m_mul(0), m_shr(0) {}
+
+        //--------------------------------------------------------------------
+        void radius(unsigned r)
+        {
+            if(r > 254) r = 254;
+            m_radius = r;
+            m_div = r * 2 + 1;
+            m_mul = stack_blur_tables<int>::g_stack_blur8_mul[r];
+            m_shr = stack_blur_tables<int>::g_stack_blur8_shr[r];
+            m_stack.allocate(m_div * max_lines * Channels);
+        }
+
+        unsigned radius() const { return m_radius; }
+
+        //--------------------------------------------------------------------
+        void blur(int8u* p, unsigned len, int pix_step,
+                  int line_step, unsigned num_lines)
+        {
+            if(m_radius == 0 || len == 0 || num_lines == 0) return;
+            if(num_lines > max_lines) num_lines = max_lines;
+
+            unsigned r  = m_radius;
+            unsigned lm = len - 1;
+            unsigned n  = num_lines * Channels;
+            unsigned i, j, l;
+            int8u* st;
+
+            memset(m_sum,     0, sizeof(m_sum));
+            memset(m_sum_in,  0, sizeof(m_sum_in));
+            memset(m_sum_out, 0, sizeof(m_sum_out));
+
+            for(l = 0; l < num_lines; l++)
+            {
+                const int8u* src = p + int(l) * line_step;
+                unsigned* sum     = m_sum     + l * Channels;
+                unsigned* sum_in  = m_sum_in  + l * Channels;
+                unsigned* sum_out = m_sum_out + l * Channels;
+                for(i = 0; i <= r; i++)
+                {
+                    st = &m_stack[i * n + l * Channels];
+                    for(j = 0; j < Channels; j++)
+                    {
+                        st[j]       = src[j];
+                        sum[j]     += src[j] * (i + 1);
+                        sum_out[j] += src[j];
+                    }
+                }
+                for(i = 1; i <= r; i++)
+                {
+                    if(i <= lm) src += pix_step;
+                    st = &m_stack[(i + r) * n + l * Channels];
+                    for(j = 0; j < Channels; j++)
+                    {
+                        st[j]      = src[j];
+                        sum[j]    += src[j] * (r + 1 - i);
+                        sum_in[j] += src[j];
+                    }
+                }
+            }
+
+            unsigned xp = (r > lm) ? lm : r;
+
+#if defined(AGG_SIMD_SSE2)
+            if(Channels == 4)
+            {
+#if defined(AGG_SIMD_AVX2)
+                if(simd_level() >= simd_avx2)
+                {
+                    stack_blur_lines_rgba8_avx2(p, len, pix_step, line_step,
+                                                num_lines, r, m_div, m_mul, m_shr,
+                                                xp, r, &m_stack[0],
+                                                m_sum, m_sum_in, m_sum_out);
+                    return;
+                }
+#endif
+                if(simd_level() >= simd_sse2)
+                {
+                    stack_blur_lines_rgba8_sse2(p, len, pix_step, line_step,
+                                                num_lines, r, m_div, m_mul, m_shr,
+                                                xp, r, &m_stack[0],
+                                                m_sum, m_sum_in, m_sum_out);
+                    return;
+                }
+            }
+#endif
+            blur_lines(p, len, pix_step, line_step, num_lines, xp);
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        void blur_lines(int8u* p, unsigned len, int pix_step,
+                        int line_step, unsigned num_lines, unsigned xp)
+        {
+            unsigned r  = m_radius;
+            unsigned lm = len - 1;
+            unsigned n  = num_lines * Channels;
+            unsigned stack_ptr = r;
+            unsigned x, j, l;
+
+            int8u* dst = p;
+            for(x = 0; x < len; x++)
+            {
+                unsigned stack_start = stack_ptr + m_div - r;
+                if(stack_start >= m_div) stack_start -= m_div;
+                if(++stack_ptr >= m_div) stack_ptr = 0;
+                if(xp < lm) ++xp;
+
+                int8u*       st_start = &m_stack[stack_start * n];
+                const int8u* st_next  = &m_stack[stack_ptr * n];
+                const int8u* src      = p + int(xp) * pix_step;
+                int8u*       d        = dst;
+                unsigned*    sum      = m_sum;
+                unsigned*    sum_in   = m_sum_in;
+                unsigned*    sum_out  = m_sum_out;
+
+                for(l = 0; l < num_lines; l++)
+                {
+                    for(j = 0; j < Channels; j++)
+                    {
+                        d[j] = int8u((sum[j] * m_mul) >> m_shr);
+                        sum[j]     -= sum_out[j];
+                        sum_out[j] -= st_start[j];
+                        st_start[j] = src[j];
+                        sum_in[j]  += src[j];
+                        sum[j]     += sum_in[j];
+                        sum_out[j] += st_next[j];
+                        sum_in[j]  -= st_next[j];
+                    }
+                    d        += line_step;
+                    src      += line_step;
+                    st_start += Channels;
+                    st_next  += Channels;
+                    sum      += Channels;
+                    sum_in   += Channels;
+                    sum_out  += Channels;
+                }
+                dst += pix_step;
+            }
+        }
+
+        unsigned m_radius;
+        unsigned m_div;
+        unsigned m_mul;
+        unsigned m_shr;
+        // One extra pixel for the AVX2 kernel, see above
+        unsigned m_sum    [(max_lines + 1) * Channels];
+        unsigned m_sum_in [(max_lines + 1) * Channels];
+        unsigned m_sum_out[(max_lines + 1) * Channels];
+        pod_vector<int8u> m_stack;
+    };
+
+
+    //=========================================================stack_blur8_task
+    // Internal. One pass of the stack blur of an image with 8-bit channels.
+    template<class Img, unsigned Channels> struct stack_blur8_task
+    {
+        enum block_e
+        {
+            row_block    = 4,
+            column_block = stack_blur_lines8<Channels>::max_lines
+        };
+
+        Img*     img;
+        unsigned radius;
+        bool     vertical;
+
+        void run(unsigned idx, unsigned num)
+        {
+            stack_blur_lines8<Channels> lines;
+            lines.radius(radius);
+
+            unsigned w = img->width();
+            unsigned h = img->height();
+            int stride = img->stride();
+
+            if(vertical)
+            {
+                unsigned nb = (w + column_block - 1) / column_block;
+                unsigned b1 = unsigned(int64u(nb) * idx / num);
+                unsigned b2 = unsigned(int64u(nb) * (idx + 1) / num);
+                for(; b1 < b2; b1++)
+                {
+                    unsigned x = b1 * column_block;
+                    unsigned n = w - x;
+                    if(n > column_block) n = column_block;
+                    lines.blur(img->pix_ptr(x, 0), h, stride, Img::pix_width, n);
+                }
+            }
+            else
+            {
+                unsigned y  = unsigned(int64u(h) * idx / num);
+                unsigned y2 = unsigned(int64u(h) * (idx + 1) / num);
+                for(; y < y2; y += row_block)
+                {
+                    unsigned n = y2 - y;
+                    if(n > row_block) n = row_block;
+                    lines.blur(img->pix_ptr(0, y), w, Img::pix_width, stride, n);
+                }
+            }
+        }
+    };
+
+
+    //------------------------------------------------------------------------
+    template<unsigned Channels, class Img>
+    void stack_blur8_parallel(Img& img, unsigned rx, unsigned ry,
+                              unsigned num_threads)
+    {
+        if(img.width() == 0 || img.height() == 0) return;
+        if(num_threads == 0) num_threads = num_cpus();
+
+        stack_blur8_task<Img, Channels> task;
+        task.img = &img;
+
+        if(rx > 0)
+        {
+            unsigned n = num_threads;
+            if(n > img.height()) n = img.height();
+            task.radius   = rx;
+            task.vertical = false;
+            run_parallel(task, n);
+        }
+
+        if(ry > 0)
+        {
+            typedef stack_blur8_task<Img, Channels> task_type;
+            unsigned n  = num_threads;
+            unsigned nb = (img.width() + task_type::column_block - 1) /
+                          task_type::column_block;
+            if(n > nb) n = nb;
+            task.radius   = ry;
+            task.vertical = true;
+            run_parallel(task, n);
+        }
+    }
+
+
+    //===============================================stack_blur_gray8_parallel
+    // The same as stack_blur_gray8(), stack_blur_rgb24() and
+    // stack_blur_rgba32(), using num_threads threads, 0 means one thread
+    // per processor. The rgba32 version uses SSE2 or AVX2 when
+    // simd_level() allows it.
+    template<class Img>
+    void stack_blur_gray8_parallel(Img& img, unsigned rx, unsigned ry,
+                                   unsigned num_threads=0)
+    {
+        stack_blur8_parallel<1>(img, rx, ry, num_threads);
+    }
+
+    //===============================================stack_blur_rgb24_parallel
+    template<class Img>
+    void stack_blur_rgb24_parallel(Img& img, unsigned rx, unsigned ry,
+                                   unsigned num_threads=0)
+    {
+        stack_blur8_parallel<3>(img, rx, ry, num_threads);
+    }
+
+    //==============================================stack_blur_rgba32_parallel
+    template<class Img>
+    void stack_blur_rgba32_parallel(Img& img, unsigned rx, unsigned ry,
+                                    unsigned num_threads=0)
+    {
+        stack_blur8_parallel<4>(img, rx, ry, num_threads);
+    }
+
+
+
+    //==========================================================blur_row_range
+    // Internal. Presents the rows [y1, y2) of an image as a whole image,
+    // so that the serial blur_x() can process a part of the rows.
+    template<class Img> class blur_row_range
+    {
+    public:
+        typedef typename Img::color_type color_type;
+
+        blur_row_range(Img& img, unsigned y1, unsigned y2) :
+            m_img(&img), m_y1(y1), m_height(y2 - y1) {}
+
+        unsigned width()  const { return m_img->width(); }
+        unsigned height() const { return m_height; }
+
+        color_type pixel(int x, int y) const
+        {
+            return m_img->pixel(x, y + m_y1);
+        }
+
+        void copy_color_hspan(int x, int y, unsigned len,
+                              const color_type* colors)
+        {
+            m_img->copy_color_hspan(x, y + m_y1, len, colors);
+        }
+
+    private:
+        Img*     m_img;
+        unsigned m_y1;
+        unsigned m_height;
+    };
+
+
+    //===========================================================blur_x_task
+    // Internal. The horizontal pass with a serial blur class, Blur,
+    // for every thread's part of the rows.
+    template<class Blur, class Img, class Radius> struct blur_x_task
+    {
+        Img*   img;
+        Radius radius;
+
+        void run(unsigned idx, unsigned num)
+        {
+            unsigned h  = img->height();
+            unsigned y1 = unsigned(int64u(h) * idx / num);
+            unsigned y2 = unsigned(int64u(h) * (idx + 1) / num);
+            if(y1 < y2)
+            {
+                Blur blur;
+                blur_row_range<Img> rows(*img, y1, y2);
+                blur.blur_x(rows, radius);
+            }
+        }
+    };
+
+
+    //===========================================================blur_y_task
+    // Internal. The vertical pass by blocks of columns with the Columns
+    // class, that provides blur(img, x, num_columns, radius).
+    template<class Columns, class Img, class Radius> struct blur_y_task
+    {
+        Img*     img;
+        Radius   radius;
+        unsigned block;
+
+        void run(unsigned idx, unsigned num)
+        {
+            unsigned w  = img->width();
+            unsigned nb = (w + block - 1) / block;
+            unsigned b1 = unsigned(int64u(nb) * idx / num);
+            unsigned b2 = unsigned(int64u(nb) * (idx + 1) / num);
+            if(b1 < b2)
+            {
+                Columns columns;
+                for(; b1 < b2; b1++)
+                {
+                    unsigned x = b1 * block;
+                    unsigned n = w - x;
+                    if(n > block) n = block;
+                    columns.blur(*img, x, n, radius);
+                }
+            }
+        }
+    };
+
+
+    //------------------------------------------------------------------------
+    template<class Blur, class Columns, class Img, class Radius>
+    void blur_parallel(Img& img, Radius rx, Radius ry,
+                       unsigned block, unsigned num_threads)
+    {
+        if(img.width() == 0 || img.height() == 0) return;
+        if(num_threads == 0) num_threads = num_cpus();
+
+        if(rx > 0)
+        {
+            blur_x_task<Blur, Img, Radius> task;
+            task.img    = &img;
+            task.radius = rx;
+            unsigned n  = num_threads;
+            if(n > img.height()) n = img.height();
+            run_parallel(task, n);
+        }
+
+        if(ry > 0)
+        {
+            blur_y_task<Columns, Img, Radius> task;
+            task.img    = &img;
+            task.radius = ry;
+            task.block  = block;
+            unsigned n  = num_threads;
+            unsigned nb = (img.width() + block - 1) / block;
+            if(n > nb) n = nb;
+            run_parallel(task, n);
+        }
+    }
+
+
+
+    //=======================================================stack_blur_columns
+    // Internal. stack_blur::blur_x() for a block of adjacent columns.
+    template<class ColorT, class CalculatorT> class stack_blur_columns
+    {
+    public:
+        typedef ColorT      color_type;
+        typedef CalculatorT calculator_type;
+
+        enum max_columns_e { max_columns = 16 };
+
+        template<class Img>
+        void blur(Img& img, unsigned x1, unsigned num, unsigned radius)
+        {
+            if(radius < 1) return;
+            if(num > max_columns) num = max_columns;
+
+            unsigned y, yp, i, k;
+            unsigned stack_ptr;
+            unsigned stack_start;
+
+            color_type      pix;
+            color_type*     stack_pix;
+            calculator_type sum[max_columns];
+            calculator_type sum_in[max_columns];
+            calculator_type sum_out[max_columns];
+            color_type      buf[max_columns];
+
+            unsigned h   = img.height();
+            unsigned hm  = h - 1;
+            unsigned div = radius * 2 + 1;
+
+            unsigned div_sum = (radius + 1) * (radius + 1);
+            unsigned mul_sum = 0;
+            unsigned shr_sum = 0;
+            unsigned max_val = color_type::base_mask;
+
+            if(max_val <= 255 && radius < 255)
+            {
+                mul_sum = stack_blur_tables<int>::g_stack_blur8_mul[radius];
+                shr_sum = stack_blur_tables<int>::g_stack_blur8_shr[radius];
+            }
+
+            m_stack.allocate(div * num, 32);
+
+            for(k = 0; k < num; k++)
+            {
+                sum[k].clear();
+                sum_in[k].clear();
+                sum_out[k].clear();
+
+                pix = img.pixel(x1 + k, 0);
+                for(i = 0; i <= radius; i++)
+                {
+                    m_stack[i * num + k] = pix;
+                    sum[k].add(pix, i + 1);
+                    sum_out[k].add(pix);
+                }
+                for(i = 1; i <= radius; i++)
+                {
+                    pix = img.pixel(x1 + k, (i > hm) ? hm : i);
+                    m_stack[(i + radius) * num + k] = pix;
+                    sum[k].add(pix, radius + 1 - i);
+                    sum_in[k].add(pix);
+                }
+            }
+
+            stack_ptr = radius;
+            for(y = 0; y < h; y++)
+            {
+                for(k = 0; k < num; k++)
+                {
+                    if(mul_sum) sum[k].calc_pix(buf[k], mul_sum, shr_sum);
+                    else        sum[k].calc_pix(buf[k], div_sum);
+                }
+                img.copy_color_hspan(x1, y, num, buf);
+
+                stack_start = stack_ptr + div - radius;
+                if(stack_start >= div) stack_start -= div;
+                yp = y + radius + 1;
+                if(yp > hm) yp = hm;
+
+                for(k = 0; k < num; k++)
+                {
+                    sum[k].sub(sum_out[k]);
+
+                    stack_pix = &m_stack[stack_start * num + k];
+                    sum_out[k].sub(*stack_pix);
+
+                    pix = img.pixel(x1 + k, yp);
+                    *stack_pix = pix;
+
+                    sum_in[k].add(pix);
+                    sum[k].add(sum_in[k]);
+                }
+
+                ++stack_ptr;
+                if(stack_ptr >= div) stack_ptr = 0;
+
+                for(k = 0; k < num; k++)
+                {
+                    stack_pix = &m_stack[stack_ptr * num + k];
+                    sum_out[k].add(*stack_pix);
+                    sum_in[k].sub(*stack_pix);
+                }
+            }
+        }
+
+    private:
+        pod_vector<color_type> m_stack;
+    };
+
+
+    //======================================================stack_blur_parallel
+    // The same as stack_blur, using num_threads threads, 0 means one thread
+    // per processor.
+    template<class ColorT, class CalculatorT> class stack_blur_parallel
+    {
+    public:
+        typedef ColorT      color_type;
+        typedef CalculatorT calculator_type;
+        typedef stack_blur<ColorT, CalculatorT>         blur_type;
+        typedef stack_blur_columns<ColorT, CalculatorT> columns_type;
+
+        //--------------------------------------------------------------------
+        explicit stack_blur_parallel(unsigned num_threads=0) :
+            m_num_threads(num_threads) {}
+
+        void     num_threads(unsigned n) { m_num_threads = n; }
+        unsigned num_threads() const     { return m_num_threads; }
+
+        //--------------------------------------------------------------------
+        template<class Img> void blur_x(Img& img, unsigned radius)
+        {
+            blur_parallel<blur_type, columns_type>(img, radius, 0u,
+                                                   columns_type::max_columns,
+                                                   m_num_threads);
+        }
+
+        //--------------------------------------------------------------------
+        template<class Img> void blur_y(Img& img, unsigned radius)
+        {
+            blur_parallel<blur_type, columns_type>(img, 0u, radius,
+                                                   columns_type::max_columns,
+                                                   m_num_threads);
+        }
+
+        //--------------------------------------------------------------------
+        template<class Img> void blur(Img& img, unsigned radius)
+        {
+            blur_parallel<blur_type, columns_type>(img, radius, radius,
+                                                   columns_type::max_columns,
+                                                   m_num_threads);
+        }
+
+    private:
+        unsigned m_num_threads;
+    };
+
+
+
+    //===================================================recursive_blur_columns
+    // Internal. recursive_blur::blur_x() for a block of adjacent columns.
+    // The backward pass overwrites the forward sums, which aren't needed
+    // any more, so there's one array of h * num calculators.
+    template<class ColorT, class CalculatorT> class recursive_blur_columns
+    {
+    public:
+        typedef ColorT color_type;
+        typedef CalculatorT calculator_type;
+        typedef typename calculator_type::value_type calc_type;
+
+        enum max_columns_e { max_columns = 8 };
+
+        template<class Img>
+        void blur(Img& img, unsigned x1, unsigned num, double radius)
+        {
+            if(radius < 0.62) return;
+            if(img.height() < 3) return;
+            if(num > max_columns) num = max_columns;
+
+            recursive_blur_coef<calc_type> k(radius);
+            calc_type b  = k.b;
+            calc_type b1 = k.b1;
+            calc_type b2 = k.b2;
+            calc_type b3 = k.b3;
+
+            int h  = img.height();
+            int hm = h - 1;
+            int n  = num;
+            int y, i;
+            calculator_type c;
+            color_type buf[max_columns];
+
+            m_sum.allocate(h * num);
+            calculator_type* s = &m_sum[0];
+
+            for(i = 0; i < n; i++)
+            {
+                c.from_pix(img.pixel(x1 + i, 0));
+                s[i].calc(b, b1, b2, b3, c, c, c, c);
+                c.from_pix(img.pixel(x1 + i, 1));
+                s[n + i].calc(b, b1, b2, b3, c, s[i], s[i], s[i]);
+                c.from_pix(img.pixel(x1 + i, 2));
+                s[2*n + i].calc(b, b1, b2, b3, c, s[n + i], s[i], s[i]);
+            }
+
+            for(y = 3; y < h; ++y)
+            {
+                calculator_type* p = s + y * n;
+                for(i = 0; i < n; i++)
+                {
+                    c.from_pix(img.pixel(x1 + i, y));
+                    p[i].calc(b, b1, b2, b3, c, p[i - n], p[i - 2*n], p[i - 3*n]);
+                }
+            }
+
+            calculator_type* p0 = s + hm * n;
+            calculator_type* p1 = p0 - n;
+            calculator_type* p2 = p1 - n;
+            for(i = 0; i < n; i++)
+            {
+                c.calc(b, b1, b2, b3, p0[i], p0[i], p0[i], p0[i]);
+                p0[i] = c;
+                c.calc(b, b1, b2, b3, p1[i], p0[i], p0[i], p0[i]);
+                p1[i] = c;
+                c.calc(b, b1, b2, b3, p2[i], p1[i], p0[i], p0[i]);
+                p2[i] = c;
+            }
+            for(i = 0; i < n; i++) p0[i].to_pix(buf[i]);
+            img.copy_color_hspan(x1, hm, num, buf);
+            for(i = 0; i < n; i++) p1[i].to_pix(buf[i]);
+            img.copy_color_hspan(x1, hm - 1, num, buf);
+            for(i = 0; i < n; i++) p2[i].to_pix(buf[i]);
+            img.copy_color_hspan(x1, hm - 2, num, buf);
+
+            for(y = hm - 3; y >= 0; --y)
+            {
+                calculator_type* p = s + y * n;
+                for(i = 0; i < n; i++)
+                {
+                    c.calc(b, b1, b2, b3, p[i], p[i + n], p[i + 2*n], p[i + 3*n]);
+                    p[i] = c;
+                    c.to_pix(buf[i]);
+                }
+                img.copy_color_hspan(x1, y, num, buf);
+            }
+        }
+
+    private:
+        pod_vector<calculator_type> m_sum;
+    };
+
+
+    //==================================================recursive_blur_parallel
+    // The same as recursive_blur, using num_threads threads, 0 means one
+    // thread per processor.
+    template<class ColorT, class CalculatorT> class recursive_blur_parallel
+    {
+    public:
+        typedef ColorT color_type;
+        typedef CalculatorT calculator_type;
+        typedef recursive_blur<ColorT, CalculatorT>         blur_type;
+        typedef recursive_blur_columns<ColorT, CalculatorT> columns_type;
+
+        //--------------------------------------------------------------------
+        explicit recursive_blur_parallel(unsigned num_threads=0) :
+            m_num_threads(num_threads) {}
+
+        void     num_threads(unsigned n) { m_num_threads = n; }
+        unsigned num_threads() const     { return m_num_threads; }
+
+        //--------------------------------------------------------------------
+        template<class Img> void blur_x(Img& img, double radius)
+        {
+            blur_parallel<blur_type, columns_type>(img, radius, 0.0,
+                                                   columns_type::max_columns,
+                                                   m_num_threads);
+        }
+
+        //--------------------------------------------------------------------
+        template<class Img> void blur_y(Img& img, double radius)
+        {
+            blur_parallel<blur_type, columns_type>(img, 0.0, radius,
+                                                   columns_type::max_columns,
+                                                   m_num_threads);
+        }
+
+        //--------------------------------------------------------------------
+        template<class Img> void blur(Img& img, double radius)
+        {
+            blur_parallel<blur_type, columns_type>(img, radius, radius,
+                                                   columns_type::max_columns,
+                                                   m_num_threads);
+        }
+
+    private:
+        unsigned m_num_threads;
+    };
+
+}
+
+#endif
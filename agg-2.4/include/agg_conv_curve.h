@@ -22,6 +22,7 @@
 
 #include "agg_basics.h"
 #include "agg_curves.h"
+#include "agg_vertex_batch.h"
 
 namespace agg
 {
@@ -111,6 +112,12 @@ namespace agg
         void     rewind(unsigned path_id); 
         unsigned vertex(double* x, double* y);
 
+        // The batched interface, see agg_vertex_batch.h. The vertices of
+        // the curves are written to the block straight by the curve
+        // approximators. A curve command needs the next vertices of the
+        // source, so the source is still read with vertex().
+        unsigned vertices(double* xy, unsigned* cmds, unsigned max);
+
     private:
         conv_curve(const self_type&);
         const self_type& operator = (const self_type&);
@@ -194,6 +201,78 @@ namespace agg
     }
 
 
+    //------------------------------------------------------------------------
+    template<class VertexSource, class Curve3, class Curve4>
+    unsigned conv_curve<VertexSource, Curve3, Curve4>::vertices(double* xy, 
+                                                                unsigned* cmds, 
+                                                                unsigned max)
+    {
+        double ct2_x = 0;
+        double ct2_y = 0;
+        double end_x = 0;
+        double end_y = 0;
+
+        unsigned n = 0;
+        while(n < max)
+        {
+            // The rest of the current curve, if any
+            unsigned k = m_curve3.vertices(xy, max - n);
+            if(k == 0) k = m_curve4.vertices(xy, max - n);
+            if(k)
+            {
+                unsigned i;
+                for(i = 0; i < k; i++) cmds[n + i] = path_cmd_line_to;
+                xy += k * 2;
+                n  += k;
+                m_last_x = xy[-2];
+                m_last_y = xy[-1];
+                continue;
+            }
+
+            unsigned cmd = m_source->vertex(xy, xy + 1);
+            switch(cmd)
+            {
+            case path_cmd_stop:
+                return n;
+
+            case path_cmd_curve3:
+                m_source->vertex(&end_x, &end_y);
+                m_curve3.init(m_last_x, m_last_y, 
+                              xy[0],    xy[1], 
+                              end_x,    end_y);
+                m_curve3.vertex(xy, xy + 1);   // Skip path_cmd_move_to
+                break;
+
+            case path_cmd_curve4:
+                m_source->vertex(&ct2_x, &ct2_y);
+                m_source->vertex(&end_x, &end_y);
+                m_curve4.init(m_last_x, m_last_y, 
+                              xy[0],    xy[1], 
+                              ct2_x,    ct2_y, 
+                              end_x,    end_y);
+                m_curve4.vertex(xy, xy + 1);   // Skip path_cmd_move_to
+                break;
+
+            default:
+                m_last_x = xy[0];
+                m_last_y = xy[1];
+                cmds[n++] = cmd;
+                xy += 2;
+                break;
+            }
+        }
+        return n;
+    }
+
+    //------------------------------------------------------------------------
+    template<class VertexSource, class Curve3, class Curve4>
+    inline unsigned read_vertices(conv_curve<VertexSource, Curve3, Curve4>& vs,
+                                  double* xy, unsigned* cmds, unsigned max)
+    {
+        return vs.vertices(xy, cmds, max);
+    }
+
+
 }
 
 
@@ -0,0 +1,316 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// classes curve3_int, curve4_int, conv_curve_int
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_CONV_CURVE_INT_INCLUDED
+#define AGG_CONV_CURVE_INT_INCLUDED
+
+#include "agg_basics.h"
+
+namespace agg
+{
+
+    //------------------------------------------------------------curve_int_base
+    // Internal. The number of steps of a curve and the parameter in fixed
+    // point. The number of steps is calculated from the length of the
+    // control polygon the same way as in curve3_inc and curve4_inc, with
+    // the length approximated in integers.
+    class curve_int_base
+    {
+    public:
+        enum step_shift_e
+        {
+            step_shift = 16,
+            step_scale = 1 << step_shift,
+            max_steps  = 4096
+        };
+
+        curve_int_base() : m_scale(poly_subpixel_scale), m_num_steps(0), m_step(-1) {}
+
+        //--------------------------------------------------------------------
+        void approximation_scale(double s)
+        {
+            m_scale = uround(s * poly_subpixel_scale);
+            if(m_scale < 1) m_scale = 1;
+        }
+        double approximation_scale() const
+        {
+            return double(m_scale) / poly_subpixel_scale;
+        }
+
+        void rewind(unsigned) { m_step = 0; }
+        void reset() { m_num_steps = 0; m_step = -1; }
+
+    protected:
+        //--------------------------------------------------------------------
+        // Approximate distance, 0 to 12 percent longer than the real one
+        static int64 dist(int x1, int y1, int x2, int y2)
+        {
+            int64 dx = int64(x2) - x1;
+            int64 dy = int64(y2) - y1;
+            if(dx < 0) dx = -dx;
+            if(dy < 0) dy = -dy;
+            return (dx > dy) ? dx + (dy >> 1) : dy + (dx >> 1);
+        }
+
+        //--------------------------------------------------------------------
+        // len is in subpixels, the step is about 4 pixels at scale 1
+        void calc_steps(int64 len)
+        {
+            int64 n = (len * m_scale) >> (poly_subpixel_shift * 2 + 2);
+            if(n < 4) n = 4;
+            if(n > max_steps) n = max_steps;
+            m_num_steps = int(n);
+            m_step = 0;
+        }
+
+        //--------------------------------------------------------------------
+        static AGG_INLINE int lerp(int a, int b, int t)
+        {
+            return a + int(((int64(b) - a) * t) >> step_shift);
+        }
+
+        int m_scale;
+        int m_num_steps;
+        int m_step;
+    };
+
+
+    //================================================================curve3_int
+    class curve3_int : public curve_int_base
+    {
+    public:
+        curve3_int() {}
+        curve3_int(int x1, int y1, int x2, int y2, int x3, int y3)
+        {
+            init(x1, y1, x2, y2, x3, y3);
+        }
+
+        //--------------------------------------------------------------------
+        void init(int x1, int y1, int x2, int y2, int x3, int y3)
+        {
+            m_x1 = x1; m_y1 = y1;
+            m_x2 = x2; m_y2 = y2;
+            m_x3 = x3; m_y3 = y3;
+            calc_steps(dist(x1, y1, x2, y2) + dist(x2, y2, x3, y3));
+        }
+
+        //--------------------------------------------------------------------
+        unsigned vertex(int* x, int* y)
+        {
+            if(m_step < 0 || m_step > m_num_steps) return path_cmd_stop;
+            if(m_step == 0)
+            {
+                *x = m_x1;
+                *y = m_y1;
+                ++m_step;
+                return path_cmd_move_to;
+            }
+            if(m_step == m_num_steps)
+            {
+                *x = m_x3;
+                *y = m_y3;
+                ++m_step;
+                return path_cmd_line_to;
+            }
+            int t = int((int64(m_step) << step_shift) / m_num_steps);
+            *x = lerp(lerp(m_x1, m_x2, t), lerp(m_x2, m_x3, t), t);
+            *y = lerp(lerp(m_y1, m_y2, t), lerp(m_y2, m_y3, t), t);
+            ++m_step;
+            return path_cmd_line_to;
+        }
+
+    private:
+        int m_x1, m_y1;
+        int m_x2, m_y2;
+        int m_x3, m_y3;
+    };
+
+
+    //================================================================curve4_int
+    class curve4_int : public curve_int_base
+    {
+    public:
+        curve4_int() {}
+        curve4_int(int x1, int y1, int x2, int y2,
+                   int x3, int y3, int x4, int y4)
+        {
+            init(x1, y1, x2, y2, x3, y3, x4, y4);
+        }
+
+        //--------------------------------------------------------------------
+        void init(int x1, int y1, int x2, int y2,
+                  int x3, int y3, int x4, int y4)
+        {
+            m_x1 = x1; m_y1 = y1;
+            m_x2 = x2; m_y2 = y2;
+            m_x3 = x3; m_y3 = y3;
+            m_x4 = x4; m_y4 = y4;
+            calc_steps(dist(x1, y1, x2, y2) +
+                       dist(x2, y2, x3, y3) +
+                       dist(x3, y3, x4, y4));
+        }
+
+        //--------------------------------------------------------------------
+        unsigned vertex(int* x, int* y)
+        {
+            if(m_step < 0 || m_step > m_num_steps) return path_cmd_stop;
+            if(m_step == 0)
+            {
+                *x = m_x1;
+                *y = m_y1;
+                ++m_step;
+                return path_cmd_move_to;
+            }
+            if(m_step == m_num_steps)
+            {
+                *x = m_x4;
+                *y = m_y4;
+                ++m_step;
+                return path_cmd_line_to;
+            }
+
+            // de Casteljau, it doesn't accumulate the error
+            // like the forward differences do
+            int t = int((int64(m_step) << step_shift) / m_num_steps);
+            int x12  = lerp(m_x1, m_x2, t);
+            int y12  = lerp(m_y1, m_y2, t);
+            int x23  = lerp(m_x2, m_x3, t);
+            int y23  = lerp(m_y2, m_y3, t);
+            int x34  = lerp(m_x3, m_x4, t);
+            int y34  = lerp(m_y3, m_y4, t);
+            int x123 = lerp(x12, x23, t);
+            int y123 = lerp(y12, y23, t);
+            int x234 = lerp(x23, x34, t);
+            int y234 = lerp(y23, y34, t);
+            *x = lerp(x123, x234, t);
+            *y = lerp(y123, y234, t);
+            ++m_step;
+            return path_cmd_line_to;
+        }
+
+    private:
+        int m_x1, m_y1;
+        int m_x2, m_y2;
+        int m_x3, m_y3;
+        int m_x4, m_y4;
+    };
+
+
+    //============================================================conv_curve_int
+    // conv_curve for the integer vertex sources
+    //------------------------------------------------------------------------
+    template<class VertexSource> class conv_curve_int
+    {
+    public:
+        typedef conv_curve_int<VertexSource> self_type;
+
+        explicit conv_curve_int(VertexSource& source) :
+            m_source(&source), m_last_x(0), m_last_y(0) {}
+        void attach(VertexSource& source) { m_source = &source; }
+
+        void approximation_scale(double s)
+        {
+            m_curve3.approximation_scale(s);
+            m_curve4.approximation_scale(s);
+        }
+
+        double approximation_scale() const
+        {
+            return m_curve4.approximation_scale();
+        }
+
+        //--------------------------------------------------------------------
+        void rewind(unsigned path_id)
+        {
+            m_source->rewind(path_id);
+            m_last_x = 0;
+            m_last_y = 0;
+            m_curve3.reset();
+            m_curve4.reset();
+        }
+
+        //--------------------------------------------------------------------
+        unsigned vertex(int* x, int* y)
+        {
+            if(!is_stop(m_curve3.vertex(x, y)))
+            {
+                m_last_x = *x;
+                m_last_y = *y;
+                return path_cmd_line_to;
+            }
+
+            if(!is_stop(m_curve4.vertex(x, y)))
+            {
+                m_last_x = *x;
+                m_last_y = *y;
+                return path_cmd_line_to;
+            }
+
+            int ct2_x = 0;
+            int ct2_y = 0;
+            int end_x = 0;
+            int end_y = 0;
+
+            unsigned cmd = m_source->vertex(x, y);
+            switch(cmd)
+            {
+            case path_cmd_curve3:
+                m_source->vertex(&end_x, &end_y);
+
+                m_curve3.init(m_last_x, m_last_y,
+                              *x,       *y,
+                              end_x,     end_y);
+
+                m_curve3.vertex(x, y);    // First call returns path_cmd_move_to
+                m_curve3.vertex(x, y);    // This is the first vertex of the curve
+                cmd = path_cmd_line_to;
+                break;
+
+            case path_cmd_curve4:
+                m_source->vertex(&ct2_x, &ct2_y);
+                m_source->vertex(&end_x, &end_y);
+
+                m_curve4.init(m_last_x, m_last_y,
+                              *x,       *y,
+                              ct2_x,    ct2_y,
+                              end_x,    end_y);
+
+                m_curve4.vertex(x, y);    // First call returns path_cmd_move_to
+                m_curve4.vertex(x, y);    // This is the first vertex of the curve
+                cmd = path_cmd_line_to;
+                break;
+            }
+            m_last_x = *x;
+            m_last_y = *y;
+            return cmd;
+        }
+
+    private:
+        conv_curve_int(const self_type&);
+        const self_type& operator = (const self_type&);
+
+        VertexSource* m_source;
+        int           m_last_x;
+        int           m_last_y;
+        curve3_int    m_curve3;
+        curve4_int    m_curve4;
+    };
+
+}
+
+#endif
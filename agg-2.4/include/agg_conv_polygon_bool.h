@@ -0,0 +1,82 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Boolean operations on two vertex sources: Union, Intersection, XOR,
+// A-B, B-A. The same interface as conv_gpc, without the GPC library:
+//
+//   agg::conv_polygon_bool<VSA, VSB> pb(a, b, agg::polygon_bool_and);
+//   ras.add_path(pb);
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_CONV_POLYGON_BOOL_INCLUDED
+#define AGG_CONV_POLYGON_BOOL_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_polygon_bool.h"
+
+namespace agg
+{
+
+    //=======================================================conv_polygon_bool
+    template<class VSA, class VSB> class conv_polygon_bool
+    {
+    public:
+        typedef VSA source_a_type;
+        typedef VSB source_b_type;
+        typedef conv_polygon_bool<source_a_type, source_b_type> self_type;
+
+        conv_polygon_bool(source_a_type& a, source_b_type& b,
+                          polygon_bool_op_e op = polygon_bool_or) :
+            m_src_a(&a),
+            m_src_b(&b),
+            m_operation(op)
+        {
+        }
+
+        void attach1(VSA& source) { m_src_a = &source; }
+        void attach2(VSB& source) { m_src_b = &source; }
+
+        void operation(polygon_bool_op_e v) { m_operation = v; }
+        polygon_bool_op_e operation() const { return m_operation; }
+
+        // Vertex Source Interface
+        void rewind(unsigned path_id)
+        {
+            m_bool.remove_all();
+            m_bool.add_path(0, *m_src_a, path_id);
+            m_bool.add_path(1, *m_src_b, path_id);
+            m_bool.execute(m_operation);
+            m_bool.rewind(0);
+        }
+
+        unsigned vertex(double* x, double* y)
+        {
+            return m_bool.vertex(x, y);
+        }
+
+    private:
+        conv_polygon_bool(const self_type&);
+        const self_type& operator = (const self_type&);
+
+        source_a_type*    m_src_a;
+        source_b_type*    m_src_b;
+        polygon_bool_op_e m_operation;
+        polygon_bool      m_bool;
+    };
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// conv_stroke_int
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_CONV_STROKE_INT_INCLUDED
+#define AGG_CONV_STROKE_INT_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_conv_stroke.h"
+
+namespace agg
+{
+
+    //--------------------------------------------------------conv_int_to_dbl
+    // Internal. Gives the integer vertices as double, in subpixels.
+    template<class VertexSource> class conv_int_to_dbl
+    {
+    public:
+        explicit conv_int_to_dbl(VertexSource& source) : m_source(&source) {}
+        void attach(VertexSource& source) { m_source = &source; }
+
+        void rewind(unsigned path_id) { m_source->rewind(path_id); }
+
+        unsigned vertex(double* x, double* y)
+        {
+            int ix;
+            int iy;
+            unsigned cmd = m_source->vertex(&ix, &iy);
+            *x = ix;
+            *y = iy;
+            return cmd;
+        }
+
+    private:
+        VertexSource* m_source;
+    };
+
+
+    //=========================================================conv_stroke_int
+    // conv_stroke for the integer vertex sources. The joins and the caps
+    // need the square roots and the trigonometry, so vcgen_stroke does
+    // the geometry in double, in subpixels, and the result is rounded
+    // back to 24.8. The widths are in pixels, as in conv_stroke.
+    //------------------------------------------------------------------------
+    template<class VertexSource> class conv_stroke_int
+    {
+    public:
+        typedef conv_int_to_dbl<VertexSource>  source_type;
+        typedef conv_stroke<source_type>       stroke_type;
+
+        explicit conv_stroke_int(VertexSource& vs) :
+            m_source(vs),
+            m_stroke(m_source)
+        {
+            width(1.0);
+            approximation_scale(1.0);
+        }
+        void attach(VertexSource& vs) { m_source.attach(vs); }
+
+        void line_cap(line_cap_e lc)     { m_stroke.line_cap(lc);  }
+        void line_join(line_join_e lj)   { m_stroke.line_join(lj); }
+        void inner_join(inner_join_e ij) { m_stroke.inner_join(ij); }
+
+        line_cap_e   line_cap()   const { return m_stroke.line_cap();  }
+        line_join_e  line_join()  const { return m_stroke.line_join(); }
+        inner_join_e inner_join() const { return m_stroke.inner_join(); }
+
+        void width(double w) { m_stroke.width(w * poly_subpixel_scale); }
+        void miter_limit(double ml) { m_stroke.miter_limit(ml); }
+        void miter_limit_theta(double t) { m_stroke.miter_limit_theta(t); }
+        void inner_miter_limit(double ml) { m_stroke.inner_miter_limit(ml); }
+        void approximation_scale(double as) { m_stroke.approximation_scale(as / poly_subpixel_scale); }
+
+        double width() const { return m_stroke.width() / poly_subpixel_scale; }
+        double miter_limit() const { return m_stroke.miter_limit(); }
+        double inner_miter_limit() const { return m_stroke.inner_miter_limit(); }
+        double approximation_scale() const { return m_stroke.approximation_scale() * poly_subpixel_scale; }
+
+        void shorten(double s) { m_stroke.shorten(s * poly_subpixel_scale); }
+        double shorten() const { return m_stroke.shorten() / poly_subpixel_scale; }
+
+        //--------------------------------------------------------------------
+        void rewind(unsigned path_id) { m_stroke.rewind(path_id); }
+
+        unsigned vertex(int* x, int* y)
+        {
+            double dx;
+            double dy;
+            unsigned cmd = m_stroke.vertex(&dx, &dy);
+            *x = iround(dx);
+            *y = iround(dy);
+            return cmd;
+        }
+
+    private:
+        conv_stroke_int(const conv_stroke_int<VertexSource>&);
+        const conv_stroke_int<VertexSource>&
+            operator = (const conv_stroke_int<VertexSource>&);
+
+        source_type m_source;
+        stroke_type m_stroke;
+    };
+
+}
+
+#endif
@@ -21,6 +21,7 @@
 
 #include "agg_basics.h"
 #include "agg_trans_affine.h"
+#include "agg_vertex_batch.h"
 
 namespace agg
 {
@@ -48,6 +49,28 @@ namespace agg
             return cmd;
         }
 
+        // The batched interface, see agg_vertex_batch.h
+        unsigned vertices(double* xy, unsigned* cmds, unsigned max)
+        {
+            unsigned n = read_vertices(*m_source, xy, cmds, max);
+            unsigned i = 0;
+            while(i < n)
+            {
+                if(is_vertex(cmds[i]))
+                {
+                    unsigned j = i + 1;
+                    while(j < n && is_vertex(cmds[j])) ++j;
+                    transform_points(*m_trans, xy + i * 2, j - i);
+                    i = j;
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+            return n;
+        }
+
         void transformer(Transformer& tr)
         {
             m_trans = &tr;
@@ -62,6 +85,13 @@ namespace agg
         Transformer* m_trans;
     };
 
+    //------------------------------------------------------------------------
+    template<class VertexSource, class Transformer>
+    inline unsigned read_vertices(conv_transform<VertexSource, Transformer>& vs,
+                                  double* xy, unsigned* cmds, unsigned max)
+    {
+        return vs.vertices(xy, cmds, max);
+    }
 
 }
 
@@ -0,0 +1,70 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// class conv_transform_int
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_CONV_TRANSFORM_INT_INCLUDED
+#define AGG_CONV_TRANSFORM_INT_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_trans_affine_int.h"
+
+namespace agg
+{
+
+    //------------------------------------------------------conv_transform_int
+    // conv_transform for the integer vertex sources
+    //------------------------------------------------------------------------
+    template<class VertexSource, class Transformer=trans_affine_int>
+    class conv_transform_int
+    {
+    public:
+        conv_transform_int(VertexSource& source, const Transformer& tr) :
+            m_source(&source), m_trans(&tr) {}
+        void attach(VertexSource& source) { m_source = &source; }
+
+        void rewind(unsigned path_id)
+        {
+            m_source->rewind(path_id);
+        }
+
+        unsigned vertex(int* x, int* y)
+        {
+            unsigned cmd = m_source->vertex(x, y);
+            if(is_vertex(cmd))
+            {
+                m_trans->transform(x, y);
+            }
+            return cmd;
+        }
+
+        void transformer(const Transformer& tr)
+        {
+            m_trans = &tr;
+        }
+
+    private:
+        conv_transform_int(const conv_transform_int<VertexSource, Transformer>&);
+        const conv_transform_int<VertexSource, Transformer>&
+            operator = (const conv_transform_int<VertexSource, Transformer>&);
+
+        VertexSource*      m_source;
+        const Transformer* m_trans;
+    };
+
+}
+
+#endif
@@ -65,6 +65,7 @@ namespace agg
 
         void     rewind(unsigned path_id);
         unsigned vertex(double* x, double* y);
+        unsigned vertices(double* xy, unsigned max);
 
     private:
         int      m_num_steps;
@@ -141,6 +142,20 @@ namespace agg
             return (m_count == 1) ? path_cmd_move_to : path_cmd_line_to;
         }
 
+        unsigned vertices(double* xy, unsigned max)
+        {
+            unsigned n = m_points.size() - m_count;
+            if(n > max) n = max;
+            unsigned i;
+            for(i = 0; i < n; i++)
+            {
+                const point_d& p = m_points[m_count++];
+                *xy++ = p.x;
+                *xy++ = p.y;
+            }
+            return n;
+        }
+
     private:
         void bezier(double x1, double y1, 
                     double x2, double y2, 
@@ -237,6 +252,7 @@ namespace agg
 
         void     rewind(unsigned path_id);
         unsigned vertex(double* x, double* y);
+        unsigned vertices(double* xy, unsigned max);
 
     private:
         int      m_num_steps;
@@ -449,6 +465,20 @@ namespace agg
             return (m_count == 1) ? path_cmd_move_to : path_cmd_line_to;
         }
 
+        unsigned vertices(double* xy, unsigned max)
+        {
+            unsigned n = m_points.size() - m_count;
+            if(n > max) n = max;
+            unsigned i;
+            for(i = 0; i < n; i++)
+            {
+                const point_d& p = m_points[m_count++];
+                *xy++ = p.x;
+                *xy++ = p.y;
+            }
+            return n;
+        }
+
     private:
         void bezier(double x1, double y1, 
                     double x2, double y2, 
@@ -565,6 +595,17 @@ namespace agg
             return m_curve_div.vertex(x, y);
         }
 
+        // Up to max of the next vertices as x,y pairs, all of them are
+        // line_to. The first vertex (move_to) must be read with vertex().
+        unsigned vertices(double* xy, unsigned max)
+        {
+            if(m_approximation_method == curve_inc) 
+            {
+                return m_curve_inc.vertices(xy, max);
+            }
+            return m_curve_div.vertices(xy, max);
+        }
+
     private:
         curve3_inc m_curve_inc;
         curve3_div m_curve_div;
@@ -679,6 +720,17 @@ namespace agg
             return m_curve_div.vertex(x, y);
         }
 
+        // Up to max of the next vertices as x,y pairs, all of them are
+        // line_to. The first vertex (move_to) must be read with vertex().
+        unsigned vertices(double* xy, unsigned max)
+        {
+            if(m_approximation_method == curve_inc) 
+            {
+                return m_curve_inc.vertices(xy, max);
+            }
+            return m_curve_div.vertices(xy, max);
+        }
+
     private:
         curve4_inc m_curve_inc;
         curve4_div m_curve_div;
@@ -0,0 +1,289 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Dirty rectangles for the interactive redrawing. Instead of clearing
+// and rendering the whole scene on every change, the areas that change
+// are collected and only they are redrawn:
+//
+//   agg::dirty_rects dirty;
+//   dirty.bounds(0, 0, rbuf.width() - 1, rbuf.height() - 1);
+//   . . .
+//   // A shape moves: both the old and the new places are dirty
+//   dirty.add_path(shape);
+//   shape.move(dx, dy);
+//   dirty.add_path(shape);
+//   . . .
+//   agg::render_dirty_rects(dirty, ras, ren_base, background, scene);
+//   dirty.clear();
+//
+// render_dirty_rects() clips the renderer to every rectangle in turn,
+// fills it with the background and calls
+//
+//   scene.draw(ras, ren_base, rect);
+//
+// which renders the objects that overlap rect (the others are clipped
+// out anyway, but skipping them saves their rasterization). The 
+// rasterizer is restricted to the rows of the rectangle with band() 
+// rather than clipped, because clipping the geometry changes the 
+// rounding of the cells. So the result is exactly the same as when 
+// the whole scene is redrawn.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_DIRTY_RECTS_INCLUDED
+#define AGG_DIRTY_RECTS_INCLUDED
+
+#include <math.h>
+#include "agg_basics.h"
+#include "agg_array.h"
+#include "agg_bounding_rect.h"
+
+namespace agg
+{
+
+    //=============================================================dirty_rects
+    // The set of the rectangles to redraw, in pixels, inclusive. The
+    // overlapping and the touching rectangles are merged. When there are
+    // more than max_rects of them, the pair that gives the least extra
+    // area is merged, so with max_rects = 1 it's just the union.
+    //------------------------------------------------------------------------
+    class dirty_rects
+    {
+    public:
+        enum default_max_rects_e
+        {
+            default_max_rects = 16
+        };
+
+        //--------------------------------------------------------------------
+        explicit dirty_rects(unsigned max_rects = default_max_rects) :
+            m_max_rects(max_rects ? max_rects : 1),
+            m_bounds(-0x3FFFFFFF, -0x3FFFFFFF, 0x3FFFFFFF, 0x3FFFFFFF)
+        {
+        }
+
+        //--------------------------------------------------------------------
+        // The rectangles are clipped to the bounds, normally the whole
+        // rendering buffer.
+        void bounds(int x1, int y1, int x2, int y2)
+        {
+            m_bounds = rect_i(x1, y1, x2, y2);
+            m_bounds.normalize();
+        }
+        const rect_i& bounds() const { return m_bounds; }
+
+        //--------------------------------------------------------------------
+        void max_rects(unsigned n) { m_max_rects = n ? n : 1; reduce(); }
+        unsigned max_rects() const { return m_max_rects; }
+
+        //--------------------------------------------------------------------
+        void clear() { m_rects.remove_all(); }
+
+        //--------------------------------------------------------------------
+        // Marks the whole bounds dirty
+        void invalidate()
+        {
+            m_rects.remove_all();
+            m_rects.add(m_bounds);
+        }
+
+        //--------------------------------------------------------------------
+        void add(rect_i r)
+        {
+            r.normalize();
+            if(!r.clip(m_bounds)) return;
+
+            // Merging can make the rectangle overlap the ones checked
+            // before, so it's repeated until nothing merges.
+            unsigned i = 0;
+            while(i < m_rects.size())
+            {
+                if(touches(m_rects[i], r))
+                {
+                    r = unite_rectangles(r, m_rects[i]);
+                    m_rects[i] = m_rects[m_rects.size() - 1];
+                    m_rects.remove_last();
+                    i = 0;
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+            m_rects.add(r);
+            reduce();
+        }
+
+        //--------------------------------------------------------------------
+        void add(int x1, int y1, int x2, int y2)
+        {
+            add(rect_i(x1, y1, x2, y2));
+        }
+
+        //--------------------------------------------------------------------
+        // A rectangle in subpixel accurate coordinates, such as a bounding
+        // box of a path, extended by margin. All the pixels it touches are
+        // dirty, which includes the anti-aliased edges.
+        void add(const rect_d& r, double margin = 0.0)
+        {
+            double x1 = r.x1 < r.x2 ? r.x1 : r.x2;
+            double y1 = r.y1 < r.y2 ? r.y1 : r.y2;
+            double x2 = r.x1 < r.x2 ? r.x2 : r.x1;
+            double y2 = r.y1 < r.y2 ? r.y2 : r.y1;
+            add(rect_i(int(floor(x1 - margin)), int(floor(y1 - margin)),
+                       int(floor(x2 + margin)), int(floor(y2 + margin))));
+        }
+
+        //--------------------------------------------------------------------
+        // The bounding rectangle of the path, extended by margin, which
+        // should be at least a half of the stroke width for the strokes.
+        // Returns false if the path is empty.
+        template<class VertexSource>
+        bool add_path(VertexSource& vs, unsigned path_id = 0, double margin = 0.0)
+        {
+            rect_d r;
+            if(!bounding_rect_single(vs, path_id, &r.x1, &r.y1, &r.x2, &r.y2))
+            {
+                return false;
+            }
+            add(r, margin);
+            return true;
+        }
+
+        //--------------------------------------------------------------------
+        unsigned size() const { return m_rects.size(); }
+        bool     empty() const { return m_rects.size() == 0; }
+        const rect_i& operator [] (unsigned i) const { return m_rects[i]; }
+
+        //--------------------------------------------------------------------
+        // The number of the dirty pixels
+        unsigned area() const
+        {
+            unsigned a = 0;
+            unsigned i;
+            for(i = 0; i < m_rects.size(); i++) a += area(m_rects[i]);
+            return a;
+        }
+
+        //--------------------------------------------------------------------
+        // The union, invalid if there are no rectangles
+        rect_i union_rect() const
+        {
+            rect_i r(1, 1, 0, 0);
+            unsigned i;
+            for(i = 0; i < m_rects.size(); i++)
+            {
+                r = i ? unite_rectangles(r, m_rects[i]) : m_rects[i];
+            }
+            return r;
+        }
+
+        //--------------------------------------------------------------------
+        // Whether anything in the box needs redrawing, for culling the
+        // objects that don't.
+        bool overlaps(const rect_d& r) const
+        {
+            rect_i ri(int(floor(r.x1)), int(floor(r.y1)),
+                      int(floor(r.x2)), int(floor(r.y2)));
+            ri.normalize();
+            unsigned i;
+            for(i = 0; i < m_rects.size(); i++)
+            {
+                if(m_rects[i].overlaps(ri)) return true;
+            }
+            return false;
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        static unsigned area(const rect_i& r)
+        {
+            return unsigned(r.x2 - r.x1 + 1) * unsigned(r.y2 - r.y1 + 1);
+        }
+
+        //--------------------------------------------------------------------
+        // Overlapping or adjacent
+        static bool touches(const rect_i& a, const rect_i& b)
+        {
+            return !(b.x1 > a.x2 + 1 || b.x2 + 1 < a.x1 ||
+                     b.y1 > a.y2 + 1 || b.y2 + 1 < a.y1);
+        }
+
+        //--------------------------------------------------------------------
+        void reduce()
+        {
+            while(m_rects.size() > m_max_rects)
+            {
+                unsigned best_i = 0;
+                unsigned best_j = 1;
+                double best = -1.0;
+                unsigned i, j;
+                for(i = 0; i < m_rects.size(); i++)
+                {
+                    for(j = i + 1; j < m_rects.size(); j++)
+                    {
+                        double extra =
+                            double(area(unite_rectangles(m_rects[i], m_rects[j]))) -
+                            double(area(m_rects[i])) - double(area(m_rects[j]));
+                        if(best < 0.0 || extra < best)
+                        {
+                            best   = extra;
+                            best_i = i;
+                            best_j = j;
+                        }
+                    }
+                }
+                rect_i r = unite_rectangles(m_rects[best_i], m_rects[best_j]);
+                m_rects[best_j] = m_rects[m_rects.size() - 1];
+                m_rects.remove_last();
+                m_rects[best_i] = m_rects[m_rects.size() - 1];
+                m_rects.remove_last();
+                add(r);
+            }
+        }
+
+        unsigned               m_max_rects;
+        rect_i                 m_bounds;
+        pod_bvector<rect_i, 4> m_rects;
+    };
+
+
+
+    //======================================================render_dirty_rects
+    template<class Rasterizer, class BaseRenderer, class Scene>
+    void render_dirty_rects(const dirty_rects& dirty,
+                            Rasterizer& ras, BaseRenderer& ren,
+                            const typename BaseRenderer::color_type& background,
+                            Scene& scene)
+    {
+        rect_i clip = ren.clip_box();
+        unsigned i;
+        for(i = 0; i < dirty.size(); i++)
+        {
+            const rect_i& r = dirty[i];
+            if(ren.clip_box(r.x1, r.y1, r.x2, r.y2))
+            {
+                rect_i cb = ren.clip_box();
+                ras.band(cb.y1, cb.y2);
+                ren.copy_bar(cb.x1, cb.y1, cb.x2, cb.y2, background);
+                scene.draw(ras, ren, cb);
+            }
+            ren.clip_box(clip.x1, clip.y1, clip.x2, clip.y2);
+        }
+        ras.reset_band();
+    }
+
+}
+
+#endif
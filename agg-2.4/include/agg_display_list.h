@@ -0,0 +1,375 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+#ifndef AGG_DISPLAY_LIST_INCLUDED
+#define AGG_DISPLAY_LIST_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_array.h"
+#include "agg_scanline_p.h"
+#include "agg_scanline_storage_aa.h"
+#include "agg_renderer_scanline.h"
+#include "agg_span_allocator.h"
+#include "agg_pixfmt_rgba.h"
+#include "agg_threads.h"
+
+namespace agg
+{
+
+    //-----------------------------------------------------display_list_comp_op
+    // Sets the compositing operation of a pixel format before an item of
+    // the display list is rendered. It does nothing for the pixel formats
+    // with a fixed blender. Overload it for other pixel formats that
+    // support compositing operations.
+    template<class PixFmt>
+    inline void display_list_comp_op(PixFmt&, unsigned) {}
+
+    template<class Blender, class RenBuf>
+    inline void display_list_comp_op(pixfmt_custom_blend_rgba<Blender, RenBuf>& pixf,
+                                     unsigned op)
+    {
+        pixf.comp_op(op);
+    }
+
+
+    //============================================================display_list
+    // Records the rasterized paths of a scene, that is, their coverage
+    // along with the style and the compositing operation of each path,
+    // so that the scene can be rendered many times without flattening,
+    // stroking and sorting the cells again. It's useful for static layers
+    // that are drawn under the changing content.
+    //
+    // All the coverage is kept in one scanline_storage_aa; an item refers
+    // to a range of its scanlines. The styles are resolved at the time of
+    // rendering with the same style handler as render_scanlines_compound()
+    // uses:
+    //
+    // class style_handler
+    // {
+    // public:
+    //     bool is_solid(unsigned style) const;
+    //     color_type color(unsigned style) const;
+    //     void generate_span(color_type* span, int x, int y,
+    //                        unsigned len, unsigned style);
+    // };
+    //
+    // Rendering doesn't change the display list. So, a recorded list can
+    // be rendered from several threads simultaneously, into different
+    // buffers or into different parts of the same buffer, provided that
+    // the style handler can be called concurrently. render_parallel()
+    // does exactly that, dividing the clip box into bands.
+    //------------------------------------------------------------------------
+    template<class Scanline=scanline_p8> class display_list
+    {
+    public:
+        typedef Scanline scanline_type;
+        typedef typename scanline_type::cover_type cover_type;
+        typedef scanline_storage_aa<cover_type> storage_type;
+        typedef display_list<Scanline> self_type;
+
+        //--------------------------------------------------------------------
+        struct item
+        {
+            unsigned start_scanline;
+            unsigned num_scanlines;
+            unsigned style;
+            unsigned comp_op;
+            rect_i   bounds;
+        };
+
+        //--------------------------------------------------------------------
+        display_list() :
+            m_band_height(32),
+            m_bounds(1, 1, 0, 0),
+            m_num_scanlines(0)
+        {}
+
+        //--------------------------------------------------------------------
+        void remove_all()
+        {
+            m_storage.prepare();
+            m_items.remove_all();
+            m_bounds = rect_i(1, 1, 0, 0);
+            m_num_scanlines = 0;
+        }
+
+        //--------------------------------------------------------------------
+        // Sweeps the rasterizer and adds the result as a new item. Empty
+        // paths are not added. Returns true if the item was added.
+        template<class Rasterizer>
+        bool add(Rasterizer& ras, unsigned style,
+                 unsigned comp_op = comp_op_src_over)
+        {
+            item it;
+            it.start_scanline = m_num_scanlines;
+            it.num_scanlines  = 0;
+            it.style          = style;
+            it.comp_op        = comp_op;
+            it.bounds         = rect_i(1, 1, 0, 0);
+
+            recorder rec(*this, it);
+            render_scanlines(ras, m_sl, rec);
+            if(it.num_scanlines == 0) return false;
+
+            m_items.add(it);
+            if(m_items.size() == 1)
+            {
+                m_bounds = it.bounds;
+            }
+            else
+            {
+                if(it.bounds.x1 < m_bounds.x1) m_bounds.x1 = it.bounds.x1;
+                if(it.bounds.y1 < m_bounds.y1) m_bounds.y1 = it.bounds.y1;
+                if(it.bounds.x2 > m_bounds.x2) m_bounds.x2 = it.bounds.x2;
+                if(it.bounds.y2 > m_bounds.y2) m_bounds.y2 = it.bounds.y2;
+            }
+            return true;
+        }
+
+        //--------------------------------------------------------------------
+        unsigned    num_items()          const { return m_items.size(); }
+        const item& item_at(unsigned i)  const { return m_items[i]; }
+        const rect_i& bounds()           const { return m_bounds; }
+        const storage_type& storage()    const { return m_storage; }
+
+        //--------------------------------------------------------------------
+        void band_height(unsigned h) { m_band_height = h ? h : 1; }
+        unsigned band_height() const { return m_band_height; }
+
+        //--------------------------------------------------------------------
+        // Renders all the items shifted by (dx, dy). Only the scanlines
+        // within the clip box of the renderer are processed. The renderer
+        // must be renderer_base; its pixel format is copied to set the
+        // compositing operations, so the original one stays unchanged.
+        template<class BaseRenderer, class StyleHandler>
+        void render(BaseRenderer& ren, StyleHandler& sh,
+                    int dx=0, int dy=0) const
+        {
+            render_clipped(ren, sh, dx, dy,
+                           ren.xmin(), ren.ymin(), ren.xmax(), ren.ymax());
+        }
+
+        //--------------------------------------------------------------------
+        // The same as render(), but the clip box is divided into horizontal
+        // bands of band_height() pixels that are rendered by num_threads
+        // threads, 0 means one thread per processor. The bands are
+        // interleaved between the threads to balance the load.
+        template<class BaseRenderer, class StyleHandler>
+        void render_parallel(BaseRenderer& ren, StyleHandler& sh,
+                             unsigned num_threads=0,
+                             int dx=0, int dy=0) const
+        {
+            int h = ren.ymax() - ren.ymin() + 1;
+            if(h <= 0 || m_items.size() == 0) return;
+            unsigned nb = (unsigned(h) + m_band_height - 1) / m_band_height;
+            if(num_threads == 0) num_threads = num_cpus();
+            if(num_threads > nb) num_threads = nb;
+
+            band_task<BaseRenderer, StyleHandler> task;
+            task.dl  = this;
+            task.ren = &ren;
+            task.sh  = &sh;
+            task.dx  = dx;
+            task.dy  = dy;
+            task.num_bands = nb;
+            run_parallel(task, num_threads);
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        // Renderer interface for render_scanlines(). The scanlines are
+        // appended to the storage without prepare().
+        class recorder
+        {
+        public:
+            recorder(self_type& dl, item& it) : m_dl(&dl), m_item(&it) {}
+
+            void prepare() {}
+
+            template<class SL> void render(const SL& sl)
+            {
+                typename SL::const_iterator span = sl.begin();
+                unsigned num_spans = sl.num_spans();
+                int x1 = span->x;
+                int x2 = x1;
+                for(;;)
+                {
+                    int len = span->len;
+                    if(len < 0) len = -len;
+                    if(span->x < x1) x1 = span->x;
+                    if(span->x + len - 1 > x2) x2 = span->x + len - 1;
+                    if(--num_spans == 0) break;
+                    ++span;
+                }
+
+                rect_i& b = m_item->bounds;
+                if(m_item->num_scanlines == 0)
+                {
+                    b = rect_i(x1, sl.y(), x2, sl.y());
+                }
+                else
+                {
+                    if(x1 < b.x1) b.x1 = x1;
+                    if(x2 > b.x2) b.x2 = x2;
+                    b.y2 = sl.y();
+                }
+                m_dl->m_storage.render(sl);
+                ++m_item->num_scanlines;
+                ++m_dl->m_num_scanlines;
+            }
+
+        private:
+            self_type* m_dl;
+            item*      m_item;
+        };
+
+        //--------------------------------------------------------------------
+        template<class StyleHandler, class ColorT> struct style_span_gen
+        {
+            StyleHandler* sh;
+            unsigned      style;
+
+            void prepare() {}
+            void generate(ColorT* span, int x, int y, unsigned len)
+            {
+                sh->generate_span(span, x, y, len, style);
+            }
+        };
+
+        //--------------------------------------------------------------------
+        template<class BaseRenderer, class StyleHandler> struct band_task
+        {
+            const self_type* dl;
+            BaseRenderer*    ren;
+            StyleHandler*    sh;
+            int              dx;
+            int              dy;
+            unsigned         num_bands;
+
+            void run(unsigned idx, unsigned num)
+            {
+                unsigned i;
+                for(i = idx; i < num_bands; i += num)
+                {
+                    int y1 = ren->ymin() + int(i * dl->m_band_height);
+                    int y2 = y1 + int(dl->m_band_height) - 1;
+                    if(y2 > ren->ymax()) y2 = ren->ymax();
+                    dl->render_clipped(*ren, *sh, dx, dy,
+                                       ren->xmin(), y1, ren->xmax(), y2);
+                }
+            }
+        };
+
+        //--------------------------------------------------------------------
+        // Returns the index of the first scanline of the item with y >= y1.
+        // The scanlines of an item go in ascending order of y.
+        unsigned first_scanline(const item& it, int y1) const
+        {
+            unsigned lo = it.start_scanline;
+            unsigned hi = it.start_scanline + it.num_scanlines;
+            while(lo < hi)
+            {
+                unsigned mid = (lo + hi) >> 1;
+                if(m_storage.scanline_by_index(mid).y < y1) lo = mid + 1;
+                else                                        hi = mid;
+            }
+            return lo;
+        }
+
+        //--------------------------------------------------------------------
+        template<class BaseRenderer, class StyleHandler>
+        void render_clipped(BaseRenderer& ren, StyleHandler& sh,
+                            int dx, int dy,
+                            int x1, int y1, int x2, int y2) const
+        {
+            typedef typename BaseRenderer::pixfmt_type pixfmt_type;
+            typedef typename BaseRenderer::color_type  color_type;
+            typedef typename storage_type::scanline_data scanline_data;
+            typedef typename storage_type::span_data     span_data;
+
+            if(m_items.size() == 0) return;
+            if(m_bounds.x1 + dx > x2 || m_bounds.x2 + dx < x1 ||
+               m_bounds.y1 + dy > y2 || m_bounds.y2 + dy < y1) return;
+
+            pixfmt_type pixf(ren.ren());
+            BaseRenderer rb(pixf);
+            rb.clip_box_naked(x1, y1, x2, y2);
+
+            scanline_type sl;
+            span_allocator<color_type> alloc;
+            style_span_gen<StyleHandler, color_type> span_gen;
+            span_gen.sh = &sh;
+
+            unsigned i;
+            for(i = 0; i < m_items.size(); i++)
+            {
+                const item& it = m_items[i];
+                if(it.bounds.x1 + dx > x2 || it.bounds.x2 + dx < x1 ||
+                   it.bounds.y1 + dy > y2 || it.bounds.y2 + dy < y1) continue;
+
+                display_list_comp_op(pixf, it.comp_op);
+                bool solid = sh.is_solid(it.style);
+                color_type c;
+                if(solid) c = sh.color(it.style);
+                span_gen.style = it.style;
+
+                sl.reset(it.bounds.x1 + dx, it.bounds.x2 + dx);
+                unsigned end = it.start_scanline + it.num_scanlines;
+                unsigned j;
+                for(j = first_scanline(it, y1 - dy); j < end; j++)
+                {
+                    const scanline_data& sd = m_storage.scanline_by_index(j);
+                    int y = sd.y + dy;
+                    if(y > y2) break;
+
+                    sl.reset_spans();
+                    unsigned num_spans = sd.num_spans;
+                    unsigned span_idx  = sd.start_span;
+                    do
+                    {
+                        const span_data& sp = m_storage.span_by_index(span_idx++);
+                        const cover_type* covers =
+                            m_storage.covers_by_index(sp.covers_id);
+                        if(sp.len < 0)
+                        {
+                            sl.add_span(sp.x + dx, unsigned(-sp.len), *covers);
+                        }
+                        else
+                        {
+                            sl.add_cells(sp.x + dx, sp.len, covers);
+                        }
+                    }
+                    while(--num_spans);
+                    sl.finalize(y);
+
+                    if(solid) render_scanline_aa_solid(sl, rb, c);
+                    else      render_scanline_aa(sl, rb, alloc, span_gen);
+                }
+            }
+        }
+
+        display_list(const self_type&);
+        const self_type& operator = (const self_type&);
+
+        storage_type     m_storage;
+        pod_bvector<item> m_items;
+        scanline_type    m_sl;
+        unsigned         m_band_height;
+        rect_i           m_bounds;
+        unsigned         m_num_scanlines;
+    };
+
+}
+
+#endif
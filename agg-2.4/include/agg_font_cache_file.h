@@ -0,0 +1,468 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Persistent glyph cache files. The file is memory-mapped when possible,
+// define AGG_NO_MMAP to read it into memory instead.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_FONT_CACHE_FILE_INCLUDED
+#define AGG_FONT_CACHE_FILE_INCLUDED
+
+#include <cstring>
+#include <cstdio>
+#include "agg_array.h"
+#include "agg_font_cache_manager.h"
+
+#if !defined(AGG_NO_MMAP)
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#endif
+
+namespace agg
+{
+    //---------------------------------------------------------font_cache_file
+    // A file with the cached glyphs of one font, that is, the data that
+    // the font engine has already serialized: scanline_storage_aa8,
+    // scanline_storage_bin or path_storage_integer. The file is identified
+    // by a key, which must describe the font exactly: the face file, size,
+    // hinting, transformation, gamma and so on. See, for example,
+    // font_engine_freetype_base::cache_key(). If the key doesn't match,
+    // open() fails and the glyphs must be rendered as usual.
+    //
+    // The layout, in the native byte order, with all the offsets from
+    // the beginning of the file:
+    //
+    //     header                   (header)
+    //     key                      (key_size bytes, padded to 8)
+    //     glyph records            (num_glyphs x glyph_record)
+    //     glyph data               (every block padded to 8)
+    //
+    // The header keeps a checksum of the glyph records and the glyph data,
+    // so that open() rejects the files damaged after the header, too.
+    //
+    // After open() the glyphs point directly to the mapped file, which is
+    // read-only, so the file must stay open as long as they are in use.
+    // A typical use is:
+    //
+    //     font_cache_file file;
+    //     if(file.open(name, feng.cache_key())) file.load_to(fman);
+    //     ... render the text ...
+    //     if(!file.is_open()) font_cache_file::save(fman, name, feng.cache_key());
+    //------------------------------------------------------------------------
+    class font_cache_file
+    {
+    public:
+        enum format_e
+        {
+            byte_order = 0x01020304,
+            version    = 2
+        };
+
+        //--------------------------------------------------------------------
+        struct header
+        {
+            char   magic[8];
+            int32u byte_order;
+            int32u version;
+            int32u key_size;
+            int32u num_glyphs;
+            int32u reserved;
+            int64u checksum;
+        };
+
+        //--------------------------------------------------------------------
+        struct glyph_record
+        {
+            int32u glyph_code;
+            int32u glyph_index;
+            int32u data_size;
+            int32u data_type;
+            int32  x1;
+            int32  y1;
+            int32  x2;
+            int32  y2;
+            double advance_x;
+            double advance_y;
+            int64u data_offset;
+        };
+
+        //--------------------------------------------------------------------
+        ~font_cache_file()
+        {
+            close();
+        }
+
+        //--------------------------------------------------------------------
+        font_cache_file() :
+            m_data(0),
+            m_size(0),
+            m_num_glyphs(0)
+        {}
+
+        //--------------------------------------------------------------------
+        // Maps the file and checks its integrity. Returns false if
+        // the file doesn't exist, is damaged or has a different key.
+        bool open(const char* file_name, const char* key)
+        {
+            close();
+            if(!map_file(file_name)) return false;
+            if(!parse(key))
+            {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        //--------------------------------------------------------------------
+        void close()
+        {
+            m_glyphs.resize(0);
+            m_codes.resize(0);
+            m_num_glyphs = 0;
+            unmap_file();
+        }
+
+        //--------------------------------------------------------------------
+        bool is_open() const { return m_data != 0; }
+        unsigned num_glyphs() const { return m_num_glyphs; }
+        unsigned glyph_code(unsigned i) const { return m_codes[i]; }
+        const glyph_cache& glyph(unsigned i) const { return m_glyphs[i]; }
+
+        //--------------------------------------------------------------------
+        // Adds all the glyphs to the cache of the current font of the
+        // font_cache_manager and returns their number. The glyphs that are
+        // already cached are left as they are.
+        template<class FontCacheManager> unsigned load_to(FontCacheManager& fman) const
+        {
+            unsigned i;
+            unsigned n = 0;
+            for(i = 0; i < m_num_glyphs; i++)
+            {
+                if(fman.cached_glyph(m_codes[i]) == 0 &&
+                   fman.add_glyph(m_codes[i], m_glyphs[i]))
+                {
+                    ++n;
+                }
+            }
+            return n;
+        }
+
+        //--------------------------------------------------------------------
+        // Saves the glyphs cached for the current font of
+        // the font_cache_manager.
+        template<class FontCacheManager>
+        static bool save(FontCacheManager& fman, const char* file_name, const char* key)
+        {
+            pod_bvector<unsigned> codes;
+            pod_bvector<const glyph_cache*> glyphs;
+            fman.cached_glyphs(codes, glyphs);
+            pod_array<unsigned> c(codes.size());
+            pod_array<const glyph_cache*> g(glyphs.size());
+            if(codes.size())
+            {
+                codes.serialize((int8u*)&c[0]);
+                glyphs.serialize((int8u*)&g[0]);
+            }
+            return write(file_name, key, c.data(), g.data(), codes.size());
+        }
+
+        //--------------------------------------------------------------------
+        // Writes the glyphs to the file. The file is written under
+        // a temporary name and then renamed, so that other processes
+        // never see it incomplete.
+        static bool write(const char* file_name,
+                          const char* key,
+                          const unsigned* codes,
+                          const glyph_cache* const* glyphs,
+                          unsigned num_glyphs)
+        {
+            unsigned name_len = unsigned(std::strlen(file_name));
+            pod_array<char> tmp_name(name_len + 5);
+            std::memcpy(&tmp_name[0], file_name, name_len);
+            std::memcpy(&tmp_name[name_len], ".tmp", 5);
+
+            FILE* fd = std::fopen(&tmp_name[0], "wb");
+            if(fd == 0) return false;
+
+            header h;
+            std::memset(&h, 0, sizeof(h));
+            std::memcpy(h.magic, "AGGGLYPH", 8);
+            h.byte_order = byte_order;
+            h.version    = version;
+            h.key_size   = int32u(std::strlen(key));
+            h.num_glyphs = num_glyphs;
+            std::fwrite(&h, sizeof(h), 1, fd);
+            std::fwrite(key, 1, h.key_size, fd);
+            write_padding(fd, h.key_size);
+
+            int64u sum_a = 1;
+            int64u sum_b = 0;
+
+            int64u offset = sizeof(header) +
+                            align8(h.key_size) +
+                            int64u(num_glyphs) * sizeof(glyph_record);
+            unsigned i;
+            for(i = 0; i < num_glyphs; i++)
+            {
+                const glyph_cache& gl = *glyphs[i];
+                glyph_record r;
+                std::memset(&r, 0, sizeof(r));
+                r.glyph_code  = codes[i];
+                r.glyph_index = gl.glyph_index;
+                r.data_size   = gl.data_size;
+                r.data_type   = gl.data_type;
+                r.x1          = gl.bounds.x1;
+                r.y1          = gl.bounds.y1;
+                r.x2          = gl.bounds.x2;
+                r.y2          = gl.bounds.y2;
+                r.advance_x   = gl.advance_x;
+                r.advance_y   = gl.advance_y;
+                r.data_offset = offset;
+                std::fwrite(&r, sizeof(r), 1, fd);
+                update_checksum(sum_a, sum_b, (const int8u*)&r, sizeof(r));
+                offset += align8(gl.data_size);
+            }
+
+            static const int8u zeros[8] = { 0 };
+            for(i = 0; i < num_glyphs; i++)
+            {
+                const glyph_cache& gl = *glyphs[i];
+                if(gl.data_size) std::fwrite(gl.data, 1, gl.data_size, fd);
+                write_padding(fd, gl.data_size);
+                update_checksum(sum_a, sum_b, gl.data, gl.data_size);
+                update_checksum(sum_a, sum_b, zeros, align8(gl.data_size) - gl.data_size);
+            }
+
+            // The checksum is known only now, rewrite the header
+            h.checksum = (sum_b << 32) | sum_a;
+            std::fseek(fd, 0, SEEK_SET);
+            std::fwrite(&h, sizeof(h), 1, fd);
+
+            bool ok = std::ferror(fd) == 0;
+            if(std::fclose(fd) != 0) ok = false;
+            if(ok)
+            {
+#if defined(_WIN32)
+                std::remove(file_name);
+#endif
+                ok = std::rename(&tmp_name[0], file_name) == 0;
+            }
+            if(!ok) std::remove(&tmp_name[0]);
+            return ok;
+        }
+
+    private:
+        font_cache_file(const font_cache_file&);
+        const font_cache_file& operator = (const font_cache_file&);
+
+        //--------------------------------------------------------------------
+        static int64u align8(int64u n) { return (n + 7) & ~int64u(7); }
+
+        //--------------------------------------------------------------------
+        // Fletcher-64 over bytes, both sums are kept modulo 2^32-1. They
+        // are reduced every 4096 bytes, where they can't overflow yet.
+        static void update_checksum(int64u& a, int64u& b, const int8u* p, int64u size)
+        {
+            while(size)
+            {
+                unsigned n = (size < 4096) ? unsigned(size) : 4096;
+                size -= n;
+                do
+                {
+                    a += *p++;
+                    b += a;
+                }
+                while(--n);
+                a %= 0xFFFFFFFFu;
+                b %= 0xFFFFFFFFu;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        static void write_padding(FILE* fd, unsigned size)
+        {
+            static const char zeros[8] = { 0 };
+            unsigned n = unsigned(align8(size) - size);
+            if(n) std::fwrite(zeros, 1, n, fd);
+        }
+
+        //--------------------------------------------------------------------
+        bool parse(const char* key)
+        {
+            if(m_size < sizeof(header)) return false;
+            const header& h = *(const header*)m_data;
+            if(std::memcmp(h.magic, "AGGGLYPH", 8) != 0 ||
+               h.byte_order != byte_order ||
+               h.version != version)
+            {
+                return false;
+            }
+
+            int64u key_size = std::strlen(key);
+            if(h.key_size != key_size ||
+               sizeof(header) + key_size > m_size ||
+               std::memcmp(m_data + sizeof(header), key, h.key_size) != 0)
+            {
+                return false;
+            }
+
+            int64u records = sizeof(header) + align8(h.key_size);
+            int64u data = records + int64u(h.num_glyphs) * sizeof(glyph_record);
+            if(data > m_size) return false;
+
+            int64u sum_a = 1;
+            int64u sum_b = 0;
+            update_checksum(sum_a, sum_b, m_data + records, m_size - records);
+            if(h.checksum != ((sum_b << 32) | sum_a)) return false;
+
+            m_glyphs.resize(h.num_glyphs);
+            m_codes.resize(h.num_glyphs);
+            const glyph_record* r = (const glyph_record*)(m_data + records);
+            unsigned i;
+            for(i = 0; i < h.num_glyphs; i++, r++)
+            {
+                if(r->data_type > glyph_data_outline ||
+                   (r->data_offset & 7) != 0 ||
+                   r->data_offset < data ||
+                   r->data_offset > m_size ||
+                   r->data_size > m_size - r->data_offset)
+                {
+                    return false;
+                }
+                glyph_cache& gl = m_glyphs[i];
+                gl.glyph_index = r->glyph_index;
+                gl.data        = (int8u*)m_data + r->data_offset;
+                gl.data_size   = r->data_size;
+                gl.data_type   = glyph_data_type(r->data_type);
+                gl.bounds      = rect_i(r->x1, r->y1, r->x2, r->y2);
+                gl.advance_x   = r->advance_x;
+                gl.advance_y   = r->advance_y;
+                m_codes[i]     = r->glyph_code;
+            }
+            m_num_glyphs = h.num_glyphs;
+            return true;
+        }
+
+#if defined(AGG_NO_MMAP)
+        //--------------------------------------------------------------------
+        bool map_file(const char* file_name)
+        {
+            FILE* fd = std::fopen(file_name, "rb");
+            if(fd == 0) return false;
+            std::fseek(fd, 0, SEEK_END);
+            long size = std::ftell(fd);
+            std::fseek(fd, 0, SEEK_SET);
+            bool ok = false;
+            if(size > 0)
+            {
+                m_buffer.resize(unsigned(size));
+                ok = std::fread(&m_buffer[0], 1, size, fd) == size_t(size);
+            }
+            std::fclose(fd);
+            if(!ok) return false;
+            m_data = &m_buffer[0];
+            m_size = int64u(size);
+            return true;
+        }
+
+        //--------------------------------------------------------------------
+        void unmap_file()
+        {
+            m_buffer.resize(0);
+            m_data = 0;
+            m_size = 0;
+        }
+
+        pod_array<int8u> m_buffer;
+
+#elif defined(_WIN32)
+        //--------------------------------------------------------------------
+        bool map_file(const char* file_name)
+        {
+            HANDLE fd = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, 0,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+            if(fd == INVALID_HANDLE_VALUE) return false;
+            LARGE_INTEGER size;
+            if(!GetFileSizeEx(fd, &size) || size.QuadPart == 0)
+            {
+                CloseHandle(fd);
+                return false;
+            }
+            HANDLE mapping = CreateFileMappingA(fd, 0, PAGE_READONLY, 0, 0, 0);
+            CloseHandle(fd);
+            if(mapping == 0) return false;
+            void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if(p == 0) return false;
+            m_data = (const int8u*)p;
+            m_size = int64u(size.QuadPart);
+            return true;
+        }
+
+        //--------------------------------------------------------------------
+        void unmap_file()
+        {
+            if(m_data) UnmapViewOfFile(m_data);
+            m_data = 0;
+            m_size = 0;
+        }
+
+#else
+        //--------------------------------------------------------------------
+        bool map_file(const char* file_name)
+        {
+            int fd = ::open(file_name, O_RDONLY);
+            if(fd < 0) return false;
+            struct stat st;
+            if(::fstat(fd, &st) != 0 || st.st_size == 0)
+            {
+                ::close(fd);
+                return false;
+            }
+            void* p = ::mmap(0, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if(p == MAP_FAILED) return false;
+            m_data = (const int8u*)p;
+            m_size = int64u(st.st_size);
+            return true;
+        }
+
+        //--------------------------------------------------------------------
+        void unmap_file()
+        {
+            if(m_data) ::munmap((void*)m_data, size_t(m_size));
+            m_data = 0;
+            m_size = 0;
+        }
+#endif
+
+        const int8u*            m_data;
+        int64u                  m_size;
+        unsigned                m_num_glyphs;
+        pod_array<glyph_cache>  m_glyphs;
+        pod_array<unsigned>     m_codes;
+    };
+
+}
+
+#endif
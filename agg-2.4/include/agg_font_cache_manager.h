@@ -18,6 +18,7 @@
 
 #include <cstring>
 #include "agg_array.h"
+#include "agg_threads.h"
 
 namespace agg
 {
@@ -48,6 +49,12 @@ namespace agg
     //--------------------------------------------------------------font_cache
     class font_cache
     {
+        // The glyph with the code it was cached with
+        struct glyph_entry : glyph_cache
+        {
+            unsigned glyph_code;
+        };
+
     public:
         enum block_size_e { block_size = 16384-16 };
 
@@ -91,22 +98,14 @@ namespace agg
                                  double          advance_x,
                                  double          advance_y)
         {
-            unsigned msb = (glyph_code >> 8) & 0xFF;
-            if(m_glyphs[msb] == 0)
-            {
-                m_glyphs[msb] = 
-                    (glyph_cache**)m_allocator.allocate(sizeof(glyph_cache*) * 256, 
-                                                        sizeof(glyph_cache*));
-                std::memset(m_glyphs[msb], 0, sizeof(glyph_cache*) * 256);
-            }
-
-            unsigned lsb = glyph_code & 0xFF;
-            if(m_glyphs[msb][lsb]) return 0; // Already exists, do not overwrite
+            glyph_entry** slot = glyph_slot(glyph_code);
+            if(*slot) return 0; // Already exists, do not overwrite
 
-            glyph_cache* glyph = 
-                (glyph_cache*)m_allocator.allocate(sizeof(glyph_cache),
+            glyph_entry* glyph = 
+                (glyph_entry*)m_allocator.allocate(sizeof(glyph_entry),
                                                    sizeof(double));
 
+            glyph->glyph_code         = glyph_code;
             glyph->glyph_index        = glyph_index;
             glyph->data               = m_allocator.allocate(data_size);
             glyph->data_size          = data_size;
@@ -114,12 +113,63 @@ namespace agg
             glyph->bounds             = bounds;
             glyph->advance_x          = advance_x;
             glyph->advance_y          = advance_y;
-            return m_glyphs[msb][lsb] = glyph;
+            return *slot = glyph;
+        }
+
+        //--------------------------------------------------------------------
+        // Adds a glyph with the data kept elsewhere, for example, in 
+        // a font_cache_file. The data must stay valid as long as the cache.
+        glyph_cache* cache_glyph_ref(unsigned glyph_code, const glyph_cache& gl)
+        {
+            glyph_entry** slot = glyph_slot(glyph_code);
+            if(*slot) return 0; // Already exists, do not overwrite
+
+            glyph_entry* glyph = 
+                (glyph_entry*)m_allocator.allocate(sizeof(glyph_entry),
+                                                   sizeof(double));
+            *(glyph_cache*)glyph = gl;
+            glyph->glyph_code = glyph_code;
+            return *slot = glyph;
+        }
+
+        //--------------------------------------------------------------------
+        // Adds all the cached glyphs with their codes to the arrays.
+        void cached_glyphs(pod_bvector<unsigned>& codes,
+                           pod_bvector<const glyph_cache*>& glyphs) const
+        {
+            unsigned i, j;
+            for(i = 0; i < 256; i++)
+            {
+                if(m_glyphs[i] == 0) continue;
+                for(j = 0; j < 256; j++)
+                {
+                    const glyph_entry* e = m_glyphs[i][j];
+                    if(e)
+                    {
+                        codes.add(e->glyph_code);
+                        glyphs.add(e);
+                    }
+                }
+            }
         }
 
     private:
+        //--------------------------------------------------------------------
+        glyph_entry** glyph_slot(unsigned glyph_code)
+        {
+            unsigned msb = (glyph_code >> 8) & 0xFF;
+            if(m_glyphs[msb] == 0)
+            {
+                m_glyphs[msb] = 
+                    (glyph_entry**)m_allocator.allocate(sizeof(glyph_entry*) * 256, 
+                                                        sizeof(glyph_entry*));
+                std::memset(m_glyphs[msb], 0, sizeof(glyph_entry*) * 256);
+            }
+            return m_glyphs[msb] + (glyph_code & 0xFF);
+        }
+
         block_allocator m_allocator;
-        glyph_cache**   m_glyphs[256];
+        glyph_entry**   m_glyphs[256];
         char*           m_font_signature;
     };
 
@@ -220,6 +270,20 @@ namespace agg
         }
 
 
+        //--------------------------------------------------------------------
+        glyph_cache* cache_glyph_ref(unsigned glyph_code, const glyph_cache& gl)
+        {
+            if(m_cur_font) return m_cur_font->cache_glyph_ref(glyph_code, gl);
+            return 0;
+        }
+
+        //--------------------------------------------------------------------
+        void cached_glyphs(pod_bvector<unsigned>& codes,
+                           pod_bvector<const glyph_cache*>& glyphs) const
+        {
+            if(m_cur_font) m_cur_font->cached_glyphs(codes, glyphs);
+        }
+
         //--------------------------------------------------------------------
         int find_font(const char* font_signature)
         {
@@ -241,6 +305,491 @@ namespace agg
 
 
 
+    //-------------------------------------------------------font_cache_shared
+    // A glyph cache that can be shared by several font_cache_manager
+    // objects, working in different threads, so that every glyph is
+    // rasterized and kept in memory only once.
+    //
+    // The glyphs are distributed between the shards by the glyph code,
+    // every shard has its own mutex, which is locked only to insert or 
+    // evict a glyph. find_glyph() doesn't lock at all: the glyphs are 
+    // completely written before they are published in the lookup tables.
+    //
+    // The memory is bounded by memory_limit() (0 means no limit), divided
+    // equally between the shards. When a shard exceeds its limit the least
+    // recently used glyphs are evicted, using the CLOCK approximation of 
+    // LRU, so that a lookup only sets a flag in the glyph. The evicted 
+    // glyphs are removed from the lookup tables at once, but their memory 
+    // isn't freed, because other threads can still use them. It's freed 
+    // by collect(), which must be called when no thread uses the glyphs 
+    // returned before, for example, between frames. Call reset_last_glyph()
+    // of the managers too, since they keep the last two glyphs for kerning.
+    //
+    // Like font_cache, it stores glyph codes up to 0xFFFF without
+    // collisions; greater codes with the same lower 16 bits displace 
+    // each other.
+    //------------------------------------------------------------------------
+    class font_cache_shared
+    {
+    public:
+        struct font_record;
+
+        //--------------------------------------------------------------------
+        struct glyph_entry : glyph_cache
+        {
+            font_record*  font;
+            unsigned      glyph_code;
+            unsigned      memory;
+            volatile int  referenced;
+            glyph_entry*  prev;
+            glyph_entry*  next;
+        };
+
+        //--------------------------------------------------------------------
+        struct font_record
+        {
+            char*                           signature;
+            glyph_entry* volatile* volatile pages[256];
+            mutex                           lock;
+        };
+
+        //--------------------------------------------------------------------
+        struct statistics
+        {
+            int64    hits;
+            int64    misses;
+            int64    insertions;
+            int64    evictions;
+            unsigned num_glyphs;
+            unsigned memory;
+            unsigned retired_memory;
+        };
+
+        //--------------------------------------------------------------------
+        ~font_cache_shared()
+        {
+            unsigned i;
+            for(i = 0; i < m_num_shards; i++)
+            {
+                shard* s = m_shards[i];
+                while(s->hand) retire(*s, s->hand);
+                free_retired(*s);
+                obj_allocator<shard>::deallocate(s);
+            }
+            pod_allocator<shard*>::deallocate(m_shards, m_num_shards);
+
+            for(i = 0; i < m_fonts.size(); i++)
+            {
+                font_record* f = m_fonts[i];
+                unsigned j;
+                for(j = 0; j < 256; j++)
+                {
+                    if(f->pages[j])
+                    {
+                        pod_allocator<glyph_entry*>::deallocate(
+                            (glyph_entry**)f->pages[j], 256);
+                    }
+                }
+                pod_allocator<char>::deallocate(f->signature, 
+                                                unsigned(std::strlen(f->signature) + 1));
+                obj_allocator<font_record>::deallocate(f);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // num_shards is rounded up to a power of 2, up to 256.
+        font_cache_shared(unsigned memory_limit=0, unsigned num_shards=16) :
+            m_memory_limit(memory_limit)
+        {
+            if(num_shards > 256) num_shards = 256;
+            m_num_shards = 1;
+            while(m_num_shards < num_shards) m_num_shards <<= 1;
+            m_shards = pod_allocator<shard*>::allocate(m_num_shards);
+            unsigned i;
+            for(i = 0; i < m_num_shards; i++)
+            {
+                m_shards[i] = obj_allocator<shard>::allocate();
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void memory_limit(unsigned limit) { m_memory_limit = limit; }
+        unsigned memory_limit() const { return m_memory_limit; }
+        unsigned num_shards() const { return m_num_shards; }
+
+        //--------------------------------------------------------------------
+        // Finds or creates the font. The fonts are kept until the cache 
+        // is destroyed, so the returned pointer is always valid.
+        font_record* font(const char* font_signature)
+        {
+            scoped_lock lock(m_fonts_lock);
+            unsigned i;
+            for(i = 0; i < m_fonts.size(); i++)
+            {
+                if(std::strcmp(m_fonts[i]->signature, font_signature) == 0)
+                {
+                    return m_fonts[i];
+                }
+            }
+            font_record* f = obj_allocator<font_record>::allocate();
+            unsigned len = unsigned(std::strlen(font_signature) + 1);
+            f->signature = pod_allocator<char>::allocate(len);
+            std::memcpy(f->signature, font_signature, len);
+            for(i = 0; i < 256; i++) f->pages[i] = 0;
+            m_fonts.add(f);
+            return f;
+        }
+
+        //--------------------------------------------------------------------
+        // Evicts all the glyphs of the font.
+        void reset_font(font_record* f)
+        {
+            unsigned i;
+            for(i = 0; i < m_num_shards; i++)
+            {
+                shard& s = *m_shards[i];
+                scoped_lock lock(s.lock);
+                unsigned n = s.num_glyphs;
+                glyph_entry* e = s.hand;
+                for(; n; --n)
+                {
+                    glyph_entry* next = e->next;
+                    if(e->font == f) 
+                    {
+                        retire(s, e);
+                        s.evictions.increment();
+                    }
+                    e = next;
+                }
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // Lock-free lookup, can be called from any thread.
+        const glyph_cache* find_glyph(const font_record* f, unsigned glyph_code)
+        {
+            shard& s = *m_shards[shard_index(glyph_code)];
+            glyph_entry* e = lookup(f, glyph_code);
+            if(e)
+            {
+                if(atomic_load_relaxed(&e->referenced) == 0)
+                {
+                    atomic_store_relaxed(&e->referenced, 1);
+                }
+                s.hits.increment();
+                return e;
+            }
+            s.misses.increment();
+            return 0;
+        }
+
+        //--------------------------------------------------------------------
+        // The same as find_glyph() but it doesn't count as a use of 
+        // the glyph, nor in the statistics.
+        const glyph_cache* peek_glyph(const font_record* f, unsigned glyph_code) const
+        {
+            return lookup(f, glyph_code);
+        }
+
+        //--------------------------------------------------------------------
+        // Adds all the glyphs of the font with the codes they were inserted
+        // with to the arrays. Like peek_glyph() it doesn't count as a use.
+        // The glyphs evicted by the other threads in the meantime stay
+        // valid until collect().
+        void cached_glyphs(const font_record* f,
+                           pod_bvector<unsigned>& codes,
+                           pod_bvector<const glyph_cache*>& glyphs) const
+        {
+            unsigned i, j;
+            for(i = 0; i < 256; i++)
+            {
+                glyph_entry* volatile* page = atomic_load_acquire(&f->pages[i]);
+                if(page == 0) continue;
+                for(j = 0; j < 256; j++)
+                {
+                    glyph_entry* e = atomic_load_acquire(&page[j]);
+                    if(e)
+                    {
+                        codes.add(e->glyph_code);
+                        glyphs.add(e);
+                    }
+                }
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // Allocates a glyph that isn't yet visible to the other threads.
+        // Write the glyph data and then call insert_glyph().
+        glyph_cache* new_glyph(unsigned        glyph_index,
+                               unsigned        data_size,
+                               glyph_data_type data_type,
+                               const rect_i&   bounds,
+                               double          advance_x,
+                               double          advance_y)
+        {
+            glyph_entry* e = obj_allocator<glyph_entry>::allocate();
+            e->glyph_index = glyph_index;
+            e->data        = pod_allocator<int8u>::allocate(data_size);
+            e->data_size   = data_size;
+            e->data_type   = data_type;
+            e->bounds      = bounds;
+            e->advance_x   = advance_x;
+            e->advance_y   = advance_y;
+            e->font        = 0;
+            e->glyph_code  = 0;
+            e->memory      = unsigned(sizeof(glyph_entry)) + data_size;
+            e->referenced  = 1;
+            e->prev        = 0;
+            e->next        = 0;
+            return e;
+        }
+
+        //--------------------------------------------------------------------
+        // Publishes the glyph created by new_glyph(). If another thread has 
+        // inserted the same glyph in the meantime the new one is destroyed 
+        // and the existing one is returned.
+        const glyph_cache* insert_glyph(font_record* f, 
+                                        unsigned glyph_code, 
+                                        glyph_cache* gl)
+        {
+            glyph_entry* e = static_cast<glyph_entry*>(gl);
+            glyph_entry* volatile* page = find_page(f, glyph_code);
+            glyph_entry* volatile* slot = &page[glyph_code & 0xFF];
+
+            shard& s = *m_shards[shard_index(glyph_code)];
+            scoped_lock lock(s.lock);
+
+            glyph_entry* old = *slot;
+            if(old)
+            {
+                if(old->glyph_code == glyph_code)
+                {
+                    destroy(e);
+                    return old;
+                }
+                retire(s, old);
+                s.evictions.increment();
+            }
+
+            if(m_memory_limit)
+            {
+                unsigned limit = m_memory_limit / m_num_shards;
+                while(s.hand && s.memory + e->memory > limit)
+                {
+                    glyph_entry* victim = s.hand;
+                    if(atomic_load_relaxed(&victim->referenced))
+                    {
+                        atomic_store_relaxed(&victim->referenced, 0);
+                        s.hand = victim->next;
+                    }
+                    else
+                    {
+                        retire(s, victim);
+                        s.evictions.increment();
+                    }
+                }
+            }
+
+            e->font = f;
+            e->glyph_code = glyph_code;
+            link(s, e);
+            s.insertions.increment();
+            atomic_store_release(slot, e);
+            return e;
+        }
+
+        //--------------------------------------------------------------------
+        // Frees the memory of the evicted glyphs. No other thread may use 
+        // the glyphs obtained before the call.
+        void collect()
+        {
+            unsigned i;
+            for(i = 0; i < m_num_shards; i++)
+            {
+                shard& s = *m_shards[i];
+                scoped_lock lock(s.lock);
+                free_retired(s);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        statistics stats() const
+        {
+            statistics st;
+            std::memset(&st, 0, sizeof(st));
+            unsigned i;
+            for(i = 0; i < m_num_shards; i++)
+            {
+                shard& s = *m_shards[i];
+                st.hits       += s.hits.value();
+                st.misses     += s.misses.value();
+                st.insertions += s.insertions.value();
+                st.evictions  += s.evictions.value();
+                scoped_lock lock(s.lock);
+                st.num_glyphs     += s.num_glyphs;
+                st.memory         += s.memory;
+                st.retired_memory += s.retired_memory;
+            }
+            return st;
+        }
+
+        //--------------------------------------------------------------------
+        void reset_stats()
+        {
+            unsigned i;
+            for(i = 0; i < m_num_shards; i++)
+            {
+                shard& s = *m_shards[i];
+                s.hits.reset();
+                s.misses.reset();
+                s.insertions.reset();
+                s.evictions.reset();
+            }
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        // The glyphs are kept in a circular list, the clock hand points to
+        // the oldest one. The retired glyphs are linked through "next".
+        struct shard
+        {
+            shard() : 
+                hand(0), num_glyphs(0), memory(0), 
+                retired(0), retired_memory(0) 
+            {}
+
+            mutex          lock;
+            glyph_entry*   hand;
+            unsigned       num_glyphs;
+            unsigned       memory;
+            glyph_entry*   retired;
+            unsigned       retired_memory;
+            atomic_counter hits;
+            atomic_counter misses;
+            atomic_counter insertions;
+            atomic_counter evictions;
+        };
+
+        //--------------------------------------------------------------------
+        // Only the lower 16 bits, so that all the codes that share 
+        // the same slot in the lookup table belong to the same shard.
+        unsigned shard_index(unsigned glyph_code) const
+        {
+            return ((glyph_code >> 8) ^ glyph_code) & 0xFF & (m_num_shards - 1);
+        }
+
+        //--------------------------------------------------------------------
+        static glyph_entry* lookup(const font_record* f, unsigned glyph_code)
+        {
+            glyph_entry* volatile* page = 
+                atomic_load_acquire(&f->pages[(glyph_code >> 8) & 0xFF]);
+            if(page)
+            {
+                glyph_entry* e = atomic_load_acquire(&page[glyph_code & 0xFF]);
+                if(e && e->glyph_code == glyph_code) return e;
+            }
+            return 0;
+        }
+
+        //--------------------------------------------------------------------
+        glyph_entry* volatile* find_page(font_record* f, unsigned glyph_code)
+        {
+            glyph_entry* volatile* volatile* pp = &f->pages[(glyph_code >> 8) & 0xFF];
+            glyph_entry* volatile* page = atomic_load_acquire(pp);
+            if(page == 0)
+            {
+                scoped_lock lock(f->lock);
+                page = *pp;
+                if(page == 0)
+                {
+                    glyph_entry** p = pod_allocator<glyph_entry*>::allocate(256);
+                    std::memset(p, 0, sizeof(glyph_entry*) * 256);
+                    page = p;
+                    atomic_store_release(pp, page);
+                }
+            }
+            return page;
+        }
+
+        //--------------------------------------------------------------------
+        // Inserts the glyph right behind the clock hand, that is, as 
+        // the most recent one.
+        static void link(shard& s, glyph_entry* e)
+        {
+            if(s.hand)
+            {
+                e->next = s.hand;
+                e->prev = s.hand->prev;
+                e->prev->next = e;
+                s.hand->prev = e;
+            }
+            else
+            {
+                e->next = e->prev = e;
+                s.hand = e;
+            }
+            ++s.num_glyphs;
+            s.memory += e->memory;
+        }
+
+        //--------------------------------------------------------------------
+        // Removes the glyph from the lookup table and from the clock list.
+        static void retire(shard& s, glyph_entry* e)
+        {
+            glyph_entry* volatile* page = e->font->pages[(e->glyph_code >> 8) & 0xFF];
+            glyph_entry* volatile* slot = &page[e->glyph_code & 0xFF];
+            if(*slot == e) atomic_store_release(slot, (glyph_entry*)0);
+
+            if(e->next == e)
+            {
+                s.hand = 0;
+            }
+            else
+            {
+                if(s.hand == e) s.hand = e->next;
+                e->prev->next = e->next;
+                e->next->prev = e->prev;
+            }
+            --s.num_glyphs;
+            s.memory -= e->memory;
+
+            e->next = s.retired;
+            s.retired = e;
+            s.retired_memory += e->memory;
+        }
+
+        //--------------------------------------------------------------------
+        static void free_retired(shard& s)
+        {
+            while(s.retired)
+            {
+                glyph_entry* e = s.retired;
+                s.retired = e->next;
+                destroy(e);
+            }
+            s.retired_memory = 0;
+        }
+
+        //--------------------------------------------------------------------
+        static void destroy(glyph_entry* e)
+        {
+            pod_allocator<int8u>::deallocate(e->data, e->data_size);
+            obj_allocator<glyph_entry>::deallocate(e);
+        }
+
+        font_cache_shared(const font_cache_shared&);
+        const font_cache_shared& operator = (const font_cache_shared&);
+
+        shard**                   m_shards;
+        unsigned                  m_num_shards;
+        unsigned                  m_memory_limit;
+        pod_bvector<font_record*> m_fonts;
+        mutex                     m_fonts_lock;
+    };
+
+
+
+
     //------------------------------------------------------------------------
     enum glyph_rendering
     {
@@ -269,6 +818,22 @@ namespace agg
         //--------------------------------------------------------------------
         font_cache_manager(font_engine_type& engine, unsigned max_fonts=32) :
             m_fonts(max_fonts),
+            m_shared(0),
+            m_shared_font(0),
+            m_engine(engine),
+            m_change_stamp(-1),
+            m_prev_glyph(0),
+            m_last_glyph(0)
+        {}
+
+        //--------------------------------------------------------------------
+        // Uses the shared cache instead of its own one. Every thread 
+        // must have its own font engine and manager, they only share 
+        // the glyphs.
+        font_cache_manager(font_engine_type& engine, font_cache_shared& shared) :
+            m_fonts(1),
+            m_shared(&shared),
+            m_shared_font(0),
             m_engine(engine),
             m_change_stamp(-1),
             m_prev_glyph(0),
@@ -285,7 +850,9 @@ namespace agg
         const glyph_cache* glyph(unsigned glyph_code)
         {
             synchronize();
-            const glyph_cache* gl = m_fonts.find_glyph(glyph_code);
+            const glyph_cache* gl = m_shared ? 
+                m_shared->find_glyph(m_shared_font, glyph_code) :
+                m_fonts.find_glyph(glyph_code);
             if(gl) 
             {
                 m_prev_glyph = m_last_glyph;
@@ -296,6 +863,18 @@ namespace agg
                 if(m_engine.prepare_glyph(glyph_code))
                 {
                     m_prev_glyph = m_last_glyph;
+                    if(m_shared)
+                    {
+                        glyph_cache* sg = m_shared->new_glyph(m_engine.glyph_index(),
+                                                              m_engine.data_size(),
+                                                              m_engine.data_type(),
+                                                              m_engine.bounds(),
+                                                              m_engine.advance_x(),
+                                                              m_engine.advance_y());
+                        m_engine.write_glyph_to(sg->data);
+                        return m_last_glyph = 
+                            m_shared->insert_glyph(m_shared_font, glyph_code, sg);
+                    }
                     m_last_glyph = m_fonts.cache_glyph(glyph_code, 
                                                        m_engine.glyph_index(),
                                                        m_engine.data_size(),
@@ -310,6 +889,50 @@ namespace agg
             return 0;
         }
 
+        //--------------------------------------------------------------------
+        // Returns the glyph only if it's already in the cache, without
+        // rendering it. It doesn't affect the last glyphs nor the cache 
+        // statistics.
+        const glyph_cache* cached_glyph(unsigned glyph_code)
+        {
+            synchronize();
+            return m_shared ? 
+                m_shared->peek_glyph(m_shared_font, glyph_code) :
+                m_fonts.find_glyph(glyph_code);
+        }
+
+        //--------------------------------------------------------------------
+        // Adds a glyph rendered before, for example, loaded from
+        // a font_cache_file, to the cache of the current font. The private
+        // cache only refers to the glyph data, the shared cache copies them.
+        const glyph_cache* add_glyph(unsigned glyph_code, const glyph_cache& gl)
+        {
+            synchronize();
+            if(m_shared)
+            {
+                glyph_cache* sg = m_shared->new_glyph(gl.glyph_index,
+                                                      gl.data_size,
+                                                      gl.data_type,
+                                                      gl.bounds,
+                                                      gl.advance_x,
+                                                      gl.advance_y);
+                if(gl.data_size) std::memcpy(sg->data, gl.data, gl.data_size);
+                return m_shared->insert_glyph(m_shared_font, glyph_code, sg);
+            }
+            return m_fonts.cache_glyph_ref(glyph_code, gl);
+        }
+
+        //--------------------------------------------------------------------
+        // Adds all the glyphs cached for the current font with their codes
+        // to the arrays, including the codes above 0xFFFF.
+        void cached_glyphs(pod_bvector<unsigned>& codes,
+                           pod_bvector<const glyph_cache*>& glyphs)
+        {
+            synchronize();
+            if(m_shared) m_shared->cached_glyphs(m_shared_font, codes, glyphs);
+            else         m_fonts.cached_glyphs(codes, glyphs);
+        }
+
         //--------------------------------------------------------------------
         void init_embedded_adaptors(const glyph_cache* gl, 
                                     double x, double y, 
@@ -368,7 +991,15 @@ namespace agg
         //--------------------------------------------------------------------
         void reset_cache()
         {
-            m_fonts.font(m_engine.font_signature(), true);
+            if(m_shared)
+            {
+                m_shared_font = m_shared->font(m_engine.font_signature());
+                m_shared->reset_font(m_shared_font);
+            }
+            else
+            {
+                m_fonts.font(m_engine.font_signature(), true);
+            }
             m_change_stamp = m_engine.change_stamp();
             m_prev_glyph = m_last_glyph = 0;
         }
@@ -383,13 +1014,16 @@ namespace agg
         {
             if(m_change_stamp != m_engine.change_stamp())
             {
-                m_fonts.font(m_engine.font_signature());
+                if(m_shared) m_shared_font = m_shared->font(m_engine.font_signature());
+                else         m_fonts.font(m_engine.font_signature());
                 m_change_stamp = m_engine.change_stamp();
                 m_prev_glyph = m_last_glyph = 0;
             }
         }
 
         font_cache_pool     m_fonts;
+        font_cache_shared*  m_shared;
+        font_cache_shared::font_record* m_shared_font;
         font_engine_type&   m_engine;
         int                 m_change_stamp;
         double              m_dx;
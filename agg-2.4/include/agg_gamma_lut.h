@@ -198,7 +198,32 @@ namespace agg
                 m_dir_table[i] = uround(65535.0 * sRGB_to_linear(i / 255.0));
                 m_inv_table[i] = uround(65535.0 * sRGB_to_linear((i - 0.5) / 255.0));
             }
+            for (unsigned j = 0; j < inv_index_size; ++j)
+            {
+                m_inv_index[j] = sRGB_lut_base<int16u>::inv(int16u(j << inv_index_shift));
+            }
+        }
+
+        int8u inv(int16u v) const
+        {
+            // The index gives the value at the beginning of the interval 
+            // of 16 linear values. The thresholds are at least 19 apart
+            // (the slope of sRGB_to_linear() is minimal at zero), so there
+            // is at most one of them within the interval. The result is 
+            // the same as of the binary search.
+            unsigned x = m_inv_index[v >> inv_index_shift];
+            if (x < 255 && v > m_inv_table[x + 1]) ++x;
+            return int8u(x);
         }
+
+    private:
+        enum inv_index_e
+        {
+            inv_index_shift = 4,
+            inv_index_size  = 65536 >> inv_index_shift
+        };
+
+        int8u m_inv_index[inv_index_size];
     };
 
     template<>
@@ -0,0 +1,181 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Mipmap pyramid of an image for the minifying image transformations.
+// See span_image_mipmap_rgba and span_image_mipmap_rgba_affine.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_IMAGE_MIPMAP_INCLUDED
+#define AGG_IMAGE_MIPMAP_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_array.h"
+
+namespace agg
+{
+
+    //===========================================================image_mipmap
+    // The level 0 is the image itself, every next level is half of the
+    // previous one, rounded up, down to 1x1. A pixel of the next level is
+    // the average of 2x2 pixels, the odd last row and column are repeated.
+    //
+    // The levels are built lazily, when they are requested for the first
+    // time, and they are kept while the mipmap is attached to the same
+    // buffer of the same size. Call invalidate() when the pixels of the
+    // image change. Since building modifies the mipmap, call build() before
+    // sharing it between threads.
+    //
+    // The pixel values must be integer, all the values of a pixel
+    // (pix_width / sizeof(value_type)) are averaged.
+    //------------------------------------------------------------------------
+    template<class PixFmt> class image_mipmap
+    {
+    public:
+        typedef PixFmt pixfmt_type;
+        typedef typename pixfmt_type::color_type color_type;
+        typedef typename pixfmt_type::order_type order_type;
+        typedef typename pixfmt_type::value_type value_type;
+        typedef typename pixfmt_type::rbuf_type  rbuf_type;
+        typedef typename color_type::calc_type   calc_type;
+        enum max_levels_e { max_levels = 32 };
+
+        //--------------------------------------------------------------------
+        image_mipmap() :
+            m_src_buf(0), m_src_width(0), m_src_height(0), m_src_stride(0),
+            m_num_levels(0), m_num_built(0)
+        {}
+
+        explicit image_mipmap(rbuf_type& rbuf) :
+            m_src_buf(0), m_src_width(0), m_src_height(0), m_src_stride(0),
+            m_num_levels(0), m_num_built(0)
+        {
+            attach(rbuf);
+        }
+
+        //--------------------------------------------------------------------
+        void attach(rbuf_type& rbuf)
+        {
+            m_levels[0].attach(rbuf);
+            if(m_num_levels &&
+               rbuf.buf()    == m_src_buf   &&
+               rbuf.width()  == m_src_width &&
+               rbuf.height() == m_src_height &&
+               rbuf.stride() == m_src_stride) return;
+
+            m_src_buf    = rbuf.buf();
+            m_src_width  = rbuf.width();
+            m_src_height = rbuf.height();
+            m_src_stride = rbuf.stride();
+
+            m_num_levels = 1;
+            unsigned w = m_src_width;
+            unsigned h = m_src_height;
+            while((w > 1 || h > 1) && m_num_levels < max_levels)
+            {
+                w = (w + 1) >> 1;
+                h = (h + 1) >> 1;
+                ++m_num_levels;
+            }
+            m_num_built = 1;
+        }
+
+        //--------------------------------------------------------------------
+        void invalidate() { if(m_num_built) m_num_built = 1; }
+
+        //--------------------------------------------------------------------
+        unsigned num_levels() const { return m_num_levels; }
+
+        //--------------------------------------------------------------------
+        pixfmt_type& level(unsigned i)
+        {
+            if(i >= m_num_built) build(i);
+            return m_levels[i];
+        }
+
+        //--------------------------------------------------------------------
+        void build() { if(m_num_levels) build(m_num_levels - 1); }
+
+        //--------------------------------------------------------------------
+        void build(unsigned last)
+        {
+            if(last >= m_num_levels) last = m_num_levels - 1;
+            while(m_num_built <= last)
+            {
+                downsample(m_levels[m_num_built - 1], m_num_built);
+                ++m_num_built;
+            }
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        void downsample(const pixfmt_type& src, unsigned i)
+        {
+            enum values_e
+            {
+                num_values = pixfmt_type::pix_width / sizeof(value_type)
+            };
+
+            unsigned sw = src.width();
+            unsigned sh = src.height();
+            unsigned w = (sw + 1) >> 1;
+            unsigned h = (sh + 1) >> 1;
+            unsigned stride = w * pixfmt_type::pix_width;
+            m_bufs[i].resize(stride * h);
+            m_rbufs[i].attach(m_bufs[i].data(), w, h, stride);
+            m_levels[i].attach(m_rbufs[i]);
+
+            unsigned y;
+            for(y = 0; y < h; y++)
+            {
+                unsigned y1 = y << 1;
+                unsigned y2 = (y1 + 1 < sh) ? y1 + 1 : y1;
+                value_type* p = (value_type*)m_levels[i].pix_ptr(0, y);
+                unsigned x;
+                for(x = 0; x < w; x++)
+                {
+                    unsigned x1 = x << 1;
+                    unsigned x2 = (x1 + 1 < sw) ? x1 + 1 : x1;
+                    const value_type* p11 = (const value_type*)src.pix_ptr(x1, y1);
+                    const value_type* p12 = (const value_type*)src.pix_ptr(x2, y1);
+                    const value_type* p21 = (const value_type*)src.pix_ptr(x1, y2);
+                    const value_type* p22 = (const value_type*)src.pix_ptr(x2, y2);
+                    unsigned k;
+                    for(k = 0; k < num_values; k++)
+                    {
+                        *p++ = value_type((calc_type(p11[k]) + p12[k] +
+                                           p21[k] + p22[k] + 2) >> 2);
+                    }
+                }
+            }
+        }
+
+        //--------------------------------------------------------------------
+        image_mipmap(const image_mipmap<PixFmt>&);
+        const image_mipmap<PixFmt>& operator = (const image_mipmap<PixFmt>&);
+
+        const int8u*     m_src_buf;
+        unsigned         m_src_width;
+        unsigned         m_src_height;
+        int              m_src_stride;
+        unsigned         m_num_levels;
+        unsigned         m_num_built;
+        pixfmt_type      m_levels[max_levels];
+        rbuf_type        m_rbufs[max_levels];
+        pod_array<int8u> m_bufs[max_levels];
+    };
+
+}
+
+#endif
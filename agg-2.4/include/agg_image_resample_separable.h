@@ -0,0 +1,457 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Separable image resampling for axis-aligned transformations.
+//
+// span_image_resample_rgba_affine applies the whole 2D kernel to every
+// pixel, that is, diameter_x * diameter_y taps, which is slow for large
+// downscales. When the transformation has no rotation and no shear the
+// kernel is a product of two 1D kernels, so the image can be filtered
+// horizontally and then vertically, with diameter_x + diameter_y taps
+// per pixel. The weights of every column and every row are calculated
+// once, with the same filter, scale and subpixel offsets as the span
+// generator uses.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_IMAGE_RESAMPLE_SEPARABLE_INCLUDED
+#define AGG_IMAGE_RESAMPLE_SEPARABLE_INCLUDED
+
+#include <math.h>
+#include "agg_basics.h"
+#include "agg_array.h"
+#include "agg_image_filters.h"
+#include "agg_trans_affine.h"
+#include "agg_threads.h"
+
+namespace agg
+{
+
+    //==================================================resample_weight_table
+    // The weights of one axis. For every destination pixel there's a range
+    // of source pixels [start, start + num) and their weights, normalized
+    // so that the sum is image_filter_scale. The taps that fall out of the
+    // source image are added to the edge pixels, which is the same as
+    // reading the image with image_accessor_clone.
+    //------------------------------------------------------------------------
+    class resample_weight_table
+    {
+    public:
+        //--------------------------------------------------------------------
+        // dst_start, dst_len - the destination pixels
+        // scale, offset      - the source coordinate of the destination
+        //                      one is x * scale + offset
+        // radius, radius_inv - the kernel scale in the subpixel units,
+        //                      see span_image_resample_affine::prepare()
+        // src_len            - the number of the source pixels
+        void calculate(const image_filter_lut& filter,
+                       int dst_start, unsigned dst_len,
+                       double scale, double offset,
+                       int radius, int radius_inv,
+                       unsigned src_len)
+        {
+            m_start.resize(dst_len);
+            m_num.resize(dst_len);
+            m_offset.resize(dst_len);
+
+            int diameter     = filter.diameter();
+            int filter_scale = diameter << image_subpixel_shift;
+            int r            = (diameter * radius) >> 1;
+            unsigned max_taps = (filter_scale + radius_inv - 1) / radius_inv;
+            m_weights.capacity(dst_len * max_taps);
+            const int16* weight_array = filter.weight_array();
+            int last = int(src_len) - 1;
+
+            unsigned i;
+            for(i = 0; i < dst_len; i++)
+            {
+                double s = (dst_start + int(i) + 0.5) * scale + offset;
+                int x = iround(s * image_subpixel_scale) +
+                        image_subpixel_scale / 2 - r;
+
+                int x_lr = x >> image_subpixel_shift;
+                int x_hr = ((image_subpixel_mask - (x & image_subpixel_mask)) *
+                               radius_inv) >> image_subpixel_shift;
+
+                // The range of the source pixels after clamping
+                int n = 0;
+                int h;
+                for(h = x_hr; h < filter_scale; h += radius_inv) ++n;
+                int x1 = x_lr;
+                int x2 = x_lr + n - 1;
+                if(x1 < 0)    x1 = 0;
+                if(x1 > last) x1 = last;
+                if(x2 < 0)    x2 = 0;
+                if(x2 > last) x2 = last;
+
+                unsigned offs = m_weights.size();
+                int k;
+                for(k = x1; k <= x2; k++) m_weights.add(0);
+
+                int total = 0;
+                for(k = 0; x_hr < filter_scale; k++)
+                {
+                    int pos = x_lr + k;
+                    if(pos < x1) pos = x1;
+                    if(pos > x2) pos = x2;
+                    m_weights[offs + pos - x1] += weight_array[x_hr];
+                    total += weight_array[x_hr];
+                    x_hr += radius_inv;
+                }
+
+                // Normalize the weights, the error of rounding goes
+                // to the heaviest tap
+                int sum = 0;
+                unsigned heaviest = offs;
+                for(k = 0; k <= x2 - x1; k++)
+                {
+                    int w = m_weights[offs + k];
+                    if(w > m_weights[heaviest]) heaviest = offs + k;
+                    w = total ? iround(double(w) * image_filter_scale / total) : 0;
+                    m_weights[offs + k] = w;
+                    sum += w;
+                }
+                m_weights[heaviest] += image_filter_scale - sum;
+
+                m_start[i]  = x1;
+                m_num[i]    = x2 - x1 + 1;
+                m_offset[i] = offs;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        int        start(unsigned i)   const { return m_start[i]; }
+        unsigned   num(unsigned i)     const { return m_num[i]; }
+        const int* weights(unsigned i) const { return &m_weights[m_offset[i]]; }
+
+        //--------------------------------------------------------------------
+        // The range of the source pixels used by all the destination ones.
+        // It's taken over all of them, because with a negative scale
+        // (flipping) and overlapping kernels neither the first nor the last
+        // destination pixel holds both ends.
+        void src_range(int* s1, int* s2) const
+        {
+            *s1 = m_start[0];
+            *s2 = m_start[0] + int(m_num[0]) - 1;
+            unsigned i;
+            for(i = 1; i < m_start.size(); i++)
+            {
+                int e = m_start[i] + int(m_num[i]) - 1;
+                if(m_start[i] < *s1) *s1 = m_start[i];
+                if(e > *s2) *s2 = e;
+            }
+        }
+
+    private:
+        pod_array<int>      m_start;
+        pod_array<unsigned> m_num;
+        pod_array<unsigned> m_offset;
+        pod_vector<int>     m_weights;
+    };
+
+
+
+    //===============================================image_resample_separable
+    // Resamples the source image into the whole destination one with
+    // an affine transformation that has no rotation and no shear,
+    // that is, scaling, translation and flipping. The matrix transforms
+    // the source image into the destination, the same as the image matrix
+    // in the examples before invert().
+    //
+    // The filter, the scale limit and the blur are the same as in
+    // span_image_resample_affine, and the source is clamped at the edges
+    // like image_accessor_clone does. The result differs from
+    // span_image_resample_rgba_affine by the rounding only, not more than
+    // a couple of levels. Like the span generator, it assumes premultiplied
+    // colors and clips R, G, B by A. The pixel formats must be 4-component
+    // RGBA with integer components; the destination pixels are overwritten,
+    // not blended.
+    //
+    // The horizontal pass is done for the needed source rows, then the
+    // vertical pass for all the destination rows. Both are split between
+    // num_threads threads (0 means one thread per processor) by interleaved
+    // strips of rows.
+    //------------------------------------------------------------------------
+    class image_resample_separable
+    {
+    public:
+        enum strip_e { strip_height = 8 };
+
+        //--------------------------------------------------------------------
+        image_resample_separable(const image_filter_lut& filter,
+                                 unsigned num_threads=0) :
+            m_filter(&filter),
+            m_num_threads(num_threads),
+            m_scale_limit(200.0),
+            m_blur_x(1.0),
+            m_blur_y(1.0)
+        {}
+
+        //--------------------------------------------------------------------
+        void filter(const image_filter_lut& f) { m_filter = &f; }
+        const image_filter_lut& filter() const { return *m_filter; }
+
+        void num_threads(unsigned n) { m_num_threads = n; }
+        unsigned num_threads() const { return m_num_threads; }
+
+        int  scale_limit() const { return uround(m_scale_limit); }
+        void scale_limit(int v)  { m_scale_limit = v; }
+
+        double blur_x() const { return m_blur_x; }
+        double blur_y() const { return m_blur_y; }
+        void blur_x(double v) { m_blur_x = v; }
+        void blur_y(double v) { m_blur_y = v; }
+        void blur(double v) { m_blur_x = m_blur_y = v; }
+
+        //--------------------------------------------------------------------
+        static bool is_separable(const trans_affine& mtx,
+                                 double epsilon = affine_epsilon)
+        {
+            return fabs(mtx.shx) <= epsilon && fabs(mtx.shy) <= epsilon &&
+                   fabs(mtx.sx)  >  epsilon && fabs(mtx.sy)  >  epsilon;
+        }
+
+        //--------------------------------------------------------------------
+        // Returns false if the matrix is not separable or an image is empty;
+        // nothing is rendered in this case.
+        template<class DstPixFmt, class SrcPixFmt>
+        bool resample(DstPixFmt& dst, const SrcPixFmt& src,
+                      const trans_affine& mtx)
+        {
+            if(!is_separable(mtx)) return false;
+            if(dst.width() == 0 || dst.height() == 0 ||
+               src.width() == 0 || src.height() == 0) return false;
+
+            trans_affine inv = mtx;
+            inv.invert();
+
+            // The same as span_image_resample_affine::prepare() does
+            double scale_x;
+            double scale_y;
+            inv.scaling_abs(&scale_x, &scale_y);
+
+            double scale_xy = scale_x * scale_y;
+            if(scale_xy > m_scale_limit)
+            {
+                scale_x = scale_x * m_scale_limit / scale_xy;
+                scale_y = scale_y * m_scale_limit / scale_xy;
+            }
+
+            if(scale_x < 1) scale_x = 1;
+            if(scale_y < 1) scale_y = 1;
+
+            if(scale_x > m_scale_limit) scale_x = m_scale_limit;
+            if(scale_y > m_scale_limit) scale_y = m_scale_limit;
+
+            scale_x *= m_blur_x;
+            scale_y *= m_blur_y;
+
+            if(scale_x < 1) scale_x = 1;
+            if(scale_y < 1) scale_y = 1;
+
+            m_wx.calculate(*m_filter, 0, dst.width(), inv.sx, inv.tx,
+                           uround(scale_x * double(image_subpixel_scale)),
+                           uround(1.0/scale_x * double(image_subpixel_scale)),
+                           src.width());
+
+            m_wy.calculate(*m_filter, 0, dst.height(), inv.sy, inv.ty,
+                           uround(scale_y * double(image_subpixel_scale)),
+                           uround(1.0/scale_y * double(image_subpixel_scale)),
+                           src.height());
+
+            // The source rows needed
+            int y1;
+            int y2;
+            m_wy.src_range(&y1, &y2);
+            unsigned num_rows = unsigned(y2 - y1 + 1);
+            m_rows.resize(num_rows * dst.width() * 4);
+
+            unsigned num_threads = m_num_threads;
+            if(num_threads == 0) num_threads = num_cpus();
+
+            horizontal_task<SrcPixFmt> htask;
+            htask.self  = this;
+            htask.src   = &src;
+            htask.y1    = y1;
+            htask.num_rows = num_rows;
+            htask.width = dst.width();
+            run_parallel(htask, limit_threads(num_threads, num_rows));
+
+            vertical_task<DstPixFmt> vtask;
+            vtask.self  = this;
+            vtask.dst   = &dst;
+            vtask.y1    = y1;
+            vtask.width = dst.width();
+            run_parallel(vtask, limit_threads(num_threads, dst.height()));
+            return true;
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        static unsigned limit_threads(unsigned num_threads, unsigned num_rows)
+        {
+            unsigned num_strips = (num_rows + strip_height - 1) / strip_height;
+            return (num_threads > num_strips) ? num_strips : num_threads;
+        }
+
+        //--------------------------------------------------------------------
+        // Filters the source rows horizontally. The intermediate values
+        // have 8 more bits of precision than the source ones.
+        template<class SrcPixFmt> struct horizontal_task
+        {
+            typedef typename SrcPixFmt::value_type value_type;
+            typedef typename SrcPixFmt::order_type order_type;
+
+            image_resample_separable* self;
+            const SrcPixFmt*          src;
+            int                       y1;
+            unsigned                  num_rows;
+            unsigned                  width;
+
+            void run(unsigned idx, unsigned num)
+            {
+                const resample_weight_table& wx = self->m_wx;
+                unsigned row;
+                for(row = idx * strip_height; row < num_rows;
+                    row += num * strip_height)
+                {
+                    unsigned end = row + strip_height;
+                    if(end > num_rows) end = num_rows;
+                    unsigned r;
+                    for(r = row; r < end; r++)
+                    {
+                        int* dst = &self->m_rows[r * width * 4];
+                        unsigned x;
+                        for(x = 0; x < width; x++)
+                        {
+                            const value_type* p = (const value_type*)
+                                src->pix_ptr(wx.start(x), y1 + int(r));
+                            const int* w = wx.weights(x);
+                            unsigned n = wx.num(x);
+                            int fg[4] = { 0, 0, 0, 0 };
+                            do
+                            {
+                                fg[0] += *w * int(p[order_type::R]);
+                                fg[1] += *w * int(p[order_type::G]);
+                                fg[2] += *w * int(p[order_type::B]);
+                                fg[3] += *w * int(p[order_type::A]);
+                                p += 4;
+                                ++w;
+                            }
+                            while(--n);
+                            dst[0] = fg[0] >> (image_filter_shift - 8);
+                            dst[1] = fg[1] >> (image_filter_shift - 8);
+                            dst[2] = fg[2] >> (image_filter_shift - 8);
+                            dst[3] = fg[3] >> (image_filter_shift - 8);
+                            dst += 4;
+                        }
+                    }
+                }
+            }
+        };
+
+        //--------------------------------------------------------------------
+        // Filters the intermediate rows vertically into the destination.
+        template<class DstPixFmt> struct vertical_task
+        {
+            typedef typename DstPixFmt::value_type value_type;
+            typedef typename DstPixFmt::order_type order_type;
+            typedef typename DstPixFmt::color_type color_type;
+
+            image_resample_separable* self;
+            DstPixFmt*                dst;
+            int                       y1;
+            unsigned                  width;
+
+            void run(unsigned idx, unsigned num)
+            {
+                const resample_weight_table& wy = self->m_wy;
+                const int shift = image_filter_shift + 8;
+                const int64 full = color_type::full_value();
+                unsigned height = dst->height();
+                unsigned stride = width * 4;
+                unsigned row;
+                for(row = idx * strip_height; row < height;
+                    row += num * strip_height)
+                {
+                    unsigned end = row + strip_height;
+                    if(end > height) end = height;
+                    unsigned y;
+                    for(y = row; y < end; y++)
+                    {
+                        const int* src = &self->m_rows[(wy.start(y) - y1) * stride];
+                        const int* w0 = wy.weights(y);
+                        unsigned n0 = wy.num(y);
+                        value_type* p = (value_type*)dst->pix_ptr(0, y);
+                        unsigned x;
+                        for(x = 0; x < width; x++)
+                        {
+                            const int* s = src + x * 4;
+                            const int* w = w0;
+                            unsigned n = n0;
+                            int64 fg[4] = { 0, 0, 0, 0 };
+                            do
+                            {
+                                fg[0] += int64(*w) * s[0];
+                                fg[1] += int64(*w) * s[1];
+                                fg[2] += int64(*w) * s[2];
+                                fg[3] += int64(*w) * s[3];
+                                s += stride;
+                                ++w;
+                            }
+                            while(--n);
+
+                            int64 half = int64(1) << (shift - 1);
+                            int64 r = (fg[0] + half) >> shift;
+                            int64 g = (fg[1] + half) >> shift;
+                            int64 b = (fg[2] + half) >> shift;
+                            int64 a = (fg[3] + half) >> shift;
+                            if(r < 0) r = 0;
+                            if(g < 0) g = 0;
+                            if(b < 0) b = 0;
+                            if(a < 0) a = 0;
+                            if(a > full) a = full;
+                            if(r > a) r = a;
+                            if(g > a) g = a;
+                            if(b > a) b = a;
+
+                            p[order_type::R] = value_type(r);
+                            p[order_type::G] = value_type(g);
+                            p[order_type::B] = value_type(b);
+                            p[order_type::A] = value_type(a);
+                            p += 4;
+                        }
+                    }
+                }
+            }
+        };
+
+        //--------------------------------------------------------------------
+        image_resample_separable(const image_resample_separable&);
+        const image_resample_separable&
+            operator = (const image_resample_separable&);
+
+        const image_filter_lut* m_filter;
+        unsigned                m_num_threads;
+        double                  m_scale_limit;
+        double                  m_blur_x;
+        double                  m_blur_y;
+        resample_weight_table   m_wx;
+        resample_weight_table   m_wy;
+        pod_array<int>          m_rows;
+    };
+
+}
+
+#endif
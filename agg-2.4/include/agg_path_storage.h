@@ -20,13 +20,17 @@
 #include "agg_math.h"
 #include "agg_array.h"
 #include "agg_bezier_arc.h"
+#include "agg_trans_affine.h"
+#include "agg_vertex_batch.h"
 
 namespace agg
 {
 
 
     //----------------------------------------------------vertex_block_storage
-    template<class T, unsigned BlockShift=8, unsigned BlockPool=256>
+    // Allocator is pod_allocator or arena_allocator (agg_arena.h).
+    template<class T, unsigned BlockShift=8, unsigned BlockPool=256,
+             template<class> class Allocator=pod_allocator>
     class vertex_block_storage
     {
     public:
@@ -40,7 +44,7 @@ namespace agg
         };
 
         typedef T value_type;
-        typedef vertex_block_storage<T, BlockShift, BlockPool> self_type;
+        typedef vertex_block_storage<T, BlockShift, BlockPool, Allocator> self_type;
 
         ~vertex_block_storage();
         vertex_block_storage();
@@ -67,6 +71,38 @@ namespace agg
         unsigned vertex(unsigned idx, double* x, double* y) const;
         unsigned command(unsigned idx) const;
 
+        //--------------------------------------------------------------------
+        // Transforms the vertices in [start, end) with the vertex commands,
+        // the runs of them in the blocks go to transform_points() at once.
+        template<class Trans>
+        void transform_vertices(const Trans& trans, unsigned start, unsigned end)
+        {
+            while(start < end)
+            {
+                unsigned nb   = start >> block_shift;
+                unsigned i    = start & block_mask;
+                unsigned last = end - (nb << block_shift);
+                if(last > block_size) last = block_size;
+                T* coords = m_coord_blocks[nb];
+                const int8u* cmds = m_cmd_blocks[nb];
+                while(i < last)
+                {
+                    if(is_vertex(cmds[i]))
+                    {
+                        unsigned j = i + 1;
+                        while(j < last && is_vertex(cmds[j])) ++j;
+                        transform_points(trans, coords + (i << 1), j - i);
+                        i = j;
+                    }
+                    else
+                    {
+                        ++i;
+                    }
+                }
+                start = (nb + 1) << block_shift;
+            }
+        }
+
     private:
         void   allocate_block(unsigned nb);
         int8u* storage_ptrs(T** xy_ptr);
@@ -81,21 +117,21 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    void vertex_block_storage<T,S,P>::free_all()
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    void vertex_block_storage<T,S,P,A>::free_all()
     {
         if(m_total_blocks)
         {
             T** coord_blk = m_coord_blocks + m_total_blocks - 1;
             while(m_total_blocks--)
             {
-                pod_allocator<T>::deallocate(
+                A<T>::deallocate(
                     *coord_blk,
                     block_size * 2 + 
                     block_size / (sizeof(T) / sizeof(unsigned char)));
                 --coord_blk;
             }
-            pod_allocator<T*>::deallocate(m_coord_blocks, m_max_blocks * 2);
+            A<T*>::deallocate(m_coord_blocks, m_max_blocks * 2);
             m_total_blocks   = 0;
             m_max_blocks     = 0;
             m_coord_blocks   = 0;
@@ -105,15 +141,15 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    vertex_block_storage<T,S,P>::~vertex_block_storage()
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    vertex_block_storage<T,S,P,A>::~vertex_block_storage()
     {
         free_all();
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    vertex_block_storage<T,S,P>::vertex_block_storage() :
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    vertex_block_storage<T,S,P,A>::vertex_block_storage() :
         m_total_vertices(0),
         m_total_blocks(0),
         m_max_blocks(0),
@@ -123,8 +159,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    vertex_block_storage<T,S,P>::vertex_block_storage(const vertex_block_storage<T,S,P>& v) :
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    vertex_block_storage<T,S,P,A>::vertex_block_storage(const vertex_block_storage<T,S,P,A>& v) :
         m_total_vertices(0),
         m_total_blocks(0),
         m_max_blocks(0),
@@ -135,9 +171,9 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    const vertex_block_storage<T,S,P>& 
-    vertex_block_storage<T,S,P>::operator = (const vertex_block_storage<T,S,P>& v)
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    const vertex_block_storage<T,S,P,A>& 
+    vertex_block_storage<T,S,P,A>::operator = (const vertex_block_storage<T,S,P,A>& v)
     {
         remove_all();
         unsigned i;
@@ -151,15 +187,15 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline void vertex_block_storage<T,S,P>::remove_all()
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline void vertex_block_storage<T,S,P,A>::remove_all()
     {
         m_total_vertices = 0;
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline void vertex_block_storage<T,S,P>::add_vertex(double x, double y, 
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline void vertex_block_storage<T,S,P,A>::add_vertex(double x, double y, 
                                                         unsigned cmd)
     {
         T* coord_ptr = 0;
@@ -170,8 +206,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline void vertex_block_storage<T,S,P>::modify_vertex(unsigned idx, 
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline void vertex_block_storage<T,S,P,A>::modify_vertex(unsigned idx, 
                                                            double x, double y)
     {
         T* pv = m_coord_blocks[idx >> block_shift] + ((idx & block_mask) << 1);
@@ -180,8 +216,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline void vertex_block_storage<T,S,P>::modify_vertex(unsigned idx, 
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline void vertex_block_storage<T,S,P,A>::modify_vertex(unsigned idx, 
                                                            double x, double y, 
                                                            unsigned cmd)
     {
@@ -194,16 +230,16 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline void vertex_block_storage<T,S,P>::modify_command(unsigned idx, 
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline void vertex_block_storage<T,S,P,A>::modify_command(unsigned idx, 
                                                             unsigned cmd)
     {
         m_cmd_blocks[idx >> block_shift][idx & block_mask] = (int8u)cmd;
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline void vertex_block_storage<T,S,P>::swap_vertices(unsigned v1, unsigned v2)
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline void vertex_block_storage<T,S,P,A>::swap_vertices(unsigned v1, unsigned v2)
     {
         unsigned b1 = v1 >> block_shift;
         unsigned b2 = v2 >> block_shift;
@@ -220,32 +256,32 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline unsigned vertex_block_storage<T,S,P>::last_command() const
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline unsigned vertex_block_storage<T,S,P,A>::last_command() const
     {
         if(m_total_vertices) return command(m_total_vertices - 1);
         return path_cmd_stop;
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline unsigned vertex_block_storage<T,S,P>::last_vertex(double* x, double* y) const
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline unsigned vertex_block_storage<T,S,P,A>::last_vertex(double* x, double* y) const
     {
         if(m_total_vertices) return vertex(m_total_vertices - 1, x, y);
         return path_cmd_stop;
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline unsigned vertex_block_storage<T,S,P>::prev_vertex(double* x, double* y) const
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline unsigned vertex_block_storage<T,S,P,A>::prev_vertex(double* x, double* y) const
     {
         if(m_total_vertices > 1) return vertex(m_total_vertices - 2, x, y);
         return path_cmd_stop;
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline double vertex_block_storage<T,S,P>::last_x() const
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline double vertex_block_storage<T,S,P,A>::last_x() const
     {
         if(m_total_vertices)
         {
@@ -256,8 +292,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline double vertex_block_storage<T,S,P>::last_y() const
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline double vertex_block_storage<T,S,P,A>::last_y() const
     {
         if(m_total_vertices)
         {
@@ -268,15 +304,15 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline unsigned vertex_block_storage<T,S,P>::total_vertices() const
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline unsigned vertex_block_storage<T,S,P,A>::total_vertices() const
     {
         return m_total_vertices;
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline unsigned vertex_block_storage<T,S,P>::vertex(unsigned idx, 
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline unsigned vertex_block_storage<T,S,P,A>::vertex(unsigned idx, 
                                                         double* x, double* y) const
     {
         unsigned nb = idx >> block_shift;
@@ -287,20 +323,20 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    inline unsigned vertex_block_storage<T,S,P>::command(unsigned idx) const
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    inline unsigned vertex_block_storage<T,S,P,A>::command(unsigned idx) const
     {
         return m_cmd_blocks[idx >> block_shift][idx & block_mask];
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    void vertex_block_storage<T,S,P>::allocate_block(unsigned nb)
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    void vertex_block_storage<T,S,P,A>::allocate_block(unsigned nb)
     {
         if(nb >= m_max_blocks) 
         {
             T** new_coords = 
-                pod_allocator<T*>::allocate((m_max_blocks + block_pool) * 2);
+                A<T*>::allocate((m_max_blocks + block_pool) * 2);
 
             unsigned char** new_cmds = 
                 (unsigned char**)(new_coords + m_max_blocks + block_pool);
@@ -315,15 +351,15 @@ namespace agg
                        m_cmd_blocks, 
                        m_max_blocks * sizeof(unsigned char*));
 
-                pod_allocator<T*>::deallocate(m_coord_blocks, m_max_blocks * 2);
+                A<T*>::deallocate(m_coord_blocks, m_max_blocks * 2);
             }
             m_coord_blocks = new_coords;
             m_cmd_blocks   = new_cmds;
             m_max_blocks  += block_pool;
         }
         m_coord_blocks[nb] = 
-            pod_allocator<T>::allocate(block_size * 2 + 
-                   block_size / (sizeof(T) / sizeof(unsigned char)));
+            A<T>::allocate(block_size * 2 + 
+                           block_size / (sizeof(T) / sizeof(unsigned char)));
 
         m_cmd_blocks[nb]  = 
             (unsigned char*)(m_coord_blocks[nb] + block_size * 2);
@@ -332,8 +368,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class T, unsigned S, unsigned P>
-    int8u* vertex_block_storage<T,S,P>::storage_ptrs(T** xy_ptr)
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    int8u* vertex_block_storage<T,S,P,A>::storage_ptrs(T** xy_ptr)
     {
         unsigned nb = m_total_vertices >> block_shift;
         if(nb >= m_total_blocks)
@@ -592,6 +628,62 @@ namespace agg
 
 
 
+    template<class Container> class vertex_stl_storage;
+
+    //-------------------------------------------------path_vertex_transformer
+    // Transforms the vertices of a container from start to the end of
+    // the path, or to the end of the container if all_paths is true.
+    // Any container is transformed vertex by vertex with vertex() and
+    // modify_vertex(), the built-in ones use their transform_vertices().
+    //------------------------------------------------------------------------
+    template<class VertexContainer> struct path_vertex_transformer
+    {
+        template<class Trans>
+        static void transform(VertexContainer& vc, const Trans& trans,
+                              unsigned start, bool all_paths)
+        {
+            unsigned num_ver = vc.total_vertices();
+            for(; start < num_ver; start++)
+            {
+                double x, y;
+                unsigned cmd = vc.vertex(start, &x, &y);
+                if(is_stop(cmd) && !all_paths) break;
+                if(is_vertex(cmd))
+                {
+                    trans.transform(&x, &y);
+                    vc.modify_vertex(start, x, y);
+                }
+            }
+        }
+    };
+
+    //--------------------------------------------path_vertex_transformer_bulk
+    template<class VertexContainer> struct path_vertex_transformer_bulk
+    {
+        template<class Trans>
+        static void transform(VertexContainer& vc, const Trans& trans,
+                              unsigned start, bool all_paths)
+        {
+            unsigned end = vc.total_vertices();
+            if(!all_paths)
+            {
+                unsigned num_ver = end;
+                end = start;
+                while(end < num_ver && !is_stop(vc.command(end))) ++end;
+            }
+            vc.transform_vertices(trans, start, end);
+        }
+    };
+
+    template<class T, unsigned S, unsigned P, template<class> class A>
+    struct path_vertex_transformer<vertex_block_storage<T,S,P,A> > :
+        path_vertex_transformer_bulk<vertex_block_storage<T,S,P,A> > {};
+
+    template<class Container>
+    struct path_vertex_transformer<vertex_stl_storage<Container> > :
+        path_vertex_transformer_bulk<vertex_stl_storage<Container> > {};
+
+
     //---------------------------------------------------------------path_base
     // A container to store vertices with their flags. 
     // A path consists of a number of contours separated with "move_to" 
@@ -698,6 +790,9 @@ namespace agg
         void     rewind(unsigned path_id);
         unsigned vertex(double* x, double* y);
 
+        // The batched interface, see agg_vertex_batch.h
+        unsigned vertices(double* xy, unsigned* cmds, unsigned max);
+
         // Arrange the orientation of a polygon, all polygons in a path, 
         // or in all paths. After calling arrange_orientations() or 
         // arrange_orientations_all_paths(), all the polygons will have 
@@ -802,35 +897,16 @@ namespace agg
         template<class Trans>
         void transform(const Trans& trans, unsigned path_id=0)
         {
-            unsigned num_ver = m_vertices.total_vertices();
-            for(; path_id < num_ver; path_id++)
-            {
-                double x, y;
-                unsigned cmd = m_vertices.vertex(path_id, &x, &y);
-                if(is_stop(cmd)) break;
-                if(is_vertex(cmd))
-                {
-                    trans.transform(&x, &y);
-                    m_vertices.modify_vertex(path_id, x, y);
-                }
-            }
+            path_vertex_transformer<VertexContainer>::transform(m_vertices, trans,
+                                                                path_id, false);
         }
 
         //--------------------------------------------------------------------
         template<class Trans>
         void transform_all_paths(const Trans& trans)
         {
-            unsigned idx;
-            unsigned num_ver = m_vertices.total_vertices();
-            for(idx = 0; idx < num_ver; idx++)
-            {
-                double x, y;
-                if(is_vertex(m_vertices.vertex(idx, &x, &y)))
-                {
-                    trans.transform(&x, &y);
-                    m_vertices.modify_vertex(idx, x, y);
-                }
-            }
+            path_vertex_transformer<VertexContainer>::transform(m_vertices, trans,
+                                                                0, true);
         }
 
 
@@ -1246,6 +1322,29 @@ namespace agg
         return m_vertices.vertex(m_iterator++, x, y);
     }
 
+    //------------------------------------------------------------------------
+    template<class VC> 
+    inline unsigned path_base<VC>::vertices(double* xy, unsigned* cmds, unsigned max)
+    {
+        unsigned total = m_vertices.total_vertices();
+        unsigned n = 0;
+        while(n < max && m_iterator < total)
+        {
+            unsigned cmd = m_vertices.vertex(m_iterator++, xy, xy + 1);
+            if(is_stop(cmd)) break;
+            cmds[n++] = cmd;
+            xy += 2;
+        }
+        return n;
+    }
+
+    //------------------------------------------------------------------------
+    template<class VC> 
+    inline unsigned read_vertices(path_base<VC>& vs, double* xy, unsigned* cmds, unsigned max)
+    {
+        return vs.vertices(xy, cmds, max);
+    }
+
     //------------------------------------------------------------------------
     template<class VC> 
     unsigned path_base<VC>::perceive_polygon_orientation(unsigned start,
@@ -1552,6 +1651,23 @@ namespace agg
             return m_vertices[idx].cmd;
         }
 
+        template<class Trans>
+        void transform_vertices(const Trans& trans, unsigned start, unsigned end)
+        {
+            for(; start < end; start++)
+            {
+                vertex_type& v = m_vertices[start];
+                if(is_vertex(v.cmd))
+                {
+                    double x = v.x;
+                    double y = v.y;
+                    trans.transform(&x, &y);
+                    v.x = value_type(x);
+                    v.y = value_type(y);
+                }
+            }
+        }
+
     private:
         Container m_vertices;
     };
@@ -0,0 +1,201 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// The integer vertex pipeline.
+//
+// The vertex sources of the integer pipeline have the same interface
+// as the usual ones, but the coordinates are int in the subpixel units
+// of the rasterizer, that is, 24.8 fixed point (poly_subpixel_shift):
+//
+//   void     rewind(unsigned path_id);
+//   unsigned vertex(int* x, int* y);
+//
+// The pipeline is path_storage_int, conv_transform_int, conv_curve_int
+// and conv_stroke_int; rasterizer_scanline_aa::add_path_int() takes
+// the vertices without any conversion. A vertex takes 9 bytes instead
+// of 17 in path_storage.
+//
+// Unlike path_storage_integer (agg_path_storage_integer.h), which packs
+// the commands into the coordinates for the serialized glyph data and
+// gives double vertices, path_storage_int keeps all the path commands
+// and gives the integer ones.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_PATH_STORAGE_INT_INCLUDED
+#define AGG_PATH_STORAGE_INT_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_array.h"
+
+namespace agg
+{
+
+    //------------------------------------------------------------vertex_int
+    struct vertex_int
+    {
+        int32 x;
+        int32 y;
+
+        vertex_int() {}
+        vertex_int(int32 x_, int32 y_) : x(x_), y(y_) {}
+    };
+
+
+    //======================================================path_storage_int
+    // The path with the integer coordinates, 24.8 fixed point. The commands
+    // are the same as in path_storage: the curves are stored as their
+    // control points with path_cmd_curve3 and path_cmd_curve4 and
+    // flattened by conv_curve_int.
+    //------------------------------------------------------------------------
+    class path_storage_int
+    {
+    public:
+        enum coord_scale_e
+        {
+            coord_shift = poly_subpixel_shift,
+            coord_scale = 1 << coord_shift
+        };
+
+        //--------------------------------------------------------------------
+        path_storage_int() : m_iterator(0) {}
+
+        //--------------------------------------------------------------------
+        void remove_all() { m_coords.remove_all(); m_cmds.remove_all(); m_iterator = 0; }
+        void free_all()   { m_coords.free_all();   m_cmds.free_all();   m_iterator = 0; }
+
+        //--------------------------------------------------------------------
+        // Returns the index of the new path, the same as in path_storage
+        unsigned start_new_path()
+        {
+            if(!is_stop(last_command()))
+            {
+                add_vertex(0, 0, path_cmd_stop);
+            }
+            return total_vertices();
+        }
+
+        //--------------------------------------------------------------------
+        void move_to(int x, int y) { add_vertex(x, y, path_cmd_move_to); }
+        void line_to(int x, int y) { add_vertex(x, y, path_cmd_line_to); }
+
+        //--------------------------------------------------------------------
+        void curve3(int x_ctrl, int y_ctrl,
+                    int x_to,   int y_to)
+        {
+            add_vertex(x_ctrl, y_ctrl, path_cmd_curve3);
+            add_vertex(x_to,   y_to,   path_cmd_curve3);
+        }
+
+        //--------------------------------------------------------------------
+        void curve4(int x_ctrl1, int y_ctrl1,
+                    int x_ctrl2, int y_ctrl2,
+                    int x_to,    int y_to)
+        {
+            add_vertex(x_ctrl1, y_ctrl1, path_cmd_curve4);
+            add_vertex(x_ctrl2, y_ctrl2, path_cmd_curve4);
+            add_vertex(x_to,    y_to,    path_cmd_curve4);
+        }
+
+        //--------------------------------------------------------------------
+        void end_poly(unsigned flags = path_flags_close)
+        {
+            if(is_vertex(last_command()))
+            {
+                add_vertex(0, 0, path_cmd_end_poly | flags);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void close_polygon(unsigned flags = path_flags_none)
+        {
+            end_poly(path_flags_close | flags);
+        }
+
+        //--------------------------------------------------------------------
+        // Adds the vertices of a usual double vertex source, converting
+        // them to 24.8 fixed point.
+        template<class VertexSource>
+        void concat_path(VertexSource& vs, unsigned path_id = 0)
+        {
+            double x, y;
+            unsigned cmd;
+            vs.rewind(path_id);
+            while(!is_stop(cmd = vs.vertex(&x, &y)))
+            {
+                add_vertex(iround(x * coord_scale), iround(y * coord_scale), cmd);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void add_vertex(int x, int y, unsigned cmd)
+        {
+            m_coords.add(vertex_int(x, y));
+            m_cmds.add(int8u(cmd));
+        }
+
+        //--------------------------------------------------------------------
+        unsigned total_vertices() const { return m_coords.size(); }
+
+        unsigned last_command() const
+        {
+            return m_cmds.size() ? m_cmds[m_cmds.size() - 1] : unsigned(path_cmd_stop);
+        }
+
+        unsigned vertex(unsigned idx, int* x, int* y) const
+        {
+            const vertex_int& v = m_coords[idx];
+            *x = v.x;
+            *y = v.y;
+            return m_cmds[idx];
+        }
+
+        unsigned command(unsigned idx) const { return m_cmds[idx]; }
+
+        //--------------------------------------------------------------------
+        unsigned byte_size() const
+        {
+            return m_coords.size() * sizeof(vertex_int) + m_cmds.size();
+        }
+
+        //--------------------------------------------------------------------
+        void rewind(unsigned path_id) { m_iterator = path_id; }
+
+        unsigned vertex(int* x, int* y)
+        {
+            if(m_iterator >= m_coords.size()) return path_cmd_stop;
+            return vertex(m_iterator++, x, y);
+        }
+
+        //--------------------------------------------------------------------
+        // The double interface, for the usual converters and
+        // bounding_rect(). The coordinates are in pixels.
+        unsigned vertex(double* x, double* y)
+        {
+            int ix, iy;
+            unsigned cmd = vertex(&ix, &iy);
+            *x = double(ix) / coord_scale;
+            *y = double(iy) / coord_scale;
+            return cmd;
+        }
+
+    private:
+        pod_bvector<vertex_int, 8> m_coords;
+        pod_bvector<int8u, 8>      m_cmds;
+        unsigned                   m_iterator;
+    };
+
+}
+
+#endif
@@ -28,6 +28,7 @@
 #include <cmath>
 #include "agg_pixfmt_base.h"
 #include "agg_rendering_buffer.h"
+#include "agg_pixfmt_rgba_simd.h"
 
 namespace agg
 {
@@ -277,6 +278,65 @@ namespace agg
         }
     };
 
+    //====================================================blender_srgba_linear
+    // Blends sRGB colors into an sRGB buffer in linear light. The buffer 
+    // and the colors are decoded to 16-bit linear values with sRGB_conv,
+    // interpolated and encoded back, so the anti-aliased edges have 
+    // the right brightness, like with rgba16 or rgba32 buffers, at the 
+    // cost of a table lookup per component. The alpha is blended as in
+    // blender_rgba. The interpolation is exact for the opaque buffers,
+    // which is the usual case for text.
+    //
+    // pixfmt_alpha_blend_rgba blends the spans with AVX2, see 
+    // span_blender_srgba_linear; with SSE2 they are blended pixel by pixel.
+    template<class Order> 
+    struct blender_srgba_linear : conv_rgba_pre<srgba8, Order>
+    {
+        typedef srgba8 color_type;
+        typedef Order order_type;
+        typedef color_type::value_type value_type;
+        typedef color_type::calc_type calc_type;
+        typedef color_type::long_type long_type;
+
+        //--------------------------------------------------------------------
+        static AGG_INLINE void blend_pix(value_type* p, 
+            value_type cr, value_type cg, value_type cb, value_type alpha, cover_type cover)
+        {
+            blend_pix(p, cr, cg, cb, color_type::mult_cover(alpha, cover));
+        }
+        
+        //--------------------------------------------------------------------
+        static AGG_INLINE void blend_pix(value_type* p, 
+            value_type cr, value_type cg, value_type cb, value_type alpha)
+        {
+            if(alpha)
+            {
+                unsigned ia = (color_type::base_mask - alpha) * 257;
+                p[Order::R] = blend_linear(p[Order::R], cr, ia);
+                p[Order::G] = blend_linear(p[Order::G], cg, ia);
+                p[Order::B] = blend_linear(p[Order::B], cb, ia);
+                p[Order::A] = color_type::prelerp(p[Order::A], alpha, alpha);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // q + (p - q) * ia, where ia is 1 - alpha in 16 bits. Interpolating
+        // from the color gives exactly the color for the opaque pixels.
+        static AGG_INLINE int16u lerp_linear(int16u p, int16u q, unsigned ia)
+        {
+            return int16u((q >= p) ? q - (((q - p) * ia) >> 16) : 
+                                     q + (((p - q) * ia) >> 16));
+        }
+
+        //--------------------------------------------------------------------
+        static AGG_INLINE value_type blend_linear(value_type p, value_type q, unsigned ia)
+        {
+            return sRGB_conv<int16u>::rgb_to_sRGB(
+                lerp_linear(sRGB_conv<int16u>::rgb_from_sRGB(p),
+                            sRGB_conv<int16u>::rgb_from_sRGB(q), ia));
+        }
+    };
+
     // SVG compositing operations.
     // For specifications, see http://www.w3.org/TR/SVGCompositing/
 
@@ -1511,6 +1571,7 @@ namespace agg
         typedef Blender  blender_type;
         typedef typename blender_type::color_type color_type;
         typedef typename blender_type::order_type order_type;
+        typedef span_blender_rgba<Blender> span_blender_type;
         typedef typename color_type::value_type value_type;
         typedef typename color_type::calc_type calc_type;
         enum 
@@ -1854,6 +1915,11 @@ namespace agg
             if (!c.is_transparent())
             {
                 pixel_type* p = pix_value_ptr(x, y, len);
+                unsigned n = span_blender_type::blend_solid_hspan(p->c, len, c, covers);
+                if (n == len) return;
+                p = p->advance(n);
+                covers += n;
+                len -= n;
                 do 
                 {
                     if (c.is_opaque() && *covers == cover_mask)
@@ -1932,8 +1998,14 @@ namespace agg
                                int8u cover)
         {
             pixel_type* p = pix_value_ptr(x, y, len);
+            unsigned n = span_blender_type::blend_color_hspan(p->c, len, colors, covers, cover);
+            if (n == len) return;
+            p = p->advance(n);
+            colors += n;
+            len -= n;
             if (covers)
             {
+                covers += n;
                 do 
                 {
                     copy_or_blend_pix(p, *colors++, *covers++);
@@ -2685,6 +2757,11 @@ namespace agg
     typedef blender_rgba<srgba8, order_abgr> blender_sabgr32;
     typedef blender_rgba<srgba8, order_bgra> blender_sbgra32;
 
+    typedef blender_srgba_linear<order_rgba> blender_srgba32_linear;
+    typedef blender_srgba_linear<order_argb> blender_sargb32_linear;
+    typedef blender_srgba_linear<order_abgr> blender_sabgr32_linear;
+    typedef blender_srgba_linear<order_bgra> blender_sbgra32_linear;
+
     typedef blender_rgba_pre<rgba8, order_rgba> blender_rgba32_pre;
     typedef blender_rgba_pre<rgba8, order_argb> blender_argb32_pre;
     typedef blender_rgba_pre<rgba8, order_abgr> blender_abgr32_pre;
@@ -2747,6 +2824,11 @@ namespace agg
     typedef pixfmt_alpha_blend_rgba<blender_sabgr32, rendering_buffer> pixfmt_sabgr32;
     typedef pixfmt_alpha_blend_rgba<blender_sbgra32, rendering_buffer> pixfmt_sbgra32;
 
+    typedef pixfmt_alpha_blend_rgba<blender_srgba32_linear, rendering_buffer> pixfmt_srgba32_linear;
+    typedef pixfmt_alpha_blend_rgba<blender_sargb32_linear, rendering_buffer> pixfmt_sargb32_linear;
+    typedef pixfmt_alpha_blend_rgba<blender_sabgr32_linear, rendering_buffer> pixfmt_sabgr32_linear;
+    typedef pixfmt_alpha_blend_rgba<blender_sbgra32_linear, rendering_buffer> pixfmt_sbgra32_linear;
+
     typedef pixfmt_alpha_blend_rgba<blender_rgba32_pre, rendering_buffer> pixfmt_rgba32_pre;
     typedef pixfmt_alpha_blend_rgba<blender_argb32_pre, rendering_buffer> pixfmt_argb32_pre;
     typedef pixfmt_alpha_blend_rgba<blender_abgr32_pre, rendering_buffer> pixfmt_abgr32_pre;
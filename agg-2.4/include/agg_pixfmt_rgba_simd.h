@@ -0,0 +1,689 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Span blending with SSE2/AVX2 for the 8-bit RGBA pixel formats,
+// including the sRGB ones blended in linear light.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_PIXFMT_RGBA_SIMD_INCLUDED
+#define AGG_PIXFMT_RGBA_SIMD_INCLUDED
+
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_color_rgba.h"
+#include "agg_simd.h"
+
+namespace agg
+{
+    template<class ColorT, class Order> struct blender_rgba;
+    template<class ColorT, class Order> struct blender_rgba_pre;
+    template<class Order> struct blender_srgba_linear;
+
+    //=====================================================span_blender_rgba
+    // Blends whole spans for pixfmt_alpha_blend_rgba. The functions process
+    // some number of pixels from the beginning of the span and return this
+    // number, the pixfmt blends the rest pixel by pixel with the Blender.
+    // The generic version doesn't process anything.
+    //------------------------------------------------------------------------
+    template<class Blender> struct span_blender_rgba
+    {
+        template<class T, class ColorT>
+        static unsigned blend_solid_hspan(T*, unsigned, const ColorT&,
+                                          const int8u*)
+        {
+            return 0;
+        }
+
+        template<class T, class ColorT>
+        static unsigned blend_color_hspan(T*, unsigned, const ColorT*,
+                                          const int8u*, unsigned)
+        {
+            return 0;
+        }
+    };
+
+
+    //====================================================span_blender_rgba8
+    // Vectorized versions of blender_rgba (Pre=false) and blender_rgba_pre
+    // (Pre=true) for 8-bit colors, 4 pixels per iteration with SSE2 and 8
+    // with AVX2. The components are expanded to 16 bits and the arithmetic
+    // reproduces rgba8T::multiply(), lerp() and prelerp() exactly, so the
+    // result is bit-identical to the per-pixel blending, including
+    // the wrap-around for the non-premultiplied colors in blender_rgba_pre.
+    // lerp(p, q, a) is computed as p + multiply(q - p, a) if q > p and
+    // p - multiply(p - q, a) otherwise, which is the same in integers.
+    //
+    // Without SSE2 nothing is processed. A port to other instruction sets,
+    // such as NEON, only needs the same 16-bit operations: multiply-low,
+    // add, subtract, saturated subtract, shift and a 4x16 shuffle.
+    //------------------------------------------------------------------------
+    template<class Order, bool Pre> struct span_blender_rgba8
+    {
+        enum order_e
+        {
+            // For every position in the pixel, the index of the component
+            // in rgba8T, that is, r=0, g=1, b=2, a=3.
+            src0 = (Order::R == 0) ? 0 : (Order::G == 0) ? 1 : (Order::B == 0) ? 2 : 3,
+            src1 = (Order::R == 1) ? 0 : (Order::G == 1) ? 1 : (Order::B == 1) ? 2 : 3,
+            src2 = (Order::R == 2) ? 0 : (Order::G == 2) ? 1 : (Order::B == 2) ? 2 : 3,
+            src3 = (Order::R == 3) ? 0 : (Order::G == 3) ? 1 : (Order::B == 3) ? 2 : 3,
+
+            shuffle_color = (src3 << 6) | (src2 << 4) | (src1 << 2) | src0,
+            shuffle_alpha = Order::A * 0x55,
+            shuffle_none  = 0xE4
+        };
+
+        //--------------------------------------------------------------------
+        template<class ColorT>
+        static unsigned blend_solid_hspan(int8u* p, unsigned len,
+                                          const ColorT& c, const int8u* covers)
+        {
+            int8u color[4];
+            color[Order::R] = c.r;
+            color[Order::G] = c.g;
+            color[Order::B] = c.b;
+            color[Order::A] = c.a;
+            switch(simd_level())
+            {
+#if defined(AGG_SIMD_AVX2)
+            case simd_avx2: return blend_solid_hspan_avx2(p, len, color, covers);
+#endif
+#if defined(AGG_SIMD_SSE2)
+            case simd_sse2: return blend_solid_hspan_sse2(p, len, color, covers);
+#endif
+            default: break;
+            }
+            return 0;
+        }
+
+        //--------------------------------------------------------------------
+        // The colors must be 4 consecutive bytes r, g, b, a.
+        template<class ColorT>
+        static unsigned blend_color_hspan(int8u* p, unsigned len,
+                                          const ColorT* colors,
+                                          const int8u* covers, unsigned cover)
+        {
+            switch(simd_level())
+            {
+#if defined(AGG_SIMD_AVX2)
+            case simd_avx2:
+                return blend_color_hspan_avx2(p, len, (const int8u*)colors,
+                                              covers, cover);
+#endif
+#if defined(AGG_SIMD_SSE2)
+            case simd_sse2:
+                return blend_color_hspan_sse2(p, len, (const int8u*)colors,
+                                              covers, cover);
+#endif
+            default: break;
+            }
+            return 0;
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        static int32u load4(const int8u* p)
+        {
+            int32u v;
+            memcpy(&v, p, 4);
+            return v;
+        }
+
+        //--------------------------------------------------------------------
+        static int64u load8(const int8u* p)
+        {
+            int64u v;
+            memcpy(&v, p, 8);
+            return v;
+        }
+
+        //--------------------------------------------------------------------
+        // 0xFF in the alpha component of every pixel
+        static int32u alpha_mask32()
+        {
+            int8u m[4] = { 0, 0, 0, 0 };
+            m[Order::A] = 0xFF;
+            return load4(m);
+        }
+
+#if defined(AGG_SIMD_SSE2)
+        //--------------------------------------------------------------------
+        static AGG_INLINE __m128i multiply_sse2(__m128i a, __m128i b)
+        {
+            __m128i t = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+            return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+        }
+
+        //--------------------------------------------------------------------
+        static AGG_INLINE __m128i alpha_sse2(__m128i c)
+        {
+            return _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, shuffle_alpha),
+                                       shuffle_alpha);
+        }
+
+        //--------------------------------------------------------------------
+        static AGG_INLINE __m128i order_sse2(__m128i c)
+        {
+            if(shuffle_color == shuffle_none) return c;
+            return _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, shuffle_color),
+                                       shuffle_color);
+        }
+
+        //--------------------------------------------------------------------
+        // Two pixels p, two colors c and the covers, expanded to 16 bits.
+        // amask has 0xFFFF in the alpha component.
+        static AGG_INLINE __m128i blend_sse2(__m128i p, __m128i c,
+                                             __m128i cover, __m128i amask)
+        {
+            if(Pre)
+            {
+                c = multiply_sse2(c, cover);
+                __m128i r = _mm_sub_epi16(_mm_add_epi16(p, c),
+                                          multiply_sse2(p, alpha_sse2(c)));
+                return _mm_and_si128(r, _mm_set1_epi16(0xFF));
+            }
+            __m128i a = multiply_sse2(alpha_sse2(c), cover);
+            __m128i r = _mm_sub_epi16(
+                            _mm_add_epi16(p, multiply_sse2(_mm_subs_epu16(c, p), a)),
+                            multiply_sse2(_mm_subs_epu16(p, c), a));
+            __m128i ra = _mm_sub_epi16(_mm_add_epi16(p, a), multiply_sse2(p, a));
+            return _mm_or_si128(_mm_and_si128(amask, ra),
+                                _mm_andnot_si128(amask, r));
+        }
+
+        //--------------------------------------------------------------------
+        // Expands 4 covers to 16 bits, one per component, for pixels 0,1
+        // and 2,3 respectively.
+        static AGG_INLINE void covers_sse2(int32u covers, __m128i& lo, __m128i& hi)
+        {
+            __m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(int(covers)),
+                                          _mm_setzero_si128());
+            v  = _mm_unpacklo_epi16(v, v);
+            lo = _mm_unpacklo_epi32(v, v);
+            hi = _mm_unpackhi_epi32(v, v);
+        }
+
+        //--------------------------------------------------------------------
+        static unsigned blend_solid_hspan_sse2(int8u* p, unsigned len,
+                                               const int8u* color,
+                                               const int8u* covers)
+        {
+            unsigned n = len & ~3u;
+            __m128i zero  = _mm_setzero_si128();
+            __m128i c8    = _mm_set1_epi32(int(load4(color)));
+            __m128i c     = _mm_unpacklo_epi8(c8, zero);
+            __m128i amask = _mm_unpacklo_epi8(_mm_set1_epi32(int(alpha_mask32())),
+                                              _mm_set1_epi32(int(alpha_mask32())));
+            bool opaque = color[Order::A] == 0xFF;
+            unsigned i;
+            for(i = 0; i < n; i += 4, p += 16, covers += 4)
+            {
+                int32u cv = load4(covers);
+                if(cv == 0) continue;
+                if(opaque && cv == 0xFFFFFFFF)
+                {
+                    _mm_storeu_si128((__m128i*)p, c8);
+                    continue;
+                }
+                __m128i cov_lo, cov_hi;
+                covers_sse2(cv, cov_lo, cov_hi);
+                __m128i px = _mm_loadu_si128((const __m128i*)p);
+                __m128i lo = blend_sse2(_mm_unpacklo_epi8(px, zero), c, cov_lo, amask);
+                __m128i hi = blend_sse2(_mm_unpackhi_epi8(px, zero), c, cov_hi, amask);
+                _mm_storeu_si128((__m128i*)p, _mm_packus_epi16(lo, hi));
+            }
+            return n;
+        }
+
+        //--------------------------------------------------------------------
+        static unsigned blend_color_hspan_sse2(int8u* p, unsigned len,
+                                               const int8u* colors,
+                                               const int8u* covers,
+                                               unsigned cover)
+        {
+            unsigned n = len & ~3u;
+            __m128i zero  = _mm_setzero_si128();
+            __m128i ones  = _mm_set1_epi8(char(0xFF));
+            __m128i amask = _mm_unpacklo_epi8(_mm_set1_epi32(int(alpha_mask32())),
+                                              _mm_set1_epi32(int(alpha_mask32())));
+            int32u cv = cover * 0x01010101u;
+            unsigned i;
+            for(i = 0; i < n; i += 4, p += 16, colors += 16)
+            {
+                if(covers)
+                {
+                    cv = load4(covers);
+                    covers += 4;
+                }
+                if(cv == 0) continue;
+
+                // Alpha is byte 3 of every rgba8T color
+                __m128i cols = _mm_loadu_si128((const __m128i*)colors);
+                if((_mm_movemask_epi8(_mm_cmpeq_epi8(cols, zero)) & 0x8888) == 0x8888)
+                {
+                    continue;
+                }
+                __m128i c_lo = order_sse2(_mm_unpacklo_epi8(cols, zero));
+                __m128i c_hi = order_sse2(_mm_unpackhi_epi8(cols, zero));
+                if(cv == 0xFFFFFFFF &&
+                   (_mm_movemask_epi8(_mm_cmpeq_epi8(cols, ones)) & 0x8888) == 0x8888)
+                {
+                    _mm_storeu_si128((__m128i*)p, _mm_packus_epi16(c_lo, c_hi));
+                    continue;
+                }
+                __m128i cov_lo, cov_hi;
+                covers_sse2(cv, cov_lo, cov_hi);
+                __m128i px = _mm_loadu_si128((const __m128i*)p);
+                __m128i p_lo = _mm_unpacklo_epi8(px, zero);
+                __m128i p_hi = _mm_unpackhi_epi8(px, zero);
+                __m128i lo = blend_sse2(p_lo, c_lo, cov_lo, amask);
+                __m128i hi = blend_sse2(p_hi, c_hi, cov_hi, amask);
+                if(Pre)
+                {
+                    // The transparent colors are skipped, which isn't the
+                    // same as blending if they are not premultiplied.
+                    __m128i t_lo = _mm_cmpeq_epi16(alpha_sse2(c_lo), zero);
+                    __m128i t_hi = _mm_cmpeq_epi16(alpha_sse2(c_hi), zero);
+                    lo = _mm_or_si128(_mm_and_si128(t_lo, p_lo), _mm_andnot_si128(t_lo, lo));
+                    hi = _mm_or_si128(_mm_and_si128(t_hi, p_hi), _mm_andnot_si128(t_hi, hi));
+                }
+                _mm_storeu_si128((__m128i*)p, _mm_packus_epi16(lo, hi));
+            }
+            return n;
+        }
+#endif
+
+#if defined(AGG_SIMD_AVX2)
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static AGG_INLINE __m256i multiply_avx2(__m256i a, __m256i b)
+        {
+            __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(a, b),
+                                         _mm256_set1_epi16(128));
+            return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+        }
+
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static AGG_INLINE __m256i alpha_avx2(__m256i c)
+        {
+            return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(c, shuffle_alpha),
+                                          shuffle_alpha);
+        }
+
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static AGG_INLINE __m256i order_avx2(__m256i c)
+        {
+            if(shuffle_color == shuffle_none) return c;
+            return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(c, shuffle_color),
+                                          shuffle_color);
+        }
+
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static AGG_INLINE __m256i blend_avx2(__m256i p, __m256i c,
+                                             __m256i cover, __m256i amask)
+        {
+            if(Pre)
+            {
+                c = multiply_avx2(c, cover);
+                __m256i r = _mm256_sub_epi16(_mm256_add_epi16(p, c),
+                                             multiply_avx2(p, alpha_avx2(c)));
+                return _mm256_and_si256(r, _mm256_set1_epi16(0xFF));
+            }
+            __m256i a = multiply_avx2(alpha_avx2(c), cover);
+            __m256i r = _mm256_sub_epi16(
+                            _mm256_add_epi16(p, multiply_avx2(_mm256_subs_epu16(c, p), a)),
+                            multiply_avx2(_mm256_subs_epu16(p, c), a));
+            __m256i ra = _mm256_sub_epi16(_mm256_add_epi16(p, a), multiply_avx2(p, a));
+            return _mm256_or_si256(_mm256_and_si256(amask, ra),
+                                   _mm256_andnot_si256(amask, r));
+        }
+
+        //--------------------------------------------------------------------
+        // The unpacking works within the 128-bit halves, so the low part
+        // gets pixels 0,1,4,5 and the high part gets pixels 2,3,6,7.
+        AGG_SIMD_TARGET_AVX2
+        static AGG_INLINE void covers_avx2(int64u covers, __m256i& lo, __m256i& hi)
+        {
+            __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)&covers),
+                                          _mm_setzero_si128());
+            __m256i w = _mm256_inserti128_si256(
+                            _mm256_castsi128_si256(_mm_unpacklo_epi16(v, v)),
+                            _mm_unpackhi_epi16(v, v), 1);
+            lo = _mm256_unpacklo_epi32(w, w);
+            hi = _mm256_unpackhi_epi32(w, w);
+        }
+
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static unsigned blend_solid_hspan_avx2(int8u* p, unsigned len,
+                                               const int8u* color,
+                                               const int8u* covers)
+        {
+            unsigned n = len & ~7u;
+            __m256i zero  = _mm256_setzero_si256();
+            __m256i c8    = _mm256_set1_epi32(int(load4(color)));
+            __m256i c     = _mm256_unpacklo_epi8(c8, zero);
+            __m256i amask = _mm256_unpacklo_epi8(_mm256_set1_epi32(int(alpha_mask32())),
+                                                 _mm256_set1_epi32(int(alpha_mask32())));
+            bool opaque = color[Order::A] == 0xFF;
+            unsigned i;
+            for(i = 0; i < n; i += 8, p += 32, covers += 8)
+            {
+                int64u cv = load8(covers);
+                if(cv == 0) continue;
+                if(opaque && cv == ~int64u(0))
+                {
+                    _mm256_storeu_si256((__m256i*)p, c8);
+                    continue;
+                }
+                __m256i cov_lo, cov_hi;
+                covers_avx2(cv, cov_lo, cov_hi);
+                __m256i px = _mm256_loadu_si256((const __m256i*)p);
+                __m256i lo = blend_avx2(_mm256_unpacklo_epi8(px, zero), c, cov_lo, amask);
+                __m256i hi = blend_avx2(_mm256_unpackhi_epi8(px, zero), c, cov_hi, amask);
+                _mm256_storeu_si256((__m256i*)p, _mm256_packus_epi16(lo, hi));
+            }
+            _mm256_zeroupper();
+            return n + blend_solid_hspan_sse2(p, len - n, color, covers);
+        }
+
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static unsigned blend_color_hspan_avx2(int8u* p, unsigned len,
+                                               const int8u* colors,
+                                               const int8u* covers,
+                                               unsigned cover)
+        {
+            unsigned n = len & ~7u;
+            __m256i zero  = _mm256_setzero_si256();
+            __m256i ones  = _mm256_set1_epi8(char(0xFF));
+            __m256i amask = _mm256_unpacklo_epi8(_mm256_set1_epi32(int(alpha_mask32())),
+                                                 _mm256_set1_epi32(int(alpha_mask32())));
+            int64u cv = cover * int64u(0x0101010101010101ULL);
+            unsigned i;
+            for(i = 0; i < n; i += 8, p += 32, colors += 32)
+            {
+                if(covers)
+                {
+                    cv = load8(covers);
+                    covers += 8;
+                }
+                if(cv == 0) continue;
+
+                __m256i cols = _mm256_loadu_si256((const __m256i*)colors);
+                if((unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(cols, zero))) & 0x88888888u) ==
+                   0x88888888u)
+                {
+                    continue;
+                }
+                __m256i c_lo = order_avx2(_mm256_unpacklo_epi8(cols, zero));
+                __m256i c_hi = order_avx2(_mm256_unpackhi_epi8(cols, zero));
+                if(cv == ~int64u(0) &&
+                   (unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(cols, ones))) & 0x88888888u) ==
+                   0x88888888u)
+                {
+                    _mm256_storeu_si256((__m256i*)p, _mm256_packus_epi16(c_lo, c_hi));
+                    continue;
+                }
+                __m256i cov_lo, cov_hi;
+                covers_avx2(cv, cov_lo, cov_hi);
+                __m256i px = _mm256_loadu_si256((const __m256i*)p);
+                __m256i p_lo = _mm256_unpacklo_epi8(px, zero);
+                __m256i p_hi = _mm256_unpackhi_epi8(px, zero);
+                __m256i lo = blend_avx2(p_lo, c_lo, cov_lo, amask);
+                __m256i hi = blend_avx2(p_hi, c_hi, cov_hi, amask);
+                if(Pre)
+                {
+                    __m256i t_lo = _mm256_cmpeq_epi16(alpha_avx2(c_lo), zero);
+                    __m256i t_hi = _mm256_cmpeq_epi16(alpha_avx2(c_hi), zero);
+                    lo = _mm256_or_si256(_mm256_and_si256(t_lo, p_lo),
+                                         _mm256_andnot_si256(t_lo, lo));
+                    hi = _mm256_or_si256(_mm256_and_si256(t_hi, p_hi),
+                                         _mm256_andnot_si256(t_hi, hi));
+                }
+                _mm256_storeu_si256((__m256i*)p, _mm256_packus_epi16(lo, hi));
+            }
+            _mm256_zeroupper();
+            return n + blend_color_hspan_sse2(p, len - n, colors, covers,
+                                              cover);
+        }
+#endif
+    };
+
+
+    //=============================================span_blender_srgba_linear
+    // Spans for blender_srgba_linear with AVX2, 8 pixels per iteration. 
+    // The table lookups are done with the gather instructions; the tables
+    // are the same as in sRGB_lut<int16u>, widened to 32 bits, and the 
+    // arithmetic is that of blender_srgba_linear::lerp_linear(), so the 
+    // result is bit-identical to the per-pixel blending. Without the 
+    // gathers the lookups dominate and can't be vectorized, so with SSE2
+    // the spans are blended pixel by pixel.
+    //------------------------------------------------------------------------
+    template<class Order> struct span_blender_srgba_linear
+    {
+        typedef srgba8 color_type;
+
+        //--------------------------------------------------------------------
+        static unsigned blend_solid_hspan(int8u* p, unsigned len,
+                                          const color_type& c, 
+                                          const int8u* covers)
+        {
+            switch(simd_level())
+            {
+#if defined(AGG_SIMD_AVX2)
+            case simd_avx2: return blend_solid_hspan_avx2(p, len, c, covers);
+#endif
+            default: break;
+            }
+            return 0;
+        }
+
+        //--------------------------------------------------------------------
+        static unsigned blend_color_hspan(int8u* p, unsigned len,
+                                          const color_type* colors,
+                                          const int8u* covers, 
+                                          unsigned cover)
+        {
+            switch(simd_level())
+            {
+#if defined(AGG_SIMD_AVX2)
+            case simd_avx2: 
+                return blend_color_hspan_avx2(p, len, (const int8u*)colors, 
+                                              covers, cover);
+#endif
+            default: break;
+            }
+            return 0;
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        struct lut_type
+        {
+            int32 dir[256];
+            int32 inv[257];
+            int32 index[4096];
+
+            lut_type()
+            {
+                unsigned i;
+                dir[0] = 0;
+                inv[0] = 0;
+                for(i = 1; i < 256; i++)
+                {
+                    dir[i] = uround(65535.0 * sRGB_to_linear(i / 255.0));
+                    inv[i] = uround(65535.0 * sRGB_to_linear((i - 0.5) / 255.0));
+                }
+                inv[256] = 65536;
+                unsigned x = 0;
+                for(i = 0; i < 4096; i++)
+                {
+                    while(int32(i << 4) > inv[x + 1]) ++x;
+                    index[i] = x;
+                }
+            }
+        };
+
+        static const lut_type& lut()
+        {
+            static lut_type l;
+            return l;
+        }
+
+#if defined(AGG_SIMD_AVX2)
+        //--------------------------------------------------------------------
+        // rgba8T::multiply() in 32-bit lanes
+        AGG_SIMD_TARGET_AVX2
+        static AGG_INLINE __m256i multiply_avx2(__m256i a, __m256i b)
+        {
+            __m256i t = _mm256_add_epi32(_mm256_mullo_epi32(a, b), 
+                                         _mm256_set1_epi32(128));
+            return _mm256_srli_epi32(_mm256_add_epi32(t, _mm256_srli_epi32(t, 8)), 8);
+        }
+
+        //--------------------------------------------------------------------
+        // Blends one component of 8 pixels: p and q are the sRGB values 
+        // in 32-bit lanes, ia is 1 - alpha in 16 bits. Returns the result
+        // in the lanes.
+        AGG_SIMD_TARGET_AVX2
+        static AGG_INLINE __m256i blend_avx2(const lut_type& l, 
+                                             __m256i p, __m256i q, __m256i ia)
+        {
+            __m256i zero = _mm256_setzero_si256();
+            __m256i lp = _mm256_i32gather_epi32((const int*)l.dir, p, 4);
+            __m256i lq = _mm256_i32gather_epi32((const int*)l.dir, q, 4);
+            __m256i d  = _mm256_sub_epi32(lp, lq);
+            __m256i up = _mm256_srli_epi32(
+                            _mm256_mullo_epi32(_mm256_max_epi32(d, zero), ia), 16);
+            __m256i dn = _mm256_srli_epi32(
+                            _mm256_mullo_epi32(_mm256_max_epi32(_mm256_sub_epi32(zero, d), zero), ia), 16);
+            __m256i r  = _mm256_sub_epi32(_mm256_add_epi32(lq, up), dn);
+            __m256i x  = _mm256_i32gather_epi32((const int*)l.index, 
+                                                _mm256_srli_epi32(r, 4), 4);
+            __m256i t  = _mm256_i32gather_epi32((const int*)(l.inv + 1), x, 4);
+            return _mm256_sub_epi32(x, _mm256_cmpgt_epi32(r, t));
+        }
+
+        //--------------------------------------------------------------------
+        // Blends 8 pixels px with the colors given by their components 
+        // cr, cg, cb in 32-bit lanes and the alpha a multiplied by cover.
+        // The pixels with zero alpha stay the same.
+        AGG_SIMD_TARGET_AVX2
+        static AGG_INLINE __m256i blend_pix_avx2(const lut_type& l, __m256i px,
+                                                 __m256i cr, __m256i cg, 
+                                                 __m256i cb, __m256i a)
+        {
+            __m256i mask = _mm256_set1_epi32(0xFF);
+            __m256i ia = _mm256_mullo_epi32(_mm256_sub_epi32(mask, a), 
+                                            _mm256_set1_epi32(257));
+            __m256i pr = _mm256_and_si256(_mm256_srli_epi32(px, Order::R * 8), mask);
+            __m256i pg = _mm256_and_si256(_mm256_srli_epi32(px, Order::G * 8), mask);
+            __m256i pb = _mm256_and_si256(_mm256_srli_epi32(px, Order::B * 8), mask);
+            __m256i pa = _mm256_and_si256(_mm256_srli_epi32(px, Order::A * 8), mask);
+            pa = _mm256_sub_epi32(_mm256_add_epi32(pa, a), multiply_avx2(pa, a));
+            __m256i r = _mm256_or_si256(
+                _mm256_or_si256(_mm256_slli_epi32(blend_avx2(l, pr, cr, ia), Order::R * 8),
+                                _mm256_slli_epi32(blend_avx2(l, pg, cg, ia), Order::G * 8)),
+                _mm256_or_si256(_mm256_slli_epi32(blend_avx2(l, pb, cb, ia), Order::B * 8),
+                                _mm256_slli_epi32(pa, Order::A * 8)));
+            __m256i keep = _mm256_cmpeq_epi32(a, _mm256_setzero_si256());
+            return _mm256_blendv_epi8(r, px, keep);
+        }
+
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static unsigned blend_solid_hspan_avx2(int8u* p, unsigned len,
+                                               const color_type& c,
+                                               const int8u* covers)
+        {
+            const lut_type& l = lut();
+            unsigned n = len & ~7u;
+            __m256i cr = _mm256_set1_epi32(c.r);
+            __m256i cg = _mm256_set1_epi32(c.g);
+            __m256i cb = _mm256_set1_epi32(c.b);
+            __m256i ca = _mm256_set1_epi32(c.a);
+            unsigned i;
+            for(i = 0; i < n; i += 8, p += 32, covers += 8)
+            {
+                int64u cv;
+                memcpy(&cv, covers, 8);
+                if(cv == 0) continue;
+                __m256i a  = multiply_avx2(
+                    _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)covers)), ca);
+                __m256i px = _mm256_loadu_si256((const __m256i*)p);
+                _mm256_storeu_si256((__m256i*)p, blend_pix_avx2(l, px, cr, cg, cb, a));
+            }
+            _mm256_zeroupper();
+            return n;
+        }
+
+        //--------------------------------------------------------------------
+        // The colors must be 4 consecutive bytes r, g, b, a.
+        AGG_SIMD_TARGET_AVX2
+        static unsigned blend_color_hspan_avx2(int8u* p, unsigned len,
+                                               const int8u* colors,
+                                               const int8u* covers,
+                                               unsigned cover)
+        {
+            const lut_type& l = lut();
+            unsigned n = len & ~7u;
+            __m256i mask = _mm256_set1_epi32(0xFF);
+            __m256i cv = _mm256_set1_epi32(cover);
+            unsigned i;
+            for(i = 0; i < n; i += 8, p += 32, colors += 32)
+            {
+                if(covers)
+                {
+                    cv = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)covers));
+                    covers += 8;
+                }
+                __m256i cols = _mm256_loadu_si256((const __m256i*)colors);
+                __m256i a = multiply_avx2(_mm256_srli_epi32(cols, 24), cv);
+                if(_mm256_testz_si256(a, a)) continue;
+                __m256i px = _mm256_loadu_si256((const __m256i*)p);
+                _mm256_storeu_si256((__m256i*)p, 
+                    blend_pix_avx2(l, px, 
+                                   _mm256_and_si256(cols, mask),
+                                   _mm256_and_si256(_mm256_srli_epi32(cols, 8), mask),
+                                   _mm256_and_si256(_mm256_srli_epi32(cols, 16), mask),
+                                   a));
+            }
+            _mm256_zeroupper();
+            return n;
+        }
+#endif
+    };
+
+
+    //------------------------------------------------------------------------
+    template<class Colorspace, class Order>
+    struct span_blender_rgba<blender_rgba<rgba8T<Colorspace>, Order> > :
+        span_blender_rgba8<Order, false> {};
+
+    template<class Colorspace, class Order>
+    struct span_blender_rgba<blender_rgba_pre<rgba8T<Colorspace>, Order> > :
+        span_blender_rgba8<Order, true> {};
+
+    template<class Order>
+    struct span_blender_rgba<blender_srgba_linear<Order> > :
+        span_blender_srgba_linear<Order> {};
+
+}
+
+#endif
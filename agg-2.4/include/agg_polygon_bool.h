@@ -0,0 +1,182 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Boolean operations on polygons: union, intersection, XOR, A-B, B-A.
+//
+// The algorithm is the plane sweep by F. Martinez, A. J. Rueda and
+// F. R. Feito, "A new algorithm for computing Boolean operations on
+// polygons", 2009. The edges of both polygons are sorted into an event
+// queue, the sweep line keeps the edges that cross it in the order from
+// the bottom to the top, the neighbouring edges are checked for the
+// intersections and divided at them. Every edge knows whether the area
+// above it is inside A and B from its neighbour below, and it belongs to
+// the result if the operation gives different values above and below it.
+// That also counts the overlapping edges right, even many of them. The
+// edges of the result are then connected into contours. The sweep line
+// is a sorted array, which is fast while it crosses not too many edges.
+//
+// Both polygons are filled with the even-odd rule, like in GPC. The result
+// contours don't cross each other, the outer ones are counterclockwise
+// (path_flags_ccw) and the holes are clockwise, so the result can be
+// rendered with any filling rule.
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_POLYGON_BOOL_INCLUDED
+#define AGG_POLYGON_BOOL_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_array.h"
+
+namespace agg
+{
+    //-----------------------------------------------------polygon_bool_op_e
+    enum polygon_bool_op_e
+    {
+        polygon_bool_or,
+        polygon_bool_and,
+        polygon_bool_xor,
+        polygon_bool_a_minus_b,
+        polygon_bool_b_minus_a
+    };
+
+
+    //============================================================polygon_bool
+    //
+    // See Implementation agg_polygon_bool.cpp
+    //
+    // Usage:
+    //   polygon_bool pb;
+    //   pb.add_path(0, path_a);
+    //   pb.add_path(1, path_b);
+    //   pb.execute(polygon_bool_and);
+    //   ras.add_path(pb);
+    //
+    class polygon_bool
+    {
+        enum edge_flag_e
+        {
+            edge_out       = 1,
+            edge_processed = 2
+        };
+
+        struct sweep_event
+        {
+            point_d      p;
+            point_d      s1;     // The source edge, the parts of it
+            point_d      s2;     // get the intersections from that
+            sweep_event* other;
+            unsigned     id;
+            unsigned     polygon;
+            unsigned     below;  // The areas below and above the edge,
+            unsigned     inside; // bit 0 is inside A, bit 1 is inside B
+            int          pos;
+            bool         left;
+            bool         in_result;
+        };
+
+        struct contour_type
+        {
+            unsigned start;
+            unsigned num;
+            unsigned flags;
+        };
+
+        typedef pod_bvector<sweep_event,  8> event_storage;
+        typedef pod_bvector<sweep_event*, 8> event_ptr_storage;
+        typedef pod_vector<sweep_event*>     event_ptr_array;
+
+    public:
+        polygon_bool();
+
+        // Source polygons, 0 is A and 1 is B. Every move_to starts
+        // a contour, the contours are always closed.
+        void remove_all();
+        void add_vertex(unsigned polygon, double x, double y, unsigned cmd);
+
+        template<class VertexSource>
+        void add_path(unsigned polygon, VertexSource& vs, unsigned path_id = 0)
+        {
+            double x;
+            double y;
+            unsigned cmd;
+            vs.rewind(path_id);
+            while(!is_stop(cmd = vs.vertex(&x, &y)))
+            {
+                add_vertex(polygon, x, y, cmd);
+            }
+        }
+
+        // Calculates the result, the sources are kept
+        void execute(polygon_bool_op_e op);
+
+        unsigned num_contours() const { return m_contours.size(); }
+        unsigned num_vertices() const { return m_out_vertices.size(); }
+
+        // Vertex Source Interface, the result
+        void     rewind(unsigned path_id);
+        unsigned vertex(double* x, double* y);
+
+    private:
+        polygon_bool(const polygon_bool&);
+        const polygon_bool& operator = (const polygon_bool&);
+
+        void add_edge(unsigned polygon, const point_d& p1, const point_d& p2);
+        sweep_event* new_event(const point_d& p, bool left,
+                               unsigned polygon, sweep_event* other);
+
+        void push_event(sweep_event* e);
+        sweep_event* pop_event();
+        bool queue_empty() const
+        {
+            return m_queue.size() == 0 && m_input_pos >= m_input.size();
+        }
+
+        unsigned sweep_line_insert(sweep_event* e);
+        int      sweep_line_find(sweep_event* e) const;
+        void     sweep_line_erase(unsigned i);
+
+        bool in_result(unsigned inside) const;
+        void compute_fields(sweep_event* e, sweep_event* prev);
+        void divide_segment(sweep_event* e, const point_d& p);
+        void possible_intersection(sweep_event* e1, sweep_event* e2);
+        void connect_edges();
+        unsigned next_edge(unsigned cur, unsigned t, unsigned start,
+                           const pod_array<int8u>& flags) const;
+
+        // Source
+        pod_bvector<point_d, 8>      m_src_vertices;
+        pod_bvector<contour_type, 6> m_src_contours;
+
+        // Sweep
+        polygon_bool_op_e m_operation;
+        double            m_grid;
+        event_storage     m_events;
+        event_ptr_array   m_input;
+        unsigned          m_input_pos;
+        event_ptr_storage m_queue;
+        event_ptr_storage m_sweep_line;
+        event_ptr_storage m_sorted;
+
+        // Result
+        pod_bvector<point_d, 8>      m_out_vertices;
+        pod_bvector<contour_type, 6> m_contours;
+        unsigned                     m_contour;
+        unsigned                     m_vertex;
+    };
+
+}
+
+#endif
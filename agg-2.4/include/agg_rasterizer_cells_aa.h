@@ -38,11 +38,39 @@
 
 namespace agg
 {
+    template<class Cell> class cell_sorter_qsort;
+
+    //---------------------------------------------------------cell_overflow_e
+    // What rasterizer_cells_aa does when the cells don't fit in 
+    // cell_block_limit blocks:
+    //
+    // cell_overflow_drop  - drops the rest of the cells, the shape is 
+    //                       rendered partially (the original behaviour).
+    // cell_overflow_grow  - ignores the limit and allocates more blocks.
+    // cell_overflow_error - drops the cells like cell_overflow_drop, but 
+    //                       the rasterizer refuses to render the shape, 
+    //                       so that nothing is drawn wrong. The caller
+    //                       checks overflow() and renders the shape by
+    //                       bands, see render_path_split().
+    //
+    // In all the cases overflow() tells about the lost cells until reset().
+    //------------------------------------------------------------------------
+    enum cell_overflow_e
+    {
+        cell_overflow_drop,
+        cell_overflow_grow,
+        cell_overflow_error
+    };
 
     //-----------------------------------------------------rasterizer_cells_aa
     // An internal class that implements the main rasterization algorithm.
     // Used in the rasterizer. Should not be used direcly.
-    template<class Cell> class rasterizer_cells_aa
+    // The Sorter arranges the cells by Y and X after they are generated,
+    // see cell_sorter_qsort and cell_sorter_radix below. The Allocator
+    // of the cell blocks is pod_allocator or arena_allocator (agg_arena.h).
+    template<class Cell, class Sorter=cell_sorter_qsort<Cell>,
+             template<class> class Allocator=pod_allocator> 
+    class rasterizer_cells_aa
     {
         enum cell_block_scale_e
         {
@@ -52,15 +80,11 @@ namespace agg
             cell_block_pool  = 256
         };
 
-        struct sorted_y
-        {
-            unsigned start;
-            unsigned num;
-        };
-
     public:
         typedef Cell cell_type;
-        typedef rasterizer_cells_aa<Cell> self_type;
+        typedef Sorter sorter_type;
+        typedef typename Sorter::const_iterator const_iterator;
+        typedef rasterizer_cells_aa<Cell, Sorter, Allocator> self_type;
 
         ~rasterizer_cells_aa();
         rasterizer_cells_aa(unsigned cell_block_limit=1024);
@@ -69,6 +93,14 @@ namespace agg
         void style(const cell_type& style_cell);
         void line(int x1, int y1, int x2, int y2);
 
+        // Restrict the generated cells to the scanlines y1...y2 (inclusive).
+        // Unlike clipping the geometry the cells within the band remain 
+        // exactly the same as without the band, so that the image can be
+        // rendered by independent horizontal stripes. The band is kept 
+        // until reset_band() is called, reset() doesn't affect it.
+        void band(int y1, int y2);
+        void reset_band();
+
         int min_x() const { return m_min_x; }
         int min_y() const { return m_min_y; }
         int max_x() const { return m_max_x; }
@@ -83,22 +115,56 @@ namespace agg
 
         unsigned scanline_num_cells(unsigned y) const 
         { 
-            return m_sorted_y[y - m_min_y].num; 
+            return m_sorter.scanline_num_cells(y); 
         }
 
-        const cell_type* const* scanline_cells(unsigned y) const
+        const_iterator scanline_cells(unsigned y) const
         { 
-            return m_sorted_cells.data() + m_sorted_y[y - m_min_y].start; 
+            return m_sorter.scanline_cells(y); 
         }
 
         bool sorted() const { return m_sorted; }
 
+        int band_min_y() const { return m_band_min_y; }
+        int band_max_y() const { return m_band_max_y; }
+
+        // Capacity planning. The blocks of cells are kept between reset()
+        // calls, so after the first frames there are no allocations. 
+        // reserve() allocates them (and the sorter's arrays) in advance,
+        // shrink_to_fit() gives back everything that isn't used by the 
+        // current cells. The memory is allocated in blocks of 4096 cells,
+        // the limit and the block counters are in blocks.
+        void reserve(unsigned num_cells, unsigned num_scanlines=0);
+        void shrink_to_fit();
+        unsigned capacity()   const { return m_num_blocks << cell_block_shift; }
+        unsigned num_blocks() const { return m_num_blocks; }
+
+        void cell_block_limit(unsigned limit) { m_cell_block_limit = limit; }
+        unsigned cell_block_limit() const { return m_cell_block_limit; }
+
+        void overflow_policy(cell_overflow_e p) { m_overflow_policy = p; }
+        cell_overflow_e overflow_policy() const { return m_overflow_policy; }
+
+        // True if some cells were lost since the last reset()
+        bool overflow() const { return m_overflow; }
+
+        // The counters for monitoring, accumulated until reset_stats().
+        // The peaks are updated on sort_cells() and reset(). 
+        // num_overflows() is the number of the shapes that lost cells.
+        unsigned peak_cells()    const { return m_peak_cells; }
+        unsigned peak_blocks()   const { return m_peak_blocks; }
+        unsigned num_overflows() const { return m_num_overflows; }
+        unsigned dropped_cells() const { return m_dropped_cells; }
+        void reset_stats();
+
     private:
         rasterizer_cells_aa(const self_type&);
         const self_type& operator = (const self_type&);
 
         void set_curr_cell(int x, int y);
         void add_curr_cell();
+        void drop_curr_cell();
+        void update_peaks();
         void render_hline(int ey, int x1, int y1, int x2, int y2);
         void allocate_block();
         
@@ -108,69 +174,85 @@ namespace agg
         unsigned                m_curr_block;
         unsigned                m_num_cells;
 	unsigned                m_cell_block_limit;
+        cell_overflow_e         m_overflow_policy;
+        unsigned                m_peak_cells;
+        unsigned                m_peak_blocks;
+        unsigned                m_num_overflows;
+        unsigned                m_dropped_cells;
         cell_type**             m_cells;
         cell_type*              m_curr_cell_ptr;
-        pod_vector<cell_type*>  m_sorted_cells;
-        pod_vector<sorted_y>    m_sorted_y;
+        sorter_type             m_sorter;
         cell_type               m_curr_cell;
         cell_type               m_style_cell;
+        int                     m_band_min_y;
+        int                     m_band_max_y;
         int                     m_min_x;
         int                     m_min_y;
         int                     m_max_x;
         int                     m_max_y;
         bool                    m_sorted;
+        bool                    m_overflow;
     };
 
 
 
 
     //------------------------------------------------------------------------
-    template<class Cell> 
-    rasterizer_cells_aa<Cell>::~rasterizer_cells_aa()
+    template<class Cell, class Sorter, template<class> class A> 
+    rasterizer_cells_aa<Cell, Sorter, A>::~rasterizer_cells_aa()
     {
         if(m_num_blocks)
         {
             cell_type** ptr = m_cells + m_num_blocks - 1;
             while(m_num_blocks--)
             {
-                pod_allocator<cell_type>::deallocate(*ptr, cell_block_size);
+                A<cell_type>::deallocate(*ptr, cell_block_size);
                 ptr--;
             }
-            pod_allocator<cell_type*>::deallocate(m_cells, m_max_blocks);
+            A<cell_type*>::deallocate(m_cells, m_max_blocks);
         }
     }
 
     //------------------------------------------------------------------------
-    template<class Cell> 
-    rasterizer_cells_aa<Cell>::rasterizer_cells_aa(unsigned cell_block_limit) :
+    template<class Cell, class Sorter, template<class> class A> 
+    rasterizer_cells_aa<Cell, Sorter, A>::rasterizer_cells_aa(unsigned cell_block_limit) :
         m_num_blocks(0),
         m_max_blocks(0),
         m_curr_block(0),
         m_num_cells(0),
 	m_cell_block_limit(cell_block_limit),
+        m_overflow_policy(cell_overflow_drop),
+        m_peak_cells(0),
+        m_peak_blocks(0),
+        m_num_overflows(0),
+        m_dropped_cells(0),
         m_cells(0),
         m_curr_cell_ptr(0),
-        m_sorted_cells(),
-        m_sorted_y(),
+        m_sorter(),
+        m_band_min_y(std::numeric_limits<int>::min()),
+        m_band_max_y(std::numeric_limits<int>::max()),
         m_min_x(std::numeric_limits<int>::max()),
         m_min_y(std::numeric_limits<int>::max()),
         m_max_x(std::numeric_limits<int>::min()),
         m_max_y(std::numeric_limits<int>::min()),
-        m_sorted(false)
+        m_sorted(false),
+        m_overflow(false)
     {
         m_style_cell.initial();
         m_curr_cell.initial();
     }
 
     //------------------------------------------------------------------------
-    template<class Cell> 
-    void rasterizer_cells_aa<Cell>::reset()
+    template<class Cell, class Sorter, template<class> class A> 
+    void rasterizer_cells_aa<Cell, Sorter, A>::reset()
     {
+        update_peaks();
         m_num_cells = 0; 
         m_curr_block = 0;
         m_curr_cell.initial();
         m_style_cell.initial();
         m_sorted = false;
+        m_overflow = false;
         m_min_x = std::numeric_limits<int>::max();
         m_min_y = std::numeric_limits<int>::max();
         m_max_x = std::numeric_limits<int>::min();
@@ -178,14 +260,97 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Cell> 
-    AGG_INLINE void rasterizer_cells_aa<Cell>::add_curr_cell()
+    template<class Cell, class Sorter, template<class> class A> 
+    void rasterizer_cells_aa<Cell, Sorter, A>::update_peaks()
+    {
+        if(m_num_cells  > m_peak_cells)  m_peak_cells  = m_num_cells;
+        if(m_curr_block > m_peak_blocks) m_peak_blocks = m_curr_block;
+    }
+
+    //------------------------------------------------------------------------
+    template<class Cell, class Sorter, template<class> class A> 
+    void rasterizer_cells_aa<Cell, Sorter, A>::reset_stats()
     {
-        if(m_curr_cell.area | m_curr_cell.cover)
+        m_peak_cells    = 0;
+        m_peak_blocks   = 0;
+        m_num_overflows = 0;
+        m_dropped_cells = 0;
+    }
+
+    //------------------------------------------------------------------------
+    template<class Cell, class Sorter, template<class> class A> 
+    void rasterizer_cells_aa<Cell, Sorter, A>::reserve(unsigned num_cells, 
+                                                       unsigned num_scanlines)
+    {
+        unsigned nb = (num_cells + cell_block_mask) >> cell_block_shift;
+        if(m_overflow_policy != cell_overflow_grow && nb > m_cell_block_limit)
+        {
+            nb = m_cell_block_limit;
+        }
+
+        // Allocate the blocks keeping the current cells, if any
+        unsigned curr_block = m_curr_block;
+        cell_type* curr_cell_ptr = m_curr_cell_ptr;
+        m_curr_block = m_num_blocks;
+        while(m_num_blocks < nb) allocate_block();
+        m_curr_block = curr_block;
+        m_curr_cell_ptr = curr_cell_ptr;
+
+        if(!m_sorted) m_sorter.reserve(num_cells, num_scanlines);
+    }
+
+    //------------------------------------------------------------------------
+    template<class Cell, class Sorter, template<class> class A> 
+    void rasterizer_cells_aa<Cell, Sorter, A>::shrink_to_fit()
+    {
+        while(m_num_blocks > m_curr_block)
+        {
+            A<cell_type>::deallocate(m_cells[--m_num_blocks], cell_block_size);
+        }
+        if(m_num_blocks == 0 && m_cells)
+        {
+            A<cell_type*>::deallocate(m_cells, m_max_blocks);
+            m_cells = 0;
+            m_max_blocks = 0;
+        }
+        if(!m_sorted) m_sorter.free_all();
+    }
+
+    //------------------------------------------------------------------------
+    template<class Cell, class Sorter, template<class> class A> 
+    void rasterizer_cells_aa<Cell, Sorter, A>::band(int y1, int y2)
+    {
+        if(y1 > y2) { int t = y1; y1 = y2; y2 = t; }
+        m_band_min_y = y1;
+        m_band_max_y = y2;
+    }
+
+    //------------------------------------------------------------------------
+    template<class Cell, class Sorter, template<class> class A> 
+    void rasterizer_cells_aa<Cell, Sorter, A>::reset_band()
+    {
+        m_band_min_y = std::numeric_limits<int>::min();
+        m_band_max_y = std::numeric_limits<int>::max();
+    }
+
+    //------------------------------------------------------------------------
+    template<class Cell, class Sorter, template<class> class A> 
+    AGG_INLINE void rasterizer_cells_aa<Cell, Sorter, A>::add_curr_cell()
+    {
+        // The unsigned arithmetic checks the band in one comparison
+        // and is well defined for the default (full) band.
+        if((m_curr_cell.area | m_curr_cell.cover) &&
+           unsigned(m_curr_cell.y) - unsigned(m_band_min_y) <= 
+           unsigned(m_band_max_y)  - unsigned(m_band_min_y))
         {
             if((m_num_cells & cell_block_mask) == 0)
             {
-                if(m_num_blocks >= m_cell_block_limit) return;
+                if(m_curr_block >= m_cell_block_limit &&
+                   m_overflow_policy != cell_overflow_grow)
+                {
+                    drop_curr_cell();
+                    return;
+                }
                 allocate_block();
             }
             *m_curr_cell_ptr++ = m_curr_cell;
@@ -194,8 +359,20 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Cell> 
-    AGG_INLINE void rasterizer_cells_aa<Cell>::set_curr_cell(int x, int y)
+    template<class Cell, class Sorter, template<class> class A> 
+    void rasterizer_cells_aa<Cell, Sorter, A>::drop_curr_cell()
+    {
+        if(!m_overflow)
+        {
+            m_overflow = true;
+            ++m_num_overflows;
+        }
+        ++m_dropped_cells;
+    }
+
+    //------------------------------------------------------------------------
+    template<class Cell, class Sorter, template<class> class A> 
+    AGG_INLINE void rasterizer_cells_aa<Cell, Sorter, A>::set_curr_cell(int x, int y)
     {
         if(m_curr_cell.not_equal(x, y, m_style_cell))
         {
@@ -209,8 +386,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Cell> 
-    AGG_INLINE void rasterizer_cells_aa<Cell>::render_hline(int ey, 
+    template<class Cell, class Sorter, template<class> class A> 
+    AGG_INLINE void rasterizer_cells_aa<Cell, Sorter, A>::render_hline(int ey, 
                                                             int x1, int y1, 
                                                             int x2, int y2)
     {
@@ -308,15 +485,15 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Cell> 
-    AGG_INLINE void rasterizer_cells_aa<Cell>::style(const cell_type& style_cell)
+    template<class Cell, class Sorter, template<class> class A> 
+    AGG_INLINE void rasterizer_cells_aa<Cell, Sorter, A>::style(const cell_type& style_cell)
     { 
         m_style_cell.style(style_cell); 
     }
 
     //------------------------------------------------------------------------
-    template<class Cell> 
-    void rasterizer_cells_aa<Cell>::line(int x1, int y1, int x2, int y2)
+    template<class Cell, class Sorter, template<class> class A> 
+    void rasterizer_cells_aa<Cell, Sorter, A>::line(int x1, int y1, int x2, int y2)
     {
         enum dx_limit_e { dx_limit = 16384 << poly_subpixel_shift };
 
@@ -342,6 +519,13 @@ namespace agg
         int rem, mod, lift, delta, first, incr;
         long long p;
 
+        // Trivially reject the lines that lie entirely outside the band
+        if((ey1 < m_band_min_y && ey2 < m_band_min_y) ||
+           (ey1 > m_band_max_y && ey2 > m_band_max_y))
+        {
+            return;
+        }
+
         if(ex1 < m_min_x) m_min_x = ex1;
         if(ex1 > m_max_x) m_max_x = ex1;
         if(ey1 < m_min_y) m_min_y = ey1;
@@ -467,28 +651,28 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Cell> 
-    void rasterizer_cells_aa<Cell>::allocate_block()
+    template<class Cell, class Sorter, template<class> class A> 
+    void rasterizer_cells_aa<Cell, Sorter, A>::allocate_block()
     {
         if(m_curr_block >= m_num_blocks)
         {
             if(m_num_blocks >= m_max_blocks)
             {
                 cell_type** new_cells = 
-                    pod_allocator<cell_type*>::allocate(m_max_blocks + 
-                                                        cell_block_pool);
+                    A<cell_type*>::allocate(m_max_blocks + 
+                                            cell_block_pool);
 
                 if(m_cells)
                 {
                     std::memcpy(new_cells, m_cells, m_max_blocks * sizeof(cell_type*));
-                    pod_allocator<cell_type*>::deallocate(m_cells, m_max_blocks);
+                    A<cell_type*>::deallocate(m_cells, m_max_blocks);
                 }
                 m_cells = new_cells;
                 m_max_blocks += cell_block_pool;
             }
 
             m_cells[m_num_blocks++] = 
-                pod_allocator<cell_type>::allocate(cell_block_size);
+                A<cell_type>::allocate(cell_block_size);
 
         }
         m_curr_cell_ptr = m_cells[m_curr_block++];
@@ -621,53 +805,91 @@ namespace agg
         }
     }
 
-
+    //------------------------------------------------------cell_sorter_qsort
+    // The default cell sorter. Arranges the pointers to the cells by Y 
+    // with the counting sort and then sorts every scanline by X with 
+    // qsort_cells(). 
     //------------------------------------------------------------------------
-    template<class Cell> 
-    void rasterizer_cells_aa<Cell>::sort_cells()
+    template<class Cell> class cell_sorter_qsort
     {
-        if(m_sorted) return; //Perform sort only the first time.
+        struct sorted_y
+        {
+            unsigned start;
+            unsigned num;
+        };
 
-        add_curr_cell();
-        m_curr_cell.x     = std::numeric_limits<int>::max();
-        m_curr_cell.y     = std::numeric_limits<int>::max();
-        m_curr_cell.cover = 0;
-        m_curr_cell.area  = 0;
+    public:
+        typedef Cell cell_type;
+        typedef const cell_type* const* const_iterator;
 
-        if(m_num_cells == 0) return;
+        cell_sorter_qsort() : m_min_y(0) {}
+
+        //--------------------------------------------------------------------
+        void reserve(unsigned num_cells, unsigned num_scanlines)
+        {
+            m_sorted_cells.capacity(num_cells, 16);
+            m_sorted_y.capacity(num_scanlines, 16);
+        }
+
+        void free_all()
+        {
+            m_sorted_cells.free_all();
+            m_sorted_y.free_all();
+        }
+
+        //--------------------------------------------------------------------
+        void sort(cell_type* const* blocks, unsigned block_shift, 
+                  unsigned num_cells, int min_x, int min_y, int max_x, int max_y);
+
+        //--------------------------------------------------------------------
+        unsigned scanline_num_cells(unsigned y) const 
+        { 
+            return m_sorted_y[y - m_min_y].num; 
+        }
+
+        //--------------------------------------------------------------------
+        const_iterator scanline_cells(unsigned y) const
+        { 
+            return m_sorted_cells.data() + m_sorted_y[y - m_min_y].start; 
+        }
+
+    private:
+        pod_vector<cell_type*> m_sorted_cells;
+        pod_vector<sorted_y>   m_sorted_y;
+        int                    m_min_y;
+    };
+
+
+    //------------------------------------------------------------------------
+    template<class Cell> 
+    void cell_sorter_qsort<Cell>::sort(cell_type* const* blocks, 
+                                       unsigned block_shift, 
+                                       unsigned num_cells, 
+                                       int, int min_y, int, int max_y)
+    {
+        unsigned block_size = 1 << block_shift;
+        m_min_y = min_y;
 
-// DBG: Check to see if min/max works well.
-//for(unsigned nc = 0; nc < m_num_cells; nc++)
-//{
-//    cell_type* cell = m_cells[nc >> cell_block_shift] + (nc & cell_block_mask);
-//    if(cell->x < m_min_x || 
-//       cell->y < m_min_y || 
-//       cell->x > m_max_x || 
-//       cell->y > m_max_y)
-//    {
-//        cell = cell; // Breakpoint here
-//    }
-//}
         // Allocate the array of cell pointers
-        m_sorted_cells.allocate(m_num_cells, 16);
+        m_sorted_cells.allocate(num_cells, 16);
 
         // Allocate and zero the Y array
-        m_sorted_y.allocate(m_max_y - m_min_y + 1, 16);
+        m_sorted_y.allocate(max_y - min_y + 1, 16);
         m_sorted_y.zero();
 
         // Create the Y-histogram (count the numbers of cells for each Y)
-        cell_type** block_ptr = m_cells;
+        cell_type* const* block_ptr = blocks;
         cell_type*  cell_ptr;
-        unsigned nb = m_num_cells;
+        unsigned nb = num_cells;
         unsigned i;
         while(nb)
         {
             cell_ptr = *block_ptr++;
-            i = (nb > cell_block_size) ? unsigned(cell_block_size) : nb;
+            i = (nb > block_size) ? block_size : nb;
             nb -= i;
             while(i--) 
             {
-                m_sorted_y[cell_ptr->y - m_min_y].start++;
+                m_sorted_y[cell_ptr->y - min_y].start++;
                 ++cell_ptr;
             }
         }
@@ -682,16 +904,16 @@ namespace agg
         }
 
         // Fill the cell pointer array sorted by Y
-        block_ptr = m_cells;
-        nb = m_num_cells;
+        block_ptr = blocks;
+        nb = num_cells;
         while(nb)
         {
             cell_ptr = *block_ptr++;
-            i = (nb > cell_block_size) ? unsigned(cell_block_size) : nb;
+            i = (nb > block_size) ? block_size : nb;
             nb -= i;
             while(i--)
             {
-                sorted_y& curr_y = m_sorted_y[cell_ptr->y - m_min_y];
+                sorted_y& curr_y = m_sorted_y[cell_ptr->y - min_y];
                 m_sorted_cells[curr_y.start + curr_y.num] = cell_ptr;
                 ++curr_y.num;
                 ++cell_ptr;
@@ -707,6 +929,221 @@ namespace agg
                 qsort_cells(m_sorted_cells.data() + curr_y.start, curr_y.num);
             }
         }
+    }
+
+
+
+    //-----------------------------------------------------cell_array_iterator
+    // Iterates a contiguous array of cells with the same syntax as 
+    // the array of cell pointers, i.e. *it is a pointer to the cell. 
+    template<class Cell> class cell_array_iterator
+    {
+    public:
+        cell_array_iterator(const Cell* ptr) : m_ptr(ptr) {}
+        const Cell* operator * () const { return m_ptr; }
+        cell_array_iterator& operator ++ () { ++m_ptr; return *this; }
+
+    private:
+        const Cell* m_ptr;
+    };
+
+
+    //------------------------------------------------------cell_sorter_radix
+    // Copies the cells into a contiguous array sorted by Y and X with 
+    // the LSD radix sort. First the cells are sorted by X in 8-bit digits, 
+    // the digits that are the same in all the cells are skipped, then they
+    // are distributed by Y with the stable counting sort. All the passes 
+    // are linear and sequential in memory, there's no pointer chasing 
+    // neither in sorting nor in sweeping. It's faster than the default 
+    // sorter for dense scenes with many cells per scanline, but takes 
+    // twice the memory of the cells.
+    //------------------------------------------------------------------------
+    template<class Cell> class cell_sorter_radix
+    {
+        struct sorted_y
+        {
+            unsigned start;
+            unsigned num;
+        };
+
+        enum radix_e
+        {
+            radix_shift = 8,
+            radix_size  = 1 << radix_shift,
+            radix_mask  = radix_size - 1,
+            max_digits  = 4
+        };
+
+    public:
+        typedef Cell cell_type;
+        typedef cell_array_iterator<cell_type> const_iterator;
+
+        cell_sorter_radix() : m_sorted(0), m_min_y(0) {}
+
+        //--------------------------------------------------------------------
+        void reserve(unsigned num_cells, unsigned num_scanlines)
+        {
+            m_buf1.capacity(num_cells, 16);
+            m_buf2.capacity(num_cells, 16);
+            m_sorted_y.capacity(num_scanlines, 16);
+        }
+
+        void free_all()
+        {
+            m_buf1.free_all();
+            m_buf2.free_all();
+            m_sorted_y.free_all();
+            m_sorted = 0;
+        }
+
+        //--------------------------------------------------------------------
+        void sort(cell_type* const* blocks, unsigned block_shift, 
+                  unsigned num_cells, int min_x, int min_y, int max_x, int max_y);
+
+        //--------------------------------------------------------------------
+        unsigned scanline_num_cells(unsigned y) const 
+        { 
+            return m_sorted_y[y - m_min_y].num; 
+        }
+
+        //--------------------------------------------------------------------
+        const_iterator scanline_cells(unsigned y) const
+        { 
+            return const_iterator(m_sorted + m_sorted_y[y - m_min_y].start); 
+        }
+
+    private:
+        pod_vector<cell_type> m_buf1;
+        pod_vector<cell_type> m_buf2;
+        pod_vector<sorted_y>  m_sorted_y;
+        const cell_type*      m_sorted;
+        int                   m_min_y;
+    };
+
+
+    //------------------------------------------------------------------------
+    template<class Cell> 
+    void cell_sorter_radix<Cell>::sort(cell_type* const* blocks, 
+                                       unsigned block_shift, 
+                                       unsigned num_cells, 
+                                       int min_x, int min_y, 
+                                       int max_x, int max_y)
+    {
+        unsigned block_size = 1 << block_shift;
+        unsigned counts[max_digits][radix_size];
+        unsigned num_digits = 0;
+        unsigned range = unsigned(max_x) - unsigned(min_x);
+        while(num_digits < max_digits && (range >> (num_digits * radix_shift)))
+        {
+            ++num_digits;
+        }
+
+        m_min_y = min_y;
+        m_buf1.allocate(num_cells, 16);
+        m_buf2.allocate(num_cells, 16);
+        m_sorted_y.allocate(max_y - min_y + 1, 16);
+        m_sorted_y.zero();
+        std::memset(counts, 0, sizeof(counts));
+
+        // Gather the cells into the contiguous array and calculate 
+        // the Y-histogram and the histograms of all X-digits at once.
+        cell_type* dst = m_buf1.data();
+        cell_type* const* block_ptr = blocks;
+        unsigned nb = num_cells;
+        unsigned i, d;
+        while(nb)
+        {
+            const cell_type* cell_ptr = *block_ptr++;
+            i = (nb > block_size) ? block_size : nb;
+            nb -= i;
+            while(i--)
+            {
+                unsigned key = unsigned(cell_ptr->x) - unsigned(min_x);
+                for(d = 0; d < num_digits; d++)
+                {
+                    ++counts[d][(key >> (d * radix_shift)) & radix_mask];
+                }
+                m_sorted_y[cell_ptr->y - min_y].start++;
+                *dst++ = *cell_ptr++;
+            }
+        }
+
+        cell_type* src = m_buf1.data();
+        dst = m_buf2.data();
+
+        // Sort by X, digit by digit
+        for(d = 0; d < num_digits; d++)
+        {
+            unsigned* cnt = counts[d];
+            unsigned shift = d * radix_shift;
+            unsigned start = 0;
+
+            // Skip the digit if it's the same in all the cells
+            if(cnt[((unsigned(src->x) - unsigned(min_x)) >> shift) & radix_mask] == num_cells)
+            {
+                continue;
+            }
+
+            for(i = 0; i < radix_size; i++)
+            {
+                unsigned v = cnt[i];
+                cnt[i] = start;
+                start += v;
+            }
+
+            const cell_type* ptr = src;
+            for(i = 0; i < num_cells; i++)
+            {
+                unsigned key = unsigned(ptr->x) - unsigned(min_x);
+                dst[cnt[(key >> shift) & radix_mask]++] = *ptr++;
+            }
+            cell_type* t = src; src = dst; dst = t;
+        }
+
+        // Convert the Y-histogram into the array of starting indexes
+        unsigned start = 0;
+        for(i = 0; i < m_sorted_y.size(); i++)
+        {
+            unsigned v = m_sorted_y[i].start;
+            m_sorted_y[i].start = start;
+            start += v;
+        }
+
+        // Distribute by Y, keeping the X-order within the scanlines
+        const cell_type* ptr = src;
+        for(i = 0; i < num_cells; i++)
+        {
+            sorted_y& curr_y = m_sorted_y[ptr->y - min_y];
+            dst[curr_y.start + curr_y.num] = *ptr++;
+            ++curr_y.num;
+        }
+        m_sorted = dst;
+    }
+
+
+
+    //------------------------------------------------------------------------
+    template<class Cell, class Sorter, template<class> class A> 
+    void rasterizer_cells_aa<Cell, Sorter, A>::sort_cells()
+    {
+        if(m_sorted) return; //Perform sort only the first time.
+
+        add_curr_cell();
+        m_curr_cell.x     = std::numeric_limits<int>::max();
+        m_curr_cell.y     = std::numeric_limits<int>::max();
+        m_curr_cell.cover = 0;
+        m_curr_cell.area  = 0;
+        update_peaks();
+
+        if(m_num_cells == 0) return;
+
+        // The lines crossing the band could extend the Y-range beyond it,
+        // while all the stored cells are inside.
+        if(m_min_y < m_band_min_y) m_min_y = m_band_min_y;
+        if(m_max_y > m_band_max_y) m_max_y = m_band_max_y;
+
+        m_sorter.sort(m_cells, cell_block_shift, m_num_cells, 
+                      m_min_x, m_min_y, m_max_x, m_max_y);
         m_sorted = true;
     }
 
@@ -96,6 +96,44 @@ namespace agg
             int x, area, cover; 
         };
 
+        //--------------------------------------------------------------------
+        // The state of sweeping: the active styles of the current scanline
+        // and their cells. Every sweeper has its own one, so that the
+        // sorted cells can be swept by several threads simultaneously.
+        // If num_bands > 1 only the scanlines of the bands band_idx, 
+        // band_idx + num_bands, ... are swept, the bands being band_height
+        // scanlines starting from min_y().
+        struct sweep_state
+        {
+            pod_vector<style_info> styles;    // Active Styles
+            pod_vector<unsigned>   ast;       // Active Style Table (unique values)
+            pod_vector<int8u>      asm_mask;  // Active Style Mask 
+            pod_vector<cell_info>  cells;
+            pod_vector<cover_type> cover_buf;
+            int                    scan_y;
+            int                    sl_start;
+            unsigned               sl_len;
+            unsigned               band_height;
+            unsigned               band_idx;
+            unsigned               num_bands;
+
+            sweep_state(unsigned band_height_=1, 
+                        unsigned band_idx_=0, 
+                        unsigned num_bands_=1) :
+                styles(),
+                ast(),
+                asm_mask(),
+                cells(),
+                cover_buf(),
+                scan_y(std::numeric_limits<int>::max()),
+                sl_start(0),
+                sl_len(0),
+                band_height(band_height_ ? band_height_ : 1),
+                band_idx(band_idx_),
+                num_bands(num_bands_ ? num_bands_ : 1)
+            {}
+        };
+
     public:
         typedef Clip                      clip_type;
         typedef typename Clip::conv_type  conv_type;
@@ -116,18 +154,11 @@ namespace agg
             m_clipper(),
             m_filling_rule(fill_non_zero),
             m_layer_order(layer_direct),
-            m_styles(),  // Active Styles
-            m_ast(),     // Active Style Table (unique values)
-            m_asm(),     // Active Style Mask 
-            m_cells(),
-            m_cover_buf(),
+            m_state(),
             m_min_style(std::numeric_limits<int>::max()),
             m_max_style(std::numeric_limits<int>::min()),
             m_start_x(0),
-            m_start_y(0),
-            m_scan_y(std::numeric_limits<int>::max()),
-            m_sl_start(0),
-            m_sl_len(0)
+            m_start_y(0)
         {}
 
         //--------------------------------------------------------------------
@@ -175,13 +206,20 @@ namespace agg
 
         //--------------------------------------------------------------------
         void sort();
+        bool sorted() const { return m_outline.sorted(); }
         bool rewind_scanlines();
-        unsigned sweep_styles();
-        int      scanline_start()  const { return m_sl_start; }
-        unsigned scanline_length() const { return m_sl_len;   }
-        unsigned style(unsigned style_idx) const;
+        unsigned sweep_styles() { return sweep_styles(m_state); }
+        int      scanline_start()  const { return m_state.sl_start; }
+        unsigned scanline_length() const { return m_state.sl_len;   }
+        unsigned style(unsigned style_idx) const 
+        { 
+            return style(m_state, style_idx); 
+        }
 
-        cover_type* allocate_cover_buffer(unsigned len);
+        cover_type* allocate_cover_buffer(unsigned len)
+        {
+            return allocate_cover_buffer(m_state, len);
+        }
 
         //--------------------------------------------------------------------
         bool navigate_scanline(int y); 
@@ -209,7 +247,82 @@ namespace agg
         // determined by calling style(). 
         template<class Scanline> bool sweep_scanline(Scanline& sl, int style_idx)
         {
-            int scan_y = m_scan_y - 1;
+            return sweep_scanline(m_state, sl, style_idx);
+        }
+
+        //--------------------------------------------------------------------
+        // Sweeps the cells of a sorted rasterizer with its own state, 
+        // without changing the rasterizer. It has the same sweeping 
+        // interface as the rasterizer, so it can be used with 
+        // render_scanlines_compound() and render_scanlines_compound_layered().
+        // Several sweepers can work with the same rasterizer from different 
+        // threads, each one taking its own set of bands of scanlines
+        // (see sweep_state). The rasterizer must be sorted and must not 
+        // change while the sweepers are in use.
+        class sweeper;
+        friend class sweeper;
+        class sweeper
+        {
+        public:
+            typedef rasterizer_compound_aa<Clip> rasterizer_type;
+
+            sweeper(const rasterizer_type& ras, 
+                    unsigned band_height=1, 
+                    unsigned band_idx=0, 
+                    unsigned num_bands=1) :
+                m_ras(&ras),
+                m_state(band_height, band_idx, num_bands)
+            {}
+
+            int min_x()     const { return m_ras->min_x(); }
+            int min_y()     const { return m_ras->min_y(); }
+            int max_x()     const { return m_ras->max_x(); }
+            int max_y()     const { return m_ras->max_y(); }
+            int min_style() const { return m_ras->min_style(); }
+            int max_style() const { return m_ras->max_style(); }
+
+            bool rewind_scanlines()    { return m_ras->rewind_state(m_state); }
+            bool navigate_scanline(int y) 
+            { 
+                return m_ras->navigate_state(m_state, y); 
+            }
+            unsigned sweep_styles()    { return m_ras->sweep_styles(m_state); }
+            int      scanline_start()  const { return m_state.sl_start; }
+            unsigned scanline_length() const { return m_state.sl_len;   }
+            unsigned style(unsigned style_idx) const 
+            { 
+                return m_ras->style(m_state, style_idx); 
+            }
+
+            cover_type* allocate_cover_buffer(unsigned len)
+            {
+                return m_ras->allocate_cover_buffer(m_state, len);
+            }
+
+            template<class Scanline> bool sweep_scanline(Scanline& sl, int style_idx)
+            {
+                return m_ras->sweep_scanline(m_state, sl, style_idx);
+            }
+
+        private:
+            const rasterizer_type* m_ras;
+            sweep_state            m_state;
+        };
+
+    private:
+        //--------------------------------------------------------------------
+        bool rewind_state(sweep_state& st) const;
+        bool navigate_state(sweep_state& st, int y) const;
+        void add_style(sweep_state& st, int style_id) const;
+        unsigned sweep_styles(sweep_state& st) const;
+        unsigned style(const sweep_state& st, unsigned style_idx) const;
+        cover_type* allocate_cover_buffer(sweep_state& st, unsigned len) const;
+
+        //--------------------------------------------------------------------
+        template<class Scanline> 
+        bool sweep_scanline(sweep_state& st, Scanline& sl, int style_idx) const
+        {
+            int scan_y = st.scan_y - 1;
             if(scan_y > m_outline.max_y()) return false;
 
             sl.reset_spans();
@@ -223,10 +336,10 @@ namespace agg
                 style_idx++;
             }
 
-            const style_info& st = m_styles[m_ast[style_idx]];
+            const style_info& si = st.styles[st.ast[style_idx]];
 
-            unsigned num_cells = st.num_cells;
-            cell_info* cell = &m_cells[st.start_cell];
+            unsigned num_cells = si.num_cells;
+            const cell_info* cell = &st.cells[si.start_cell];
 
             int cover = 0;
             while(num_cells--)
@@ -261,9 +374,6 @@ namespace agg
             return true;
         }
 
-    private:
-        void add_style(int style_id);
-
         //--------------------------------------------------------------------
         // Disable copying
         rasterizer_compound_aa(const rasterizer_compound_aa<Clip>&);
@@ -275,19 +385,12 @@ namespace agg
         clip_type              m_clipper;
         filling_rule_e         m_filling_rule;
         layer_order_e          m_layer_order;
-        pod_vector<style_info> m_styles;  // Active Styles
-        pod_vector<unsigned>   m_ast;     // Active Style Table (unique values)
-        pod_vector<int8u>      m_asm;     // Active Style Mask 
-        pod_vector<cell_info>  m_cells;
-        pod_vector<cover_type> m_cover_buf;
+        sweep_state            m_state;
 
         int        m_min_style;
         int        m_max_style;
         coord_type m_start_x;
         coord_type m_start_y;
-        int        m_scan_y;
-        int        m_sl_start;
-        unsigned   m_sl_len;
     };
 
 
@@ -306,9 +409,9 @@ namespace agg
         m_outline.reset(); 
         m_min_style = std::numeric_limits<int>::max();
         m_max_style = std::numeric_limits<int>::min();
-        m_scan_y    = std::numeric_limits<int>::max();
-        m_sl_start  =  0;
-        m_sl_len    = 0;
+        m_state.scan_y   = std::numeric_limits<int>::max();
+        m_state.sl_start = 0;
+        m_state.sl_len   = 0;
     }
 
     //------------------------------------------------------------------------
@@ -449,7 +552,14 @@ namespace agg
     AGG_INLINE bool rasterizer_compound_aa<Clip>::rewind_scanlines()
     {
         m_outline.sort_cells();
-        if(m_outline.total_cells() == 0) 
+        return rewind_state(m_state);
+    }
+
+    //------------------------------------------------------------------------
+    template<class Clip> 
+    bool rasterizer_compound_aa<Clip>::rewind_state(sweep_state& st) const
+    {
+        if(!m_outline.sorted() || m_outline.total_cells() == 0) 
         {
             return false;
         }
@@ -457,14 +567,15 @@ namespace agg
         {
             return false;
         }
-        m_scan_y = m_outline.min_y();
-        m_styles.allocate(m_max_style - m_min_style + 2, 128);
+        st.scan_y = m_outline.min_y();
+        st.styles.allocate(m_max_style - m_min_style + 2, 128);
         return true;
     }
 
     //------------------------------------------------------------------------
     template<class Clip> 
-    AGG_INLINE void rasterizer_compound_aa<Clip>::add_style(int style_id)
+    AGG_INLINE void 
+    rasterizer_compound_aa<Clip>::add_style(sweep_state& st, int style_id) const
     {
         if(style_id < 0) style_id  = 0;
         else             style_id -= m_min_style - 1;
@@ -472,11 +583,11 @@ namespace agg
         unsigned nbyte = style_id >> 3;
         unsigned mask = 1 << (style_id & 7);
 
-        style_info* style = &m_styles[style_id];
-        if((m_asm[nbyte] & mask) == 0)
+        style_info* style = &st.styles[style_id];
+        if((st.asm_mask[nbyte] & mask) == 0)
         {
-            m_ast.add(style_id);
-            m_asm[nbyte] |= mask;
+            st.ast.add(style_id);
+            st.asm_mask[nbyte] |= mask;
             style->start_cell = 0;
             style->num_cells = 0;
             style->last_x = std::numeric_limits<int>::min();
@@ -487,57 +598,67 @@ namespace agg
     //------------------------------------------------------------------------
     // Returns the number of styles
     template<class Clip> 
-    unsigned rasterizer_compound_aa<Clip>::sweep_styles()
+    unsigned rasterizer_compound_aa<Clip>::sweep_styles(sweep_state& st) const
     {
         for(;;)
         {
-            if(m_scan_y > m_outline.max_y()) return 0;
-            unsigned num_cells = m_outline.scanline_num_cells(m_scan_y);
-            const cell_style_aa* const* cells = m_outline.scanline_cells(m_scan_y);
+            if(st.num_bands > 1)
+            {
+                // Skip to the nearest band of this sweeper
+                unsigned band = unsigned(st.scan_y - m_outline.min_y()) / st.band_height;
+                unsigned skip = (st.band_idx + st.num_bands - band % st.num_bands) % st.num_bands;
+                if(skip)
+                {
+                    st.scan_y = m_outline.min_y() + int((band + skip) * st.band_height);
+                }
+            }
+            if(st.scan_y > m_outline.max_y()) return 0;
+            unsigned num_cells = m_outline.scanline_num_cells(st.scan_y);
+            const cell_style_aa* const* cells = m_outline.scanline_cells(st.scan_y);
             unsigned num_styles = m_max_style - m_min_style + 2;
             const cell_style_aa* curr_cell;
             unsigned style_id;
             style_info* style;
             cell_info* cell;
 
-            m_cells.allocate(num_cells * 2, 256); // Each cell can have two styles
-            m_ast.capacity(num_styles, 64);
-            m_asm.allocate((num_styles + 7) >> 3, 8);
-            m_asm.zero();
+            st.cells.allocate(num_cells * 2, 256); // Each cell can have two styles
+            st.ast.capacity(num_styles, 64);
+            st.asm_mask.allocate((num_styles + 7) >> 3, 8);
+            st.asm_mask.zero();
 
             if(num_cells)
             {
                 // Pre-add zero (for no-fill style, that is, -1).
                 // We need that to ensure that the "-1 style" would go first.
-                m_asm[0] |= 1; 
-                m_ast.add(0);
-                style = &m_styles[0];
+                st.asm_mask[0] |= 1; 
+                st.ast.add(0);
+                style = &st.styles[0];
                 style->start_cell = 0;
                 style->num_cells = 0;
                 style->last_x = std::numeric_limits<int>::min();
 
-                m_sl_start = cells[0]->x;
-                m_sl_len   = cells[num_cells-1]->x - m_sl_start + 1;
+                st.sl_start = cells[0]->x;
+                st.sl_len   = cells[num_cells-1]->x - st.sl_start + 1;
                 while(num_cells--)
                 {
                     curr_cell = *cells++;
-                    add_style(curr_cell->left);
-                    add_style(curr_cell->right);
+                    add_style(st, curr_cell->left);
+                    add_style(st, curr_cell->right);
                 }
 
                 // Convert the Y-histogram into the array of starting indexes
                 unsigned i;
                 unsigned start_cell = 0;
-                for(i = 0; i < m_ast.size(); i++)
+                for(i = 0; i < st.ast.size(); i++)
                 {
-                    style_info& st = m_styles[m_ast[i]];
-                    unsigned v = st.start_cell;
-                    st.start_cell = start_cell;
+                    style_info& si = st.styles[st.ast[i]];
+                    unsigned v = si.start_cell;
+                    si.start_cell = start_cell;
                     start_cell += v;
                 }
 
-                cells = m_outline.scanline_cells(m_scan_y);
-                num_cells = m_outline.scanline_num_cells(m_scan_y);
+                cells = m_outline.scanline_cells(st.scan_y);
+                num_cells = m_outline.scanline_num_cells(st.scan_y);
 
                 while(num_cells--)
                 {
@@ -545,16 +666,16 @@ namespace agg
                     style_id = (curr_cell->left < 0) ? 0 : 
                                 curr_cell->left - m_min_style + 1;
 
-                    style = &m_styles[style_id];
+                    style = &st.styles[style_id];
                     if(curr_cell->x == style->last_x)
                     {
-                        cell = &m_cells[style->start_cell + style->num_cells - 1];
+                        cell = &st.cells[style->start_cell + style->num_cells - 1];
                         cell->area  += curr_cell->area;
                         cell->cover += curr_cell->cover;
                     }
                     else
                     {
-                        cell = &m_cells[style->start_cell + style->num_cells];
+                        cell = &st.cells[style->start_cell + style->num_cells];
                         cell->x       = curr_cell->x;
                         cell->area    = curr_cell->area;
                         cell->cover   = curr_cell->cover;
@@ -565,16 +686,16 @@ namespace agg
                     style_id = (curr_cell->right < 0) ? 0 : 
                                 curr_cell->right - m_min_style + 1;
 
-                    style = &m_styles[style_id];
+                    style = &st.styles[style_id];
                     if(curr_cell->x == style->last_x)
                     {
-                        cell = &m_cells[style->start_cell + style->num_cells - 1];
+                        cell = &st.cells[style->start_cell + style->num_cells - 1];
                         cell->area  -= curr_cell->area;
                         cell->cover -= curr_cell->cover;
                     }
                     else
                     {
-                        cell = &m_cells[style->start_cell + style->num_cells];
+                        cell = &st.cells[style->start_cell + style->num_cells];
                         cell->x       =  curr_cell->x;
                         cell->area    = -curr_cell->area;
                         cell->cover   = -curr_cell->cover;
@@ -583,28 +704,29 @@ namespace agg
                     }
                 }
             }
-            if(m_ast.size() > 1) break;
-            ++m_scan_y;
+            if(st.ast.size() > 1) break;
+            ++st.scan_y;
         }
-        ++m_scan_y;
+        ++st.scan_y;
 
         if(m_layer_order != layer_unsorted)
         {
-            range_adaptor<pod_vector<unsigned> > ra(m_ast, 1, m_ast.size() - 1);
+            range_adaptor<pod_vector<unsigned> > ra(st.ast, 1, st.ast.size() - 1);
             if(m_layer_order == layer_direct) quick_sort(ra, unsigned_greater);
             else                              quick_sort(ra, unsigned_less);
         }
 
-        return m_ast.size() - 1;
+        return st.ast.size() - 1;
     }
 
     //------------------------------------------------------------------------
     // Returns style ID depending of the existing style index
     template<class Clip> 
-    AGG_INLINE 
-    unsigned rasterizer_compound_aa<Clip>::style(unsigned style_idx) const
+    AGG_INLINE unsigned 
+    rasterizer_compound_aa<Clip>::style(const sweep_state& st, 
+                                        unsigned style_idx) const
     {
-        return m_ast[style_idx + 1] + m_min_style - 1;
+        return st.ast[style_idx + 1] + m_min_style - 1;
     }
 
     //------------------------------------------------------------------------ 
@@ -612,7 +734,14 @@ namespace agg
     AGG_INLINE bool rasterizer_compound_aa<Clip>::navigate_scanline(int y)
     {
         m_outline.sort_cells();
-        if(m_outline.total_cells() == 0) 
+        return navigate_state(m_state, y);
+    }
+
+    //------------------------------------------------------------------------ 
+    template<class Clip> 
+    bool rasterizer_compound_aa<Clip>::navigate_state(sweep_state& st, int y) const
+    {
+        if(!m_outline.sorted() || m_outline.total_cells() == 0) 
         {
             return false;
         }
@@ -624,8 +753,8 @@ namespace agg
         {
             return false;
         }
-        m_scan_y = y;
-        m_styles.allocate(m_max_style - m_min_style + 2, 128);
+        st.scan_y = y;
+        st.styles.allocate(m_max_style - m_min_style + 2, 128);
         return true;
     }
     
@@ -651,10 +780,12 @@ namespace agg
 
     //------------------------------------------------------------------------ 
     template<class Clip> 
-    cover_type* rasterizer_compound_aa<Clip>::allocate_cover_buffer(unsigned len)
+    cover_type* 
+    rasterizer_compound_aa<Clip>::allocate_cover_buffer(sweep_state& st, 
+                                                        unsigned len) const
     {
-        m_cover_buf.allocate(len, 256);
-        return &m_cover_buf[0];
+        st.cover_buf.allocate(len, 256);
+        return &st.cover_buf[0];
     }
 
 }
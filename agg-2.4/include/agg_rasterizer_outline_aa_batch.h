@@ -0,0 +1,496 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// class rasterizer_outline_aa_batch
+//
+// Renders many independent line segments with renderer_outline_aa, for
+// example, the edges of a large graph. Every segment is drawn exactly
+// like a two-vertex polyline of rasterizer_outline_aa, with the same
+// caps and the same pixels, but without the vertex sequence and the
+// joins. Before the rendering the segments are prepared in one pass:
+//
+//   - The lengths are calculated in SIMD, a few segments at a time.
+//   - The segments that don't touch the clip box of the base renderer
+//     are dropped, as well as the ones shorter than 1.5 pixels, which
+//     rasterizer_outline_aa drops too.
+//   - The rest are sorted by the tiles of tile_size pixels with a
+//     counting sort, so that the neighbouring segments are drawn one
+//     after another and their pixels stay in the cache.
+//
+// Because of the sorting the segments aren't drawn in the order they
+// were added, which only matters when the translucent segments of
+// different colors overlap.
+//
+// Only the lengths are calculated in SIMD. The pixels are drawn by
+// the distance interpolators of renderer_outline_aa, which stay scalar,
+// that's out of the scope of this class.
+//
+// render_parallel() draws the rows of tiles in different threads, each
+// one through a copy of the base renderer clipped to the row. The result
+// is byte-identical to render(). With one processor, or when there are
+// too few segments or rows of tiles to share, it is render().
+//
+// Usage:
+//   agg::rasterizer_outline_aa_batch<renderer_type> batch(ren);
+//   batch.round_cap(true);
+//   batch.add_segment_d(x1, y1, x2, y2, color);
+//   ...
+//   batch.render();
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_RASTERIZER_OUTLINE_AA_BATCH_INCLUDED
+#define AGG_RASTERIZER_OUTLINE_AA_BATCH_INCLUDED
+
+#include <cmath>
+#include "agg_basics.h"
+#include "agg_array.h"
+#include "agg_simd.h"
+#include "agg_threads.h"
+#include "agg_line_aa_basics.h"
+#include "agg_rasterizer_outline_aa.h"
+
+namespace agg
+{
+
+    //=================================================outline_aa_batch_lengths
+    // uround(sqrt(dx*dx + dy*dy)) for the pairs of dx, dy, exactly like
+    // line_aa_vertex calculates the lengths.
+    //------------------------------------------------------------------------
+    class outline_aa_batch_lengths
+    {
+    public:
+        static void calculate(const int* dxy, int* len, unsigned num)
+        {
+            unsigned i = 0;
+#if !defined(AGG_FISTP) && !defined(AGG_QIFIST)
+            switch(simd_level())
+            {
+#if defined(AGG_SIMD_AVX2)
+            case simd_avx2: i = calculate_avx2(dxy, len, num); break;
+#endif
+#if defined(AGG_SIMD_SSE2)
+            case simd_sse2: i = calculate_sse2(dxy, len, num); break;
+#endif
+            default: break;
+            }
+#endif
+            for(; i < num; i++)
+            {
+                double dx = dxy[i * 2];
+                double dy = dxy[i * 2 + 1];
+                len[i] = uround(std::sqrt(dx * dx + dy * dy));
+            }
+        }
+
+    private:
+#if defined(AGG_SIMD_SSE2)
+        //--------------------------------------------------------------------
+        static unsigned calculate_sse2(const int* dxy, int* len, unsigned num)
+        {
+            unsigned n = num & ~1u;
+            __m128d half = _mm_set1_pd(0.5);
+            unsigned i;
+            for(i = 0; i < n; i += 2)
+            {
+                __m128i v = _mm_shuffle_epi32(
+                                _mm_loadu_si128((const __m128i*)(dxy + i * 2)), 0xD8);
+                __m128d x = _mm_cvtepi32_pd(v);
+                __m128d y = _mm_cvtepi32_pd(_mm_shuffle_epi32(v, 0xEE));
+                __m128d d = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)));
+                _mm_storel_epi64((__m128i*)(len + i),
+                                 _mm_cvttpd_epi32(_mm_add_pd(d, half)));
+            }
+            return n;
+        }
+#endif
+
+#if defined(AGG_SIMD_AVX2)
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static unsigned calculate_avx2(const int* dxy, int* len, unsigned num)
+        {
+            unsigned n = num & ~3u;
+            __m256d half = _mm256_set1_pd(0.5);
+            __m256i perm = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+            unsigned i;
+            for(i = 0; i < n; i += 4)
+            {
+                __m256i v = _mm256_permutevar8x32_epi32(
+                                _mm256_loadu_si256((const __m256i*)(dxy + i * 2)), perm);
+                __m256d x = _mm256_cvtepi32_pd(_mm256_castsi256_si128(v));
+                __m256d y = _mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1));
+                __m256d d = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(x, x),
+                                                         _mm256_mul_pd(y, y)));
+                _mm_storeu_si128((__m128i*)(len + i),
+                                 _mm256_cvttpd_epi32(_mm256_add_pd(d, half)));
+            }
+            return n;
+        }
+#endif
+    };
+
+
+    //=============================================rasterizer_outline_aa_batch
+    template<class Renderer, class Coord=line_coord>
+    class rasterizer_outline_aa_batch
+    {
+    public:
+        typedef Renderer renderer_type;
+        typedef typename renderer_type::color_type color_type;
+        typedef typename renderer_type::base_ren_type base_ren_type;
+        typedef rasterizer_outline_aa_batch<Renderer, Coord> self_type;
+
+        enum tile_e
+        {
+            tile_shift = 6,
+            tile_size  = 1 << tile_shift
+        };
+
+    private:
+        enum prepare_chunk_e { prepare_chunk = 256 };
+
+        // Fewer segments per thread aren't worth starting it
+        enum min_thread_segments_e { min_thread_segments = 4096 };
+
+        struct segment
+        {
+            int        x1;
+            int        y1;
+            int        x2;
+            int        y2;
+            int        len;
+            color_type color;
+        };
+
+    public:
+        //--------------------------------------------------------------------
+        explicit rasterizer_outline_aa_batch(renderer_type& ren) :
+            m_ren(&ren),
+            m_round_cap(false),
+            m_num_sorted(0),
+            m_tiles_x(0),
+            m_tiles_y(0)
+        {}
+
+        void attach(renderer_type& ren) { m_ren = &ren; }
+
+        //--------------------------------------------------------------------
+        void round_cap(bool v) { m_round_cap = v; }
+        bool round_cap() const { return m_round_cap; }
+
+        //--------------------------------------------------------------------
+        void remove_all() { m_segments.remove_all(); }
+        unsigned num_segments() const { return m_segments.size(); }
+
+        //--------------------------------------------------------------------
+        // The coordinates in the subpixel units (line_subpixel_scale)
+        void add_segment(int x1, int y1, int x2, int y2, const color_type& c)
+        {
+            segment s;
+            s.x1    = x1;
+            s.y1    = y1;
+            s.x2    = x2;
+            s.y2    = y2;
+            s.len   = 0;
+            s.color = c;
+            m_segments.add(s);
+        }
+
+        void add_segment(int x1, int y1, int x2, int y2)
+        {
+            add_segment(x1, y1, x2, y2, m_ren->color());
+        }
+
+        //--------------------------------------------------------------------
+        void add_segment_d(double x1, double y1, double x2, double y2,
+                           const color_type& c)
+        {
+            add_segment(Coord::conv(x1), Coord::conv(y1),
+                        Coord::conv(x2), Coord::conv(y2), c);
+        }
+
+        void add_segment_d(double x1, double y1, double x2, double y2)
+        {
+            add_segment_d(x1, y1, x2, y2, m_ren->color());
+        }
+
+        //--------------------------------------------------------------------
+        // num segments as x1, y1, x2, y2 each
+        void add_segments_d(const double* xy, unsigned num, const color_type& c)
+        {
+            for(; num; --num)
+            {
+                add_segment_d(xy[0], xy[1], xy[2], xy[3], c);
+                xy += 4;
+            }
+        }
+
+        void add_segments_d(const double* xy, unsigned num)
+        {
+            add_segments_d(xy, num, m_ren->color());
+        }
+
+        //--------------------------------------------------------------------
+        void render()
+        {
+            prepare();
+            render_sorted();
+        }
+
+        //--------------------------------------------------------------------
+        // The same as render() in num_threads threads, 0 means one per
+        // processor. The renderer is copied for every row of tiles, so it
+        // must not be used from the other threads at the same time.
+        // There are never more threads than processors, the threads
+        // sharing one processor only add the cost of the rows.
+        void render_parallel(unsigned num_threads = 0)
+        {
+            unsigned max_threads = num_cpus();
+            if(num_threads == 0 || num_threads > max_threads)
+            {
+                num_threads = max_threads;
+            }
+            prepare();
+            if(num_threads > m_tiles_y) num_threads = m_tiles_y;
+            max_threads = m_num_sorted / min_thread_segments;
+            if(num_threads > max_threads) num_threads = max_threads;
+            if(num_threads < 2)
+            {
+                render_sorted();
+                return;
+            }
+            build_rows();
+            row_task task(*this);
+            run_parallel(task, num_threads);
+        }
+
+    private:
+        rasterizer_outline_aa_batch(const self_type&);
+        const self_type& operator = (const self_type&);
+
+        //--------------------------------------------------------------------
+        struct row_task
+        {
+            row_task(self_type& b) : self(&b) {}
+
+            void run(unsigned idx, unsigned num)
+            {
+                unsigned i;
+                for(i = idx; i < self->m_tiles_y; i += num)
+                {
+                    self->render_row(i);
+                }
+            }
+
+            self_type* self;
+        };
+
+        //--------------------------------------------------------------------
+        // A half of the line width with the smoother part, plus a pixel
+        int margin() const
+        {
+            return ((m_ren->subpixel_width() + line_subpixel_mask) >>
+                     line_subpixel_shift) + 1;
+        }
+
+        //--------------------------------------------------------------------
+        // Calculates the lengths, drops the invisible and the short
+        // segments and sorts the rest by the tiles into m_sorted.
+        void prepare()
+        {
+            m_num_sorted = 0;
+            const base_ren_type& rb = m_ren->ren();
+            int xmin = rb.xmin();
+            int ymin = rb.ymin();
+            int xmax = rb.xmax();
+            int ymax = rb.ymax();
+            unsigned n = m_segments.size();
+            if(n == 0 || xmin > xmax || ymin > ymax) return;
+
+            m_tiles_x = unsigned(xmax - xmin) / tile_size + 1;
+            m_tiles_y = unsigned(ymax - ymin) / tile_size + 1;
+            unsigned num_tiles = m_tiles_x * m_tiles_y;
+            m_keys.allocate(n);
+            m_counts.allocate(num_tiles + 1);
+            m_counts.zero();
+
+            int m = margin();
+            int dxy[prepare_chunk * 2];
+            int len[prepare_chunk];
+            unsigned i;
+            for(i = 0; i < n; i += prepare_chunk)
+            {
+                unsigned num = n - i;
+                if(num > unsigned(prepare_chunk)) num = prepare_chunk;
+                unsigned j;
+                for(j = 0; j < num; j++)
+                {
+                    const segment& s = m_segments[i + j];
+                    dxy[j * 2]     = s.x2 - s.x1;
+                    dxy[j * 2 + 1] = s.y2 - s.y1;
+                }
+                outline_aa_batch_lengths::calculate(dxy, len, num);
+
+                for(j = 0; j < num; j++)
+                {
+                    segment& s = m_segments[i + j];
+                    s.len = len[j];
+                    m_keys[i + j] = ~0u;
+                    if(s.len <= line_subpixel_scale + line_subpixel_scale / 2)
+                    {
+                        continue;
+                    }
+
+                    int x1 = ((s.x1 < s.x2) ? s.x1 : s.x2) >> line_subpixel_shift;
+                    int y1 = ((s.y1 < s.y2) ? s.y1 : s.y2) >> line_subpixel_shift;
+                    int x2 = ((s.x1 > s.x2) ? s.x1 : s.x2) >> line_subpixel_shift;
+                    int y2 = ((s.y1 > s.y2) ? s.y1 : s.y2) >> line_subpixel_shift;
+                    if(x2 + m < xmin || y2 + m < ymin ||
+                       x1 - m > xmax || y1 - m > ymax) continue;
+
+                    unsigned tx = (x1 > xmin) ? unsigned(x1 - xmin) / tile_size : 0;
+                    unsigned ty = (y1 > ymin) ? unsigned(y1 - ymin) / tile_size : 0;
+                    if(tx >= m_tiles_x) tx = m_tiles_x - 1;
+                    if(ty >= m_tiles_y) ty = m_tiles_y - 1;
+                    unsigned key = ty * m_tiles_x + tx;
+                    m_keys[i + j] = key;
+                    ++m_counts[key + 1];
+                    ++m_num_sorted;
+                }
+            }
+
+            for(i = 1; i <= num_tiles; i++) m_counts[i] += m_counts[i - 1];
+            m_sorted.allocate(m_num_sorted);
+            for(i = 0; i < n; i++)
+            {
+                unsigned key = m_keys[i];
+                if(key != ~0u) m_sorted[m_counts[key]++] = m_segments[i];
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void render_sorted()
+        {
+            unsigned i;
+            for(i = 0; i < m_num_sorted; i++)
+            {
+                draw(*m_ren, m_sorted[i]);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // Lists the sorted segments that touch every row of tiles
+        void build_rows()
+        {
+            const base_ren_type& rb = m_ren->ren();
+            int ymin = rb.ymin();
+            int ymax = rb.ymax();
+            int m = margin();
+
+            m_row_start.allocate(m_tiles_y + 1);
+            m_row_start.zero();
+            unsigned i;
+            for(i = 0; i < m_num_sorted; i++)
+            {
+                unsigned r1, r2;
+                segment_rows(m_sorted[i], ymin, ymax, m, &r1, &r2);
+                for(; r1 <= r2; r1++) ++m_row_start[r1 + 1];
+            }
+            for(i = 1; i <= m_tiles_y; i++) m_row_start[i] += m_row_start[i - 1];
+
+            m_row_idx.allocate(m_row_start[m_tiles_y]);
+            m_counts.allocate(m_tiles_y);
+            for(i = 0; i < m_tiles_y; i++) m_counts[i] = m_row_start[i];
+            for(i = 0; i < m_num_sorted; i++)
+            {
+                unsigned r1, r2;
+                segment_rows(m_sorted[i], ymin, ymax, m, &r1, &r2);
+                for(; r1 <= r2; r1++) m_row_idx[m_counts[r1]++] = i;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void segment_rows(const segment& s, int ymin, int ymax, int m,
+                          unsigned* r1, unsigned* r2) const
+        {
+            int y1 = (((s.y1 < s.y2) ? s.y1 : s.y2) >> line_subpixel_shift) - m;
+            int y2 = (((s.y1 > s.y2) ? s.y1 : s.y2) >> line_subpixel_shift) + m;
+            if(y1 < ymin) y1 = ymin;
+            if(y2 > ymax) y2 = ymax;
+            *r1 = unsigned(y1 - ymin) / tile_size;
+            *r2 = unsigned(y2 - ymin) / tile_size;
+        }
+
+        //--------------------------------------------------------------------
+        void render_row(unsigned row)
+        {
+            const base_ren_type& rb = m_ren->ren();
+            int y1 = rb.ymin() + int(row * tile_size);
+            int y2 = y1 + tile_size - 1;
+            if(y2 > rb.ymax()) y2 = rb.ymax();
+
+            base_ren_type rb_row(rb);
+            rb_row.clip_box_naked(rb.xmin(), y1, rb.xmax(), y2);
+            renderer_type ren(*m_ren);
+            ren.attach(rb_row);
+
+            unsigned i;
+            for(i = m_row_start[row]; i < m_row_start[row + 1]; i++)
+            {
+                draw(ren, m_sorted[m_row_idx[i]]);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // The same as rasterizer_outline_aa::render() with two vertices
+        void draw(renderer_type& ren, const segment& s) const
+        {
+            int x1 = s.x1;
+            int y1 = s.y1;
+            int x2 = s.x2;
+            int y2 = s.y2;
+            ren.color(s.color);
+            line_parameters lp(x1, y1, x2, y2, s.len);
+            if(m_round_cap)
+            {
+                ren.semidot(cmp_dist_start, x1, y1, x1 + (y2 - y1), y1 - (x2 - x1));
+            }
+            ren.line3(lp,
+                      x1 + (y2 - y1),
+                      y1 - (x2 - x1),
+                      x2 + (y2 - y1),
+                      y2 - (x2 - x1));
+            if(m_round_cap)
+            {
+                ren.semidot(cmp_dist_end, x2, y2, x2 + (y2 - y1), y2 - (x2 - x1));
+            }
+        }
+
+        renderer_type*           m_ren;
+        bool                     m_round_cap;
+        pod_bvector<segment, 12> m_segments;
+        pod_vector<segment>      m_sorted;
+        unsigned                 m_num_sorted;
+        pod_vector<unsigned>     m_keys;
+        pod_vector<unsigned>     m_counts;
+        unsigned                 m_tiles_x;
+        unsigned                 m_tiles_y;
+        pod_vector<unsigned>     m_row_start;
+        pod_vector<unsigned>     m_row_idx;
+    };
+
+}
+
+#endif
@@ -31,6 +31,7 @@
 
 #include "agg_rasterizer_cells_aa.h"
 #include "agg_rasterizer_sl_clip.h"
+#include "agg_vertex_batch.h"
 #include "agg_rasterizer_scanline_aa_nogamma.h"
 #include "agg_gamma_functions.h"
 
@@ -67,8 +68,17 @@ namespace agg
     //    while the intersecting contours with different orders will have "holes".
     //
     // filling_rule() and gamma() can be called anytime before "sweeping".
+    //
+    // CellSorter defines how the cells are sorted before sweeping, 
+    // cell_sorter_qsort<cell_aa> (default) or cell_sorter_radix<cell_aa>.
+    // Both produce exactly the same result. Allocator gives the memory
+    // for the cells, pod_allocator (default) or arena_allocator, see
+    // agg_arena.h.
     //------------------------------------------------------------------------
-    template<class Clip=rasterizer_sl_clip_int> class rasterizer_scanline_aa
+    template<class Clip=rasterizer_sl_clip_int, 
+             class CellSorter=cell_sorter_qsort<cell_aa>,
+             template<class> class Allocator=pod_allocator> 
+    class rasterizer_scanline_aa
     {
         enum status
         {
@@ -80,6 +90,8 @@ namespace agg
 
     public:
         typedef Clip                      clip_type;
+        typedef CellSorter                cell_sorter_type;
+        typedef rasterizer_cells_aa<cell_aa, CellSorter, Allocator> outline_type;
         typedef typename Clip::conv_type  conv_type;
         typedef typename Clip::coord_type coord_type;
 
@@ -126,6 +138,8 @@ namespace agg
         void clip_box(double x1, double y1, double x2, double y2);
         void filling_rule(filling_rule_e filling_rule);
         void auto_close(bool flag) { m_auto_close = flag; }
+        void band(int y1, int y2);
+        void reset_band();
 
         //--------------------------------------------------------------------
         template<class GammaF> void gamma(const GammaF& gamma_function)
@@ -155,18 +169,57 @@ namespace agg
         void edge_d(double x1, double y1, double x2, double y2);
 
         //-------------------------------------------------------------------
+        // The vertices are read in blocks, see agg_vertex_batch.h
         template<class VertexSource>
         void add_path(VertexSource& vs, unsigned path_id=0)
         {
-            double x;
-            double y;
+            double   xy[vertex_batch_size * 2];
+            unsigned cmds[vertex_batch_size];
+            unsigned n;
+            unsigned i;
+
+            vs.rewind(path_id);
+            if(m_outline.sorted()) reset();
+            do
+            {
+                n = read_vertices(vs, xy, cmds, vertex_batch_size);
+                for(i = 0; i < n; i++)
+                {
+                    add_vertex(xy[i * 2], xy[i * 2 + 1], cmds[i]);
+                }
+            }
+            while(n == vertex_batch_size);
+        }
+
+        //-------------------------------------------------------------------
+        // The same for the integer vertex sources, see agg_path_storage_int.h.
+        // The coordinates are in the subpixel units and go to move_to()
+        // and line_to() without any conversion.
+        template<class VertexSource>
+        void add_path_int(VertexSource& vs, unsigned path_id=0)
+        {
+            int x;
+            int y;
 
             unsigned cmd;
             vs.rewind(path_id);
             if(m_outline.sorted()) reset();
             while(!is_stop(cmd = vs.vertex(&x, &y)))
             {
-                add_vertex(x, y, cmd);
+                if(is_move_to(cmd))
+                {
+                    move_to(x, y);
+                }
+                else
+                if(is_vertex(cmd))
+                {
+                    line_to(x, y);
+                }
+                else
+                if(is_close(cmd))
+                {
+                    close_polygon();
+                }
             }
         }
         
@@ -176,6 +229,33 @@ namespace agg
         int max_x() const { return m_outline.max_x(); }
         int max_y() const { return m_outline.max_y(); }
 
+        //--------------------------------------------------------------------
+        // Capacity planning, the overflow policy and the counters,
+        // see rasterizer_cells_aa. With cell_overflow_error the shape
+        // that lost cells isn't rendered at all.
+        void reserve(unsigned num_cells, unsigned num_scanlines=0)
+        {
+            m_outline.reserve(num_cells, num_scanlines);
+        }
+        void shrink_to_fit() { m_outline.shrink_to_fit(); }
+        unsigned capacity() const { return m_outline.capacity(); }
+
+        void cell_block_limit(unsigned limit) { m_outline.cell_block_limit(limit); }
+        unsigned cell_block_limit() const { return m_outline.cell_block_limit(); }
+
+        void overflow_policy(cell_overflow_e p) { m_outline.overflow_policy(p); }
+        cell_overflow_e overflow_policy() const { return m_outline.overflow_policy(); }
+        bool overflow() const { return m_outline.overflow(); }
+
+        unsigned peak_cells()    const { return m_outline.peak_cells(); }
+        unsigned peak_blocks()   const { return m_outline.peak_blocks(); }
+        unsigned num_overflows() const { return m_outline.num_overflows(); }
+        unsigned dropped_cells() const { return m_outline.dropped_cells(); }
+        void reset_stats() { m_outline.reset_stats(); }
+
+        int band_min_y() const { return m_outline.band_min_y(); }
+        int band_max_y() const { return m_outline.band_max_y(); }
+
         //--------------------------------------------------------------------
         void sort();
         bool rewind_scanlines();
@@ -207,7 +287,8 @@ namespace agg
                 if(m_scan_y > m_outline.max_y()) return false;
                 sl.reset_spans();
                 unsigned num_cells = m_outline.scanline_num_cells(m_scan_y);
-                const cell_aa* const* cells = m_outline.scanline_cells(m_scan_y);
+                typename outline_type::const_iterator cells = 
+                    m_outline.scanline_cells(m_scan_y);
                 int cover = 0;
 
                 while(num_cells)
@@ -262,14 +343,21 @@ namespace agg
 
 
     private:
+        //--------------------------------------------------------------------
+        bool rejected() const
+        {
+            return m_outline.overflow() && 
+                   m_outline.overflow_policy() == cell_overflow_error;
+        }
+
         //--------------------------------------------------------------------
         // Disable copying
-        rasterizer_scanline_aa(const rasterizer_scanline_aa<Clip>&);
-        const rasterizer_scanline_aa<Clip>& 
-        operator = (const rasterizer_scanline_aa<Clip>&);
+        rasterizer_scanline_aa(const rasterizer_scanline_aa<Clip, CellSorter, Allocator>&);
+        const rasterizer_scanline_aa<Clip, CellSorter, Allocator>& 
+        operator = (const rasterizer_scanline_aa<Clip, CellSorter, Allocator>&);
 
     private:
-        rasterizer_cells_aa<cell_aa> m_outline;
+        outline_type   m_outline;
         clip_type      m_clipper;
         int            m_gamma[aa_scale];
         filling_rule_e m_filling_rule;
@@ -292,23 +380,23 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::reset() 
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::reset() 
     { 
         m_outline.reset(); 
         m_status = status_initial;
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::filling_rule(filling_rule_e filling_rule) 
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::filling_rule(filling_rule_e filling_rule) 
     { 
         m_filling_rule = filling_rule; 
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::clip_box(double x1, double y1, 
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::clip_box(double x1, double y1, 
                                                 double x2, double y2)
     {
         reset();
@@ -317,16 +405,32 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::reset_clipping()
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::reset_clipping()
     {
         reset();
         m_clipper.reset_clipping();
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::close_polygon()
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::band(int y1, int y2)
+    {
+        reset();
+        m_outline.band(y1, y2);
+    }
+
+    //------------------------------------------------------------------------
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::reset_band()
+    {
+        reset();
+        m_outline.reset_band();
+    }
+
+    //------------------------------------------------------------------------
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::close_polygon()
     {
         if(m_status == status_line_to)
         {
@@ -336,8 +440,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::move_to(int x, int y)
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::move_to(int x, int y)
     {
         if(m_outline.sorted()) reset();
         if(m_auto_close) close_polygon();
@@ -347,8 +451,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::line_to(int x, int y)
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::line_to(int x, int y)
     {
         m_clipper.line_to(m_outline, 
                           conv_type::downscale(x), 
@@ -357,8 +461,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::move_to_d(double x, double y) 
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::move_to_d(double x, double y) 
     { 
         if(m_outline.sorted()) reset();
         if(m_auto_close) close_polygon();
@@ -368,8 +472,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::line_to_d(double x, double y) 
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::line_to_d(double x, double y) 
     { 
         m_clipper.line_to(m_outline, 
                           conv_type::upscale(x), 
@@ -378,8 +482,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::add_vertex(double x, double y, unsigned cmd)
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::add_vertex(double x, double y, unsigned cmd)
     {
         if(is_move_to(cmd)) 
         {
@@ -398,8 +502,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::edge(int x1, int y1, int x2, int y2)
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::edge(int x1, int y1, int x2, int y2)
     {
         if(m_outline.sorted()) reset();
         m_clipper.move_to(conv_type::downscale(x1), conv_type::downscale(y1));
@@ -410,8 +514,8 @@ namespace agg
     }
     
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::edge_d(double x1, double y1, 
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::edge_d(double x1, double y1, 
                                               double x2, double y2)
     {
         if(m_outline.sorted()) reset();
@@ -423,20 +527,20 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa<Clip>::sort()
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa<Clip, CellSorter, A>::sort()
     {
         if(m_auto_close) close_polygon();
         m_outline.sort_cells();
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    AGG_INLINE bool rasterizer_scanline_aa<Clip>::rewind_scanlines()
+    template<class Clip, class CellSorter, template<class> class A> 
+    AGG_INLINE bool rasterizer_scanline_aa<Clip, CellSorter, A>::rewind_scanlines()
     {
         if(m_auto_close) close_polygon();
         m_outline.sort_cells();
-        if(m_outline.total_cells() == 0) 
+        if(m_outline.total_cells() == 0 || rejected()) 
         {
             return false;
         }
@@ -446,12 +550,12 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    AGG_INLINE bool rasterizer_scanline_aa<Clip>::navigate_scanline(int y)
+    template<class Clip, class CellSorter, template<class> class A> 
+    AGG_INLINE bool rasterizer_scanline_aa<Clip, CellSorter, A>::navigate_scanline(int y)
     {
         if(m_auto_close) close_polygon();
         m_outline.sort_cells();
-        if(m_outline.total_cells() == 0 || 
+        if(m_outline.total_cells() == 0 || rejected() ||
            y < m_outline.min_y() || 
            y > m_outline.max_y()) 
         {
@@ -462,8 +566,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    bool rasterizer_scanline_aa<Clip>::hit_test(int tx, int ty)
+    template<class Clip, class CellSorter, template<class> class A> 
+    bool rasterizer_scanline_aa<Clip, CellSorter, A>::hit_test(int tx, int ty)
     {
         if(!navigate_scanline(ty)) return false;
         scanline_hit_test sl(tx);
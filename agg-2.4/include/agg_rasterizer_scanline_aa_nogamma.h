@@ -32,6 +32,7 @@
 #include <limits>
 #include "agg_rasterizer_cells_aa.h"
 #include "agg_rasterizer_sl_clip.h"
+#include "agg_vertex_batch.h"
 
 
 namespace agg
@@ -97,7 +98,10 @@ namespace agg
     //
     // filling_rule() and gamma() can be called anytime before "sweeping".
     //------------------------------------------------------------------------
-    template<class Clip=rasterizer_sl_clip_int> class rasterizer_scanline_aa_nogamma
+    template<class Clip=rasterizer_sl_clip_int, 
+             class CellSorter=cell_sorter_qsort<cell_aa>,
+             template<class> class Allocator=pod_allocator> 
+    class rasterizer_scanline_aa_nogamma
     {
         enum status
         {
@@ -109,6 +113,8 @@ namespace agg
 
     public:
         typedef Clip                      clip_type;
+        typedef CellSorter                cell_sorter_type;
+        typedef rasterizer_cells_aa<cell_aa, CellSorter, Allocator> outline_type;
         typedef typename Clip::conv_type  conv_type;
         typedef typename Clip::coord_type coord_type;
 
@@ -139,6 +145,8 @@ namespace agg
         void clip_box(double x1, double y1, double x2, double y2);
         void filling_rule(filling_rule_e filling_rule);
         void auto_close(bool flag) { m_auto_close = flag; }
+        void band(int y1, int y2);
+        void reset_band();
 
         //--------------------------------------------------------------------
         unsigned apply_gamma(unsigned cover) const 
@@ -158,18 +166,57 @@ namespace agg
         void edge_d(double x1, double y1, double x2, double y2);
 
         //-------------------------------------------------------------------
+        // The vertices are read in blocks, see agg_vertex_batch.h
         template<class VertexSource>
         void add_path(VertexSource& vs, unsigned path_id=0)
         {
-            double x;
-            double y;
+            double   xy[vertex_batch_size * 2];
+            unsigned cmds[vertex_batch_size];
+            unsigned n;
+            unsigned i;
+
+            vs.rewind(path_id);
+            if(m_outline.sorted()) reset();
+            do
+            {
+                n = read_vertices(vs, xy, cmds, vertex_batch_size);
+                for(i = 0; i < n; i++)
+                {
+                    add_vertex(xy[i * 2], xy[i * 2 + 1], cmds[i]);
+                }
+            }
+            while(n == vertex_batch_size);
+        }
+
+        //-------------------------------------------------------------------
+        // The same for the integer vertex sources, see agg_path_storage_int.h.
+        // The coordinates are in the subpixel units and go to move_to()
+        // and line_to() without any conversion.
+        template<class VertexSource>
+        void add_path_int(VertexSource& vs, unsigned path_id=0)
+        {
+            int x;
+            int y;
 
             unsigned cmd;
             vs.rewind(path_id);
             if(m_outline.sorted()) reset();
             while(!is_stop(cmd = vs.vertex(&x, &y)))
             {
-                add_vertex(x, y, cmd);
+                if(is_move_to(cmd))
+                {
+                    move_to(x, y);
+                }
+                else
+                if(is_vertex(cmd))
+                {
+                    line_to(x, y);
+                }
+                else
+                if(is_close(cmd))
+                {
+                    close_polygon();
+                }
             }
         }
         
@@ -179,6 +226,33 @@ namespace agg
         int max_x() const { return m_outline.max_x(); }
         int max_y() const { return m_outline.max_y(); }
 
+        //--------------------------------------------------------------------
+        // Capacity planning, the overflow policy and the counters,
+        // see rasterizer_cells_aa. With cell_overflow_error the shape
+        // that lost cells isn't rendered at all.
+        void reserve(unsigned num_cells, unsigned num_scanlines=0)
+        {
+            m_outline.reserve(num_cells, num_scanlines);
+        }
+        void shrink_to_fit() { m_outline.shrink_to_fit(); }
+        unsigned capacity() const { return m_outline.capacity(); }
+
+        void cell_block_limit(unsigned limit) { m_outline.cell_block_limit(limit); }
+        unsigned cell_block_limit() const { return m_outline.cell_block_limit(); }
+
+        void overflow_policy(cell_overflow_e p) { m_outline.overflow_policy(p); }
+        cell_overflow_e overflow_policy() const { return m_outline.overflow_policy(); }
+        bool overflow() const { return m_outline.overflow(); }
+
+        unsigned peak_cells()    const { return m_outline.peak_cells(); }
+        unsigned peak_blocks()   const { return m_outline.peak_blocks(); }
+        unsigned num_overflows() const { return m_outline.num_overflows(); }
+        unsigned dropped_cells() const { return m_outline.dropped_cells(); }
+        void reset_stats() { m_outline.reset_stats(); }
+
+        int band_min_y() const { return m_outline.band_min_y(); }
+        int band_max_y() const { return m_outline.band_max_y(); }
+
         //--------------------------------------------------------------------
         void sort();
         bool rewind_scanlines();
@@ -210,7 +284,8 @@ namespace agg
                 if(m_scan_y > m_outline.max_y()) return false;
                 sl.reset_spans();
                 unsigned num_cells = m_outline.scanline_num_cells(m_scan_y);
-                const cell_aa* const* cells = m_outline.scanline_cells(m_scan_y);
+                typename outline_type::const_iterator cells = 
+                    m_outline.scanline_cells(m_scan_y);
                 int cover = 0;
 
                 while(num_cells)
@@ -265,14 +340,21 @@ namespace agg
 
 
     private:
+        //--------------------------------------------------------------------
+        bool rejected() const
+        {
+            return m_outline.overflow() && 
+                   m_outline.overflow_policy() == cell_overflow_error;
+        }
+
         //--------------------------------------------------------------------
         // Disable copying
-        rasterizer_scanline_aa_nogamma(const rasterizer_scanline_aa_nogamma<Clip>&);
-        const rasterizer_scanline_aa_nogamma<Clip>& 
-        operator = (const rasterizer_scanline_aa_nogamma<Clip>&);
+        rasterizer_scanline_aa_nogamma(const rasterizer_scanline_aa_nogamma<Clip, CellSorter, Allocator>&);
+        const rasterizer_scanline_aa_nogamma<Clip, CellSorter, Allocator>& 
+        operator = (const rasterizer_scanline_aa_nogamma<Clip, CellSorter, Allocator>&);
 
     private:
-        rasterizer_cells_aa<cell_aa> m_outline;
+        outline_type   m_outline;
         clip_type      m_clipper;
         filling_rule_e m_filling_rule;
         bool           m_auto_close;
@@ -294,23 +376,23 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::reset() 
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::reset() 
     { 
         m_outline.reset(); 
         m_status = status_initial;
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::filling_rule(filling_rule_e filling_rule) 
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::filling_rule(filling_rule_e filling_rule) 
     { 
         m_filling_rule = filling_rule; 
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::clip_box(double x1, double y1, 
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::clip_box(double x1, double y1, 
                                                 double x2, double y2)
     {
         reset();
@@ -319,16 +401,32 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::reset_clipping()
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::reset_clipping()
     {
         reset();
         m_clipper.reset_clipping();
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::close_polygon()
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::band(int y1, int y2)
+    {
+        reset();
+        m_outline.band(y1, y2);
+    }
+
+    //------------------------------------------------------------------------
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::reset_band()
+    {
+        reset();
+        m_outline.reset_band();
+    }
+
+    //------------------------------------------------------------------------
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::close_polygon()
     {
         if(m_status == status_line_to)
         {
@@ -338,8 +436,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::move_to(int x, int y)
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::move_to(int x, int y)
     {
         if(m_outline.sorted()) reset();
         if(m_auto_close) close_polygon();
@@ -349,8 +447,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::line_to(int x, int y)
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::line_to(int x, int y)
     {
         m_clipper.line_to(m_outline, 
                           conv_type::downscale(x), 
@@ -359,8 +457,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::move_to_d(double x, double y) 
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::move_to_d(double x, double y) 
     { 
         if(m_outline.sorted()) reset();
         if(m_auto_close) close_polygon();
@@ -370,8 +468,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::line_to_d(double x, double y) 
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::line_to_d(double x, double y) 
     { 
         m_clipper.line_to(m_outline, 
                           conv_type::upscale(x), 
@@ -380,8 +478,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::add_vertex(double x, double y, unsigned cmd)
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::add_vertex(double x, double y, unsigned cmd)
     {
         if(is_move_to(cmd)) 
         {
@@ -400,8 +498,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::edge(int x1, int y1, int x2, int y2)
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::edge(int x1, int y1, int x2, int y2)
     {
         if(m_outline.sorted()) reset();
         m_clipper.move_to(conv_type::downscale(x1), conv_type::downscale(y1));
@@ -412,8 +510,8 @@ namespace agg
     }
     
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::edge_d(double x1, double y1, 
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::edge_d(double x1, double y1, 
                                               double x2, double y2)
     {
         if(m_outline.sorted()) reset();
@@ -425,20 +523,20 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    void rasterizer_scanline_aa_nogamma<Clip>::sort()
+    template<class Clip, class CellSorter, template<class> class A> 
+    void rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::sort()
     {
         if(m_auto_close) close_polygon();
         m_outline.sort_cells();
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    AGG_INLINE bool rasterizer_scanline_aa_nogamma<Clip>::rewind_scanlines()
+    template<class Clip, class CellSorter, template<class> class A> 
+    AGG_INLINE bool rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::rewind_scanlines()
     {
         if(m_auto_close) close_polygon();
         m_outline.sort_cells();
-        if(m_outline.total_cells() == 0) 
+        if(m_outline.total_cells() == 0 || rejected()) 
         {
             return false;
         }
@@ -448,12 +546,12 @@ namespace agg
 
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    AGG_INLINE bool rasterizer_scanline_aa_nogamma<Clip>::navigate_scanline(int y)
+    template<class Clip, class CellSorter, template<class> class A> 
+    AGG_INLINE bool rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::navigate_scanline(int y)
     {
         if(m_auto_close) close_polygon();
         m_outline.sort_cells();
-        if(m_outline.total_cells() == 0 || 
+        if(m_outline.total_cells() == 0 || rejected() ||
            y < m_outline.min_y() || 
            y > m_outline.max_y()) 
         {
@@ -464,8 +562,8 @@ namespace agg
     }
 
     //------------------------------------------------------------------------
-    template<class Clip> 
-    bool rasterizer_scanline_aa_nogamma<Clip>::hit_test(int tx, int ty)
+    template<class Clip, class CellSorter, template<class> class A> 
+    bool rasterizer_scanline_aa_nogamma<Clip, CellSorter, A>::hit_test(int tx, int ty)
     {
         if(!navigate_scanline(ty)) return false;
         scanline_hit_test sl(tx);
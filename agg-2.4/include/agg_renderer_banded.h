@@ -0,0 +1,205 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+#ifndef AGG_RENDERER_BANDED_INCLUDED
+#define AGG_RENDERER_BANDED_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_threads.h"
+
+namespace agg
+{
+
+    //=========================================================renderer_banded
+    // Renders a scene by horizontal bands of the base renderer's clip box.
+    // Every band is rasterized independently with its own rasterizer and
+    // scanline, using rasterizer::band(), so that the bands can be rendered
+    // in parallel. Since band() doesn't clip the geometry but only drops
+    // the cells outside the band the result is byte-identical to the
+    // serial rendering.
+    //
+    // The Scene is any class that renders itself with the given rasterizer,
+    // scanline and base renderer, that is:
+    //
+    // class scene
+    // {
+    // public:
+    //     template<class Rasterizer, class Scanline, class BaseRenderer>
+    //     void render(Rasterizer& ras, Scanline& sl, BaseRenderer& ren);
+    // };
+    //
+    // scene::render() is called once for each band, possibly from different
+    // threads at the same time. So, it must not modify any shared state;
+    // the span allocators and span generators with internal state must be
+    // created inside render(). The vertex sources are replayed for every
+    // band, the lines that don't touch the band are rejected early.
+    // The rasterizer comes in after reset(), with the default clipping,
+    // filling rule and gamma left from the previous band, so the scene
+    // should set up whatever it needs, for example, ras.clip_box().
+    //------------------------------------------------------------------------
+    template<class BaseRenderer,
+             class Rasterizer=rasterizer_scanline_aa<>,
+             class Scanline=scanline_u8>
+    class renderer_banded
+    {
+    public:
+        typedef BaseRenderer base_ren_type;
+        typedef Rasterizer   rasterizer_type;
+        typedef Scanline     scanline_type;
+        typedef renderer_banded<BaseRenderer, Rasterizer, Scanline> self_type;
+
+        //--------------------------------------------------------------------
+        struct worker
+        {
+            rasterizer_type ras;
+            scanline_type   sl;
+        };
+
+        //--------------------------------------------------------------------
+        ~renderer_banded()
+        {
+            free_workers();
+        }
+
+        //--------------------------------------------------------------------
+        explicit renderer_banded(base_ren_type& ren, unsigned band_height=32) :
+            m_ren(&ren),
+            m_band_height(band_height ? band_height : 1),
+            m_workers(0),
+            m_num_workers(0)
+        {}
+
+        //--------------------------------------------------------------------
+        void attach(base_ren_type& ren) { m_ren = &ren; }
+        base_ren_type& ren() { return *m_ren; }
+
+        //--------------------------------------------------------------------
+        void band_height(unsigned h) { m_band_height = h ? h : 1; }
+        unsigned band_height() const { return m_band_height; }
+
+        //--------------------------------------------------------------------
+        unsigned num_bands() const
+        {
+            int h = m_ren->ymax() - m_ren->ymin() + 1;
+            if(h <= 0) return 0;
+            return (unsigned(h) + m_band_height - 1) / m_band_height;
+        }
+
+        //--------------------------------------------------------------------
+        // Renders a single band. It's safe to call it simultaneously for
+        // different bands as long as every thread uses its own rasterizer
+        // and scanline.
+        template<class Scene>
+        void render_band(unsigned band, Scene& scene,
+                         rasterizer_type& ras, scanline_type& sl)
+        {
+            int y1 = m_ren->ymin() + int(band * m_band_height);
+            int y2 = y1 + int(m_band_height) - 1;
+            if(y2 > m_ren->ymax()) y2 = m_ren->ymax();
+            if(y1 > y2) return;
+
+            base_ren_type ren(*m_ren);
+            ren.clip_box_naked(m_ren->xmin(), y1, m_ren->xmax(), y2);
+            ras.band(y1, y2);
+            scene.render(ras, sl, ren);
+        }
+
+        //--------------------------------------------------------------------
+        // Renders all the bands using num_threads threads, 0 means one
+        // thread per processor. The bands are interleaved between the
+        // threads to balance the load. The workers (rasterizers and
+        // scanlines) are kept between the calls to reuse their memory.
+        template<class Scene> void render(Scene& scene, unsigned num_threads=0)
+        {
+            if(num_threads == 0) num_threads = num_cpus();
+            unsigned nb = num_bands();
+            if(nb == 0) return;
+            if(num_threads > nb) num_threads = nb;
+            allocate_workers(num_threads);
+
+            band_task<Scene> task(*this, scene);
+            run_parallel(task, num_threads);
+        }
+
+        //--------------------------------------------------------------------
+        unsigned num_workers() const { return m_num_workers; }
+        worker& worker_at(unsigned i) { return *m_workers[i]; }
+
+    private:
+        //--------------------------------------------------------------------
+        template<class Scene> struct band_task
+        {
+            band_task(self_type& r, Scene& s) : ren(&r), scene(&s) {}
+
+            void run(unsigned idx, unsigned num)
+            {
+                worker& w = ren->worker_at(idx);
+                unsigned nb = ren->num_bands();
+                unsigned i;
+                for(i = idx; i < nb; i += num)
+                {
+                    ren->render_band(i, *scene, w.ras, w.sl);
+                }
+            }
+
+            self_type* ren;
+            Scene*     scene;
+        };
+
+        //--------------------------------------------------------------------
+        void allocate_workers(unsigned num)
+        {
+            if(num <= m_num_workers) return;
+            worker** w = pod_allocator<worker*>::allocate(num);
+            unsigned i;
+            for(i = 0; i < m_num_workers; i++) w[i] = m_workers[i];
+            for(; i < num; i++) w[i] = obj_allocator<worker>::allocate();
+            if(m_workers)
+            {
+                pod_allocator<worker*>::deallocate(m_workers, m_num_workers);
+            }
+            m_workers = w;
+            m_num_workers = num;
+        }
+
+        //--------------------------------------------------------------------
+        void free_workers()
+        {
+            unsigned i;
+            for(i = 0; i < m_num_workers; i++)
+            {
+                obj_allocator<worker>::deallocate(m_workers[i]);
+            }
+            if(m_workers)
+            {
+                pod_allocator<worker*>::deallocate(m_workers, m_num_workers);
+            }
+            m_workers = 0;
+            m_num_workers = 0;
+        }
+
+        renderer_banded(const self_type&);
+        const self_type& operator = (const self_type&);
+
+        base_ren_type* m_ren;
+        unsigned       m_band_height;
+        worker**       m_workers;
+        unsigned       m_num_workers;
+    };
+
+}
+
+#endif
@@ -0,0 +1,553 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// class renderer_mclip_indexed
+//
+// The same as renderer_mclip, but the clip boxes are indexed, so that
+// every span is rendered only through the boxes it intersects. The frame
+// is divided into the horizontal bands, about as high as the boxes are
+// on average. Every band keeps the boxes that intersect it, sorted by x1,
+// and the boxes of a span are found with a binary search. The boxes that
+// cross several bands are clipped to the rows of the band, so that the
+// vertical lines and the bars aren't rendered twice through them.
+//
+// The index is built on the first rendering after the boxes change.
+// Like with renderer_mclip, the overlapping boxes render their common
+// pixels more than once.
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_RENDERER_MCLIP_INDEXED_INCLUDED
+#define AGG_RENDERER_MCLIP_INDEXED_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_array.h"
+#include "agg_renderer_base.h"
+
+namespace agg
+{
+
+    //--------------------------------------------------renderer_mclip_indexed
+    template<class PixelFormat> class renderer_mclip_indexed
+    {
+        enum band_shift_e
+        {
+            band_shift_min = 2,
+            band_shift_max = 10
+        };
+
+        struct band_type
+        {
+            unsigned start;
+            unsigned num;
+            int      max_width;
+        };
+
+        static bool box_x1_less(const rect_i& a, const rect_i& b)
+        {
+            return a.x1 < b.x1;
+        }
+
+    public:
+        typedef PixelFormat pixfmt_type;
+        typedef typename pixfmt_type::color_type color_type;
+        typedef typename pixfmt_type::row_data row_data;
+        typedef renderer_base<pixfmt_type> base_ren_type;
+
+        //--------------------------------------------------------------------
+        explicit renderer_mclip_indexed(pixfmt_type& pixf) :
+            m_ren(pixf),
+            m_curr_cb(0),
+            m_bounds(m_ren.xmin(), m_ren.ymin(), m_ren.xmax(), m_ren.ymax()),
+            m_index_valid(false),
+            m_band_shift(band_shift_min),
+            m_band(0),
+            m_band_last(0),
+            m_idx(0),
+            m_idx_end(0)
+        {}
+        void attach(pixfmt_type& pixf)
+        {
+            m_ren.attach(pixf);
+            reset_clipping(true);
+        }
+
+        //--------------------------------------------------------------------
+        const pixfmt_type& ren() const { return m_ren.ren();  }
+        pixfmt_type& ren() { return m_ren.ren();  }
+
+        //--------------------------------------------------------------------
+        unsigned width()  const { return m_ren.width();  }
+        unsigned height() const { return m_ren.height(); }
+
+        //--------------------------------------------------------------------
+        const rect_i& clip_box() const { return m_ren.clip_box(); }
+        int           xmin()     const { return m_ren.xmin(); }
+        int           ymin()     const { return m_ren.ymin(); }
+        int           xmax()     const { return m_ren.xmax(); }
+        int           ymax()     const { return m_ren.ymax(); }
+
+        //--------------------------------------------------------------------
+        const rect_i& bounding_clip_box() const { return m_bounds;    }
+        int           bounding_xmin()     const { return m_bounds.x1; }
+        int           bounding_ymin()     const { return m_bounds.y1; }
+        int           bounding_xmax()     const { return m_bounds.x2; }
+        int           bounding_ymax()     const { return m_bounds.y2; }
+
+        //--------------------------------------------------------------------
+        // All the clip boxes in the order they were added,
+        // like in renderer_mclip
+        void first_clip_box()
+        {
+            m_curr_cb = 0;
+            if(m_clip.size())
+            {
+                const rect_i& cb = m_clip[0];
+                m_ren.clip_box_naked(cb.x1, cb.y1, cb.x2, cb.y2);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        bool next_clip_box()
+        {
+            if(++m_curr_cb < m_clip.size())
+            {
+                const rect_i& cb = m_clip[m_curr_cb];
+                m_ren.clip_box_naked(cb.x1, cb.y1, cb.x2, cb.y2);
+                return true;
+            }
+            return false;
+        }
+
+        //--------------------------------------------------------------------
+        void reset_clipping(bool visibility)
+        {
+            m_ren.reset_clipping(visibility);
+            m_clip.remove_all();
+            m_curr_cb = 0;
+            m_bounds = m_ren.clip_box();
+            m_index_valid = false;
+        }
+
+        //--------------------------------------------------------------------
+        void add_clip_box(int x1, int y1, int x2, int y2)
+        {
+            rect_i cb(x1, y1, x2, y2);
+            cb.normalize();
+            if(cb.clip(rect_i(0, 0, width() - 1, height() - 1)))
+            {
+                m_clip.add(cb);
+                if(cb.x1 < m_bounds.x1) m_bounds.x1 = cb.x1;
+                if(cb.y1 < m_bounds.y1) m_bounds.y1 = cb.y1;
+                if(cb.x2 > m_bounds.x2) m_bounds.x2 = cb.x2;
+                if(cb.y2 > m_bounds.y2) m_bounds.y2 = cb.y2;
+                m_index_valid = false;
+            }
+        }
+
+        unsigned num_clip_boxes() const { return m_clip.size(); }
+
+        //--------------------------------------------------------------------
+        void clear(const color_type& c)
+        {
+            m_ren.clear(c);
+        }
+
+        //--------------------------------------------------------------------
+        void copy_pixel(int x, int y, const color_type& c)
+        {
+            if(first_box(x, y, x, y))
+            {
+                if(m_ren.inbox(x, y))
+                {
+                    m_ren.ren().copy_pixel(x, y, c);
+                }
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void blend_pixel(int x, int y, const color_type& c, cover_type cover)
+        {
+            if(first_box(x, y, x, y))
+            {
+                if(m_ren.inbox(x, y))
+                {
+                    m_ren.ren().blend_pixel(x, y, c, cover);
+                }
+            }
+        }
+
+        //--------------------------------------------------------------------
+        color_type pixel(int x, int y) const
+        {
+            unsigned i;
+            for(i = 0; i < m_clip.size(); i++)
+            {
+                const rect_i& cb = m_clip[i];
+                if(x >= cb.x1 && y >= cb.y1 && x <= cb.x2 && y <= cb.y2)
+                {
+                    return m_ren.ren().pixel(x, y);
+                }
+            }
+            return color_type::no_color();
+        }
+
+        //--------------------------------------------------------------------
+        void copy_hline(int x1, int y, int x2, const color_type& c)
+        {
+            if(first_box(x1, y, x2, y))
+            {
+                do
+                {
+                    m_ren.copy_hline(x1, y, x2, c);
+                }
+                while(next_box());
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void copy_vline(int x, int y1, int y2, const color_type& c)
+        {
+            if(first_box(x, y1, x, y2))
+            {
+                do
+                {
+                    m_ren.copy_vline(x, y1, y2, c);
+                }
+                while(next_box());
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void blend_hline(int x1, int y, int x2,
+                         const color_type& c, cover_type cover)
+        {
+            if(first_box(x1, y, x2, y))
+            {
+                do
+                {
+                    m_ren.blend_hline(x1, y, x2, c, cover);
+                }
+                while(next_box());
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void blend_vline(int x, int y1, int y2,
+                         const color_type& c, cover_type cover)
+        {
+            if(first_box(x, y1, x, y2))
+            {
+                do
+                {
+                    m_ren.blend_vline(x, y1, y2, c, cover);
+                }
+                while(next_box());
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void copy_bar(int x1, int y1, int x2, int y2, const color_type& c)
+        {
+            if(first_box(x1, y1, x2, y2))
+            {
+                do
+                {
+                    m_ren.copy_bar(x1, y1, x2, y2, c);
+                }
+                while(next_box());
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void blend_bar(int x1, int y1, int x2, int y2,
+                       const color_type& c, cover_type cover)
+        {
+            if(first_box(x1, y1, x2, y2))
+            {
+                do
+                {
+                    m_ren.blend_bar(x1, y1, x2, y2, c, cover);
+                }
+                while(next_box());
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void blend_solid_hspan(int x, int y, int len,
+                               const color_type& c, const cover_type* covers)
+        {
+            if(first_box(x, y, x + len - 1, y))
+            {
+                do
+                {
+                    m_ren.blend_solid_hspan(x, y, len, c, covers);
+                }
+                while(next_box());
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void blend_solid_vspan(int x, int y, int len,
+                               const color_type& c, const cover_type* covers)
+        {
+            if(first_box(x, y, x, y + len - 1))
+            {
+                do
+                {
+                    m_ren.blend_solid_vspan(x, y, len, c, covers);
+                }
+                while(next_box());
+            }
+        }
+
+
+        //--------------------------------------------------------------------
+        void copy_color_hspan(int x, int y, int len, const color_type* colors)
+        {
+            if(first_box(x, y, x + len - 1, y))
+            {
+                do
+                {
+                    m_ren.copy_color_hspan(x, y, len, colors);
+                }
+                while(next_box());
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void blend_color_hspan(int x, int y, int len,
+                               const color_type* colors,
+                               const cover_type* covers,
+                               cover_type cover = cover_full)
+        {
+            if(first_box(x, y, x + len - 1, y))
+            {
+                do
+                {
+                    m_ren.blend_color_hspan(x, y, len, colors, covers, cover);
+                }
+                while(next_box());
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void blend_color_vspan(int x, int y, int len,
+                               const color_type* colors,
+                               const cover_type* covers,
+                               cover_type cover = cover_full)
+        {
+            if(first_box(x, y, x, y + len - 1))
+            {
+                do
+                {
+                    m_ren.blend_color_vspan(x, y, len, colors, covers, cover);
+                }
+                while(next_box());
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void copy_from(const rendering_buffer& from,
+                       const rect_i* rc=0,
+                       int x_to=0,
+                       int y_to=0)
+        {
+            if(first_box(0, 0, width() - 1, height() - 1))
+            {
+                do
+                {
+                    m_ren.copy_from(from, rc, x_to, y_to);
+                }
+                while(next_box());
+            }
+        }
+
+        //--------------------------------------------------------------------
+        template<class SrcPixelFormatRenderer>
+        void blend_from(const SrcPixelFormatRenderer& src,
+                        const rect_i* rect_src_ptr = 0,
+                        int dx = 0,
+                        int dy = 0,
+                        cover_type cover = cover_full)
+        {
+            if(first_box(0, 0, width() - 1, height() - 1))
+            {
+                do
+                {
+                    m_ren.blend_from(src, rect_src_ptr, dx, dy, cover);
+                }
+                while(next_box());
+            }
+        }
+
+
+    private:
+        renderer_mclip_indexed(const renderer_mclip_indexed<PixelFormat>&);
+        const renderer_mclip_indexed<PixelFormat>&
+            operator = (const renderer_mclip_indexed<PixelFormat>&);
+
+        //--------------------------------------------------------------------
+        void build_index()
+        {
+            unsigned n = m_clip.size();
+            unsigned i;
+
+            // The bands are about as high as the boxes on average
+            double h = 0;
+            for(i = 0; i < n; i++) h += m_clip[i].y2 - m_clip[i].y1 + 1;
+            h /= n;
+            m_band_shift = band_shift_min;
+            while(m_band_shift < band_shift_max &&
+                  double(1 << (m_band_shift + 1)) <= h) ++m_band_shift;
+
+            unsigned num_bands = ((height() - 1) >> m_band_shift) + 1;
+            m_bands.allocate(num_bands);
+            m_bands.zero();
+
+            unsigned total = 0;
+            for(i = 0; i < n; i++)
+            {
+                const rect_i& cb = m_clip[i];
+                unsigned b;
+                for(b = cb.y1 >> m_band_shift; b <= unsigned(cb.y2 >> m_band_shift); b++)
+                {
+                    ++m_bands[b].num;
+                    ++total;
+                }
+            }
+
+            unsigned start = 0;
+            for(i = 0; i < num_bands; i++)
+            {
+                m_bands[i].start = start;
+                start += m_bands[i].num;
+                m_bands[i].num = 0;
+            }
+
+            m_boxes.allocate(total);
+            for(i = 0; i < n; i++)
+            {
+                const rect_i& cb = m_clip[i];
+                unsigned b;
+                for(b = cb.y1 >> m_band_shift; b <= unsigned(cb.y2 >> m_band_shift); b++)
+                {
+                    band_type& band = m_bands[b];
+                    m_boxes[band.start + band.num++] = cb;
+                    if(cb.x2 - cb.x1 > band.max_width) band.max_width = cb.x2 - cb.x1;
+                }
+            }
+
+            for(i = 0; i < num_bands; i++)
+            {
+                pod_array_adaptor<rect_i> boxes(&m_boxes[m_bands[i].start],
+                                                m_bands[i].num);
+                quick_sort(boxes, box_x1_less);
+            }
+            m_index_valid = true;
+        }
+
+        //--------------------------------------------------------------------
+        // Sets the clip box of m_ren to the first box that intersects
+        // the given rectangle. Without the boxes it keeps the clip box of
+        // reset_clipping() for one pass, like renderer_mclip.
+        bool first_box(int x1, int y1, int x2, int y2)
+        {
+            m_idx = m_idx_end = 0;
+            m_band = 1;
+            m_band_last = 0;
+            if(m_clip.size() == 0) return true;
+            if(!m_index_valid) build_index();
+
+            if(x1 > x2) { int t = x1; x1 = x2; x2 = t; }
+            if(y1 > y2) { int t = y1; y1 = y2; y2 = t; }
+            if(y1 < 0) y1 = 0;
+            if(y2 > int(height()) - 1) y2 = int(height()) - 1;
+            if(y1 > y2) return false;
+
+            m_qx1 = x1;
+            m_qy1 = y1;
+            m_qx2 = x2;
+            m_qy2 = y2;
+            m_band      = unsigned(y1) >> m_band_shift;
+            m_band_last = unsigned(y2) >> m_band_shift;
+            start_band();
+            return next_box();
+        }
+
+        //--------------------------------------------------------------------
+        void start_band()
+        {
+            const band_type& b = m_bands[m_band];
+            int x = m_qx1 - b.max_width;
+            unsigned lo = b.start;
+            unsigned hi = b.start + b.num;
+            while(lo < hi)
+            {
+                unsigned mid = (lo + hi) >> 1;
+                if(m_boxes[mid].x1 < x) lo = mid + 1;
+                else                    hi = mid;
+            }
+            m_idx     = lo;
+            m_idx_end = b.start + b.num;
+        }
+
+        //--------------------------------------------------------------------
+        bool next_box()
+        {
+            for(;;)
+            {
+                while(m_idx < m_idx_end)
+                {
+                    const rect_i& cb = m_boxes[m_idx++];
+                    if(cb.x1 > m_qx2) break;
+                    if(cb.x2 >= m_qx1 && cb.y1 <= m_qy2 && cb.y2 >= m_qy1)
+                    {
+                        int by1 = int(m_band << m_band_shift);
+                        int by2 = by1 + (1 << m_band_shift) - 1;
+                        m_ren.clip_box_naked(cb.x1, (cb.y1 > by1) ? cb.y1 : by1,
+                                             cb.x2, (cb.y2 < by2) ? cb.y2 : by2);
+                        return true;
+                    }
+                }
+                if(++m_band > m_band_last) return false;
+                start_band();
+            }
+        }
+
+        base_ren_type          m_ren;
+        pod_bvector<rect_i, 4> m_clip;
+        unsigned               m_curr_cb;
+        rect_i                 m_bounds;
+
+        bool                   m_index_valid;
+        unsigned               m_band_shift;
+        pod_vector<band_type>  m_bands;
+        pod_vector<rect_i>     m_boxes;
+
+        int                    m_qx1;
+        int                    m_qy1;
+        int                    m_qx2;
+        int                    m_qy2;
+        unsigned               m_band;
+        unsigned               m_band_last;
+        unsigned               m_idx;
+        unsigned               m_idx_end;
+    };
+
+
+}
+
+#endif
@@ -1358,6 +1358,8 @@ namespace agg
             m_clipping(false)
         {}
         void attach(base_ren_type& ren) { m_ren = &ren; }
+        const base_ren_type& ren() const { return *m_ren; }
+        base_ren_type& ren() { return *m_ren; }
 
         //---------------------------------------------------------------------
         void color(const color_type& c) { m_color = c; }
@@ -21,6 +21,7 @@
 #include <cstring>
 #include "agg_basics.h"
 #include "agg_renderer_base.h"
+#include "agg_rasterizer_cells_aa.h"
 
 namespace agg
 {
@@ -471,6 +472,80 @@ namespace agg
         }
     }
 
+    //---------------------------------------------------render_path_split_band
+    template<class Rasterizer, class Scanline, class Renderer, 
+             class VertexSource>
+    void render_path_split_band(Rasterizer& ras, 
+                                Scanline& sl,
+                                Renderer& r, 
+                                VertexSource& vs, 
+                                unsigned path_id,
+                                int y1, int y2)
+    {
+        ras.band(y1, y2);
+        ras.add_path(vs, path_id);
+        ras.sort();
+        if(ras.overflow())
+        {
+            if(y1 < y2)
+            {
+                int ym = y1 + (y2 - y1) / 2;
+                render_path_split_band(ras, sl, r, vs, path_id, y1, ym);
+                render_path_split_band(ras, sl, r, vs, path_id, ym + 1, y2);
+                return;
+            }
+            // A single scanline that doesn't fit, render what there is
+            ras.overflow_policy(cell_overflow_drop);
+            render_scanlines(ras, sl, r);
+            ras.overflow_policy(cell_overflow_error);
+            return;
+        }
+        render_scanlines(ras, sl, r);
+    }
+
+    //========================================================render_path_split
+    // Renders a path that may not fit in the rasterizer's cell_block_limit.
+    // The cells can't be flushed to the renderer when the limit is reached,
+    // because a cell's coverage depends on all the cells to the left of it
+    // on the same scanline, which may come later. So, the path is rendered 
+    // as usual while it fits, and if it doesn't, it's rendered again by 
+    // two bands, recursively halving the bands that still don't fit. The 
+    // result is the same as with the unlimited rasterizer, the memory 
+    // never exceeds the limit, and the vertex source is rewound once per 
+    // band. The rasterizer's band and overflow policy are restored.
+    //------------------------------------------------------------------------
+    template<class Rasterizer, class Scanline, class Renderer, 
+             class VertexSource>
+    void render_path_split(Rasterizer& ras, 
+                           Scanline& sl,
+                           Renderer& r, 
+                           VertexSource& vs, 
+                           unsigned path_id=0)
+    {
+        int band_y1 = ras.band_min_y();
+        int band_y2 = ras.band_max_y();
+        cell_overflow_e policy = ras.overflow_policy();
+        ras.overflow_policy(cell_overflow_error);
+
+        ras.reset();
+        ras.add_path(vs, path_id);
+        ras.sort();
+        if(ras.overflow())
+        {
+            int y1 = ras.min_y();
+            int y2 = ras.max_y();
+            if(y1 < band_y1) y1 = band_y1;
+            if(y2 > band_y2) y2 = band_y2;
+            render_path_split_band(ras, sl, r, vs, path_id, y1, y2);
+            ras.band(band_y1, band_y2);
+        }
+        else
+        {
+            render_scanlines(ras, sl, r);
+        }
+        ras.overflow_policy(policy);
+    }
+
 
 
 
@@ -0,0 +1,188 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Multithreaded versions of render_scanlines_compound() and
+// render_scanlines_compound_layered().
+//
+// The rasterizer is sorted once, then every thread sweeps it with its own
+// rasterizer_compound_aa::sweeper, taking interleaved bands of scanlines.
+// Each thread has its own scanlines, span allocator and cover buffer,
+// and every scanline is rendered by exactly one thread the same way
+// as the serial function does, so the result is identical to it.
+//
+// The style handler is shared between the threads, so its is_solid(),
+// color() and generate_span() must be safe to call concurrently.
+// The same goes for the pixel format, that is, rendering different
+// rows must not interfere.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_RENDERER_SCANLINE_PARALLEL_INCLUDED
+#define AGG_RENDERER_SCANLINE_PARALLEL_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_renderer_scanline.h"
+#include "agg_threads.h"
+
+namespace agg
+{
+
+    //------------------------------------------------------compound_band_task
+    // Internal. Renders the bands of one thread. The thread 0 uses the
+    // scanlines and the allocator of the caller, the others create
+    // their own ones.
+    template<class Rasterizer,
+             class ScanlineAA,
+             class ScanlineBin,
+             class BaseRenderer,
+             class SpanAllocator,
+             class StyleHandler>
+    struct compound_band_task
+    {
+        typedef typename Rasterizer::sweeper sweeper_type;
+
+        const Rasterizer* ras;
+        ScanlineAA*       sl_aa;
+        ScanlineBin*      sl_bin;
+        BaseRenderer*     ren;
+        SpanAllocator*    alloc;
+        StyleHandler*     sh;
+        unsigned          band_height;
+        bool              layered;
+
+        void run(unsigned idx, unsigned num)
+        {
+            sweeper_type sw(*ras, band_height, idx, num);
+            if(idx == 0)
+            {
+                render(sw, *sl_aa, *sl_bin, *alloc);
+            }
+            else
+            {
+                ScanlineAA    thread_sl_aa;
+                ScanlineBin   thread_sl_bin;
+                SpanAllocator thread_alloc;
+                render(sw, thread_sl_aa, thread_sl_bin, thread_alloc);
+            }
+        }
+
+        void render(sweeper_type& sw,
+                    ScanlineAA& sl_aa_,
+                    ScanlineBin& sl_bin_,
+                    SpanAllocator& alloc_)
+        {
+            if(layered)
+            {
+                render_scanlines_compound_layered(sw, sl_aa_, *ren, alloc_, *sh);
+            }
+            else
+            {
+                render_scanlines_compound(sw, sl_aa_, sl_bin_, *ren, alloc_, *sh);
+            }
+        }
+    };
+
+
+    //------------------------------------------------render_compound_parallel
+    // Internal. Sorts the rasterizer and runs the bands.
+    template<class Rasterizer,
+             class ScanlineAA,
+             class ScanlineBin,
+             class BaseRenderer,
+             class SpanAllocator,
+             class StyleHandler>
+    void render_compound_parallel(Rasterizer& ras,
+                                  ScanlineAA& sl_aa,
+                                  ScanlineBin& sl_bin,
+                                  BaseRenderer& ren,
+                                  SpanAllocator& alloc,
+                                  StyleHandler& sh,
+                                  unsigned num_threads,
+                                  unsigned band_height,
+                                  bool layered)
+    {
+        // Sorting can't be done concurrently, it's done here once
+        if(!ras.rewind_scanlines()) return;
+
+        if(band_height == 0) band_height = 1;
+        unsigned h  = unsigned(ras.max_y() - ras.min_y() + 1);
+        unsigned nb = (h + band_height - 1) / band_height;
+        if(num_threads == 0) num_threads = num_cpus();
+        if(num_threads > nb) num_threads = nb;
+
+        compound_band_task<Rasterizer, ScanlineAA, ScanlineBin,
+                           BaseRenderer, SpanAllocator, StyleHandler> task;
+        task.ras         = &ras;
+        task.sl_aa       = &sl_aa;
+        task.sl_bin      = &sl_bin;
+        task.ren         = &ren;
+        task.alloc       = &alloc;
+        task.sh          = &sh;
+        task.band_height = band_height;
+        task.layered     = layered;
+        run_parallel(task, num_threads);
+    }
+
+
+    //====================================render_scanlines_compound_parallel
+    // The same as render_scanlines_compound(), but the scanlines are
+    // rendered by num_threads threads (0 means one thread per processor)
+    // in interleaved bands of band_height scanlines. The Rasterizer must be
+    // rasterizer_compound_aa. ScanlineAA, ScanlineBin and SpanAllocator
+    // must be default constructible, as every thread has its own ones.
+    //------------------------------------------------------------------------
+    template<class Rasterizer,
+             class ScanlineAA,
+             class ScanlineBin,
+             class BaseRenderer,
+             class SpanAllocator,
+             class StyleHandler>
+    void render_scanlines_compound_parallel(Rasterizer& ras,
+                                            ScanlineAA& sl_aa,
+                                            ScanlineBin& sl_bin,
+                                            BaseRenderer& ren,
+                                            SpanAllocator& alloc,
+                                            StyleHandler& sh,
+                                            unsigned num_threads=0,
+                                            unsigned band_height=8)
+    {
+        render_compound_parallel(ras, sl_aa, sl_bin, ren, alloc, sh,
+                                 num_threads, band_height, false);
+    }
+
+
+    //============================render_scanlines_compound_layered_parallel
+    // The same for render_scanlines_compound_layered().
+    //------------------------------------------------------------------------
+    template<class Rasterizer,
+             class ScanlineAA,
+             class BaseRenderer,
+             class SpanAllocator,
+             class StyleHandler>
+    void render_scanlines_compound_layered_parallel(Rasterizer& ras,
+                                                    ScanlineAA& sl_aa,
+                                                    BaseRenderer& ren,
+                                                    SpanAllocator& alloc,
+                                                    StyleHandler& sh,
+                                                    unsigned num_threads=0,
+                                                    unsigned band_height=8)
+    {
+        ScanlineAA sl_unused;
+        render_compound_parallel(ras, sl_aa, sl_unused, ren, alloc, sh,
+                                 num_threads, band_height, true);
+    }
+
+}
+
+#endif
@@ -0,0 +1,486 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// The union of many anti-aliased scanline shapes in one pass.
+//
+// sbool_unite_shapes_aa() combines two shapes, so uniting N of them
+// takes N-1 passes, every one copying the growing intermediate result.
+// sbool_unite_nary_aa takes all the shapes, rendered into
+// scanline_storage_aa, and sweeps them together: a heap ordered by Y
+// gives the shapes that have the next scanline, and on every scanline
+// a heap ordered by X merges their spans into the runs of the result.
+//
+//   agg::sbool_unite_nary_aa<agg::scanline_storage_aa8> u;
+//   for(i = 0; i < num; i++) u.add(storage[i]);
+//   u.render(sl, ren);               // or
+//   u.render_parallel(sl, ren, 0);   // one thread per processor
+//
+// The covers are combined in the order the shapes were added, with the
+// same formula as sbool_unite_spans_aa, so the result is exactly the
+// same as the chain of sbool_unite_shapes_aa() in that order.
+//
+// render_parallel() divides the Y range into bands, combines them in
+// parallel, each into its own scanline_storage_aa, and then renders
+// them in order. It's possible because the shapes are only read, with
+// the index access of scanline_storage_aa. The shapes must not change
+// while rendering.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_SCANLINE_BOOLEAN_NARY_INCLUDED
+#define AGG_SCANLINE_BOOLEAN_NARY_INCLUDED
+
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_array.h"
+#include "agg_scanline_storage_aa.h"
+#include "agg_threads.h"
+
+namespace agg
+{
+
+    //=====================================================sbool_unite_nary_aa
+    template<class Storage, unsigned CoverShift = cover_shift>
+    class sbool_unite_nary_aa
+    {
+    public:
+        typedef Storage                                storage_type;
+        typedef typename Storage::cover_type           cover_type;
+        typedef scanline_storage_aa<cover_type>        band_storage_type;
+        typedef sbool_unite_nary_aa<Storage, CoverShift> self_type;
+
+        enum cover_scale_e
+        {
+            cover_shift = CoverShift,
+            cover_size  = 1 << cover_shift,
+            cover_mask  = cover_size - 1,
+            cover_full  = cover_mask
+        };
+
+        enum default_band_height_e
+        {
+            default_band_height = 64
+        };
+
+        //--------------------------------------------------------------------
+        // The state of one sweep, one per thread
+        class sweep_state
+        {
+        public:
+            struct entry
+            {
+                int      key;   // Y of the next scanline or X of the next span
+                unsigned idx;   // The shape or its position in active
+            };
+
+            pod_vector<unsigned> scanline;  // The next scanline of every shape
+            pod_vector<entry>    heap;
+            pod_vector<unsigned> active;    // The shapes of this scanline
+            pod_vector<unsigned> span;      // Their next span and the end
+            pod_vector<unsigned> span_end;
+            pod_vector<entry>    span_heap;
+            pod_array<cover_type> covers;
+        };
+
+        //--------------------------------------------------------------------
+        ~sbool_unite_nary_aa()
+        {
+            free_bands();
+        }
+
+        sbool_unite_nary_aa() :
+            m_min_x(1), m_min_y(1), m_max_x(0), m_max_y(0),
+            m_band_height(default_band_height)
+        {
+        }
+
+        //--------------------------------------------------------------------
+        void remove_all()
+        {
+            m_shapes.remove_all();
+            m_min_x = m_min_y = 1;
+            m_max_x = m_max_y = 0;
+        }
+
+        //--------------------------------------------------------------------
+        // The shape is kept by reference. The empty ones are skipped.
+        void add(const storage_type& s)
+        {
+            if(s.num_scanlines() == 0) return;
+            if(m_shapes.size() == 0)
+            {
+                m_min_x = s.min_x(); m_min_y = s.min_y();
+                m_max_x = s.max_x(); m_max_y = s.max_y();
+            }
+            else
+            {
+                if(s.min_x() < m_min_x) m_min_x = s.min_x();
+                if(s.min_y() < m_min_y) m_min_y = s.min_y();
+                if(s.max_x() > m_max_x) m_max_x = s.max_x();
+                if(s.max_y() > m_max_y) m_max_y = s.max_y();
+            }
+            m_shapes.add(&s);
+        }
+
+        //--------------------------------------------------------------------
+        unsigned num_shapes() const { return m_shapes.size(); }
+        int min_x() const { return m_min_x; }
+        int min_y() const { return m_min_y; }
+        int max_x() const { return m_max_x; }
+        int max_y() const { return m_max_y; }
+
+        //--------------------------------------------------------------------
+        void band_height(unsigned h) { m_band_height = h ? h : 1; }
+        unsigned band_height() const { return m_band_height; }
+
+        //--------------------------------------------------------------------
+        template<class Scanline, class Renderer>
+        void render(Scanline& sl, Renderer& ren)
+        {
+            if(m_shapes.size() == 0) return;
+            ren.prepare();
+            sweep_state st;
+            render_band(m_min_y, m_max_y, sl, ren, st);
+        }
+
+        //--------------------------------------------------------------------
+        // Renders the scanlines from y1 to y2 without calling ren.prepare().
+        // Can be called from different threads at the same time with
+        // different scanlines, renderers and states.
+        template<class Scanline, class Renderer>
+        void render_band(int y1, int y2, Scanline& sl, Renderer& ren,
+                         sweep_state& st) const
+        {
+            if(y1 < m_min_y) y1 = m_min_y;
+            if(y2 > m_max_y) y2 = m_max_y;
+            if(y1 > y2) return;
+
+            unsigned width = unsigned(m_max_x - m_min_x + 1);
+            if(st.covers.size() < width)
+            {
+                st.covers.resize(width);
+                memset(&st.covers[0], 0, width * sizeof(cover_type));
+            }
+            unsigned num = m_shapes.size();
+            st.scanline.allocate(num);
+            st.heap.allocate(num);
+            st.heap.clear();
+            st.active.allocate(num);
+            st.span.allocate(num);
+            st.span_end.allocate(num);
+            st.span_heap.allocate(num);
+
+            // The first scanline of every shape in the band
+            unsigned i;
+            for(i = 0; i < num; i++)
+            {
+                const storage_type& s = *m_shapes[i];
+                if(s.max_y() < y1 || s.min_y() > y2) continue;
+                unsigned lo = 0;
+                unsigned hi = s.num_scanlines();
+                while(lo < hi)
+                {
+                    unsigned mid = (lo + hi) >> 1;
+                    if(s.scanline_by_index(mid).y < y1) lo = mid + 1;
+                    else                                hi = mid;
+                }
+                if(lo < s.num_scanlines())
+                {
+                    st.scanline[i] = lo;
+                    push_heap(st.heap, s.scanline_by_index(lo).y, i);
+                }
+            }
+
+            sl.reset(m_min_x, m_max_x);
+            while(st.heap.size() && st.heap[0].key <= y2)
+            {
+                int y = st.heap[0].key;
+
+                // The shapes that have this scanline come in the order of
+                // adding, because the heap is ordered by the index too
+                unsigned num_active = 0;
+                while(st.heap.size() && st.heap[0].key == y)
+                {
+                    st.active[num_active++] = st.heap[0].idx;
+                    pop_heap(st.heap);
+                }
+
+                sl.reset_spans();
+                combine_scanline(st, num_active, sl);
+                if(sl.num_spans())
+                {
+                    sl.finalize(y);
+                    ren.render(sl);
+                }
+
+                // Advance the shapes to their next scanlines
+                for(i = 0; i < num_active; i++)
+                {
+                    unsigned idx = st.active[i];
+                    unsigned n = ++st.scanline[idx];
+                    if(n < m_shapes[idx]->num_scanlines())
+                    {
+                        push_heap(st.heap, m_shapes[idx]->scanline_by_index(n).y, idx);
+                    }
+                }
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // The same as render(), with the bands of band_height() scanlines
+        // combined in num_threads threads, 0 means one per processor.
+        // The band storages are kept between the calls.
+        template<class Scanline, class Renderer>
+        void render_parallel(Scanline& sl, Renderer& ren, unsigned num_threads = 0)
+        {
+            if(m_shapes.size() == 0) return;
+            if(num_threads == 0) num_threads = num_cpus();
+            unsigned nb = unsigned(m_max_y - m_min_y) / m_band_height + 1;
+            if(num_threads > nb) num_threads = nb;
+            allocate_bands(nb);
+
+            band_task<Scanline> task(*this, nb);
+            run_parallel(task, num_threads);
+
+            ren.prepare();
+            unsigned i;
+            for(i = 0; i < nb; i++)
+            {
+                band_storage_type& bs = *m_bands[i];
+                if(bs.rewind_scanlines())
+                {
+                    sl.reset(bs.min_x(), bs.max_x());
+                    while(bs.sweep_scanline(sl)) ren.render(sl);
+                }
+            }
+        }
+
+    private:
+        sbool_unite_nary_aa(const self_type&);
+        const self_type& operator = (const self_type&);
+
+        typedef typename sweep_state::entry entry;
+
+        //--------------------------------------------------------------------
+        // Every thread sweeps with its own scanline, of the caller's type,
+        // so the covers are the same as with render()
+        template<class Scanline> struct band_task
+        {
+            band_task(self_type& u, unsigned nb) : self(&u), num_bands(nb) {}
+
+            void run(unsigned idx, unsigned num)
+            {
+                sweep_state st;
+                Scanline sl;
+                unsigned i;
+                for(i = idx; i < num_bands; i += num)
+                {
+                    int y1 = self->m_min_y + int(i * self->m_band_height);
+                    int y2 = y1 + int(self->m_band_height) - 1;
+                    band_storage_type& bs = *self->m_bands[i];
+                    bs.prepare();
+                    self->render_band(y1, y2, sl, bs, st);
+                }
+            }
+
+            self_type* self;
+            unsigned   num_bands;
+        };
+
+        //--------------------------------------------------------------------
+        static bool less(const entry& a, const entry& b)
+        {
+            return a.key < b.key || (a.key == b.key && a.idx < b.idx);
+        }
+
+        //--------------------------------------------------------------------
+        static void push_heap(pod_vector<entry>& h, int key, unsigned idx)
+        {
+            entry e;
+            e.key = key;
+            e.idx = idx;
+            unsigned i = h.size();
+            h.add(e);
+            while(i)
+            {
+                unsigned parent = (i - 1) >> 1;
+                if(!less(e, h[parent])) break;
+                h[i] = h[parent];
+                i = parent;
+            }
+            h[i] = e;
+        }
+
+        //--------------------------------------------------------------------
+        static void pop_heap(pod_vector<entry>& h)
+        {
+            unsigned n = h.size() - 1;
+            entry e = h[n];
+            h.cut_at(n);
+            if(n == 0) return;
+            unsigned i = 0;
+            for(;;)
+            {
+                unsigned child = i * 2 + 1;
+                if(child >= n) break;
+                if(child + 1 < n && less(h[child + 1], h[child])) ++child;
+                if(!less(h[child], e)) break;
+                h[i] = h[child];
+                i = child;
+            }
+            h[i] = e;
+        }
+
+        //--------------------------------------------------------------------
+        // Combines the covers of the active shapes in their order, then
+        // merges their spans by X into the runs to add to the scanline.
+        template<class Scanline>
+        void combine_scanline(sweep_state& st, unsigned num_active, Scanline& sl) const
+        {
+            cover_type* covers = &st.covers[0] - m_min_x;
+            unsigned i;
+            st.span_heap.clear();
+            for(i = 0; i < num_active; i++)
+            {
+                const storage_type& s = *m_shapes[st.active[i]];
+                const typename storage_type::scanline_data& sd =
+                    s.scanline_by_index(st.scanline[st.active[i]]);
+                st.span[i]     = sd.start_span;
+                st.span_end[i] = sd.start_span + sd.num_spans;
+                if(sd.num_spans == 0) continue;
+
+                unsigned k;
+                for(k = st.span[i]; k < st.span_end[i]; k++)
+                {
+                    const typename storage_type::span_data& sp = s.span_by_index(k);
+                    const cover_type* src = s.covers_by_index(sp.covers_id);
+                    cover_type* dst = covers + sp.x;
+                    if(sp.len < 0)
+                    {
+                        unite(dst, *src, unsigned(-sp.len));
+                    }
+                    else
+                    {
+                        unite(dst, src, unsigned(sp.len));
+                    }
+                }
+                push_heap(st.span_heap, s.span_by_index(st.span[i]).x, i);
+            }
+
+            // K-way merge of the spans, every run of the overlapping or
+            // touching ones is added at once and its covers are cleared.
+            int x1 = 0;
+            int x2 = -1;
+            bool run = false;
+            while(st.span_heap.size())
+            {
+                unsigned a = st.span_heap[0].idx;
+                const storage_type& s = *m_shapes[st.active[a]];
+                const typename storage_type::span_data& sp = s.span_by_index(st.span[a]);
+                int sx2 = sp.x + ((sp.len < 0) ? -sp.len : sp.len) - 1;
+                pop_heap(st.span_heap);
+                if(++st.span[a] < st.span_end[a])
+                {
+                    push_heap(st.span_heap, s.span_by_index(st.span[a]).x, a);
+                }
+
+                if(run && sp.x <= x2 + 1)
+                {
+                    if(sx2 > x2) x2 = sx2;
+                }
+                else
+                {
+                    if(run) add_run(covers, x1, x2, sl);
+                    x1 = sp.x;
+                    x2 = sx2;
+                    run = true;
+                }
+            }
+            if(run) add_run(covers, x1, x2, sl);
+        }
+
+        //--------------------------------------------------------------------
+        // The same as sbool_unite_spans_aa, zero means no cover yet
+        static AGG_INLINE unsigned unite_cover(unsigned a, unsigned b)
+        {
+            if(a == 0) return b;
+            unsigned cover = cover_mask * cover_mask -
+                             (cover_mask - a) * (cover_mask - b);
+            return (cover == cover_full * cover_full) ?
+                    unsigned(cover_full) : (cover >> cover_shift);
+        }
+
+        static void unite(cover_type* dst, const cover_type* src, unsigned len)
+        {
+            do { *dst = cover_type(unite_cover(*dst, *src++)); ++dst; } while(--len);
+        }
+
+        static void unite(cover_type* dst, unsigned c, unsigned len)
+        {
+            do { *dst = cover_type(unite_cover(*dst, c)); ++dst; } while(--len);
+        }
+
+        //--------------------------------------------------------------------
+        template<class Scanline>
+        static void add_run(cover_type* covers, int x1, int x2, Scanline& sl)
+        {
+            int x = x1;
+            while(x <= x2)
+            {
+                unsigned c = covers[x];
+                if(c == cover_full)
+                {
+                    int x0 = x;
+                    do covers[x++] = 0; while(x <= x2 && covers[x] == cover_full);
+                    sl.add_span(x0, unsigned(x - x0), cover_full);
+                }
+                else
+                {
+                    if(c) sl.add_cell(x, c);
+                    covers[x++] = 0;
+                }
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void allocate_bands(unsigned num)
+        {
+            while(m_bands.size() < num)
+            {
+                m_bands.add(obj_allocator<band_storage_type>::allocate());
+            }
+        }
+
+        void free_bands()
+        {
+            unsigned i;
+            for(i = 0; i < m_bands.size(); i++)
+            {
+                obj_allocator<band_storage_type>::deallocate(m_bands[i]);
+            }
+            m_bands.remove_all();
+        }
+
+        pod_bvector<const storage_type*, 8> m_shapes;
+        pod_bvector<band_storage_type*, 4>  m_bands;
+        int      m_min_x;
+        int      m_min_y;
+        int      m_max_x;
+        int      m_max_y;
+        unsigned m_band_height;
+    };
+
+}
+
+#endif
@@ -34,7 +34,8 @@ namespace agg
 {
 
     //----------------------------------------------scanline_cell_storage
-    template<class T> class scanline_cell_storage
+    template<class T, template<class> class Allocator=pod_allocator> 
+    class scanline_cell_storage
     {
         struct extra_span
         {
@@ -60,7 +61,7 @@ namespace agg
 
         // Copying
         //---------------------------------------------------------------
-        scanline_cell_storage(const scanline_cell_storage<T>& v) :
+        scanline_cell_storage(const scanline_cell_storage<T, Allocator>& v) :
             m_cells(v.m_cells),
             m_extra_storage()
         {
@@ -68,8 +69,8 @@ namespace agg
         }
 
         //---------------------------------------------------------------
-        const scanline_cell_storage<T>& 
-        operator = (const scanline_cell_storage<T>& v)
+        const scanline_cell_storage<T, Allocator>& 
+        operator = (const scanline_cell_storage<T, Allocator>& v)
         {
             remove_all();
             m_cells = v.m_cells;
@@ -83,7 +84,7 @@ namespace agg
             int i;
             for(i = m_extra_storage.size()-1; i >= 0; --i)
             {
-                pod_allocator<T>::deallocate(m_extra_storage[i].ptr,
+                Allocator<T>::deallocate(m_extra_storage[i].ptr,
                                              m_extra_storage[i].len);
             }
             m_extra_storage.remove_all();
@@ -102,7 +103,7 @@ namespace agg
             }
             extra_span s;
             s.len = num_cells;
-            s.ptr = pod_allocator<T>::allocate(num_cells);
+            s.ptr = Allocator<T>::allocate(num_cells);
             std::memcpy(s.ptr, cells, sizeof(T) * num_cells);
             m_extra_storage.add(s);
             return -int(m_extra_storage.size());
@@ -135,7 +136,7 @@ namespace agg
         }
 
     private:
-        void copy_extra_storage(const scanline_cell_storage<T>& v)
+        void copy_extra_storage(const scanline_cell_storage<T, Allocator>& v)
         {
             unsigned i;
             for(i = 0; i < v.m_extra_storage.size(); ++i)
@@ -143,14 +144,14 @@ namespace agg
                 const extra_span& src = v.m_extra_storage[i];
                 extra_span dst;
                 dst.len = src.len;
-                dst.ptr = pod_allocator<T>::allocate(dst.len);
+                dst.ptr = Allocator<T>::allocate(dst.len);
                 std::memcpy(dst.ptr, src.ptr, dst.len * sizeof(T));
                 m_extra_storage.add(dst);
             }
         }
 
-        pod_bvector<T, 12>         m_cells;
-        pod_bvector<extra_span, 6> m_extra_storage;
+        pod_bvector<T, 12, Allocator>         m_cells;
+        pod_bvector<extra_span, 6, Allocator> m_extra_storage;
     };
 
 
@@ -159,7 +160,9 @@ namespace agg
 
 
     //-----------------------------------------------scanline_storage_aa
-    template<class T> class scanline_storage_aa
+    // Allocator is pod_allocator or arena_allocator (agg_arena.h).
+    template<class T, template<class> class Allocator=pod_allocator> 
+    class scanline_storage_aa
     {
     public:
         typedef T cover_type;
@@ -335,6 +338,9 @@ namespace agg
         int max_x() const { return m_max_x; }
         int max_y() const { return m_max_y; }
 
+        //---------------------------------------------------------------
+        unsigned num_scanlines() const { return m_scanlines.size(); }
+
         //---------------------------------------------------------------
         bool rewind_scanlines()
         {
@@ -513,9 +519,9 @@ namespace agg
         }
 
     private:
-        scanline_cell_storage<T>      m_covers;
-        pod_bvector<span_data, 10>    m_spans;
-        pod_bvector<scanline_data, 8> m_scanlines;
+        scanline_cell_storage<T, Allocator>      m_covers;
+        pod_bvector<span_data, 10, Allocator>    m_spans;
+        pod_bvector<scanline_data, 8, Allocator> m_scanlines;
         span_data     m_fake_span;
         scanline_data m_fake_scanline;
         int           m_min_x;
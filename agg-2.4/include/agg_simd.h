@@ -0,0 +1,129 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// SIMD configuration and run-time CPU detection.
+//
+// AGG_SIMD_SSE2 is defined when SSE2 is available at compile time (always
+// on x86-64). AGG_SIMD_AVX2 is defined when the compiler can generate AVX2
+// code for separate functions, marked with AGG_SIMD_TARGET_AVX2, without
+// compiling the whole program with -mavx2. Such functions may only be
+// called when simd_level() reports simd_avx2.
+// Define AGG_NO_SIMD to use the plain C++ code only.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_SIMD_INCLUDED
+#define AGG_SIMD_INCLUDED
+
+#include "agg_basics.h"
+
+#if !defined(AGG_NO_SIMD)
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGG_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(AGG_SIMD_SSE2)
+#if defined(__AVX2__)
+#define AGG_SIMD_AVX2
+#define AGG_SIMD_TARGET_AVX2
+#elif defined(__clang__) || \
+      (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define AGG_SIMD_AVX2
+#define AGG_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1700
+#define AGG_SIMD_AVX2
+#define AGG_SIMD_TARGET_AVX2
+#endif
+#endif
+
+#if defined(AGG_SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
+#if defined(AGG_SIMD_SSE2) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#endif
+
+namespace agg
+{
+
+    //---------------------------------------------------------simd_level_e
+    enum simd_level_e
+    {
+        simd_none,
+        simd_sse2,
+        simd_avx2
+    };
+
+    //---------------------------------------------------------simd_detect
+    // Returns the best instruction set supported by both the compiler
+    // and the processor.
+    inline simd_level_e simd_detect()
+    {
+#if defined(AGG_SIMD_AVX2)
+#if defined(_MSC_VER) && !defined(__clang__)
+        int r[4];
+        __cpuid(r, 0);
+        if(r[0] >= 7)
+        {
+            __cpuid(r, 1);
+            // OSXSAVE and AVX, then the OS must save the YMM registers
+            if((r[2] & (1 << 27)) && (r[2] & (1 << 28)) &&
+               (_xgetbv(0) & 6) == 6)
+            {
+                __cpuidex(r, 7, 0);
+                if(r[1] & (1 << 5)) return simd_avx2;
+            }
+        }
+#else
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) return simd_avx2;
+#endif
+#endif
+#if defined(AGG_SIMD_SSE2)
+        return simd_sse2;
+#else
+        return simd_none;
+#endif
+    }
+
+    //-----------------------------------------------------------simd_level
+    // The instruction set the SIMD code paths use. It's detected once and
+    // can be lowered with simd_level(level), for example, to compare the
+    // results or the speed with the plain C++ code. It can't be raised
+    // above what the processor supports.
+    inline simd_level_e& simd_current_level()
+    {
+        static simd_level_e level = simd_detect();
+        return level;
+    }
+
+    inline simd_level_e simd_level()
+    {
+        return simd_current_level();
+    }
+
+    inline void simd_level(simd_level_e level)
+    {
+        simd_level_e max_level = simd_detect();
+        simd_current_level() = (level < max_level) ? level : max_level;
+    }
+
+}
+
+#endif
@@ -0,0 +1,180 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// span_cache remembers the spans given by a span generator, so that the
+// repeated backgrounds, like a gradient fill redrawn every frame, are
+// copied instead of calculated again:
+//
+//   agg::span_cache<gradient_span_gen_type> cache(span_gradient);
+//   . . .
+//   // Every frame
+//   cache.key(gradient_mtx, gradient_version);
+//   agg::render_scanlines_aa(ras, sl, ren_base, span_alloc, cache);
+//
+// The spans are matched exactly by x, y and length, which is what the
+// same shapes give in every frame, so the result is always the same
+// as without the cache. key() tells what the spans depend on: the
+// transformations and a version number that the caller changes along
+// with anything else, for example, the colors or the gradient function.
+// When either of them differs from the previous call, the cache is
+// cleared.
+//
+// The cache isn't thread-safe, each thread or band needs its own one.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_SPAN_CACHE_INCLUDED
+#define AGG_SPAN_CACHE_INCLUDED
+
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_array.h"
+#include "agg_trans_affine.h"
+
+namespace agg
+{
+
+    //==============================================================span_cache
+    template<class SpanGenerator, unsigned BlockShift = 12> class span_cache
+    {
+        struct span_type
+        {
+            int      x;
+            unsigned len;
+            int      colors;
+            int      next;
+        };
+
+    public:
+        typedef SpanGenerator                      span_generator_type;
+        typedef typename SpanGenerator::color_type color_type;
+
+        enum default_max_colors_e
+        {
+            default_max_colors = 4096 * 1024
+        };
+
+        //--------------------------------------------------------------------
+        // The spans longer than 2^BlockShift-1 pixels are not cached. When
+        // the cache exceeds max_colors colors it's cleared.
+        explicit span_cache(SpanGenerator& span_gen,
+                            unsigned max_colors = default_max_colors) :
+            m_span_gen(&span_gen),
+            m_max_colors(max_colors),
+            m_version(0),
+            m_hits(0),
+            m_misses(0)
+        {
+        }
+
+        //--------------------------------------------------------------------
+        void attach(SpanGenerator& span_gen)
+        {
+            m_span_gen = &span_gen;
+            invalidate();
+        }
+
+        //--------------------------------------------------------------------
+        void key(const trans_affine& mtx, unsigned version = 0)
+        {
+            if(version != m_version || 
+               mtx.sx  != m_mtx.sx  || mtx.shy != m_mtx.shy ||
+               mtx.shx != m_mtx.shx || mtx.sy  != m_mtx.sy  ||
+               mtx.tx  != m_mtx.tx  || mtx.ty  != m_mtx.ty)
+            {
+                m_mtx = mtx;
+                m_version = version;
+                invalidate();
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void invalidate()
+        {
+            m_rows.remove_all();
+            m_spans.remove_all();
+            m_colors.remove_all();
+        }
+
+        //--------------------------------------------------------------------
+        unsigned hits()   const { return m_hits; }
+        unsigned misses() const { return m_misses; }
+        unsigned num_colors() const { return m_colors.size(); }
+
+        //--------------------------------------------------------------------
+        void prepare()
+        {
+            m_span_gen->prepare();
+        }
+
+        //--------------------------------------------------------------------
+        void generate(color_type* span, int x, int y, unsigned len)
+        {
+            if(y < 0 || len >= unsigned(1 << BlockShift))
+            {
+                m_span_gen->generate(span, x, y, len);
+                return;
+            }
+
+            if(unsigned(y) < m_rows.size())
+            {
+                int i = m_rows[y];
+                while(i >= 0)
+                {
+                    const span_type& s = m_spans[i];
+                    if(s.x == x && s.len == len)
+                    {
+                        memcpy(span, &m_colors[s.colors], len * sizeof(color_type));
+                        ++m_hits;
+                        return;
+                    }
+                    i = s.next;
+                }
+            }
+
+            ++m_misses;
+            m_span_gen->generate(span, x, y, len);
+
+            if(m_colors.size() + len > m_max_colors) invalidate();
+            while(m_rows.size() <= unsigned(y)) m_rows.add(-1);
+
+            span_type s;
+            s.x      = x;
+            s.len    = len;
+            s.colors = m_colors.allocate_continuous_block(len);
+            s.next   = m_rows[y];
+            memcpy(&m_colors[s.colors], span, len * sizeof(color_type));
+            m_rows[y] = m_spans.size();
+            m_spans.add(s);
+        }
+
+    private:
+        span_cache(const span_cache<SpanGenerator, BlockShift>&);
+        const span_cache<SpanGenerator, BlockShift>&
+            operator = (const span_cache<SpanGenerator, BlockShift>&);
+
+        SpanGenerator*                      m_span_gen;
+        unsigned                            m_max_colors;
+        trans_affine                        m_mtx;
+        unsigned                            m_version;
+        pod_bvector<int, 10>                m_rows;
+        pod_bvector<span_type, 10>          m_spans;
+        pod_bvector<color_type, BlockShift> m_colors;
+        unsigned                            m_hits;
+        unsigned                            m_misses;
+    };
+
+}
+
+#endif
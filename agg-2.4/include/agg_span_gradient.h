@@ -21,6 +21,7 @@
 #include "agg_basics.h"
 #include "agg_math.h"
 #include "agg_array.h"
+#include "agg_simd.h"
 
 
 namespace agg
@@ -35,6 +36,462 @@ namespace agg
 
 
 
+    //-----------------------------------------------------gradient_batch_size_e
+    enum gradient_batch_size_e
+    {
+        gradient_batch_size = 256
+    };
+
+
+    //==========================================================gradient_batch
+    // The vectorized parts of span_gradient: the mapping of the gradient
+    // values to the color indices and the gradient functions that have
+    // the calculations worth vectorizing. All of them give exactly the 
+    // same results as the scalar code, including the rounding. The
+    // division in color_indices() is done in doubles, which is exact 
+    // for 32-bit integers. The arc tangent for gradient_conic is the 
+    // Cephes rational approximation, within 2 ulp of std::atan2(), which
+    // makes no difference after the rounding to the subpixel units.
+    //------------------------------------------------------------------------
+    class gradient_batch
+    {
+    public:
+        //--------------------------------------------------------------------
+        // d[i] = ((d[i] - d1) * size) / dd clipped to 0...size-1
+        static void color_indices(int* d, unsigned len, int d1, int dd, int size)
+        {
+            unsigned i = 0;
+            switch(simd_level())
+            {
+#if defined(AGG_SIMD_AVX2)
+            case simd_avx2: i = color_indices_avx2(d, len, d1, dd, size); break;
+#endif
+#if defined(AGG_SIMD_SSE2)
+            case simd_sse2: i = color_indices_sse2(d, len, d1, dd, size); break;
+#endif
+            default: break;
+            }
+            for(; i < len; i++)
+            {
+                int v = ((d[i] - d1) * size) / dd;
+                if(v < 0) v = 0;
+                if(v >= size) v = size - 1;
+                d[i] = v;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // uround(sqrt(x*x + y*y)), gradient_radial_d
+        static void radial_d(const int* xy, int* d, unsigned len)
+        {
+            unsigned i = 0;
+            switch(simd_level())
+            {
+#if defined(AGG_SIMD_AVX2)
+            case simd_avx2: i = radial_d_avx2(xy, d, len); break;
+#endif
+#if defined(AGG_SIMD_SSE2)
+            case simd_sse2: i = radial_d_sse2(xy, d, len); break;
+#endif
+            default: break;
+            }
+            for(; i < len; i++)
+            {
+                double x = xy[i * 2];
+                double y = xy[i * 2 + 1];
+                d[i] = uround(std::sqrt(x * x + y * y));
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // gradient_radial_focus with the given invariants
+        static void radial_focus(const int* xy, int* d, unsigned len,
+                                 int fx, int fy, double r2, double mul)
+        {
+            unsigned i = 0;
+            switch(simd_level())
+            {
+#if defined(AGG_SIMD_AVX2)
+            case simd_avx2: i = radial_focus_avx2(xy, d, len, fx, fy, r2, mul); break;
+#endif
+#if defined(AGG_SIMD_SSE2)
+            case simd_sse2: i = radial_focus_sse2(xy, d, len, fx, fy, r2, mul); break;
+#endif
+            default: break;
+            }
+            for(; i < len; i++)
+            {
+                double dx = xy[i * 2]     - fx;
+                double dy = xy[i * 2 + 1] - fy;
+                double d2 = dx * fy - dy * fx;
+                double d3 = r2 * (dx * dx + dy * dy) - d2 * d2;
+                d[i] = iround((dx * fx + dy * fy + std::sqrt(std::fabs(d3))) * mul);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // uround(|atan2(y, x)| * dd / pi), gradient_conic
+        static void conic(const int* xy, int* d, unsigned len, int dd)
+        {
+            unsigned i = 0;
+            switch(simd_level())
+            {
+#if defined(AGG_SIMD_AVX2)
+            case simd_avx2: i = conic_avx2(xy, d, len, dd); break;
+#endif
+#if defined(AGG_SIMD_SSE2)
+            case simd_sse2: i = conic_sse2(xy, d, len, dd); break;
+#endif
+            default: break;
+            }
+            for(; i < len; i++)
+            {
+                d[i] = uround(std::fabs(std::atan2(double(xy[i * 2 + 1]), 
+                                                   double(xy[i * 2]))) * double(dd) / pi);
+            }
+        }
+
+    private:
+#if defined(AGG_SIMD_SSE2)
+        //--------------------------------------------------------------------
+        // Deinterleaves 2 points into the x and y doubles
+        static AGG_INLINE void load_xy_sse2(const int* xy, __m128d& x, __m128d& y)
+        {
+            __m128i v = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)xy), 0xD8);
+            x = _mm_cvtepi32_pd(v);
+            y = _mm_cvtepi32_pd(_mm_shuffle_epi32(v, 0xEE));
+        }
+
+        //--------------------------------------------------------------------
+        static AGG_INLINE void store2_sse2(int* d, __m128i v)
+        {
+            _mm_storel_epi64((__m128i*)d, v);
+        }
+
+        //--------------------------------------------------------------------
+        // Like iround(), halves away from zero
+        static AGG_INLINE __m128i iround_sse2(__m128d v)
+        {
+            __m128d h = _mm_or_pd(_mm_and_pd(v, _mm_set1_pd(-0.0)), _mm_set1_pd(0.5));
+            return _mm_cvttpd_epi32(_mm_add_pd(v, h));
+        }
+
+        //--------------------------------------------------------------------
+        static AGG_INLINE __m128d select_sse2(__m128d mask, __m128d a, __m128d b)
+        {
+            return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+        }
+
+        //--------------------------------------------------------------------
+        static unsigned color_indices_sse2(int* d, unsigned len, 
+                                           int d1, int dd, int size)
+        {
+            unsigned n = len & ~3u;
+            __m128i vd1 = _mm_set1_epi32(d1);
+            __m128i vsz = _mm_set1_epi32(size);
+            __m128d vdd = _mm_set1_pd(dd);
+            __m128d vmx = _mm_set1_pd(size - 1);
+            __m128d zero = _mm_setzero_pd();
+            unsigned i;
+            for(i = 0; i < n; i += 4)
+            {
+                // (d - d1) * size in 32 bits, wrapping around as the 
+                // integer code does, the 32x32 bit multiplication done
+                // in the even and odd elements.
+                __m128i v = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(d + i)), vd1);
+                __m128i ev = _mm_mul_epu32(v, vsz);
+                __m128i od = _mm_mul_epu32(_mm_srli_epi64(v, 32), vsz);
+                v = _mm_unpacklo_epi32(_mm_shuffle_epi32(ev, 0x08), 
+                                       _mm_shuffle_epi32(od, 0x08));
+                __m128d lo = _mm_div_pd(_mm_cvtepi32_pd(v), vdd);
+                __m128d hi = _mm_div_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(v, 0xEE)), vdd);
+                // Truncate first, then clip, as the integer code does
+                lo = _mm_min_pd(_mm_max_pd(_mm_cvtepi32_pd(_mm_cvttpd_epi32(lo)), zero), vmx);
+                hi = _mm_min_pd(_mm_max_pd(_mm_cvtepi32_pd(_mm_cvttpd_epi32(hi)), zero), vmx);
+                _mm_storeu_si128((__m128i*)(d + i),
+                    _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi)));
+            }
+            return n;
+        }
+
+        //--------------------------------------------------------------------
+        static unsigned radial_d_sse2(const int* xy, int* d, unsigned len)
+        {
+            unsigned n = len & ~1u;
+            unsigned i;
+            for(i = 0; i < n; i += 2)
+            {
+                __m128d x, y;
+                load_xy_sse2(xy + i * 2, x, y);
+                __m128d r = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)));
+                store2_sse2(d + i, _mm_cvttpd_epi32(_mm_add_pd(r, _mm_set1_pd(0.5))));
+            }
+            return n;
+        }
+
+        //--------------------------------------------------------------------
+        static unsigned radial_focus_sse2(const int* xy, int* d, unsigned len,
+                                          int fx, int fy, double r2, double mul)
+        {
+            unsigned n = len & ~1u;
+            __m128d vfx = _mm_set1_pd(fx);
+            __m128d vfy = _mm_set1_pd(fy);
+            __m128d vr2 = _mm_set1_pd(r2);
+            __m128d vmul = _mm_set1_pd(mul);
+            __m128d abs_mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+            unsigned i;
+            for(i = 0; i < n; i += 2)
+            {
+                __m128d x, y;
+                load_xy_sse2(xy + i * 2, x, y);
+                __m128d dx = _mm_sub_pd(x, vfx);
+                __m128d dy = _mm_sub_pd(y, vfy);
+                __m128d d2 = _mm_sub_pd(_mm_mul_pd(dx, vfy), _mm_mul_pd(dy, vfx));
+                __m128d d3 = _mm_sub_pd(
+                    _mm_mul_pd(vr2, _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))),
+                    _mm_mul_pd(d2, d2));
+                __m128d v = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, vfx), _mm_mul_pd(dy, vfy)),
+                                       _mm_sqrt_pd(_mm_and_pd(d3, abs_mask)));
+                store2_sse2(d + i, iround_sse2(_mm_mul_pd(v, vmul)));
+            }
+            return n;
+        }
+
+        //--------------------------------------------------------------------
+        // |atan2(y, x)|. With t = min(|x|,|y|) / max(|x|,|y|) it's
+        // atan(t) = t + t * z * P(z) / Q(z), z = t*t for t <= tan(pi/8);
+        // the larger t are reduced with atan(t) = pi/4 + atan((t-1)/(t+1)).
+        // The coefficients are from Cephes Math Library.
+        static AGG_INLINE __m128d atan2_abs_sse2(__m128d y, __m128d x)
+        {
+            __m128d sign = _mm_set1_pd(-0.0);
+            __m128d one  = _mm_set1_pd(1.0);
+            __m128d ax = _mm_andnot_pd(sign, x);
+            __m128d ay = _mm_andnot_pd(sign, y);
+            __m128d mx = _mm_max_pd(ax, ay);
+            __m128d t  = _mm_div_pd(_mm_min_pd(ax, ay), 
+                                    _mm_max_pd(mx, _mm_set1_pd(1e-300)));
+            __m128d big = _mm_cmpgt_pd(t, _mm_set1_pd(0.41421356237309504880));
+            t = select_sse2(big, _mm_div_pd(_mm_sub_pd(t, one), _mm_add_pd(t, one)), t);
+            __m128d z = _mm_mul_pd(t, t);
+            __m128d p = _mm_set1_pd(-8.750608600031904122785E-1);
+            p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-1.615753718733365076637E1));
+            p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-7.500855792314704667340E1));
+            p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-1.228866684490136173410E2));
+            p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-6.485021904942025371773E1));
+            __m128d q = _mm_add_pd(z, _mm_set1_pd(2.485846490142306297962E1));
+            q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(1.650270098316988542046E2));
+            q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(4.328810604912902668951E2));
+            q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(4.853903996359136964868E2));
+            q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(1.945506571482613964425E2));
+            __m128d r = _mm_add_pd(_mm_mul_pd(t, _mm_div_pd(_mm_mul_pd(z, p), q)), t);
+            r = _mm_add_pd(_mm_and_pd(big, _mm_set1_pd(pi / 4)), 
+                           _mm_add_pd(r, _mm_and_pd(big, _mm_set1_pd(3.061616997868382943065E-17))));
+            r = select_sse2(_mm_cmpgt_pd(ay, ax), _mm_sub_pd(_mm_set1_pd(pi / 2), r), r);
+            r = select_sse2(_mm_cmplt_pd(x, _mm_setzero_pd()), _mm_sub_pd(_mm_set1_pd(pi), r), r);
+            return r;
+        }
+
+        //--------------------------------------------------------------------
+        static unsigned conic_sse2(const int* xy, int* d, unsigned len, int dd)
+        {
+            unsigned n = len & ~1u;
+            __m128d vdd = _mm_set1_pd(dd);
+            __m128d vpi = _mm_set1_pd(pi);
+            unsigned i;
+            for(i = 0; i < n; i += 2)
+            {
+                __m128d x, y;
+                load_xy_sse2(xy + i * 2, x, y);
+                __m128d a = _mm_div_pd(_mm_mul_pd(atan2_abs_sse2(y, x), vdd), vpi);
+                store2_sse2(d + i, _mm_cvttpd_epi32(_mm_add_pd(a, _mm_set1_pd(0.5))));
+            }
+            return n;
+        }
+#endif
+
+#if defined(AGG_SIMD_AVX2)
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static AGG_INLINE void load_xy_avx2(const int* xy, __m256d& x, __m256d& y)
+        {
+            __m256i v = _mm256_permutevar8x32_epi32(
+                            _mm256_loadu_si256((const __m256i*)xy),
+                            _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+            x = _mm256_cvtepi32_pd(_mm256_castsi256_si128(v));
+            y = _mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1));
+        }
+
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static AGG_INLINE __m128i iround_avx2(__m256d v)
+        {
+            __m256d h = _mm256_or_pd(_mm256_and_pd(v, _mm256_set1_pd(-0.0)), 
+                                     _mm256_set1_pd(0.5));
+            return _mm256_cvttpd_epi32(_mm256_add_pd(v, h));
+        }
+
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static unsigned color_indices_avx2(int* d, unsigned len, 
+                                           int d1, int dd, int size)
+        {
+            unsigned n = len & ~7u;
+            __m256i vd1 = _mm256_set1_epi32(d1);
+            __m256i vsz = _mm256_set1_epi32(size);
+            __m256d vdd = _mm256_set1_pd(dd);
+            __m128i vmx = _mm_set1_epi32(size - 1);
+            __m128i zero = _mm_setzero_si128();
+            unsigned i;
+            for(i = 0; i < n; i += 8)
+            {
+                __m256i v = _mm256_mullo_epi32(
+                    _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(d + i)), vd1), vsz);
+                __m256d lo = _mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), vdd);
+                __m256d hi = _mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), vdd);
+                _mm_storeu_si128((__m128i*)(d + i), 
+                    _mm_min_epi32(_mm_max_epi32(_mm256_cvttpd_epi32(lo), zero), vmx));
+                _mm_storeu_si128((__m128i*)(d + i + 4), 
+                    _mm_min_epi32(_mm_max_epi32(_mm256_cvttpd_epi32(hi), zero), vmx));
+            }
+            _mm256_zeroupper();
+            return n;
+        }
+
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static unsigned radial_d_avx2(const int* xy, int* d, unsigned len)
+        {
+            unsigned n = len & ~3u;
+            unsigned i;
+            for(i = 0; i < n; i += 4)
+            {
+                __m256d x, y;
+                load_xy_avx2(xy + i * 2, x, y);
+                __m256d r = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(x, x), 
+                                                         _mm256_mul_pd(y, y)));
+                _mm_storeu_si128((__m128i*)(d + i), 
+                    _mm256_cvttpd_epi32(_mm256_add_pd(r, _mm256_set1_pd(0.5))));
+            }
+            _mm256_zeroupper();
+            return n;
+        }
+
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static unsigned radial_focus_avx2(const int* xy, int* d, unsigned len,
+                                          int fx, int fy, double r2, double mul)
+        {
+            unsigned n = len & ~3u;
+            __m256d vfx = _mm256_set1_pd(fx);
+            __m256d vfy = _mm256_set1_pd(fy);
+            __m256d vr2 = _mm256_set1_pd(r2);
+            __m256d vmul = _mm256_set1_pd(mul);
+            __m256d abs_mask = _mm256_castsi256_pd(
+                                   _mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+            unsigned i;
+            for(i = 0; i < n; i += 4)
+            {
+                __m256d x, y;
+                load_xy_avx2(xy + i * 2, x, y);
+                __m256d dx = _mm256_sub_pd(x, vfx);
+                __m256d dy = _mm256_sub_pd(y, vfy);
+                __m256d d2 = _mm256_sub_pd(_mm256_mul_pd(dx, vfy), _mm256_mul_pd(dy, vfx));
+                __m256d d3 = _mm256_sub_pd(
+                    _mm256_mul_pd(vr2, _mm256_add_pd(_mm256_mul_pd(dx, dx), 
+                                                     _mm256_mul_pd(dy, dy))),
+                    _mm256_mul_pd(d2, d2));
+                __m256d v = _mm256_add_pd(
+                    _mm256_add_pd(_mm256_mul_pd(dx, vfx), _mm256_mul_pd(dy, vfy)),
+                    _mm256_sqrt_pd(_mm256_and_pd(d3, abs_mask)));
+                _mm_storeu_si128((__m128i*)(d + i), iround_avx2(_mm256_mul_pd(v, vmul)));
+            }
+            _mm256_zeroupper();
+            return n;
+        }
+
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static AGG_INLINE __m256d atan2_abs_avx2(__m256d y, __m256d x)
+        {
+            __m256d sign = _mm256_set1_pd(-0.0);
+            __m256d one  = _mm256_set1_pd(1.0);
+            __m256d ax = _mm256_andnot_pd(sign, x);
+            __m256d ay = _mm256_andnot_pd(sign, y);
+            __m256d mx = _mm256_max_pd(ax, ay);
+            __m256d t  = _mm256_div_pd(_mm256_min_pd(ax, ay), 
+                                       _mm256_max_pd(mx, _mm256_set1_pd(1e-300)));
+            __m256d big = _mm256_cmp_pd(t, _mm256_set1_pd(0.41421356237309504880), _CMP_GT_OQ);
+            t = _mm256_blendv_pd(t, _mm256_div_pd(_mm256_sub_pd(t, one), 
+                                                  _mm256_add_pd(t, one)), big);
+            __m256d z = _mm256_mul_pd(t, t);
+            __m256d p = _mm256_set1_pd(-8.750608600031904122785E-1);
+            p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(-1.615753718733365076637E1));
+            p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(-7.500855792314704667340E1));
+            p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(-1.228866684490136173410E2));
+            p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(-6.485021904942025371773E1));
+            __m256d q = _mm256_add_pd(z, _mm256_set1_pd(2.485846490142306297962E1));
+            q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(1.650270098316988542046E2));
+            q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(4.328810604912902668951E2));
+            q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(4.853903996359136964868E2));
+            q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(1.945506571482613964425E2));
+            __m256d r = _mm256_add_pd(_mm256_mul_pd(t, _mm256_div_pd(_mm256_mul_pd(z, p), q)), t);
+            r = _mm256_add_pd(_mm256_and_pd(big, _mm256_set1_pd(pi / 4)), 
+                              _mm256_add_pd(r, _mm256_and_pd(big, _mm256_set1_pd(3.061616997868382943065E-17))));
+            r = _mm256_blendv_pd(r, _mm256_sub_pd(_mm256_set1_pd(pi / 2), r), 
+                                 _mm256_cmp_pd(ay, ax, _CMP_GT_OQ));
+            r = _mm256_blendv_pd(r, _mm256_sub_pd(_mm256_set1_pd(pi), r), 
+                                 _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_LT_OQ));
+            return r;
+        }
+
+        //--------------------------------------------------------------------
+        AGG_SIMD_TARGET_AVX2
+        static unsigned conic_avx2(const int* xy, int* d, unsigned len, int dd)
+        {
+            unsigned n = len & ~3u;
+            __m256d vdd = _mm256_set1_pd(dd);
+            __m256d vpi = _mm256_set1_pd(pi);
+            unsigned i;
+            for(i = 0; i < n; i += 4)
+            {
+                __m256d x, y;
+                load_xy_avx2(xy + i * 2, x, y);
+                __m256d a = _mm256_div_pd(_mm256_mul_pd(atan2_abs_avx2(y, x), vdd), vpi);
+                _mm_storeu_si128((__m128i*)(d + i), 
+                    _mm256_cvttpd_epi32(_mm256_add_pd(a, _mm256_set1_pd(0.5))));
+            }
+            _mm256_zeroupper();
+            return n;
+        }
+#endif
+    };
+
+
+    //-----------------------------------------------------calculate_gradients
+    // Calculates the gradient values for len points given as x,y pairs.
+    // The gradient functions that benefit from doing it for many points 
+    // at once have the overloads next to them, together with the ones
+    // of gradient_batched() that return true. span_gradient uses this 
+    // way only for them: for the cheap functions the per pixel loop is 
+    // faster, the integer division there overlaps with the interpolator.
+    //------------------------------------------------------------------------
+    template<class GradientF>
+    void calculate_gradients(GradientF& gf, const int* xy, int* d, 
+                             unsigned len, int d2)
+    {
+        unsigned i;
+        for(i = 0; i < len; i++)
+        {
+            d[i] = gf.calculate(xy[i * 2], xy[i * 2 + 1], d2);
+        }
+    }
+
+    //--------------------------------------------------------gradient_batched
+    template<class GradientF>
+    bool gradient_batched(const GradientF&) { return false; }
+
+
     //==========================================================span_gradient
     template<class ColorT,
              class Interpolator,
@@ -87,6 +544,11 @@ namespace agg
         //--------------------------------------------------------------------
         void generate(color_type* span, int x, int y, unsigned len)
         {   
+            if(gradient_batched(*m_gradient_function))
+            {
+                generate_batched(span, x, y, len);
+                return;
+            }
             int dd = m_d2 - m_d1;
             if(dd < 1) dd = 1;
             m_interpolator->begin(x+0.5, y+0.5, len);
@@ -105,6 +567,46 @@ namespace agg
         }
 
     private:
+        //--------------------------------------------------------------------
+        // The same in batches: the coordinates for up to gradient_batch_size 
+        // pixels, then the gradient values for all of them, then the
+        // color indices.
+        void generate_batched(color_type* span, int x, int y, unsigned len)
+        {
+            int xy[gradient_batch_size * 2];
+            int d[gradient_batch_size];
+            int dd = m_d2 - m_d1;
+            if(dd < 1) dd = 1;
+            int size = (int)m_color_function->size();
+            // The interpolator is copied, so that its state can stay in the
+            // registers; through the pointer every store to xy would have
+            // to be assumed to change it.
+            interpolator_type inter(*m_interpolator);
+            inter.begin(x+0.5, y+0.5, len);
+            do
+            {
+                unsigned n = (len < unsigned(gradient_batch_size)) ? 
+                                 len : unsigned(gradient_batch_size);
+                unsigned i;
+                for(i = 0; i < n; i++)
+                {
+                    inter.coordinates(&x, &y);
+                    xy[i * 2]     = x >> downscale_shift;
+                    xy[i * 2 + 1] = y >> downscale_shift;
+                    ++inter;
+                }
+                calculate_gradients(*m_gradient_function, xy, d, n, m_d2);
+                gradient_batch::color_indices(d, n, m_d1, dd, size);
+                for(i = 0; i < n; i++)
+                {
+                    *span++ = (*m_color_function)[d[i]];
+                }
+                len -= n;
+            }
+            while(len);
+            *m_interpolator = inter;
+        }
+
         interpolator_type* m_interpolator;
         GradientF*         m_gradient_function;
         ColorF*            m_color_function;
@@ -194,6 +696,18 @@ namespace agg
         }
     };
 
+#if !defined(AGG_FISTP) && !defined(AGG_QIFIST)
+    //-----------------------------------------------------calculate_gradients
+    inline void calculate_gradients(gradient_radial_d&, const int* xy, int* d, 
+                                    unsigned len, int)
+    {
+        gradient_batch::radial_d(xy, d, len);
+    }
+
+    //--------------------------------------------------------gradient_batched
+    inline bool gradient_batched(const gradient_radial_d&) { return true; }
+#endif
+
     //====================================================gradient_radial_focus
     class gradient_radial_focus
     {
@@ -240,6 +754,13 @@ namespace agg
             return iround((dx * m_fx + dy * m_fy + std::sqrt(std::fabs(d3))) * m_mul);
         }
 
+        //---------------------------------------------------------------------
+        // The same for len points given as x,y pairs
+        void calculate(const int* xy, int* d, unsigned len) const
+        {
+            gradient_batch::radial_focus(xy, d, len, m_fx, m_fy, m_r2, m_mul);
+        }
+
     private:
         //---------------------------------------------------------------------
         void update_values()
@@ -274,6 +795,18 @@ namespace agg
         double m_mul;
     };
 
+#if !defined(AGG_FISTP) && !defined(AGG_QIFIST)
+    //-----------------------------------------------------calculate_gradients
+    inline void calculate_gradients(gradient_radial_focus& gf, const int* xy, int* d, 
+                                    unsigned len, int)
+    {
+        gf.calculate(xy, d, len);
+    }
+
+    //--------------------------------------------------------gradient_batched
+    inline bool gradient_batched(const gradient_radial_focus&) { return true; }
+#endif
+
 
     //==============================================================gradient_x
     class gradient_x
@@ -332,6 +865,18 @@ namespace agg
         }
     };
 
+#if !defined(AGG_FISTP) && !defined(AGG_QIFIST)
+    //-----------------------------------------------------calculate_gradients
+    inline void calculate_gradients(gradient_conic&, const int* xy, int* d, 
+                                    unsigned len, int d2)
+    {
+        gradient_batch::conic(xy, d, len, d2);
+    }
+
+    //--------------------------------------------------------gradient_batched
+    inline bool gradient_batched(const gradient_conic&) { return true; }
+#endif
+
     //=================================================gradient_repeat_adaptor
     template<class GradientF> class gradient_repeat_adaptor
     {
@@ -241,6 +241,93 @@ namespace agg
 
 
 
+    //=======================================================span_image_mipmap
+    // The base class of the mipmap span generators, the Source is
+    // an image_mipmap. The level of detail (lod) is the mipmap level in
+    // image_subpixel_scale units, the fraction is the weight of the next
+    // level. The positive lod_bias makes the image blurrier, the negative
+    // one makes it sharper.
+    //------------------------------------------------------------------------
+    template<class Source, class Interpolator>
+    class span_image_mipmap :
+    public span_image_filter<Source, Interpolator>
+    {
+    public:
+        typedef Source source_type;
+        typedef Interpolator interpolator_type;
+        typedef span_image_filter<source_type, interpolator_type> base_type;
+
+        //--------------------------------------------------------------------
+        span_image_mipmap() : m_lod_bias(0) {}
+        span_image_mipmap(source_type& src, interpolator_type& inter) :
+            base_type(src, inter, 0),
+            m_lod_bias(0)
+        {}
+
+        //--------------------------------------------------------------------
+        double lod_bias() const { return double(m_lod_bias) / double(image_subpixel_scale); }
+        void lod_bias(double v) { m_lod_bias = iround(v * double(image_subpixel_scale)); }
+
+    protected:
+        //--------------------------------------------------------------------
+        // The scale is the number of the source pixels per one destination
+        // pixel in image_subpixel_scale units. The log2 is approximated
+        // linearly within every octave.
+        AGG_INLINE int calc_lod(int scale) const
+        {
+            int lod = 0;
+            if(scale > image_subpixel_scale)
+            {
+                int level = 0;
+                while((scale >> level) >= image_subpixel_scale * 2) ++level;
+                lod = (level << image_subpixel_shift) +
+                      (scale >> level) - image_subpixel_scale;
+            }
+            lod += m_lod_bias;
+            return (lod < 0) ? 0 : lod;
+        }
+
+        int m_lod_bias;
+    };
+
+
+
+    //================================================span_image_mipmap_affine
+    // The same for the affine transformations, the lod is calculated once
+    // in prepare() from the scale of the matrix.
+    //------------------------------------------------------------------------
+    template<class Source>
+    class span_image_mipmap_affine :
+    public span_image_mipmap<Source, span_interpolator_linear<trans_affine> >
+    {
+    public:
+        typedef Source source_type;
+        typedef span_interpolator_linear<trans_affine> interpolator_type;
+        typedef span_image_mipmap<source_type, interpolator_type> base_type;
+
+        //--------------------------------------------------------------------
+        span_image_mipmap_affine() : m_lod(0) {}
+        span_image_mipmap_affine(source_type& src, interpolator_type& inter) :
+            base_type(src, inter),
+            m_lod(0)
+        {}
+
+        //--------------------------------------------------------------------
+        void prepare()
+        {
+            double scale_x;
+            double scale_y;
+            base_type::interpolator().transformer().scaling_abs(&scale_x, &scale_y);
+            double scale = (scale_x > scale_y) ? scale_x : scale_y;
+            if(scale > 1 << 20) scale = 1 << 20;
+            m_lod = base_type::calc_lod(uround(scale * double(image_subpixel_scale)));
+        }
+
+    protected:
+        int m_lod;
+    };
+
+
 
 }
 
@@ -26,6 +26,7 @@
 #include "agg_basics.h"
 #include "agg_color_rgba.h"
 #include "agg_span_image_filter.h"
+#include "agg_image_accessors.h"
 
 
 namespace agg
@@ -881,6 +882,236 @@ namespace agg
     };
 
 
+
+    //----------------------------------------------------mipmap_bilinear_rgba
+    // Internal. Bilinear filtering of one level of a mipmap. x_hr and y_hr
+    // are the coordinates in the level 0, the result has
+    // image_subpixel_shift * 2 fractional bits.
+    template<class Accessor, class LongType>
+    AGG_INLINE void mipmap_bilinear_rgba(Accessor& src,
+                                         int x_hr, int y_hr,
+                                         int dx, int dy,
+                                         unsigned level,
+                                         LongType* fg)
+    {
+        typedef typename Accessor::value_type value_type;
+
+        x_hr = (x_hr >> level) - dx;
+        y_hr = (y_hr >> level) - dy;
+
+        int x_lr = x_hr >> image_subpixel_shift;
+        int y_lr = y_hr >> image_subpixel_shift;
+
+        x_hr &= image_subpixel_mask;
+        y_hr &= image_subpixel_mask;
+
+        const value_type* fg_ptr;
+        unsigned weight;
+        fg[0] =
+        fg[1] =
+        fg[2] =
+        fg[3] = image_subpixel_scale * image_subpixel_scale / 2;
+
+        fg_ptr = (const value_type*)src.span(x_lr, y_lr, 2);
+        weight = (image_subpixel_scale - x_hr) *
+                 (image_subpixel_scale - y_hr);
+        fg[0] += weight * *fg_ptr++;
+        fg[1] += weight * *fg_ptr++;
+        fg[2] += weight * *fg_ptr++;
+        fg[3] += weight * *fg_ptr;
+
+        fg_ptr = (const value_type*)src.next_x();
+        weight = x_hr * (image_subpixel_scale - y_hr);
+        fg[0] += weight * *fg_ptr++;
+        fg[1] += weight * *fg_ptr++;
+        fg[2] += weight * *fg_ptr++;
+        fg[3] += weight * *fg_ptr;
+
+        fg_ptr = (const value_type*)src.next_y();
+        weight = (image_subpixel_scale - x_hr) * y_hr;
+        fg[0] += weight * *fg_ptr++;
+        fg[1] += weight * *fg_ptr++;
+        fg[2] += weight * *fg_ptr++;
+        fg[3] += weight * *fg_ptr;
+
+        fg_ptr = (const value_type*)src.next_x();
+        weight = x_hr * y_hr;
+        fg[0] += weight * *fg_ptr++;
+        fg[1] += weight * *fg_ptr++;
+        fg[2] += weight * *fg_ptr++;
+        fg[3] += weight * *fg_ptr;
+    }
+
+
+    //---------------------------------------------------mipmap_trilinear_rgba
+    // Internal. Filters the levels lod >> image_subpixel_shift and the next
+    // one and mixes them by the fraction of the lod. The lod must be
+    // clipped to the last level.
+    template<class Order, class Accessor, class ColorT>
+    AGG_INLINE void mipmap_trilinear_rgba(Accessor& src1, Accessor& src2,
+                                          int x_hr, int y_hr,
+                                          int dx, int dy,
+                                          int lod,
+                                          ColorT* span)
+    {
+        typedef typename ColorT::value_type value_type;
+        typedef typename ColorT::long_type  long_type;
+
+        long_type fg[4];
+        unsigned level = lod >> image_subpixel_shift;
+        unsigned frac  = lod &  image_subpixel_mask;
+        mipmap_bilinear_rgba(src1, x_hr, y_hr, dx, dy, level, fg);
+        if(frac)
+        {
+            long_type fg2[4];
+            mipmap_bilinear_rgba(src2, x_hr, y_hr, dx, dy, level + 1, fg2);
+            unsigned k;
+            for(k = 0; k < 4; k++)
+            {
+                fg[k] = (fg[k]  >> image_subpixel_shift) * (image_subpixel_scale - frac) +
+                        (fg2[k] >> image_subpixel_shift) * frac;
+            }
+        }
+        span->r = value_type(ColorT::downshift(fg[Order::R], image_subpixel_shift * 2));
+        span->g = value_type(ColorT::downshift(fg[Order::G], image_subpixel_shift * 2));
+        span->b = value_type(ColorT::downshift(fg[Order::B], image_subpixel_shift * 2));
+        span->a = value_type(ColorT::downshift(fg[Order::A], image_subpixel_shift * 2));
+    }
+
+
+    //=========================================span_image_mipmap_rgba_affine
+    // Trilinear filtering of an image_mipmap with an affine transformation.
+    // The level is chosen once per span from the scale of the matrix, so
+    // the cost per pixel doesn't depend on how much the image is minified.
+    // The Accessor is created for every level used, it's
+    // image_accessor_clone by default; image_accessor_wrap works for
+    // the images with the power of 2 sizes.
+    //------------------------------------------------------------------------
+    template<class Mipmap,
+             class Accessor = image_accessor_clone<typename Mipmap::pixfmt_type> >
+    class span_image_mipmap_rgba_affine :
+    public span_image_mipmap_affine<Mipmap>
+    {
+    public:
+        typedef Mipmap source_type;
+        typedef Accessor accessor_type;
+        typedef typename source_type::color_type color_type;
+        typedef typename source_type::order_type order_type;
+        typedef span_image_mipmap_affine<source_type> base_type;
+        typedef typename base_type::interpolator_type interpolator_type;
+
+        //--------------------------------------------------------------------
+        span_image_mipmap_rgba_affine() {}
+        span_image_mipmap_rgba_affine(source_type& src,
+                                      interpolator_type& inter) :
+            base_type(src, inter)
+        {}
+
+        //--------------------------------------------------------------------
+        void generate(color_type* span, int x, int y, unsigned len)
+        {
+            base_type::interpolator().begin(x + base_type::filter_dx_dbl(),
+                                            y + base_type::filter_dy_dbl(), len);
+
+            int max_lod = int(base_type::source().num_levels() - 1) << image_subpixel_shift;
+            int lod = (base_type::m_lod < max_lod) ? base_type::m_lod : max_lod;
+            unsigned level = lod >> image_subpixel_shift;
+
+            accessor_type src1(base_type::source().level(level));
+            accessor_type src2 = src1;
+            if(lod & image_subpixel_mask)
+            {
+                src2 = accessor_type(base_type::source().level(level + 1));
+            }
+
+            do
+            {
+                base_type::interpolator().coordinates(&x, &y);
+                mipmap_trilinear_rgba<order_type>(src1, src2, x, y,
+                                                  base_type::filter_dx_int(),
+                                                  base_type::filter_dy_int(),
+                                                  lod, span);
+                ++span;
+                ++base_type::interpolator();
+            } while(--len);
+        }
+    };
+
+
+    //=================================================span_image_mipmap_rgba
+    // The same for the arbitrary transformations, the level is chosen
+    // for every pixel from the local scale of the interpolator, so the
+    // Interpolator must have local_scale(), like span_interpolator_persp_lerp
+    // and span_interpolator_persp_exact.
+    //------------------------------------------------------------------------
+    template<class Mipmap,
+             class Interpolator,
+             class Accessor = image_accessor_clone<typename Mipmap::pixfmt_type> >
+    class span_image_mipmap_rgba :
+    public span_image_mipmap<Mipmap, Interpolator>
+    {
+    public:
+        typedef Mipmap source_type;
+        typedef Interpolator interpolator_type;
+        typedef Accessor accessor_type;
+        typedef typename source_type::color_type color_type;
+        typedef typename source_type::order_type order_type;
+        typedef span_image_mipmap<source_type, interpolator_type> base_type;
+
+        //--------------------------------------------------------------------
+        span_image_mipmap_rgba() {}
+        span_image_mipmap_rgba(source_type& src,
+                               interpolator_type& inter) :
+            base_type(src, inter)
+        {}
+
+        //--------------------------------------------------------------------
+        void generate(color_type* span, int x, int y, unsigned len)
+        {
+            base_type::interpolator().begin(x + base_type::filter_dx_dbl(),
+                                            y + base_type::filter_dy_dbl(), len);
+
+            int max_lod = int(base_type::source().num_levels() - 1) << image_subpixel_shift;
+
+            // The accessors are created again only when the level changes
+            accessor_type src1;
+            accessor_type src2;
+            int level1 = -1;
+            int level2 = -1;
+
+            do
+            {
+                int rx;
+                int ry;
+                base_type::interpolator().coordinates(&x, &y);
+                base_type::interpolator().local_scale(&rx, &ry);
+
+                int lod = base_type::calc_lod((rx > ry) ? rx : ry);
+                if(lod > max_lod) lod = max_lod;
+                int level = lod >> image_subpixel_shift;
+
+                if(level != level1)
+                {
+                    src1 = accessor_type(base_type::source().level(level));
+                    level1 = level;
+                }
+                if((lod & image_subpixel_mask) && level + 1 != level2)
+                {
+                    src2 = accessor_type(base_type::source().level(level + 1));
+                    level2 = level + 1;
+                }
+
+                mipmap_trilinear_rgba<order_type>(src1, src2, x, y,
+                                                  base_type::filter_dx_int(),
+                                                  base_type::filter_dy_int(),
+                                                  lod, span);
+                ++span;
+                ++base_type::interpolator();
+            } while(--len);
+        }
+    };
+
+
 }
 
 
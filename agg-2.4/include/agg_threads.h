@@ -0,0 +1,349 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Minimal threading support used by the parallel renderers.
+// POSIX threads or Win32 threads are used depending on the platform.
+// Define AGG_NO_THREADS to make everything run in the calling thread.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_THREADS_INCLUDED
+#define AGG_THREADS_INCLUDED
+
+#include "agg_basics.h"
+
+#if !defined(AGG_NO_THREADS)
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+#endif
+#endif
+
+namespace agg
+{
+
+    //----------------------------------------------------------------num_cpus
+    // Returns the number of processors available, at least 1. On Linux
+    // these are the ones the process may run on, which is less than
+    // the online ones with taskset or in a container with a cpuset.
+    inline unsigned num_cpus()
+    {
+#if defined(AGG_NO_THREADS)
+        return 1;
+#elif defined(__linux__) && defined(CPU_COUNT)
+        cpu_set_t set;
+        if(sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            int n = CPU_COUNT(&set);
+            if(n > 0) return unsigned(n);
+        }
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        return (n > 0) ? unsigned(n) : 1;
+#elif defined(_WIN32)
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        return si.dwNumberOfProcessors ? unsigned(si.dwNumberOfProcessors) : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        return (n > 0) ? unsigned(n) : 1;
+#else
+        return 1;
+#endif
+    }
+
+
+    //-------------------------------------------------------------------mutex
+    class mutex
+    {
+    public:
+#if defined(AGG_NO_THREADS)
+        mutex() {}
+        void lock() {}
+        void unlock() {}
+#elif defined(_WIN32)
+        ~mutex() { DeleteCriticalSection(&m_cs); }
+        mutex() { InitializeCriticalSection(&m_cs); }
+        void lock()   { EnterCriticalSection(&m_cs); }
+        void unlock() { LeaveCriticalSection(&m_cs); }
+#else
+        ~mutex() { pthread_mutex_destroy(&m_mtx); }
+        mutex() { pthread_mutex_init(&m_mtx, 0); }
+        void lock()   { pthread_mutex_lock(&m_mtx); }
+        void unlock() { pthread_mutex_unlock(&m_mtx); }
+#endif
+
+    private:
+        mutex(const mutex&);
+        const mutex& operator = (const mutex&);
+
+#if defined(AGG_NO_THREADS)
+#elif defined(_WIN32)
+        CRITICAL_SECTION m_cs;
+#else
+        pthread_mutex_t  m_mtx;
+#endif
+    };
+
+
+    //-------------------------------------------------------------scoped_lock
+    class scoped_lock
+    {
+    public:
+        ~scoped_lock() { m_mtx.unlock(); }
+        explicit scoped_lock(mutex& m) : m_mtx(m) { m_mtx.lock(); }
+
+    private:
+        scoped_lock(const scoped_lock&);
+        const scoped_lock& operator = (const scoped_lock&);
+
+        mutex& m_mtx;
+    };
+
+
+    //-----------------------------------------------------atomic_load_acquire
+    // Pointer load with acquire and store with release semantics. It's
+    // enough to publish a completely initialized object to other threads
+    // without locking: the object is written first and then the pointer
+    // is stored with atomic_store_release().
+    template<class T> inline T* atomic_load_acquire(T* const volatile* p)
+    {
+#if defined(AGG_NO_THREADS)
+        return *p;
+#elif defined(__clang__) || \
+      (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#elif defined(__GNUC__)
+        T* v = *p;
+        __sync_synchronize();
+        return v;
+#elif defined(_WIN32)
+        T* v = *p;
+        MemoryBarrier();
+        return v;
+#else
+        return *p;
+#endif
+    }
+
+    //----------------------------------------------------atomic_store_release
+    template<class T> inline void atomic_store_release(T* volatile* p, T* v)
+    {
+#if defined(AGG_NO_THREADS)
+        *p = v;
+#elif defined(__clang__) || \
+      (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+        __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#elif defined(__GNUC__)
+        __sync_synchronize();
+        *p = v;
+#elif defined(_WIN32)
+        MemoryBarrier();
+        *p = v;
+#else
+        *p = v;
+#endif
+    }
+
+
+    //-----------------------------------------------------atomic_load_relaxed
+    // Atomic access to a single value without any ordering, for flags
+    // that are read and written by different threads.
+    template<class T> inline T atomic_load_relaxed(const volatile T* p)
+    {
+#if !defined(AGG_NO_THREADS) && (defined(__clang__) || \
+    (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))))
+        return __atomic_load_n(p, __ATOMIC_RELAXED);
+#else
+        return *p;
+#endif
+    }
+
+    //----------------------------------------------------atomic_store_relaxed
+    template<class T> inline void atomic_store_relaxed(volatile T* p, T v)
+    {
+#if !defined(AGG_NO_THREADS) && (defined(__clang__) || \
+    (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))))
+        __atomic_store_n(p, v, __ATOMIC_RELAXED);
+#else
+        *p = v;
+#endif
+    }
+
+
+    //----------------------------------------------------------atomic_counter
+    // A 64-bit counter that can be incremented from several threads,
+    // for statistics. No ordering with respect to other memory is implied.
+    class atomic_counter
+    {
+    public:
+        atomic_counter() : m_value(0) {}
+
+        void add(int64 n)
+        {
+#if defined(AGG_NO_THREADS)
+            m_value += n;
+#elif defined(__clang__) || \
+      (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+            __atomic_add_fetch(&m_value, n, __ATOMIC_RELAXED);
+#elif defined(__GNUC__)
+            __sync_add_and_fetch(&m_value, n);
+#elif defined(_WIN32)
+            InterlockedExchangeAdd64((volatile LONGLONG*)&m_value, n);
+#else
+            m_value += n;
+#endif
+        }
+
+        void increment() { add(1); }
+
+        int64 value() const
+        {
+#if defined(AGG_NO_THREADS)
+            return m_value;
+#elif defined(__clang__) || \
+      (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+            return __atomic_load_n(&m_value, __ATOMIC_RELAXED);
+#elif defined(__GNUC__)
+            return __sync_add_and_fetch((volatile int64*)&m_value, 0);
+#elif defined(_WIN32)
+            return InterlockedCompareExchange64((volatile LONGLONG*)&m_value, 0, 0);
+#else
+            return m_value;
+#endif
+        }
+
+        void reset() { m_value = 0; }
+
+    private:
+        atomic_counter(const atomic_counter&);
+        const atomic_counter& operator = (const atomic_counter&);
+
+        volatile int64 m_value;
+    };
+
+
+    //------------------------------------------------------------parallel_task
+    // Internal. Carries the arguments of one thread of run_parallel().
+    template<class Task> struct parallel_task
+    {
+        Task*    task;
+        unsigned idx;
+        unsigned num;
+
+#if !defined(AGG_NO_THREADS)
+#if defined(_WIN32)
+        static DWORD WINAPI thread_proc(LPVOID arg)
+#else
+        static void* thread_proc(void* arg)
+#endif
+        {
+            parallel_task<Task>* t = (parallel_task<Task>*)arg;
+            t->task->run(t->idx, t->num);
+            return 0;
+        }
+#endif
+    };
+
+
+    //------------------------------------------------------------run_parallel
+    // Calls task.run(thread_idx, num_threads) simultaneously from
+    // num_threads threads and returns when all of them are done.
+    // The calling thread executes the task with index 0. If a thread
+    // can't be created its part of the work is executed in the calling
+    // thread, so that the result never depends on the thread availability.
+    // The Task must only provide:
+    //
+    //     void run(unsigned thread_idx, unsigned num_threads);
+    //------------------------------------------------------------------------
+    template<class Task> void run_parallel(Task& task, unsigned num_threads)
+    {
+        if(num_threads == 0) num_threads = 1;
+#if defined(AGG_NO_THREADS)
+        unsigned i;
+        for(i = 0; i < num_threads; i++) task.run(i, num_threads);
+#else
+        if(num_threads == 1)
+        {
+            task.run(0, 1);
+            return;
+        }
+
+        parallel_task<Task>* args =
+            pod_allocator<parallel_task<Task> >::allocate(num_threads);
+#if defined(_WIN32)
+        HANDLE* threads = pod_allocator<HANDLE>::allocate(num_threads);
+#else
+        pthread_t* threads = pod_allocator<pthread_t>::allocate(num_threads);
+#endif
+        bool* started = pod_allocator<bool>::allocate(num_threads);
+
+        unsigned i;
+        for(i = 0; i < num_threads; i++)
+        {
+            args[i].task = &task;
+            args[i].idx  = i;
+            args[i].num  = num_threads;
+            started[i]   = false;
+        }
+
+        for(i = 1; i < num_threads; i++)
+        {
+#if defined(_WIN32)
+            threads[i] = CreateThread(0, 0, parallel_task<Task>::thread_proc,
+                                      args + i, 0, 0);
+            started[i] = threads[i] != 0;
+#else
+            started[i] = pthread_create(threads + i, 0,
+                                        parallel_task<Task>::thread_proc,
+                                        args + i) == 0;
+#endif
+        }
+
+        task.run(0, num_threads);
+
+        for(i = 1; i < num_threads; i++)
+        {
+            if(started[i])
+            {
+#if defined(_WIN32)
+                WaitForSingleObject(threads[i], INFINITE);
+                CloseHandle(threads[i]);
+#else
+                pthread_join(threads[i], 0);
+#endif
+            }
+            else
+            {
+                task.run(i, num_threads);
+            }
+        }
+
+        pod_allocator<bool>::deallocate(started, num_threads);
+#if defined(_WIN32)
+        pod_allocator<HANDLE>::deallocate(threads, num_threads);
+#else
+        pod_allocator<pthread_t>::deallocate(threads, num_threads);
+#endif
+        pod_allocator<parallel_task<Task> >::deallocate(args, num_threads);
+#endif
+    }
+
+}
+
+#endif
@@ -254,6 +254,11 @@ namespace agg
         // invert() the matrix and then use direct transformations. 
         void inverse_transform(double* x, double* y) const;
 
+        // Direct transformation of num points given as x,y pairs, in 
+        // place, with SSE2 or AVX2 when available. The result is exactly 
+        // the same as of transform().
+        void transform_points(double* xy, unsigned num) const;
+
         //-------------------------------------------- Auxiliary
         // Calculate the determinant of matrix
         double determinant() const
@@ -511,6 +516,41 @@ namespace agg
         {}
     };
 
+
+    //-------------------------------------------------------transform_points
+    // Transforms num points given as x,y pairs in place with any 
+    // transformer. trans_affine and the classes derived from it, 
+    // trans_perspective and trans_bilinear do it in bulk, the others 
+    // point by point with transform(). The last argument picks the 
+    // overload: a pointer to the transformer converts to a pointer to 
+    // its base class better than to void*.
+    template<class Transformer, class T>
+    void transform_points(const Transformer& trans, T* xy, unsigned num, 
+                          const void*)
+    {
+        for(; num; --num)
+        {
+            double x = xy[0];
+            double y = xy[1];
+            trans.transform(&x, &y);
+            *xy++ = T(x);
+            *xy++ = T(y);
+        }
+    }
+
+    template<class Transformer>
+    void transform_points(const Transformer& trans, double* xy, unsigned num, 
+                          const trans_affine*)
+    {
+        trans.trans_affine::transform_points(xy, num);
+    }
+
+    template<class Transformer, class T>
+    void transform_points(const Transformer& trans, T* xy, unsigned num)
+    {
+        transform_points(trans, xy, num, &trans);
+    }
+
 }
 
 
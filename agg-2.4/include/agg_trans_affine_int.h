@@ -0,0 +1,92 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Fixed point affine transformations of the integer coordinates
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_TRANS_AFFINE_INT_INCLUDED
+#define AGG_TRANS_AFFINE_INT_INCLUDED
+
+#include <math.h>
+#include "agg_basics.h"
+#include "agg_trans_affine.h"
+
+namespace agg
+{
+
+    //======================================================trans_affine_int
+    // trans_affine in fixed point for the 24.8 coordinates of the integer
+    // pipeline, see agg_path_storage_int.h. The coefficients have
+    // matrix_shift fractional bits and the products are 64-bit, so
+    // the absolute values of the coefficients must be less than 128.
+    // The error is about |x| / 2^25 subpixels, that is, less than
+    // 1/32 of a pixel for the coordinates up to 2^20 pixels.
+    //------------------------------------------------------------------------
+    class trans_affine_int
+    {
+    public:
+        enum matrix_shift_e
+        {
+            matrix_shift = 24
+        };
+
+        //--------------------------------------------------------------------
+        trans_affine_int() :
+            m_sx(int64(1) << matrix_shift), m_shy(0),
+            m_shx(0), m_sy(int64(1) << matrix_shift),
+            m_tx(0), m_ty(0)
+        {}
+
+        explicit trans_affine_int(const trans_affine& mtx) { set(mtx); }
+
+        //--------------------------------------------------------------------
+        void set(const trans_affine& mtx)
+        {
+            m_sx  = to_fixed(mtx.sx);
+            m_shy = to_fixed(mtx.shy);
+            m_shx = to_fixed(mtx.shx);
+            m_sy  = to_fixed(mtx.sy);
+            m_tx  = to_fixed(mtx.tx * poly_subpixel_scale) +
+                    (int64(1) << (matrix_shift - 1));
+            m_ty  = to_fixed(mtx.ty * poly_subpixel_scale) +
+                    (int64(1) << (matrix_shift - 1));
+        }
+
+        //--------------------------------------------------------------------
+        void transform(int* x, int* y) const
+        {
+            int64 tx = *x;
+            int64 ty = *y;
+            *x = int((tx * m_sx  + ty * m_shx + m_tx) >> matrix_shift);
+            *y = int((tx * m_shy + ty * m_sy  + m_ty) >> matrix_shift);
+        }
+
+    private:
+        static int64 to_fixed(double v)
+        {
+            return int64(floor(v * double(int64(1) << matrix_shift) + 0.5));
+        }
+
+        int64 m_sx;
+        int64 m_shy;
+        int64 m_shx;
+        int64 m_sy;
+        int64 m_tx;
+        int64 m_ty;
+    };
+
+}
+
+#endif
@@ -21,6 +21,7 @@
 
 #include "agg_basics.h"
 #include "agg_simul_eq.h"
+#include "agg_simd.h"
 
 namespace agg
 {
@@ -124,6 +125,38 @@ namespace agg
             *y = m_mtx[0][1] + m_mtx[1][1] * xy + m_mtx[2][1] * tx + m_mtx[3][1] * ty;
         }
 
+        //--------------------------------------------------------------------
+        // Transform num points given as x,y pairs, in place, with SSE2 or 
+        // AVX2 when available. The result is exactly the same as of 
+        // transform().
+        void transform_points(double* xy, unsigned num) const
+        {
+            switch(simd_level())
+            {
+#if defined(AGG_SIMD_AVX2)
+            case simd_avx2:
+                {
+                    unsigned n = transform_points_avx2(m_mtx, xy, num);
+                    xy  += n * 2;
+                    num -= n;
+                }
+                break;
+#endif
+#if defined(AGG_SIMD_SSE2)
+            case simd_sse2:
+                transform_points_sse2(m_mtx, xy, num);
+                return;
+#endif
+            default: break;
+            }
+
+            for(; num; --num)
+            {
+                transform(xy, xy + 1);
+                xy += 2;
+            }
+        }
+
 
         //--------------------------------------------------------------------
         class iterator_x
@@ -157,10 +190,70 @@ namespace agg
         }
 
     private:
+#if defined(AGG_SIMD_SSE2)
+        //--------------------------------------------------------------------
+        // One point per register, x' and y' are calculated together, 
+        // the rows of m_mtx are the pairs of their coefficients.
+        static void transform_points_sse2(const double m[4][2], 
+                                          double* xy, unsigned num)
+        {
+            __m128d c0 = _mm_loadu_pd(m[0]);
+            __m128d c1 = _mm_loadu_pd(m[1]);
+            __m128d c2 = _mm_loadu_pd(m[2]);
+            __m128d c3 = _mm_loadu_pd(m[3]);
+            for(; num; --num)
+            {
+                __m128d p = _mm_loadu_pd(xy);
+                __m128d x = _mm_unpacklo_pd(p, p);
+                __m128d y = _mm_unpackhi_pd(p, p);
+                __m128d r = _mm_add_pd(c0, _mm_mul_pd(c1, _mm_mul_pd(x, y)));
+                r = _mm_add_pd(r, _mm_mul_pd(c2, x));
+                r = _mm_add_pd(r, _mm_mul_pd(c3, y));
+                _mm_storeu_pd(xy, r);
+                xy += 2;
+            }
+        }
+#endif
+
+#if defined(AGG_SIMD_AVX2)
+        //--------------------------------------------------------------------
+        // The same with two points per register, the last odd one is left.
+        AGG_SIMD_TARGET_AVX2
+        static unsigned transform_points_avx2(const double m[4][2], 
+                                              double* xy, unsigned num)
+        {
+            __m256d c0 = _mm256_set_pd(m[0][1], m[0][0], m[0][1], m[0][0]);
+            __m256d c1 = _mm256_set_pd(m[1][1], m[1][0], m[1][1], m[1][0]);
+            __m256d c2 = _mm256_set_pd(m[2][1], m[2][0], m[2][1], m[2][0]);
+            __m256d c3 = _mm256_set_pd(m[3][1], m[3][0], m[3][1], m[3][0]);
+            unsigned i;
+            for(i = 1; i < num; i += 2)
+            {
+                __m256d p = _mm256_loadu_pd(xy);
+                __m256d x = _mm256_unpacklo_pd(p, p);
+                __m256d y = _mm256_unpackhi_pd(p, p);
+                __m256d r = _mm256_add_pd(c0, _mm256_mul_pd(c1, _mm256_mul_pd(x, y)));
+                r = _mm256_add_pd(r, _mm256_mul_pd(c2, x));
+                r = _mm256_add_pd(r, _mm256_mul_pd(c3, y));
+                _mm256_storeu_pd(xy, r);
+                xy += 4;
+            }
+            return num & ~1u;
+        }
+#endif
+
         double m_mtx[4][2];
         bool   m_valid;
     };
 
+    //------------------------------------------------------------------------
+    template<class Transformer>
+    void transform_points(const Transformer& trans, double* xy, unsigned num, 
+                          const trans_bilinear*)
+    {
+        trans.trans_bilinear::transform_points(xy, num);
+    }
+
 }
 
 #endif
@@ -21,6 +21,7 @@
 
 #include <cmath>
 #include "agg_trans_affine.h"
+#include "agg_simd.h"
 
 namespace agg
 {
@@ -205,6 +206,11 @@ namespace agg
         // direct transformations. 
         void inverse_transform(double* x, double* y) const;
 
+        // Direct transformation of num points given as x,y pairs, in 
+        // place, with SSE2 or AVX2 when available. The result is exactly 
+        // the same as of transform().
+        void transform_points(double* xy, unsigned num) const;
+
 
         //---------------------------------------------------------- Auxiliary
         const trans_perspective& from_affine(const trans_affine& a);
@@ -268,6 +274,67 @@ namespace agg
         {
             return iterator_x(x, y, step, *this);
         }
+
+    private:
+#if defined(AGG_SIMD_SSE2)
+        //--------------------------------------------------------------------
+        // One point per register, the numerators of x' and y' together,
+        // the denominator is the same in both halves.
+        static void transform_points_sse2(const trans_perspective& m, 
+                                          double* xy, unsigned num)
+        {
+            __m128d a  = _mm_set_pd(m.shy, m.sx);
+            __m128d b  = _mm_set_pd(m.sy,  m.shx);
+            __m128d t  = _mm_set_pd(m.ty,  m.tx);
+            __m128d w0 = _mm_set1_pd(m.w0);
+            __m128d w1 = _mm_set1_pd(m.w1);
+            __m128d w2 = _mm_set1_pd(m.w2);
+            __m128d one = _mm_set1_pd(1.0);
+            for(; num; --num)
+            {
+                __m128d p = _mm_loadu_pd(xy);
+                __m128d x = _mm_unpacklo_pd(p, p);
+                __m128d y = _mm_unpackhi_pd(p, p);
+                __m128d d = _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, w0), 
+                                                  _mm_mul_pd(y, w1)), w2);
+                __m128d n = _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, a), 
+                                                  _mm_mul_pd(y, b)), t);
+                _mm_storeu_pd(xy, _mm_mul_pd(_mm_div_pd(one, d), n));
+                xy += 2;
+            }
+        }
+#endif
+
+#if defined(AGG_SIMD_AVX2)
+        //--------------------------------------------------------------------
+        // The same with two points per register, the last odd one is left.
+        AGG_SIMD_TARGET_AVX2
+        static unsigned transform_points_avx2(const trans_perspective& m, 
+                                              double* xy, unsigned num)
+        {
+            __m256d a  = _mm256_set_pd(m.shy, m.sx,  m.shy, m.sx);
+            __m256d b  = _mm256_set_pd(m.sy,  m.shx, m.sy,  m.shx);
+            __m256d t  = _mm256_set_pd(m.ty,  m.tx,  m.ty,  m.tx);
+            __m256d w0 = _mm256_set1_pd(m.w0);
+            __m256d w1 = _mm256_set1_pd(m.w1);
+            __m256d w2 = _mm256_set1_pd(m.w2);
+            __m256d one = _mm256_set1_pd(1.0);
+            unsigned i;
+            for(i = 1; i < num; i += 2)
+            {
+                __m256d p = _mm256_loadu_pd(xy);
+                __m256d x = _mm256_unpacklo_pd(p, p);
+                __m256d y = _mm256_unpackhi_pd(p, p);
+                __m256d d = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, w0), 
+                                                        _mm256_mul_pd(y, w1)), w2);
+                __m256d n = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, a), 
+                                                        _mm256_mul_pd(y, b)), t);
+                _mm256_storeu_pd(xy, _mm256_mul_pd(_mm256_div_pd(one, d), n));
+                xy += 4;
+            }
+            return num & ~1u;
+        }
+#endif
     };
 
 
@@ -577,6 +644,35 @@ namespace agg
         *py = m * (x*shy + y*sy  + ty);
     }
 
+    //------------------------------------------------------------------------
+    inline void trans_perspective::transform_points(double* xy, unsigned num) const
+    {
+        switch(simd_level())
+        {
+#if defined(AGG_SIMD_AVX2)
+        case simd_avx2:
+            {
+                unsigned n = transform_points_avx2(*this, xy, num);
+                xy  += n * 2;
+                num -= n;
+            }
+            break;
+#endif
+#if defined(AGG_SIMD_SSE2)
+        case simd_sse2:
+            transform_points_sse2(*this, xy, num);
+            return;
+#endif
+        default: break;
+        }
+
+        for(; num; --num)
+        {
+            transform(xy, xy + 1);
+            xy += 2;
+        }
+    }
+
     //------------------------------------------------------------------------
     inline void trans_perspective::transform_affine(double* x, double* y) const
     {
@@ -726,7 +822,14 @@ namespace agg
     }
 
 
+    //------------------------------------------------------------------------
+    template<class Transformer>
+    void transform_points(const Transformer& trans, double* xy, unsigned num, 
+                          const trans_perspective*)
+    {
+        trans.trans_perspective::transform_points(xy, num);
+    }
+
 }
 
 #endif
-
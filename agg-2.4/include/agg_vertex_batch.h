@@ -0,0 +1,65 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// The batched vertex interface.
+//
+// A vertex source can optionally give its vertices in blocks:
+//
+//   unsigned vertices(double* xy, unsigned* cmds, unsigned max);
+//
+// It writes up to max commands to cmds and their coordinates to xy as
+// x,y pairs and returns the number written. path_cmd_stop is never
+// written; a return value less than max means the path is over and
+// the next call must not be made before rewind().
+//
+// read_vertices() is the way to call it. The generic version calls
+// vertex() in a loop, so it works with any vertex source; the ones
+// that implement vertices() (path_base, conv_transform, conv_curve)
+// have the overloads of read_vertices() next to them that forward the
+// call. The converters call read_vertices() on their sources, so a
+// pipeline moves whole blocks through its stages when all of them
+// have it, and falls back to vertex() on the stages that don't.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_VERTEX_BATCH_INCLUDED
+#define AGG_VERTEX_BATCH_INCLUDED
+
+#include "agg_basics.h"
+
+namespace agg
+{
+    //------------------------------------------------------vertex_batch_size_e
+    enum vertex_batch_size_e
+    {
+        vertex_batch_size = 256
+    };
+
+    //-------------------------------------------------------------read_vertices
+    template<class VertexSource>
+    unsigned read_vertices(VertexSource& vs, double* xy, unsigned* cmds, unsigned max)
+    {
+        unsigned n;
+        for(n = 0; n < max; n++)
+        {
+            unsigned cmd = vs.vertex(xy, xy + 1);
+            if(is_stop(cmd)) break;
+            cmds[n] = cmd;
+            xy += 2;
+        }
+        return n;
+    }
+}
+
+#endif
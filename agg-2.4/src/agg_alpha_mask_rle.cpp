@@ -0,0 +1,385 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// alpha_mask_rle
+//
+//----------------------------------------------------------------------------
+
+#include <string.h>
+#include "agg_simd.h"
+#include "agg_alpha_mask_rle.h"
+
+namespace agg
+{
+
+#if defined(AGG_SIMD_SSE2)
+    //------------------------------------------------------------------------
+    // dst[i] = (255 + dst[i] * src[i]) >> 8, 16 covers at a time
+    static unsigned combine_covers_sse2(int8u* dst, const int8u* src, unsigned len)
+    {
+        unsigned n = len & ~15u;
+        __m128i zero = _mm_setzero_si128();
+        __m128i full = _mm_set1_epi16(255);
+        unsigned i;
+        for(i = 0; i < n; i += 16)
+        {
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+            __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero),
+                                         _mm_unpacklo_epi8(s, zero));
+            __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero),
+                                         _mm_unpackhi_epi8(s, zero));
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, full), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, full), 8);
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+        }
+        return n;
+    }
+
+    //------------------------------------------------------------------------
+    // dst[i] = (255 + dst[i] * cover) >> 8, 16 covers at a time
+    static unsigned combine_cover_sse2(int8u* dst, unsigned cover, unsigned len)
+    {
+        unsigned n = len & ~15u;
+        __m128i zero = _mm_setzero_si128();
+        __m128i full = _mm_set1_epi16(255);
+        __m128i c    = _mm_set1_epi16(short(cover));
+        unsigned i;
+        for(i = 0; i < n; i += 16)
+        {
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+            __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), c);
+            __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), c);
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, full), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, full), 8);
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+        }
+        return n;
+    }
+#endif
+
+    //------------------------------------------------------------------------
+    static void combine_covers(int8u* dst, const int8u* src, unsigned len)
+    {
+        unsigned i = 0;
+        switch(simd_level())
+        {
+#if defined(AGG_SIMD_SSE2)
+        case simd_avx2:
+        case simd_sse2: i = combine_covers_sse2(dst, src, len); break;
+#endif
+        default: break;
+        }
+        for(; i < len; i++)
+        {
+            dst[i] = int8u((alpha_mask_rle::cover_full + dst[i] * src[i]) >>
+                           alpha_mask_rle::cover_shift);
+        }
+    }
+
+    //------------------------------------------------------------------------
+    static void combine_cover(int8u* dst, unsigned cover, unsigned len)
+    {
+        unsigned i = 0;
+        switch(simd_level())
+        {
+#if defined(AGG_SIMD_SSE2)
+        case simd_avx2:
+        case simd_sse2: i = combine_cover_sse2(dst, cover, len); break;
+#endif
+        default: break;
+        }
+        for(; i < len; i++)
+        {
+            dst[i] = int8u((alpha_mask_rle::cover_full + dst[i] * cover) >>
+                           alpha_mask_rle::cover_shift);
+        }
+    }
+
+
+    //------------------------------------------------------------------------
+    alpha_mask_rle::alpha_mask_rle() :
+        m_rows(),
+        m_runs(),
+        m_covers(),
+        m_min_y(0)
+    {
+        m_cur_row.start_run = 0;
+        m_cur_row.num_runs  = 0;
+    }
+
+    //------------------------------------------------------------------------
+    void alpha_mask_rle::remove_all()
+    {
+        m_rows.remove_all();
+        m_runs.remove_all();
+        m_covers.remove_all();
+        m_min_y = 0;
+    }
+
+    //------------------------------------------------------------------------
+    bool alpha_mask_rle::start_row(int y)
+    {
+        if(m_rows.size() == 0)
+        {
+            m_min_y = y;
+        }
+        else
+        {
+            if(y <= max_y()) return false;
+        }
+
+        m_cur_row.start_run = m_runs.size();
+        m_cur_row.num_runs  = 0;
+        while(max_y() < y - 1) m_rows.add(m_cur_row);
+        return true;
+    }
+
+    //------------------------------------------------------------------------
+    void alpha_mask_rle::finish_row()
+    {
+        m_cur_row.num_runs = m_runs.size() - m_cur_row.start_run;
+        m_rows.add(m_cur_row);
+    }
+
+    //------------------------------------------------------------------------
+    void alpha_mask_rle::add_solid(int x, unsigned len, unsigned cover)
+    {
+        if(cover == cover_none) return;
+        if(m_runs.size() > m_cur_row.start_run)
+        {
+            run_data& r = m_runs.last();
+            if(r.covers_id < 0 && r.cover == cover && r.x + int(r.len) == x)
+            {
+                r.len += len;
+                return;
+            }
+        }
+        run_data r;
+        r.x         = x;
+        r.len       = len;
+        r.covers_id = -1;
+        r.cover     = cover;
+        m_runs.add(r);
+    }
+
+    //------------------------------------------------------------------------
+    void alpha_mask_rle::add_partial(int x, unsigned len, const cover_type* covers)
+    {
+        while(len)
+        {
+            unsigned n = (len < unsigned(partial_run_max)) ? len : unsigned(partial_run_max);
+            int id = m_covers.allocate_continuous_block(n);
+            memcpy(&m_covers[id], covers, n * sizeof(cover_type));
+
+            bool merged = false;
+            if(m_runs.size() > m_cur_row.start_run)
+            {
+                run_data& r = m_runs.last();
+                if(r.covers_id >= 0 &&
+                   r.x + int(r.len) == x &&
+                   r.covers_id + int(r.len) == id &&
+                   r.len + n <= unsigned(partial_run_max))
+                {
+                    r.len += n;
+                    merged = true;
+                }
+            }
+            if(!merged)
+            {
+                run_data r;
+                r.x         = x;
+                r.len       = n;
+                r.covers_id = id;
+                r.cover     = 0;
+                m_runs.add(r);
+            }
+            x      += n;
+            covers += n;
+            len    -= n;
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Splits the covers into the solid runs of equal covers and the
+    // partial runs between them. The zero covers are dropped.
+    void alpha_mask_rle::add_covers(int x, unsigned len, const cover_type* covers)
+    {
+        unsigned start = 0;
+        unsigned i = 0;
+        while(i < len)
+        {
+            unsigned j = i + 1;
+            while(j < len && covers[j] == covers[i]) ++j;
+            if(covers[i] == cover_none || j - i >= unsigned(solid_run_min))
+            {
+                if(i > start) add_partial(x + start, i - start, covers + start);
+                add_solid(x + i, j - i, covers[i]);
+                start = j;
+            }
+            i = j;
+        }
+        if(len > start) add_partial(x + start, len - start, covers + start);
+    }
+
+    //------------------------------------------------------------------------
+    const alpha_mask_rle::row_data* alpha_mask_rle::row(int y) const
+    {
+        if(y < m_min_y) return 0;
+        unsigned i = unsigned(y - m_min_y);
+        if(i >= m_rows.size()) return 0;
+        const row_data& r = m_rows[i];
+        return r.num_runs ? &r : 0;
+    }
+
+    //------------------------------------------------------------------------
+    // The first run of the row that ends after x
+    unsigned alpha_mask_rle::first_run(const row_data& r, int x) const
+    {
+        unsigned lo = r.start_run;
+        unsigned hi = r.start_run + r.num_runs;
+        while(lo < hi)
+        {
+            unsigned mid = (lo + hi) >> 1;
+            const run_data& rn = m_runs[mid];
+            if(rn.x + int(rn.len) <= x) lo = mid + 1;
+            else                        hi = mid;
+        }
+        return lo;
+    }
+
+    //------------------------------------------------------------------------
+    alpha_mask_rle::cover_type alpha_mask_rle::pixel(int x, int y) const
+    {
+        const row_data* r = row(y);
+        if(r == 0) return cover_none;
+        unsigned i = first_run(*r, x);
+        if(i >= r->start_run + r->num_runs) return cover_none;
+        const run_data& rn = m_runs[i];
+        if(rn.x > x) return cover_none;
+        if(rn.covers_id < 0) return cover_type(rn.cover);
+        return m_covers[rn.covers_id + (x - rn.x)];
+    }
+
+    //------------------------------------------------------------------------
+    alpha_mask_rle::cover_type
+    alpha_mask_rle::combine_pixel(int x, int y, cover_type val) const
+    {
+        return cover_type((cover_full + val * pixel(x, y)) >> cover_shift);
+    }
+
+    //------------------------------------------------------------------------
+    void alpha_mask_rle::fill_hspan(int x, int y, cover_type* dst, int num_pix) const
+    {
+        const row_data* r = row(y);
+        if(r == 0)
+        {
+            memset(dst, 0, num_pix * sizeof(cover_type));
+            return;
+        }
+
+        int x2 = x + num_pix;
+        unsigned end = r->start_run + r->num_runs;
+        unsigned i;
+        for(i = first_run(*r, x); i < end && x < x2; i++)
+        {
+            const run_data& rn = m_runs[i];
+            if(rn.x >= x2) break;
+            if(rn.x > x)
+            {
+                memset(dst, 0, (rn.x - x) * sizeof(cover_type));
+                dst += rn.x - x;
+                x = rn.x;
+            }
+            int e = rn.x + int(rn.len);
+            if(e > x2) e = x2;
+            unsigned n = unsigned(e - x);
+            if(rn.covers_id < 0)
+            {
+                memset(dst, int(rn.cover), n * sizeof(cover_type));
+            }
+            else
+            {
+                memcpy(dst, &m_covers[rn.covers_id + (x - rn.x)],
+                       n * sizeof(cover_type));
+            }
+            dst += n;
+            x = e;
+        }
+        if(x < x2) memset(dst, 0, (x2 - x) * sizeof(cover_type));
+    }
+
+    //------------------------------------------------------------------------
+    void alpha_mask_rle::combine_hspan(int x, int y, cover_type* dst, int num_pix) const
+    {
+        const row_data* r = row(y);
+        if(r == 0)
+        {
+            memset(dst, 0, num_pix * sizeof(cover_type));
+            return;
+        }
+
+        int x2 = x + num_pix;
+        unsigned end = r->start_run + r->num_runs;
+        unsigned i;
+        for(i = first_run(*r, x); i < end && x < x2; i++)
+        {
+            const run_data& rn = m_runs[i];
+            if(rn.x >= x2) break;
+            if(rn.x > x)
+            {
+                memset(dst, 0, (rn.x - x) * sizeof(cover_type));
+                dst += rn.x - x;
+                x = rn.x;
+            }
+            int e = rn.x + int(rn.len);
+            if(e > x2) e = x2;
+            unsigned n = unsigned(e - x);
+            if(rn.covers_id < 0)
+            {
+                if(rn.cover != cover_full) combine_cover(dst, rn.cover, n);
+            }
+            else
+            {
+                combine_covers(dst, &m_covers[rn.covers_id + (x - rn.x)], n);
+            }
+            dst += n;
+            x = e;
+        }
+        if(x < x2) memset(dst, 0, (x2 - x) * sizeof(cover_type));
+    }
+
+    //------------------------------------------------------------------------
+    void alpha_mask_rle::fill_vspan(int x, int y, cover_type* dst, int num_pix) const
+    {
+        do
+        {
+            *dst++ = pixel(x, y++);
+        }
+        while(--num_pix);
+    }
+
+    //------------------------------------------------------------------------
+    void alpha_mask_rle::combine_vspan(int x, int y, cover_type* dst, int num_pix) const
+    {
+        do
+        {
+            *dst = cover_type((cover_full + (*dst) * pixel(x, y++)) >> cover_shift);
+            ++dst;
+        }
+        while(--num_pix);
+    }
+
+}
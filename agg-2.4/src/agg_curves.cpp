@@ -125,6 +125,39 @@ namespace agg
         return path_cmd_line_to;
     }
 
+    //------------------------------------------------------------------------
+    unsigned curve3_inc::vertices(double* xy, unsigned max)
+    {
+        double fx  = m_fx;
+        double fy  = m_fy;
+        double dfx = m_dfx;
+        double dfy = m_dfy;
+        unsigned n = 0;
+        while(n < max && m_step > 0)
+        {
+            fx  += dfx; 
+            fy  += dfy;
+            dfx += m_ddfx; 
+            dfy += m_ddfy; 
+            *xy++ = fx;
+            *xy++ = fy;
+            --m_step;
+            ++n;
+        }
+        m_fx  = fx;
+        m_fy  = fy;
+        m_dfx = dfx;
+        m_dfy = dfy;
+        if(n < max && m_step == 0)
+        {
+            *xy++ = m_end_x;
+            *xy++ = m_end_y;
+            --m_step;
+            ++n;
+        }
+        return n;
+    }
+
     //------------------------------------------------------------------------
     void curve3_div::init(double x1, double y1, 
                           double x2, double y2, 
@@ -370,6 +403,45 @@ namespace agg
         return path_cmd_line_to;
     }
 
+    //------------------------------------------------------------------------
+    unsigned curve4_inc::vertices(double* xy, unsigned max)
+    {
+        double fx   = m_fx;
+        double fy   = m_fy;
+        double dfx  = m_dfx;
+        double dfy  = m_dfy;
+        double ddfx = m_ddfx;
+        double ddfy = m_ddfy;
+        unsigned n = 0;
+        while(n < max && m_step > 0)
+        {
+            fx   += dfx;
+            fy   += dfy;
+            dfx  += ddfx; 
+            dfy  += ddfy; 
+            ddfx += m_dddfx; 
+            ddfy += m_dddfy; 
+            *xy++ = fx;
+            *xy++ = fy;
+            --m_step;
+            ++n;
+        }
+        m_fx   = fx;
+        m_fy   = fy;
+        m_dfx  = dfx;
+        m_dfy  = dfy;
+        m_ddfx = ddfx;
+        m_ddfy = ddfy;
+        if(n < max && m_step == 0)
+        {
+            *xy++ = m_end_x;
+            *xy++ = m_end_y;
+            --m_step;
+            ++n;
+        }
+        return n;
+    }
+
 
 
 
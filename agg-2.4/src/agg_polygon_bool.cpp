@@ -0,0 +1,932 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Boolean operations on polygons
+//
+//----------------------------------------------------------------------------
+
+#include <math.h>
+#include "agg_math.h"
+#include "agg_polygon_bool.h"
+
+namespace agg
+{
+
+    //------------------------------------------------------------------------
+    static inline double signed_area(const point_d& p0,
+                                     const point_d& p1,
+                                     const point_d& p2)
+    {
+        return (p0.x - p2.x) * (p1.y - p2.y) - (p1.x - p2.x) * (p0.y - p2.y);
+    }
+
+    //------------------------------------------------------------------------
+    static inline bool equal_points(const point_d& a, const point_d& b)
+    {
+        return a.x == b.x && a.y == b.y;
+    }
+
+    //------------------------------------------------------------------------
+    // The events are always accessed through the pointers, so these
+    // take any type with the fields of polygon_bool::sweep_event.
+    template<class Event>
+    static inline bool event_below(const Event* e, const point_d& p)
+    {
+        return e->left ?
+            signed_area(e->p, e->other->p, p) > 0 :
+            signed_area(e->other->p, e->p, p) > 0;
+    }
+
+    template<class Event>
+    static inline bool event_vertical(const Event* e)
+    {
+        return e->p.x == e->other->p.x;
+    }
+
+    //------------------------------------------------------------------------
+    // Whether e1 is processed after e2: from the left to the right, from
+    // the bottom to the top, the right ends first and the lower edges first.
+    template<class Event>
+    static bool event_after(const Event* e1, const Event* e2)
+    {
+        if(e1->p.x != e2->p.x) return e1->p.x > e2->p.x;
+        if(e1->p.y != e2->p.y) return e1->p.y > e2->p.y;
+        if(e1->left != e2->left) return e1->left;
+        if(signed_area(e1->p, e1->other->p, e2->other->p) != 0)
+        {
+            return !event_below(e1, e2->other->p);
+        }
+        if(e1->polygon != e2->polygon) return e1->polygon > e2->polygon;
+        return e1->id > e2->id;
+    }
+
+    //------------------------------------------------------------------------
+    // The order of the edges in the sweep line, from the bottom to the top
+    template<class Event>
+    static bool segment_less(const Event* e1, const Event* e2)
+    {
+        if(e1 == e2) return false;
+        if(signed_area(e1->p, e1->other->p, e2->p) != 0 ||
+           signed_area(e1->p, e1->other->p, e2->other->p) != 0)
+        {
+            // Not collinear
+            if(equal_points(e1->p, e2->p)) return event_below(e1, e2->other->p);
+            if(e1->p.x == e2->p.x) return e1->p.y < e2->p.y;
+
+            // Whether e2 is above the left end of e1, which came later,
+            // or the other way round. If the edge starts on the other one,
+            // its right end tells.
+            if(event_after(e1, e2))
+            {
+                if(signed_area(e2->p, e2->other->p, e1->p) == 0)
+                {
+                    return !event_below(e2, e1->other->p);
+                }
+                return !event_below(e2, e1->p);
+            }
+            if(signed_area(e1->p, e1->other->p, e2->p) == 0)
+            {
+                return event_below(e1, e2->other->p);
+            }
+            return event_below(e1, e2->p);
+        }
+
+        // Collinear
+        if(e1->polygon != e2->polygon) return e1->polygon < e2->polygon;
+        if(equal_points(e1->p, e2->p)) return e1->id < e2->id;
+        return event_after(e1, e2);
+    }
+
+    //------------------------------------------------------------------------
+    // The intersection of the closed intervals [u0,u1] and [v0,v1]
+    static unsigned interval_intersection(double u0, double u1,
+                                          double v0, double v1,
+                                          double* w)
+    {
+        if(u1 < v0 || u0 > v1) return 0;
+        if(u1 > v0)
+        {
+            if(u0 < v1)
+            {
+                w[0] = (u0 < v0) ? v0 : u0;
+                w[1] = (u1 > v1) ? v1 : u1;
+                return 2;
+            }
+            w[0] = u0;
+            return 1;
+        }
+        w[0] = u1;
+        return 1;
+    }
+
+    //------------------------------------------------------------------------
+    // The points that are closer than this to an end of an edge are moved
+    // to the end, not to create the tiny edges.
+    const double polygon_bool_snap_epsilon = 1e-8;
+
+    // The grid step is this many bits below the largest coordinate
+    const int polygon_bool_grid_bits = 40;
+
+    static inline bool near_points(const point_d& a, const point_d& b)
+    {
+        return calc_sq_distance(a.x, a.y, b.x, b.y) <
+               polygon_bool_snap_epsilon * polygon_bool_snap_epsilon;
+    }
+
+    static inline void snap_point(point_d* p, const point_d& a, const point_d& b,
+                                  const point_d& c, const point_d& d)
+    {
+        if(near_points(*p, a)) { *p = a; return; }
+        if(near_points(*p, b)) { *p = b; return; }
+        if(near_points(*p, c)) { *p = c; return; }
+        if(near_points(*p, d)) { *p = d; return; }
+    }
+
+    static inline void snap_to_grid(point_d* p, double grid)
+    {
+        p->x = floor(p->x / grid + 0.5) * grid;
+        p->y = floor(p->y / grid + 0.5) * grid;
+    }
+
+    static inline void clip_to_box(point_d* p, const point_d& a, const point_d& b)
+    {
+        if(a.x < b.x) p->x = (p->x < a.x) ? a.x : ((p->x > b.x) ? b.x : p->x);
+        else          p->x = (p->x < b.x) ? b.x : ((p->x > a.x) ? a.x : p->x);
+        if(a.y < b.y) p->y = (p->y < a.y) ? a.y : ((p->y > b.y) ? b.y : p->y);
+        else          p->y = (p->y < b.y) ? b.y : ((p->y > a.y) ? a.y : p->y);
+    }
+
+    //------------------------------------------------------------------------
+    // The intersection of the segments a1-a2 and b1-b2: none, a point
+    // or an overlap from ip[0] to ip[1]. From D. Eberly, "Intersection of
+    // Linear and Circular Components in 2D".
+    static unsigned segment_intersection(const point_d& a1, const point_d& a2,
+                                         const point_d& b1, const point_d& b2,
+                                         const point_d* src,
+                                         double grid, point_d* ip)
+    {
+        double d0x = a2.x - a1.x;
+        double d0y = a2.y - a1.y;
+        double d1x = b2.x - b1.x;
+        double d1y = b2.y - b1.y;
+        double ex  = b1.x - a1.x;
+        double ey  = b1.y - a1.y;
+        double kross = d0x * d1y - d0y * d1x;
+        double sqr_len0 = d0x * d0x + d0y * d0y;
+        double sqr_len1 = d1x * d1x + d1y * d1y;
+
+        // The edges are on the same line when the ends of one of them are
+        // on the other one within the snapping to the grid. The edges
+        // divided at a snapped point aren't exactly collinear with their
+        // copies any more, the angle alone can't tell it.
+        double tol = (grid > polygon_bool_snap_epsilon) ? grid : polygon_bool_snap_epsilon;
+        double sqr_tol = tol * tol;
+        double kb1 = ex * d0y - ey * d0x;
+        double kb2 = (b2.x - a1.x) * d0y - (b2.y - a1.y) * d0x;
+        double ka1 = ex * d1y - ey * d1x;
+        double ka2 = (b1.x - a2.x) * d1y - (b1.y - a2.y) * d1x;
+        bool same_line =
+            (kb1 * kb1 <= sqr_tol * sqr_len0 && kb2 * kb2 <= sqr_tol * sqr_len0) ||
+            (ka1 * ka1 <= sqr_tol * sqr_len1 && ka2 * ka2 <= sqr_tol * sqr_len1);
+
+        if(!same_line)
+        {
+            if(kross == 0.0) return 0;
+
+            // The lines intersect in one point. The edges that pass
+            // through an end of the other one within the rounding errors
+            // get divided exactly there.
+            const double t_epsilon = 1e-10;
+            double s = (ex * d1y - ey * d1x) / kross;
+            if(s < -t_epsilon || s > 1 + t_epsilon) return 0;
+            double t = (ex * d0y - ey * d0x) / kross;
+            if(t < -t_epsilon || t > 1 + t_epsilon) return 0;
+            if     (s <= t_epsilon)     ip[0] = a1;
+            else if(s >= 1 - t_epsilon) ip[0] = a2;
+            else if(t <= t_epsilon)     ip[0] = b1;
+            else if(t >= 1 - t_epsilon) ip[0] = b2;
+            else
+            {
+                // From the source edges, so that the intersections of
+                // the same lines are the same, however they are divided
+                double sx = src[1].x - src[0].x;
+                double sy = src[1].y - src[0].y;
+                double tx = src[3].x - src[2].x;
+                double ty = src[3].y - src[2].y;
+                double k = sx * ty - sy * tx;
+                if(k != 0.0)
+                {
+                    s = ((src[2].x - src[0].x) * ty - (src[2].y - src[0].y) * tx) / k;
+                    ip[0].x = src[0].x + s * sx;
+                    ip[0].y = src[0].y + s * sy;
+                }
+                else
+                {
+                    ip[0].x = a1.x + s * d0x;
+                    ip[0].y = a1.y + s * d0y;
+                }
+                snap_to_grid(ip, grid);
+                snap_point(ip, a1, a2, b1, b2);
+
+                // The point is in the boxes of both edges, so that the
+                // vertical and horizontal edges stay such after dividing
+                clip_to_box(ip, a1, a2);
+                clip_to_box(ip, b1, b2);
+            }
+            return 1;
+        }
+
+        // The same line
+        double s0 = (d0x * ex + d0y * ey) / sqr_len0;
+        double s1 = s0 + (d0x * d1x + d0y * d1y) / sqr_len0;
+        double w[2];
+        unsigned n = (s0 < s1) ?
+            interval_intersection(0, 1, s0, s1, w) :
+            interval_intersection(0, 1, s1, s0, w);
+        unsigned i;
+        for(i = 0; i < n; i++)
+        {
+            ip[i].x = a1.x + w[i] * d0x;
+            ip[i].y = a1.y + w[i] * d0y;
+            snap_to_grid(ip + i, grid);
+            snap_point(ip + i, a1, a2, b1, b2);
+        }
+        return n;
+    }
+
+
+
+    //------------------------------------------------------------------------
+    polygon_bool::polygon_bool() :
+        m_operation(polygon_bool_or),
+        m_grid(1.0),
+        m_input_pos(0),
+        m_contour(0),
+        m_vertex(0)
+    {
+    }
+
+    //------------------------------------------------------------------------
+    void polygon_bool::remove_all()
+    {
+        m_src_vertices.remove_all();
+        m_src_contours.remove_all();
+        m_out_vertices.remove_all();
+        m_contours.remove_all();
+        m_contour = m_vertex = 0;
+    }
+
+    //------------------------------------------------------------------------
+    void polygon_bool::add_vertex(unsigned polygon, double x, double y, unsigned cmd)
+    {
+        if(!is_vertex(cmd)) return;
+        if(is_move_to(cmd) || m_src_contours.size() == 0 ||
+           m_src_contours[m_src_contours.size() - 1].flags != (polygon & 1))
+        {
+            contour_type c;
+            c.start = m_src_vertices.size();
+            c.num   = 0;
+            c.flags = polygon & 1;
+            m_src_contours.add(c);
+        }
+        m_src_vertices.add(point_d(x, y));
+        ++m_src_contours[m_src_contours.size() - 1].num;
+    }
+
+    //------------------------------------------------------------------------
+    polygon_bool::sweep_event*
+    polygon_bool::new_event(const point_d& p, bool left,
+                            unsigned polygon, sweep_event* other)
+    {
+        sweep_event e;
+        e.p         = p;
+        e.other     = other;
+        e.id        = m_events.size();
+        e.polygon   = polygon;
+        e.below     = 0;
+        e.inside    = 0;
+        e.pos       = 0;
+        e.left      = left;
+        e.in_result = false;
+        m_events.add(e);
+        return &m_events[m_events.size() - 1];
+    }
+
+    //------------------------------------------------------------------------
+    void polygon_bool::add_edge(unsigned polygon, const point_d& p1, const point_d& p2)
+    {
+        if(equal_points(p1, p2)) return;
+        sweep_event* e1 = new_event(p1, true, polygon, 0);
+        sweep_event* e2 = new_event(p2, true, polygon, e1);
+        e1->s1 = e2->s1 = p1;
+        e1->s2 = e2->s2 = p2;
+        e1->other = e2;
+        if(event_after(e1, e2)) e1->left = false;
+        else                    e2->left = false;
+        m_input.add(e1);
+        m_input.add(e2);
+    }
+
+    //------------------------------------------------------------------------
+    template<class Event>
+    static bool event_less(Event* const& e1, Event* const& e2)
+    {
+        return event_after(e2, e1);
+    }
+
+    //------------------------------------------------------------------------
+    // The events of the source edges are sorted once, only the ones
+    // that come from dividing the edges go to the queue, which is a binary
+    // heap with the next event at the top.
+    void polygon_bool::push_event(sweep_event* e)
+    {
+        unsigned i = m_queue.size();
+        m_queue.add(e);
+        while(i)
+        {
+            unsigned parent = (i - 1) >> 1;
+            if(!event_after(m_queue[parent], e)) break;
+            m_queue[i] = m_queue[parent];
+            i = parent;
+        }
+        m_queue[i] = e;
+    }
+
+    //------------------------------------------------------------------------
+    polygon_bool::sweep_event* polygon_bool::pop_event()
+    {
+        if(m_input_pos < m_input.size() &&
+           (m_queue.size() == 0 || !event_after(m_input[m_input_pos], m_queue[0])))
+        {
+            return m_input[m_input_pos++];
+        }
+
+        sweep_event* top = m_queue[0];
+        unsigned n = m_queue.size() - 1;
+        sweep_event* e = m_queue[n];
+        m_queue.remove_last();
+        if(n)
+        {
+            unsigned i = 0;
+            for(;;)
+            {
+                unsigned child = i * 2 + 1;
+                if(child >= n) break;
+                if(child + 1 < n && event_after(m_queue[child], m_queue[child + 1]))
+                {
+                    ++child;
+                }
+                if(!event_after(e, m_queue[child])) break;
+                m_queue[i] = m_queue[child];
+                i = child;
+            }
+            m_queue[i] = e;
+        }
+        return top;
+    }
+
+    //------------------------------------------------------------------------
+    // The sweep line is a sorted array, the number of the edges that cross
+    // it is usually small enough for that.
+    unsigned polygon_bool::sweep_line_insert(sweep_event* e)
+    {
+        unsigned lo = 0;
+        unsigned hi = m_sweep_line.size();
+        while(lo < hi)
+        {
+            unsigned mid = (lo + hi) >> 1;
+            if(segment_less(m_sweep_line[mid], e)) lo = mid + 1;
+            else                                   hi = mid;
+        }
+        m_sweep_line.add(e);
+        unsigned i;
+        for(i = m_sweep_line.size() - 1; i > lo; --i)
+        {
+            m_sweep_line[i] = m_sweep_line[i - 1];
+        }
+        m_sweep_line[lo] = e;
+        return lo;
+    }
+
+    //------------------------------------------------------------------------
+    int polygon_bool::sweep_line_find(sweep_event* e) const
+    {
+        unsigned lo = 0;
+        unsigned hi = m_sweep_line.size();
+        while(lo < hi)
+        {
+            unsigned mid = (lo + hi) >> 1;
+            if(segment_less(m_sweep_line[mid], e)) lo = mid + 1;
+            else                                   hi = mid;
+        }
+        if(lo < m_sweep_line.size() && m_sweep_line[lo] == e) return int(lo);
+
+        // The order can be broken by the rounding of the intersections
+        unsigned i;
+        for(i = 0; i < m_sweep_line.size(); i++)
+        {
+            if(m_sweep_line[i] == e) return int(i);
+        }
+        return -1;
+    }
+
+    //------------------------------------------------------------------------
+    void polygon_bool::sweep_line_erase(unsigned i)
+    {
+        for(; i + 1 < m_sweep_line.size(); i++)
+        {
+            m_sweep_line[i] = m_sweep_line[i + 1];
+        }
+        m_sweep_line.remove_last();
+    }
+
+    //------------------------------------------------------------------------
+    // Whether the area is in the result, bit 0 of inside is A and bit 1 is B
+    bool polygon_bool::in_result(unsigned inside) const
+    {
+        bool a = (inside & 1) != 0;
+        bool b = (inside & 2) != 0;
+        switch(m_operation)
+        {
+        case polygon_bool_or:  return a || b;
+        case polygon_bool_and: return a && b;
+        case polygon_bool_xor: return a != b;
+        default: break;
+        }
+        return a && !b;
+    }
+
+    //------------------------------------------------------------------------
+    // The area above prev is below e, except for a vertical prev, whose
+    // "above" is to the left of it, while e starts to the right. The same
+    // edges are counted together, only the top one can be in the result.
+    void polygon_bool::compute_fields(sweep_event* e, sweep_event* prev)
+    {
+        unsigned above = 0;
+        e->below = 0;
+        if(prev)
+        {
+            above = prev->inside;
+            if(equal_points(e->p, prev->p) &&
+               equal_points(e->other->p, prev->other->p))
+            {
+                e->below = prev->below;
+                prev->in_result = false;
+            }
+            else
+            {
+                if(event_vertical(prev)) above ^= 1 << prev->polygon;
+                e->below = above;
+            }
+        }
+        e->inside = above ^ (1 << e->polygon);
+        e->in_result = in_result(e->below) != in_result(e->inside);
+    }
+
+    //------------------------------------------------------------------------
+    void polygon_bool::divide_segment(sweep_event* e, const point_d& p)
+    {
+        // The tiny parts would be divided again and again by the points
+        // that differ only in the rounding.
+        if(near_points(p, e->p) || near_points(p, e->other->p)) return;
+
+        // The right end of the left part and the left end of the right part
+        sweep_event* r = new_event(p, false, e->polygon, e);
+        sweep_event* l = new_event(p, true, e->polygon, e->other);
+        r->s1 = l->s1 = e->s1;
+        r->s2 = l->s2 = e->s2;
+
+        // The rounding can put the point so that the right part goes
+        // backwards
+        if(event_after(l, e->other))
+        {
+            e->other->left = true;
+            l->left = false;
+        }
+        e->other->other = l;
+        e->other = r;
+        push_event(l);
+        push_event(r);
+    }
+
+    //------------------------------------------------------------------------
+    // Divides the edges at their intersection, so that the overlapping
+    // edges become the same edges. The points closer than the snap epsilon
+    // are the same here.
+    void polygon_bool::possible_intersection(sweep_event* e1, sweep_event* e2)
+    {
+        point_d ip[2];
+        point_d src[4] = { e1->s1, e1->s2, e2->s1, e2->s2 };
+        unsigned n = segment_intersection(e1->p, e1->other->p,
+                                          e2->p, e2->other->p, src, m_grid, ip);
+        if(n == 0) return;
+
+        if(n == 1)
+        {
+            // Only touch at an end of both
+            if(near_points(e1->p, e2->p) ||
+               near_points(e1->other->p, e2->other->p)) return;
+
+            divide_segment(e1, ip[0]);
+            divide_segment(e2, ip[0]);
+            return;
+        }
+
+        // The ends of the overlapping edges in the order of processing,
+        // 0 where they coincide
+        sweep_event* ev[4];
+        unsigned num = 0;
+        if(near_points(e1->p, e2->p))
+        {
+            ev[num++] = 0;
+        }
+        else
+        {
+            if(event_after(e1, e2)) { ev[num++] = e2; ev[num++] = e1; }
+            else                    { ev[num++] = e1; ev[num++] = e2; }
+        }
+        if(near_points(e1->other->p, e2->other->p))
+        {
+            ev[num++] = 0;
+        }
+        else
+        {
+            if(event_after(e1->other, e2->other))
+            {
+                ev[num++] = e2->other; ev[num++] = e1->other;
+            }
+            else
+            {
+                ev[num++] = e1->other; ev[num++] = e2->other;
+            }
+        }
+
+        if(num == 2) return;
+
+        if(num == 3)
+        {
+            // The same left or the same right ends
+            if(ev[2]) divide_segment(ev[2]->other, ev[1]->p);
+            else      divide_segment(ev[0], ev[1]->p);
+            return;
+        }
+
+        if(ev[0] != ev[3]->other)
+        {
+            // Partial overlap
+            divide_segment(ev[0], ev[1]->p);
+            divide_segment(ev[1], ev[2]->p);
+            return;
+        }
+
+        // One edge contains the other
+        divide_segment(ev[0], ev[1]->p);
+        divide_segment(ev[3]->other, ev[2]->p);
+    }
+
+    //------------------------------------------------------------------------
+    void polygon_bool::execute(polygon_bool_op_e op)
+    {
+        m_out_vertices.remove_all();
+        m_contours.remove_all();
+        m_contour = m_vertex = 0;
+
+        m_events.remove_all();
+        m_input.remove_all();
+        m_input_pos = 0;
+        m_queue.remove_all();
+        m_sweep_line.remove_all();
+        m_sorted.remove_all();
+
+        // B-A is A-B with the polygons swapped
+        unsigned swap = 0;
+        m_operation = op;
+        if(op == polygon_bool_b_minus_a)
+        {
+            m_operation = polygon_bool_a_minus_b;
+            swap = 1;
+        }
+
+        // The bounding boxes of the contours and of the polygons
+        unsigned i, j;
+        unsigned num_contours[2] = { 0, 0 };
+        unsigned num_events = 0;
+        rect_d   bounds[2];
+        pod_array<rect_d> boxes(m_src_contours.size());
+        for(i = 0; i < m_src_contours.size(); i++)
+        {
+            const contour_type& c = m_src_contours[i];
+            if(c.num < 3) continue;
+            rect_d& r = boxes[i];
+            r.x1 = r.x2 = m_src_vertices[c.start].x;
+            r.y1 = r.y2 = m_src_vertices[c.start].y;
+            for(j = 1; j < c.num; j++)
+            {
+                const point_d& p = m_src_vertices[c.start + j];
+                if(p.x < r.x1) r.x1 = p.x;
+                if(p.y < r.y1) r.y1 = p.y;
+                if(p.x > r.x2) r.x2 = p.x;
+                if(p.y > r.y2) r.y2 = p.y;
+            }
+            unsigned polygon = c.flags ^ swap;
+            bounds[polygon] = num_contours[polygon]++ ?
+                unite_rectangles(bounds[polygon], r) : r;
+            num_events += c.num * 2;
+        }
+
+        // The trivial cases
+        if(num_contours[0] == 0 &&
+           (m_operation == polygon_bool_and ||
+            m_operation == polygon_bool_a_minus_b)) return;
+        if(num_contours[1] == 0 && m_operation == polygon_bool_and) return;
+        if(m_operation == polygon_bool_and &&
+           !bounds[0].overlaps(bounds[1])) return;
+
+        // The contours that are out of the bounding box of the other
+        // polygon change nothing in the intersection, the same for the
+        // contours of B in A-B, like in GPC.
+        // All the points are on a grid that is fine enough not to change
+        // anything visible, so the intersections that should be on the
+        // vertices or on the vertical and horizontal edges get there exactly.
+        double max_abs = 0.0;
+        for(i = 0; i < 2; i++)
+        {
+            if(num_contours[i] == 0) continue;
+            if(fabs(bounds[i].x1) > max_abs) max_abs = fabs(bounds[i].x1);
+            if(fabs(bounds[i].y1) > max_abs) max_abs = fabs(bounds[i].y1);
+            if(fabs(bounds[i].x2) > max_abs) max_abs = fabs(bounds[i].x2);
+            if(fabs(bounds[i].y2) > max_abs) max_abs = fabs(bounds[i].y2);
+        }
+        int exp;
+        frexp(max_abs, &exp);
+        m_grid = ldexp(1.0, exp - polygon_bool_grid_bits);
+
+        m_input.capacity(num_events);
+        for(i = 0; i < m_src_contours.size(); i++)
+        {
+            const contour_type& c = m_src_contours[i];
+            if(c.num < 3) continue;
+            unsigned polygon = c.flags ^ swap;
+            if((m_operation == polygon_bool_and ||
+               (m_operation == polygon_bool_a_minus_b && polygon == 1)) &&
+               !boxes[i].overlaps(bounds[polygon ^ 1])) continue;
+            point_d first = m_src_vertices[c.start];
+            snap_to_grid(&first, m_grid);
+            point_d p1 = first;
+            for(j = 1; j <= c.num; j++)
+            {
+                point_d p2 = first;
+                if(j < c.num)
+                {
+                    p2 = m_src_vertices[c.start + j];
+                    snap_to_grid(&p2, m_grid);
+                }
+                add_edge(polygon, p1, p2);
+                p1 = p2;
+            }
+        }
+        quick_sort(m_input, event_less<sweep_event>);
+
+        // Nothing can be in the result to the right of this. The vertices
+        // are on the grid, so is the limit, otherwise the rightmost ones
+        // could be snapped beyond it.
+        point_d max_x(0.0, 0.0);
+        bool    limit = false;
+        if(m_operation == polygon_bool_and)
+        {
+            max_x.x = (bounds[0].x2 < bounds[1].x2) ? bounds[0].x2 : bounds[1].x2;
+            limit = true;
+        }
+        if(m_operation == polygon_bool_a_minus_b)
+        {
+            max_x.x = bounds[0].x2;
+            limit = true;
+        }
+        snap_to_grid(&max_x, m_grid);
+
+        while(!queue_empty())
+        {
+            sweep_event* e = pop_event();
+            if(limit && e->p.x > max_x.x)
+            {
+                // The edges left in the sweep line end beyond the limit,
+                // they have only the left ends processed and can't be
+                // in the result
+                for(i = 0; i < m_sweep_line.size(); i++)
+                {
+                    m_sweep_line[i]->in_result = false;
+                }
+                break;
+            }
+            m_sorted.add(e);
+
+            if(e->left)
+            {
+                // The edges that start at the same point as e go next to
+                // each other. The overlapping ones are divided to the same
+                // length, both ways, and all of them get the fields again.
+                unsigned pos   = sweep_line_insert(e);
+                unsigned first = pos;
+                unsigned last  = pos + 1;
+                while(first > 0 &&
+                      equal_points(m_sweep_line[first - 1]->p, e->p)) --first;
+                while(last < m_sweep_line.size() &&
+                      equal_points(m_sweep_line[last]->p, e->p)) ++last;
+
+                for(i = first + 1; i < last; i++)
+                {
+                    possible_intersection(m_sweep_line[i - 1], m_sweep_line[i]);
+                }
+                for(i = last - 1; i > first + 1; i--)
+                {
+                    possible_intersection(m_sweep_line[i - 2], m_sweep_line[i - 1]);
+                }
+                if(last == pos + 1 && last < m_sweep_line.size())
+                {
+                    possible_intersection(e, m_sweep_line[last]);
+                }
+                if(first == pos && first > 0)
+                {
+                    possible_intersection(m_sweep_line[first - 1], e);
+                }
+                for(i = first; i < last; i++)
+                {
+                    compute_fields(m_sweep_line[i], i ? m_sweep_line[i - 1] : 0);
+                }
+            }
+            else
+            {
+                int pos = sweep_line_find(e->other);
+                if(pos >= 0)
+                {
+                    sweep_line_erase(unsigned(pos));
+                    if(pos > 0 && unsigned(pos) < m_sweep_line.size())
+                    {
+                        possible_intersection(m_sweep_line[pos - 1],
+                                              m_sweep_line[pos]);
+                    }
+                }
+            }
+        }
+        connect_edges();
+    }
+
+    //------------------------------------------------------------------------
+    // The edge that continues the contour from the end t of the edge that
+    // starts at cur. The result is on the left of the edges, so it's the
+    // sharpest turn to the left, which keeps the contours that touch at
+    // a vertex apart. Returns start when the contour is closed.
+    unsigned polygon_bool::next_edge(unsigned cur, unsigned t, unsigned start,
+                                     const pod_array<int8u>& flags) const
+    {
+        const point_d& p = m_sorted[t]->p;
+        double dx = p.x - m_sorted[cur]->p.x;
+        double dy = p.y - m_sorted[cur]->p.y;
+
+        unsigned first = t;
+        while(first > 0 && equal_points(m_sorted[first - 1]->p, p)) --first;
+
+        unsigned best = start;
+        double best_angle = 0.0;
+        unsigned j;
+        for(j = first; j < m_sorted.size() && equal_points(m_sorted[j]->p, p); j++)
+        {
+            if((flags[j] & edge_out) == 0) continue;
+            if((flags[j] & edge_processed) && j != start) continue;
+            const point_d& p2 = m_sorted[m_sorted[j]->pos]->p;
+            double ox = p2.x - p.x;
+            double oy = p2.y - p.y;
+            double angle = atan2(dx * oy - dy * ox, dx * ox + dy * oy);
+            if(best == start || angle > best_angle)
+            {
+                best = j;
+                best_angle = angle;
+            }
+        }
+        return best;
+    }
+
+    //------------------------------------------------------------------------
+    void polygon_bool::connect_edges()
+    {
+        // Only the edges of the result are kept, sorted again, because
+        // the division of the overlapping edges can break the order.
+        unsigned i, j;
+        unsigned n = 0;
+        for(i = 0; i < m_sorted.size(); i++)
+        {
+            sweep_event* e = m_sorted[i];
+            if(e->left ? e->in_result : e->other->in_result) m_sorted[n++] = e;
+        }
+        while(m_sorted.size() > n) m_sorted.remove_last();
+
+        for(i = 1; i < n; i++)
+        {
+            sweep_event* e = m_sorted[i];
+            for(j = i; j > 0 && event_after(m_sorted[j - 1], e); --j)
+            {
+                m_sorted[j] = m_sorted[j - 1];
+            }
+            m_sorted[j] = e;
+        }
+
+        // pos of every event is the index of its other end
+        for(i = 0; i < n; i++) m_sorted[i]->pos = int(i);
+        for(i = 0; i < n; i++)
+        {
+            sweep_event* e = m_sorted[i];
+            if(!e->left)
+            {
+                int t = e->pos;
+                e->pos = e->other->pos;
+                e->other->pos = t;
+            }
+        }
+
+        // The edges go so that the result is on the left. For an edge
+        // from the left end to the right one that's above.
+        pod_array<int8u> flags(n);
+        for(i = 0; i < n; i++)
+        {
+            const sweep_event* e = m_sorted[i];
+            bool backward = in_result(e->left ? e->below : e->other->below);
+            flags[i] = (e->left != backward) ? edge_out : 0;
+        }
+
+        for(i = 0; i < n; i++)
+        {
+            if(flags[i] != edge_out) continue;
+
+            contour_type c;
+            c.start = m_out_vertices.size();
+            unsigned cur = i;
+            unsigned guard = n;
+            do
+            {
+                unsigned t = unsigned(m_sorted[cur]->pos);
+                flags[cur] |= edge_processed;
+                flags[t]   |= edge_processed;
+                m_out_vertices.add(m_sorted[cur]->p);
+                cur = next_edge(cur, t, i, flags);
+            }
+            while(cur != i && --guard);
+
+            c.num = m_out_vertices.size() - c.start;
+            if(c.num < 3)
+            {
+                while(m_out_vertices.size() > c.start) m_out_vertices.remove_last();
+                continue;
+            }
+
+            double area = 0.0;
+            for(j = 0; j < c.num; j++)
+            {
+                const point_d& p1 = m_out_vertices[c.start + j];
+                const point_d& p2 = m_out_vertices[c.start + (j + 1) % c.num];
+                area += p1.x * p2.y - p1.y * p2.x;
+            }
+            c.flags = (area < 0.0) ? path_flags_cw : path_flags_ccw;
+            m_contours.add(c);
+        }
+    }
+
+    //------------------------------------------------------------------------
+    void polygon_bool::rewind(unsigned)
+    {
+        m_contour = 0;
+        m_vertex = 0;
+    }
+
+    //------------------------------------------------------------------------
+    unsigned polygon_bool::vertex(double* x, double* y)
+    {
+        while(m_contour < m_contours.size())
+        {
+            const contour_type& c = m_contours[m_contour];
+            if(m_vertex < c.num)
+            {
+                const point_d& p = m_out_vertices[c.start + m_vertex];
+                *x = p.x;
+                *y = p.y;
+                return (m_vertex++ == 0) ? path_cmd_move_to : path_cmd_line_to;
+            }
+            ++m_contour;
+            m_vertex = 0;
+            return path_cmd_end_poly | path_flags_close | c.flags;
+        }
+        return path_cmd_stop;
+    }
+
+}
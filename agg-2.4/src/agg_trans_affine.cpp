@@ -17,6 +17,7 @@
 //
 //----------------------------------------------------------------------------
 #include "agg_trans_affine.h"
+#include "agg_simd.h"
 
 
 
@@ -189,6 +190,81 @@ namespace agg
         *y = y2 - y1;
     }
 
+#if defined(AGG_SIMD_SSE2)
+    //------------------------------------------------------------------------
+    // One point per register, x' and y' are calculated together: 
+    // (x,x)*(sx,shy) + (y,y)*(shx,sy) + (tx,ty)
+    static void transform_points_sse2(const trans_affine& m, 
+                                      double* xy, unsigned num)
+    {
+        __m128d a = _mm_set_pd(m.shy, m.sx);
+        __m128d b = _mm_set_pd(m.sy,  m.shx);
+        __m128d t = _mm_set_pd(m.ty,  m.tx);
+        for(; num; --num)
+        {
+            __m128d p = _mm_loadu_pd(xy);
+            __m128d x = _mm_unpacklo_pd(p, p);
+            __m128d y = _mm_unpackhi_pd(p, p);
+            _mm_storeu_pd(xy, _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, a), 
+                                                    _mm_mul_pd(y, b)), t));
+            xy += 2;
+        }
+    }
+#endif
+
+#if defined(AGG_SIMD_AVX2)
+    //------------------------------------------------------------------------
+    // The same with two points per register. Returns the number of points
+    // processed, the last odd one is left.
+    AGG_SIMD_TARGET_AVX2
+    static unsigned transform_points_avx2(const trans_affine& m, 
+                                          double* xy, unsigned num)
+    {
+        __m256d a = _mm256_set_pd(m.shy, m.sx,  m.shy, m.sx);
+        __m256d b = _mm256_set_pd(m.sy,  m.shx, m.sy,  m.shx);
+        __m256d t = _mm256_set_pd(m.ty,  m.tx,  m.ty,  m.tx);
+        unsigned i;
+        for(i = 1; i < num; i += 2)
+        {
+            __m256d p = _mm256_loadu_pd(xy);
+            __m256d x = _mm256_unpacklo_pd(p, p);
+            __m256d y = _mm256_unpackhi_pd(p, p);
+            _mm256_storeu_pd(xy, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, a), 
+                                                             _mm256_mul_pd(y, b)), t));
+            xy += 4;
+        }
+        return num & ~1u;
+    }
+#endif
+
+    //------------------------------------------------------------------------
+    void trans_affine::transform_points(double* xy, unsigned num) const
+    {
+        switch(simd_level())
+        {
+#if defined(AGG_SIMD_AVX2)
+        case simd_avx2:
+            {
+                unsigned n = transform_points_avx2(*this, xy, num);
+                xy  += n * 2;
+                num -= n;
+            }
+            break;
+#endif
+#if defined(AGG_SIMD_SSE2)
+        case simd_sse2:
+            transform_points_sse2(*this, xy, num);
+            return;
+#endif
+        default: break;
+        }
+
+        for(; num; --num)
+        {
+            transform(xy, xy + 1);
+            xy += 2;
+        }
+    }
 
 }
 
@@ -0,0 +1,653 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// class platform_support. Headless version.
+//
+// There's no window and no events, the "window" is a buffer in memory.
+// run() calls on_draw() a fixed number of times, measures every frame
+// and writes the timing to stdout as CSV:
+//
+//   frame,ms
+//   0,12.345
+//   ...
+//
+// The summary (number of frames, total, average, min and max time) goes
+// to stderr together with the messages of the application. When
+// wait_mode() is false on_idle() is called between the frames, so that
+// the animated examples advance. The images are .ppm files, the same as
+// in the X11 version.
+//
+// The following command line options are recognized and removed before
+// the arguments are passed to agg_main():
+//
+//   -frames N     Number of frames to draw, 1 by default
+//   -size WxH     Overrides the size of the window requested in init()
+//   -save FILE    Saves the last frame as FILE.ppm
+//
+//----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include "agg_basics.h"
+#include "agg_pixfmt_gray.h"
+#include "agg_pixfmt_rgb.h"
+#include "agg_pixfmt_rgba.h"
+#include "util/agg_color_conv_rgb8.h"
+#include "platform/agg_platform_support.h"
+
+
+namespace agg
+{
+    //------------------------------------------------------------------------
+    // The command line options, parsed in main() before the application
+    // object is created.
+    struct headless_options
+    {
+        unsigned    frames;
+        unsigned    width;
+        unsigned    height;
+        const char* save_file;
+    };
+
+    static headless_options g_headless = { 1, 0, 0, 0 };
+
+
+    //------------------------------------------------------------------------
+    // Milliseconds from an arbitrary point. Unlike std::clock() it's
+    // the wall time, so that the multithreaded rendering is measured
+    // correctly.
+    static double headless_time_ms()
+    {
+#if defined(_WIN32)
+        LARGE_INTEGER freq, t;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&t);
+        return double(t.QuadPart) * 1000.0 / double(freq.QuadPart);
+#else
+        timeval tv;
+        gettimeofday(&tv, 0);
+        return double(tv.tv_sec) * 1000.0 + double(tv.tv_usec) / 1000.0;
+#endif
+    }
+
+
+    //------------------------------------------------------------------------
+    class platform_specific
+    {
+    public:
+        platform_specific(pix_format_e format, bool flip_y);
+        ~platform_specific();
+
+        bool from_rgb24(rendering_buffer* dst, const rendering_buffer* src) const;
+        bool to_rgb24(unsigned char* dst, const unsigned char* src, unsigned width) const;
+        bool save_ppm(const rendering_buffer& rbuf, const char* file) const;
+
+        pix_format_e   m_format;
+        bool           m_flip_y;
+        unsigned       m_bpp;
+        unsigned char* m_buf_window;
+        unsigned char* m_buf_img[platform_support::max_images];
+        bool           m_update_flag;
+        bool           m_initialized;
+        double         m_sw_start;
+    };
+
+
+    //------------------------------------------------------------------------
+    platform_specific::platform_specific(pix_format_e format, bool flip_y) :
+        m_format(format),
+        m_flip_y(flip_y),
+        m_bpp(0),
+        m_buf_window(0),
+        m_update_flag(true),
+        m_initialized(false),
+        m_sw_start(headless_time_ms())
+    {
+        std::memset(m_buf_img, 0, sizeof(m_buf_img));
+
+        switch(m_format)
+        {
+        default: break;
+        case pix_format_gray8:
+        case pix_format_sgray8:
+            m_bpp = 8;
+            break;
+
+        case pix_format_gray16:
+            m_bpp = 16;
+            break;
+
+        case pix_format_gray32:
+            m_bpp = 32;
+            break;
+
+        case pix_format_rgb565:
+        case pix_format_rgb555:
+            m_bpp = 16;
+            break;
+
+        case pix_format_rgb24:
+        case pix_format_bgr24:
+        case pix_format_srgb24:
+        case pix_format_sbgr24:
+            m_bpp = 24;
+            break;
+
+        case pix_format_bgra32:
+        case pix_format_abgr32:
+        case pix_format_argb32:
+        case pix_format_rgba32:
+        case pix_format_sbgra32:
+        case pix_format_sabgr32:
+        case pix_format_sargb32:
+        case pix_format_srgba32:
+            m_bpp = 32;
+            break;
+
+        case pix_format_rgb48:
+        case pix_format_bgr48:
+            m_bpp = 48;
+            break;
+
+        case pix_format_bgra64:
+        case pix_format_abgr64:
+        case pix_format_argb64:
+        case pix_format_rgba64:
+            m_bpp = 64;
+            break;
+
+        case pix_format_rgb96:
+        case pix_format_bgr96:
+            m_bpp = 96;
+            break;
+
+        case pix_format_bgra128:
+        case pix_format_abgr128:
+        case pix_format_argb128:
+        case pix_format_rgba128:
+            m_bpp = 128;
+            break;
+        }
+    }
+
+    //------------------------------------------------------------------------
+    platform_specific::~platform_specific()
+    {
+        unsigned i = platform_support::max_images;
+        while(i--)
+        {
+            delete [] m_buf_img[i];
+        }
+        delete [] m_buf_window;
+    }
+
+
+    //------------------------------------------------------------------------
+    // Converts an sRGB 24 bit image (a .ppm file) into the format
+    // of the application.
+    bool platform_specific::from_rgb24(rendering_buffer* dst,
+                                       const rendering_buffer* src) const
+    {
+        switch(m_format)
+        {
+        case pix_format_sgray8:  convert<pixfmt_sgray8,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_gray8:   convert<pixfmt_gray8,   pixfmt_srgb24>(dst, src); break;
+        case pix_format_gray16:  convert<pixfmt_gray16,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_gray32:  convert<pixfmt_gray32,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_rgb555:  color_conv(dst, src, color_conv_rgb24_to_rgb555()); break;
+        case pix_format_rgb565:  color_conv(dst, src, color_conv_rgb24_to_rgb565()); break;
+        case pix_format_srgb24:  convert<pixfmt_srgb24,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_sbgr24:  convert<pixfmt_sbgr24,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_rgb24:   convert<pixfmt_rgb24,   pixfmt_srgb24>(dst, src); break;
+        case pix_format_bgr24:   convert<pixfmt_bgr24,   pixfmt_srgb24>(dst, src); break;
+        case pix_format_srgba32: convert<pixfmt_srgba32, pixfmt_srgb24>(dst, src); break;
+        case pix_format_sargb32: convert<pixfmt_sargb32, pixfmt_srgb24>(dst, src); break;
+        case pix_format_sbgra32: convert<pixfmt_sbgra32, pixfmt_srgb24>(dst, src); break;
+        case pix_format_sabgr32: convert<pixfmt_sabgr32, pixfmt_srgb24>(dst, src); break;
+        case pix_format_rgba32:  convert<pixfmt_rgba32,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_argb32:  convert<pixfmt_argb32,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_bgra32:  convert<pixfmt_bgra32,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_abgr32:  convert<pixfmt_abgr32,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_rgb48:   convert<pixfmt_rgb48,   pixfmt_srgb24>(dst, src); break;
+        case pix_format_bgr48:   convert<pixfmt_bgr48,   pixfmt_srgb24>(dst, src); break;
+        case pix_format_rgba64:  convert<pixfmt_rgba64,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_argb64:  convert<pixfmt_argb64,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_bgra64:  convert<pixfmt_bgra64,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_abgr64:  convert<pixfmt_abgr64,  pixfmt_srgb24>(dst, src); break;
+        case pix_format_rgb96:   convert<pixfmt_rgb96,   pixfmt_srgb24>(dst, src); break;
+        case pix_format_bgr96:   convert<pixfmt_bgr96,   pixfmt_srgb24>(dst, src); break;
+        case pix_format_rgba128: convert<pixfmt_rgba128, pixfmt_srgb24>(dst, src); break;
+        case pix_format_argb128: convert<pixfmt_argb128, pixfmt_srgb24>(dst, src); break;
+        case pix_format_bgra128: convert<pixfmt_bgra128, pixfmt_srgb24>(dst, src); break;
+        case pix_format_abgr128: convert<pixfmt_abgr128, pixfmt_srgb24>(dst, src); break;
+        default: return false;
+        }
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    // Converts a row in the format of the application into sRGB 24 bit.
+    bool platform_specific::to_rgb24(unsigned char* dst,
+                                     const unsigned char* src,
+                                     unsigned w) const
+    {
+        switch(m_format)
+        {
+        case pix_format_sgray8:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_sgray8>());  break;
+        case pix_format_gray8:   color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_gray8>());   break;
+        case pix_format_gray16:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_gray16>());  break;
+        case pix_format_gray32:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_gray32>());  break;
+        case pix_format_rgb555:  color_conv_row(dst, src, w, color_conv_rgb555_to_rgb24());              break;
+        case pix_format_rgb565:  color_conv_row(dst, src, w, color_conv_rgb565_to_rgb24());              break;
+        case pix_format_srgb24:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_srgb24>());  break;
+        case pix_format_sbgr24:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_sbgr24>());  break;
+        case pix_format_rgb24:   color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_rgb24>());   break;
+        case pix_format_bgr24:   color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_bgr24>());   break;
+        case pix_format_srgba32: color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_srgba32>()); break;
+        case pix_format_sargb32: color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_sargb32>()); break;
+        case pix_format_sbgra32: color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_sbgra32>()); break;
+        case pix_format_sabgr32: color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_sabgr32>()); break;
+        case pix_format_rgba32:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_rgba32>());  break;
+        case pix_format_argb32:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_argb32>());  break;
+        case pix_format_bgra32:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_bgra32>());  break;
+        case pix_format_abgr32:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_abgr32>());  break;
+        case pix_format_rgb48:   color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_rgb48>());   break;
+        case pix_format_bgr48:   color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_bgr48>());   break;
+        case pix_format_rgba64:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_rgba64>());  break;
+        case pix_format_argb64:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_argb64>());  break;
+        case pix_format_bgra64:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_bgra64>());  break;
+        case pix_format_abgr64:  color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_abgr64>());  break;
+        case pix_format_rgb96:   color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_rgb96>());   break;
+        case pix_format_bgr96:   color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_bgr96>());   break;
+        case pix_format_rgba128: color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_rgba128>()); break;
+        case pix_format_argb128: color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_argb128>()); break;
+        case pix_format_bgra128: color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_bgra128>()); break;
+        case pix_format_abgr128: color_conv_row(dst, src, w, conv_row<pixfmt_srgb24, pixfmt_abgr128>()); break;
+        default: return false;
+        }
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    bool platform_specific::save_ppm(const rendering_buffer& rbuf,
+                                     const char* file) const
+    {
+        char buf[1024];
+        std::strncpy(buf, file, 1019);
+        buf[1019] = 0;
+        int len = std::strlen(buf);
+        if(len < 4 || std::strcmp(buf + len - 4, ".ppm") != 0)
+        {
+            std::strcat(buf, ".ppm");
+        }
+
+        FILE* fd = std::fopen(buf, "wb");
+        if(fd == 0) return false;
+
+        unsigned w = rbuf.width();
+        unsigned h = rbuf.height();
+        std::fprintf(fd, "P6\n%d %d\n255\n", w, h);
+
+        bool ret = true;
+        unsigned y;
+        unsigned char* tmp_buf = new unsigned char [w * 3];
+        for(y = 0; y < h && ret; y++)
+        {
+            const unsigned char* src = rbuf.row_ptr(m_flip_y ? h - 1 - y : y);
+            ret = to_rgb24(tmp_buf, src, w) &&
+                  std::fwrite(tmp_buf, 1, w * 3, fd) == w * 3;
+        }
+        delete [] tmp_buf;
+        std::fclose(fd);
+        return ret;
+    }
+
+
+
+    //------------------------------------------------------------------------
+    platform_support::platform_support(pix_format_e format, bool flip_y) :
+        m_specific(new platform_specific(format, flip_y)),
+        m_format(format),
+        m_bpp(m_specific->m_bpp),
+        m_window_flags(0),
+        m_wait_mode(true),
+        m_flip_y(flip_y),
+        m_initial_width(10),
+        m_initial_height(10)
+    {
+        std::strcpy(m_caption, "AGG Application");
+    }
+
+    //------------------------------------------------------------------------
+    platform_support::~platform_support()
+    {
+        delete m_specific;
+    }
+
+    //------------------------------------------------------------------------
+    void platform_support::caption(const char* cap)
+    {
+        std::strcpy(m_caption, cap);
+    }
+
+
+    //------------------------------------------------------------------------
+    bool platform_support::init(unsigned width, unsigned height, unsigned flags)
+    {
+        m_window_flags = flags;
+        if(m_bpp == 0)
+        {
+            std::fprintf(stderr, "Unsupported pixel format\n");
+            return false;
+        }
+
+        if(g_headless.width)  width  = g_headless.width;
+        if(g_headless.height) height = g_headless.height;
+
+        delete [] m_specific->m_buf_window;
+        m_specific->m_buf_window =
+            new unsigned char[width * height * (m_bpp / 8)];
+
+        std::memset(m_specific->m_buf_window, 255, width * height * (m_bpp / 8));
+
+        m_rbuf_window.attach(m_specific->m_buf_window,
+                             width,
+                             height,
+                             m_flip_y ? -width * (m_bpp / 8) : width * (m_bpp / 8));
+
+        m_initial_width = width;
+        m_initial_height = height;
+
+        if(!m_specific->m_initialized)
+        {
+            on_init();
+            m_specific->m_initialized = true;
+        }
+
+        trans_affine_resizing(width, height);
+        on_resize(width, height);
+        m_specific->m_update_flag = true;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    void platform_support::update_window()
+    {
+        // Nothing to do, the window is the buffer itself
+    }
+
+
+    //------------------------------------------------------------------------
+    int platform_support::run()
+    {
+        if(m_specific->m_buf_window == 0) return 1;
+
+        double total = 0.0;
+        double min_time = 0.0;
+        double max_time = 0.0;
+        unsigned i;
+
+        std::printf("frame,ms\n");
+        for(i = 0; i < g_headless.frames; i++)
+        {
+            if(i && !m_wait_mode) on_idle();
+
+            double t1 = headless_time_ms();
+            on_draw();
+            update_window();
+            double t = headless_time_ms() - t1;
+            m_specific->m_update_flag = false;
+
+            std::printf("%u,%.3f\n", i, t);
+            total += t;
+            if(i == 0 || t < min_time) min_time = t;
+            if(i == 0 || t > max_time) max_time = t;
+        }
+        std::fflush(stdout);
+
+        if(g_headless.frames)
+        {
+            std::fprintf(stderr,
+                         "%s: %u frames %ux%u, total=%.3fms "
+                         "avg=%.3fms min=%.3fms max=%.3fms\n",
+                         m_caption,
+                         g_headless.frames,
+                         m_rbuf_window.width(),
+                         m_rbuf_window.height(),
+                         total,
+                         total / g_headless.frames,
+                         min_time,
+                         max_time);
+        }
+
+        if(g_headless.save_file)
+        {
+            if(!m_specific->save_ppm(m_rbuf_window, g_headless.save_file))
+            {
+                std::fprintf(stderr, "Can't save %s\n", g_headless.save_file);
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+
+
+    //------------------------------------------------------------------------
+    const char* platform_support::img_ext() const { return ".ppm"; }
+
+    //------------------------------------------------------------------------
+    const char* platform_support::full_file_name(const char* file_name)
+    {
+        return file_name;
+    }
+
+    //------------------------------------------------------------------------
+    bool platform_support::load_img(unsigned idx, const char* file)
+    {
+        if(idx < max_images)
+        {
+            char buf[1024];
+            std::strncpy(buf, file, 1019);
+            buf[1019] = 0;
+            int len = std::strlen(buf);
+            if(len < 4 || std::strcmp(buf + len - 4, ".ppm") != 0)
+            {
+                std::strcat(buf, ".ppm");
+            }
+
+            FILE* fd = std::fopen(buf, "rb");
+            if(fd == 0) return false;
+
+            if((len = std::fread(buf, 1, 1022, fd)) == 0)
+            {
+                std::fclose(fd);
+                return false;
+            }
+            buf[len] = 0;
+
+            if(buf[0] != 'P' || buf[1] != '6')
+            {
+                std::fclose(fd);
+                return false;
+            }
+
+            char* ptr = buf + 2;
+
+            while(*ptr && !std::isdigit((unsigned char)(*ptr))) ptr++;
+            unsigned width = std::atoi(ptr);
+            while(*ptr &&  std::isdigit((unsigned char)(*ptr))) ptr++;
+            while(*ptr && !std::isdigit((unsigned char)(*ptr))) ptr++;
+            unsigned height = std::atoi(ptr);
+            while(*ptr &&  std::isdigit((unsigned char)(*ptr))) ptr++;
+            while(*ptr && !std::isdigit((unsigned char)(*ptr))) ptr++;
+            unsigned max_val = std::atoi(ptr);
+            while(*ptr &&  std::isdigit((unsigned char)(*ptr))) ptr++;
+
+            if(width  == 0 || width  > 4096 ||
+               height == 0 || height > 4096 ||
+               max_val != 255 || *ptr == 0)
+            {
+                std::fclose(fd);
+                return false;
+            }
+            ptr++;
+            std::fseek(fd, long(ptr - buf), SEEK_SET);
+
+            create_img(idx, width, height);
+
+            unsigned char* buf_img = new unsigned char [width * height * 3];
+            rendering_buffer rbuf_img(buf_img,
+                                      width,
+                                      height,
+                                      m_flip_y ? -width * 3 : width * 3);
+
+            bool ret = std::fread(buf_img, 1, width * height * 3, fd) == width * height * 3 &&
+                       m_specific->from_rgb24(m_rbuf_img + idx, &rbuf_img);
+
+            delete [] buf_img;
+            std::fclose(fd);
+            return ret;
+        }
+        return false;
+    }
+
+
+    //------------------------------------------------------------------------
+    bool platform_support::save_img(unsigned idx, const char* file)
+    {
+        if(idx < max_images && rbuf_img(idx).buf())
+        {
+            return m_specific->save_ppm(rbuf_img(idx), file);
+        }
+        return false;
+    }
+
+
+    //------------------------------------------------------------------------
+    bool platform_support::create_img(unsigned idx, unsigned width, unsigned height)
+    {
+        if(idx < max_images)
+        {
+            if(width  == 0) width  = rbuf_window().width();
+            if(height == 0) height = rbuf_window().height();
+            delete [] m_specific->m_buf_img[idx];
+            m_specific->m_buf_img[idx] =
+                new unsigned char[width * height * (m_bpp / 8)];
+
+            m_rbuf_img[idx].attach(m_specific->m_buf_img[idx],
+                                   width,
+                                   height,
+                                   m_flip_y ?
+                                       -width * (m_bpp / 8) :
+                                        width * (m_bpp / 8));
+            return true;
+        }
+        return false;
+    }
+
+
+    //------------------------------------------------------------------------
+    void platform_support::force_redraw()
+    {
+        m_specific->m_update_flag = true;
+    }
+
+
+    //------------------------------------------------------------------------
+    void platform_support::message(const char* msg)
+    {
+        std::fprintf(stderr, "%s\n", msg);
+    }
+
+    //------------------------------------------------------------------------
+    void platform_support::start_timer()
+    {
+        m_specific->m_sw_start = headless_time_ms();
+    }
+
+    //------------------------------------------------------------------------
+    double platform_support::elapsed_time() const
+    {
+        return headless_time_ms() - m_specific->m_sw_start;
+    }
+
+
+    //------------------------------------------------------------------------
+    void platform_support::on_init() {}
+    void platform_support::on_resize(int, int) {}
+    void platform_support::on_idle() {}
+    void platform_support::on_mouse_move(int, int, unsigned) {}
+    void platform_support::on_mouse_button_down(int, int, unsigned) {}
+    void platform_support::on_mouse_button_up(int, int, unsigned) {}
+    void platform_support::on_key(int, int, unsigned, unsigned) {}
+    void platform_support::on_ctrl_change() {}
+    void platform_support::on_draw() {}
+    void platform_support::on_post_draw(void*) {}
+
+}
+
+
+int agg_main(int argc, char* argv[]);
+
+
+int main(int argc, char* argv[])
+{
+    // Take out the options of the headless platform,
+    // the rest goes to the application.
+    int i;
+    int n = 1;
+    for(i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+        {
+            agg::g_headless.frames = unsigned(std::atoi(argv[++i]));
+        }
+        else
+        if(std::strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+        {
+            unsigned w = 0;
+            unsigned h = 0;
+            if(std::sscanf(argv[++i], "%ux%u", &w, &h) != 2 || w == 0 || h == 0)
+            {
+                std::fprintf(stderr, "Invalid size: %s\n", argv[i]);
+                return 1;
+            }
+            agg::g_headless.width  = w;
+            agg::g_headless.height = h;
+        }
+        else
+        if(std::strcmp(argv[i], "-save") == 0 && i + 1 < argc)
+        {
+            agg::g_headless.save_file = argv[++i];
+        }
+        else
+        {
+            argv[n++] = argv[i];
+        }
+    }
+    argv[n] = 0;
+    return agg_main(n, argv);
+}
@@ -0,0 +1,175 @@
+// The SIMD span blenders of the rgba pixel formats against the plain C++
+// ones. Random translucent ellipses, with solid colors and with gradients,
+// rendered at every SIMD level the processor supports must give exactly
+// the same pixels as with simd_none.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_scanline_p.h"
+#include "agg_renderer_scanline.h"
+#include "agg_span_allocator.h"
+#include "agg_span_gradient.h"
+#include "agg_span_interpolator_linear.h"
+#include "agg_pixfmt_rgba.h"
+#include "agg_ellipse.h"
+#include "agg_simd.h"
+
+enum
+{
+    frame_width  = 403,
+    frame_height = 301,
+    num_ellipses = 300
+};
+
+//----------------------------------------------------------------------------
+// Solid colors go to blend_solid_hspan(), gradients to blend_color_hspan().
+// The odd widths and positions give the spans of every length and
+// alignment, half of the colors are opaque.
+struct ellipse_data
+{
+    double   x, y, rx, ry;
+    unsigned c1[4];
+    unsigned c2[4];
+};
+
+static ellipse_data ellipses[num_ellipses];
+
+static void generate_ellipses()
+{
+    srand(100);
+    unsigned i, j;
+    for(i = 0; i < num_ellipses; i++)
+    {
+        ellipse_data& e = ellipses[i];
+        e.x  = rand() % frame_width  + (rand() % 100) / 100.0;
+        e.y  = rand() % frame_height + (rand() % 100) / 100.0;
+        e.rx = rand() % 100 + 1;
+        e.ry = rand() % 100 + 1;
+        for(j = 0; j < 4; j++)
+        {
+            e.c1[j] = rand() & 0xFF;
+            e.c2[j] = rand() & 0xFF;
+        }
+        if(i & 2)
+        {
+            e.c1[3] = 255;
+            e.c2[3] = 255;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+template<class PixFmt, class Scanline>
+static void render_ellipses(agg::rendering_buffer& rbuf)
+{
+    typedef typename PixFmt::color_type                color_type;
+    typedef agg::renderer_base<PixFmt>                 renderer_base;
+    typedef agg::gradient_linear_color<color_type>     color_func_type;
+    typedef agg::span_interpolator_linear<>            interpolator_type;
+    typedef agg::span_gradient<color_type,
+                               interpolator_type,
+                               agg::gradient_x,
+                               color_func_type>        span_gradient_type;
+
+    PixFmt pixf(rbuf);
+    renderer_base rb(pixf);
+    agg::rasterizer_scanline_aa<> ras;
+    Scanline sl;
+    agg::span_allocator<color_type> alloc;
+    agg::gradient_x gradient_func;
+
+    rb.clear(agg::rgba(1, 1, 1, 0.5));
+    unsigned i;
+    for(i = 0; i < num_ellipses; i++)
+    {
+        const ellipse_data& ed = ellipses[i];
+        color_type c1(ed.c1[0], ed.c1[1], ed.c1[2], ed.c1[3]);
+        color_type c2(ed.c2[0], ed.c2[1], ed.c2[2], ed.c2[3]);
+        agg::ellipse e(ed.x, ed.y, ed.rx, ed.ry, 100);
+        ras.reset();
+        ras.add_path(e);
+        if(i & 1)
+        {
+            agg::trans_affine mtx;
+            mtx *= agg::trans_affine_scaling(ed.rx / 50.0);
+            mtx *= agg::trans_affine_translation(ed.x - ed.rx, ed.y);
+            mtx.invert();
+            interpolator_type inter(mtx);
+            color_func_type colors(c1, c2);
+            span_gradient_type sg(inter, gradient_func, colors, 0, 100);
+            agg::render_scanlines_aa(ras, sl, rb, alloc, sg);
+        }
+        else
+        {
+            agg::render_scanlines_aa_solid(ras, sl, rb, c1);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Returns the number of SIMD levels that differ from simd_none
+template<class PixFmt, class Scanline>
+static unsigned check(const char* name)
+{
+    static const char* level_names[] = { "none", "sse2", "avx2" };
+
+    unsigned stride = frame_width * PixFmt::pix_width;
+    agg::pod_array<agg::int8u> buf_ref(stride * frame_height);
+    agg::pod_array<agg::int8u> buf_res(stride * frame_height);
+    agg::rendering_buffer rbuf_ref(&buf_ref[0], frame_width, frame_height, stride);
+    agg::rendering_buffer rbuf_res(&buf_res[0], frame_width, frame_height, stride);
+
+    agg::simd_level(agg::simd_none);
+    render_ellipses<PixFmt, Scanline>(rbuf_ref);
+
+    unsigned errors = 0;
+    unsigned level;
+    for(level = agg::simd_sse2; level <= unsigned(agg::simd_detect()); level++)
+    {
+        agg::simd_level(agg::simd_level_e(level));
+        render_ellipses<PixFmt, Scanline>(rbuf_res);
+        if(memcmp(&buf_ref[0], &buf_res[0], stride * frame_height) != 0)
+        {
+            printf("%s, %s: the pixels differ\n", name, level_names[level]);
+            ++errors;
+        }
+    }
+    agg::simd_level(agg::simd_detect());
+    return errors;
+}
+
+
+//----------------------------------------------------------------------------
+int main()
+{
+    generate_ellipses();
+
+    unsigned errors = 0;
+    errors += check<agg::pixfmt_rgba32,          agg::scanline_u8>("rgba32");
+    errors += check<agg::pixfmt_bgra32,          agg::scanline_u8>("bgra32");
+    errors += check<agg::pixfmt_argb32,          agg::scanline_u8>("argb32");
+    errors += check<agg::pixfmt_abgr32,          agg::scanline_p8>("abgr32");
+    errors += check<agg::pixfmt_rgba32_pre,      agg::scanline_u8>("rgba32_pre");
+    errors += check<agg::pixfmt_bgra32_pre,      agg::scanline_p8>("bgra32_pre");
+    errors += check<agg::pixfmt_srgba32,         agg::scanline_u8>("srgba32");
+    errors += check<agg::pixfmt_srgba32_linear,  agg::scanline_u8>("srgba32_linear");
+    errors += check<agg::pixfmt_sbgra32_linear,  agg::scanline_p8>("sbgra32_linear");
+
+    if(agg::simd_detect() == agg::simd_none)
+    {
+        printf("no SIMD, nothing to compare\n");
+    }
+
+    if(errors)
+    {
+        printf("%u errors\n", errors);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
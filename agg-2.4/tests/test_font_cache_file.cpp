@@ -0,0 +1,194 @@
+// font_cache_file: the glyphs saved from a font_cache_manager and loaded
+// into another one must be the same, with the private and with the shared
+// cache, including the codes above 0xFFFF. The damaged files and the
+// files with another key must be rejected.
+
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_path_storage_integer.h"
+#include "agg_scanline_storage_aa.h"
+#include "agg_scanline_storage_bin.h"
+#include "agg_font_cache_manager.h"
+#include "agg_font_cache_file.h"
+
+//----------------------------------------------------------------------------
+// The glyph data are made up from the glyph code, the manager only
+// copies them.
+class test_font_engine
+{
+public:
+    typedef agg::serialized_integer_path_adaptor<agg::int32, 6> path_adaptor_type;
+    typedef agg::serialized_scanlines_adaptor_aa<agg::int8u>    gray8_adaptor_type;
+    typedef agg::serialized_scanlines_adaptor_bin               mono_adaptor_type;
+
+    test_font_engine() : m_code(0) {}
+
+    const char* font_signature() const { return "test_font_engine,12"; }
+    int         change_stamp()   const { return 0; }
+
+    bool prepare_glyph(unsigned glyph_code)
+    {
+        m_code = glyph_code;
+        return true;
+    }
+
+    unsigned             glyph_index() const { return m_code * 3 + 1; }
+    unsigned             data_size()   const { return 1 + m_code % 37; }
+    agg::glyph_data_type data_type()   const { return agg::glyph_data_gray8; }
+    agg::rect_i          bounds()      const
+    {
+        return agg::rect_i(-int(m_code % 5), -int(m_code % 7), m_code % 11, m_code % 13);
+    }
+    double advance_x() const { return (m_code % 17) * 0.5; }
+    double advance_y() const { return 0.0; }
+
+    void write_glyph_to(agg::int8u* data) const
+    {
+        unsigned i;
+        for(i = 0; i < data_size(); i++) data[i] = agg::int8u(m_code * 31 + i);
+    }
+
+    bool add_kerning(unsigned, unsigned, double*, double*) { return false; }
+
+private:
+    unsigned m_code;
+};
+
+typedef agg::font_cache_manager<test_font_engine> font_manager_type;
+
+static const char* file_name = "test_font_cache_file.agc";
+static const char* key       = "test_font_engine,12,gray8";
+
+static const unsigned codes[] =
+{
+    'A', 'B', 'Z', 0x00E9, 0x4E2D, 0xFFFF, 0x1F600, 0x20000, 0x2A6D6
+};
+enum { num_codes = sizeof(codes) / sizeof(codes[0]) };
+
+//----------------------------------------------------------------------------
+static bool same_glyph(const agg::glyph_cache* gl, unsigned code)
+{
+    test_font_engine feng;
+    feng.prepare_glyph(code);
+    agg::int8u data[64];
+    feng.write_glyph_to(data);
+    return gl->glyph_index == feng.glyph_index() &&
+           gl->data_size   == feng.data_size() &&
+           gl->data_type   == feng.data_type() &&
+           gl->bounds.x1   == feng.bounds().x1 &&
+           gl->bounds.y1   == feng.bounds().y1 &&
+           gl->bounds.x2   == feng.bounds().x2 &&
+           gl->bounds.y2   == feng.bounds().y2 &&
+           gl->advance_x   == feng.advance_x() &&
+           gl->advance_y   == feng.advance_y() &&
+           memcmp(gl->data, data, gl->data_size) == 0;
+}
+
+//----------------------------------------------------------------------------
+// Saves the glyphs cached in src, loads them to dst and compares
+static unsigned round_trip(const char* name, font_manager_type& src, font_manager_type& dst)
+{
+    unsigned errors = 0;
+    unsigned i;
+    for(i = 0; i < num_codes; i++) src.glyph(codes[i]);
+
+    if(!agg::font_cache_file::save(src, file_name, key))
+    {
+        printf("%s: not saved\n", name);
+        return 1;
+    }
+
+    agg::font_cache_file file;
+    if(!file.open(file_name, key))
+    {
+        printf("%s: not opened\n", name);
+        return 1;
+    }
+    if(file.num_glyphs() != unsigned(num_codes))
+    {
+        printf("%s: %u glyphs saved of %u\n", name, file.num_glyphs(), unsigned(num_codes));
+        ++errors;
+    }
+
+    unsigned n = file.load_to(dst);
+    if(n != file.num_glyphs())
+    {
+        printf("%s: %u glyphs loaded of %u\n", name, n, file.num_glyphs());
+        ++errors;
+    }
+    for(i = 0; i < num_codes; i++)
+    {
+        const agg::glyph_cache* gl = dst.cached_glyph(codes[i]);
+        if(gl == 0 || !same_glyph(gl, codes[i]))
+        {
+            printf("%s: glyph 0x%X %s\n", name, codes[i], gl ? "differs" : "is missing");
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+//----------------------------------------------------------------------------
+// The file with another key and the damaged one must not open
+static unsigned check_rejected()
+{
+    unsigned errors = 0;
+    agg::font_cache_file file;
+    if(file.open(file_name, "another key"))
+    {
+        printf("opened with another key\n");
+        ++errors;
+    }
+
+    FILE* fd = fopen(file_name, "r+b");
+    if(fd == 0)
+    {
+        printf("can't modify the file\n");
+        return errors + 1;
+    }
+    fseek(fd, -1, SEEK_END);
+    int c = fgetc(fd);
+    fseek(fd, -1, SEEK_END);
+    fputc(c ^ 0x55, fd);
+    fclose(fd);
+    if(file.open(file_name, key))
+    {
+        printf("opened the damaged file\n");
+        ++errors;
+    }
+    return errors;
+}
+
+
+//----------------------------------------------------------------------------
+int main()
+{
+    unsigned errors = 0;
+    {
+        test_font_engine feng1;
+        test_font_engine feng2;
+        font_manager_type src(feng1);
+        font_manager_type dst(feng2);
+        errors += round_trip("private cache", src, dst);
+    }
+    {
+        agg::font_cache_shared shared1;
+        agg::font_cache_shared shared2;
+        test_font_engine feng1;
+        test_font_engine feng2;
+        font_manager_type src(feng1, shared1);
+        font_manager_type dst(feng2, shared2);
+        errors += round_trip("shared cache", src, dst);
+    }
+    errors += check_rejected();
+    remove(file_name);
+
+    if(errors)
+    {
+        printf("%u errors\n", errors);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
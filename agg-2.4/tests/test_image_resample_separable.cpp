@@ -0,0 +1,173 @@
+// image_resample_separable against span_image_resample_rgba_affine.
+// The results must differ by the rounding only, including the flips
+// and the downscales where the kernels of the rows overlap.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_span_allocator.h"
+#include "agg_span_interpolator_linear.h"
+#include "agg_span_image_filter_rgba.h"
+#include "agg_image_accessors.h"
+#include "agg_pixfmt_rgba.h"
+#include "agg_image_resample_separable.h"
+
+typedef agg::pixfmt_rgba32_pre pixfmt;
+typedef agg::renderer_base<pixfmt> renderer_base;
+
+enum { max_diff = 2 };
+
+//----------------------------------------------------------------------------
+class image
+{
+public:
+    image(unsigned w, unsigned h) :
+        m_buf(w * h * 4),
+        m_rbuf(&m_buf[0], w, h, w * 4)
+    {
+        memset(&m_buf[0], 0, w * h * 4);
+    }
+
+    agg::rendering_buffer& rbuf() { return m_rbuf; }
+
+    // Random premultiplied colors
+    void randomize()
+    {
+        unsigned i;
+        for(i = 0; i < m_buf.size(); i += 4)
+        {
+            unsigned a = rand() & 0xFF;
+            m_buf[i + 0] = agg::int8u((rand() & 0xFF) * a / 255);
+            m_buf[i + 1] = agg::int8u((rand() & 0xFF) * a / 255);
+            m_buf[i + 2] = agg::int8u((rand() & 0xFF) * a / 255);
+            m_buf[i + 3] = agg::int8u(a);
+        }
+    }
+
+    unsigned max_diff(const image& img) const
+    {
+        unsigned d = 0;
+        unsigned i;
+        for(i = 0; i < m_buf.size(); i++)
+        {
+            unsigned v = abs(int(m_buf[i]) - int(img.m_buf[i]));
+            if(v > d) d = v;
+        }
+        return d;
+    }
+
+private:
+    agg::pod_array<agg::int8u> m_buf;
+    agg::rendering_buffer      m_rbuf;
+};
+
+//----------------------------------------------------------------------------
+static void render_span(image& dst, image& src,
+                        agg::image_filter_lut& filter,
+                        const agg::trans_affine& img_mtx)
+{
+    typedef agg::image_accessor_clone<pixfmt> img_accessor_type;
+    typedef agg::span_interpolator_linear<> interpolator_type;
+    typedef agg::span_image_resample_rgba_affine<img_accessor_type> span_gen_type;
+
+    agg::trans_affine mtx = img_mtx;
+    mtx.invert();
+
+    pixfmt img_pixf(src.rbuf());
+    img_accessor_type ia(img_pixf);
+    interpolator_type interpolator(mtx);
+    span_gen_type sg(ia, interpolator, filter);
+    agg::span_allocator<agg::rgba8> sa;
+
+    pixfmt pixf(dst.rbuf());
+    renderer_base rb(pixf);
+    agg::rasterizer_scanline_aa<> ras;
+    agg::scanline_u8 sl;
+    ras.move_to_d(0, 0);
+    ras.line_to_d(dst.rbuf().width(), 0);
+    ras.line_to_d(dst.rbuf().width(), dst.rbuf().height());
+    ras.line_to_d(0, dst.rbuf().height());
+    agg::render_scanlines_aa(ras, sl, rb, sa, sg);
+}
+
+//----------------------------------------------------------------------------
+template<class Filter>
+static unsigned check(const char* name, const Filter& f,
+                      unsigned src_w, unsigned src_h,
+                      unsigned dst_w, unsigned dst_h,
+                      const agg::trans_affine& mtx)
+{
+    agg::image_filter_lut filter(f, true);
+    image src(src_w, src_h);
+    image ref(dst_w, dst_h);
+    src.randomize();
+    render_span(ref, src, filter, mtx);
+
+    unsigned errors = 0;
+    unsigned num_threads;
+    for(num_threads = 1; num_threads <= 4; num_threads *= 2)
+    {
+        image dst(dst_w, dst_h);
+        pixfmt src_pixf(src.rbuf());
+        pixfmt dst_pixf(dst.rbuf());
+        agg::image_resample_separable resampler(filter, num_threads);
+        if(!resampler.resample(dst_pixf, src_pixf, mtx))
+        {
+            printf("%s, %u threads: not resampled\n", name, num_threads);
+            ++errors;
+            continue;
+        }
+        unsigned d = dst.max_diff(ref);
+        if(d > unsigned(max_diff))
+        {
+            printf("%s, %u threads: differs by %u\n", name, num_threads, d);
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+
+//----------------------------------------------------------------------------
+int main()
+{
+    srand(1);
+    unsigned errors = 0;
+
+    agg::image_filter_bilinear bilinear;
+    agg::image_filter_bicubic  bicubic;
+    agg::image_filter_lanczos  lanczos(4.0);
+
+    // The flipped downscale where the windows of the rows overlap, so
+    // that neither the first nor the last row holds the whole range
+    // of the source rows
+    errors += check("flipped downscale", bilinear, 8, 10, 8, 2,
+                    agg::trans_affine_scaling(1, -0.2) *
+                    agg::trans_affine_translation(0, 2));
+
+    errors += check("flipped downscale, bicubic", bicubic, 40, 50, 30, 7,
+                    agg::trans_affine_scaling(-0.7, -0.13) *
+                    agg::trans_affine_translation(30, 7));
+
+    errors += check("downscale", lanczos, 100, 80, 33, 17,
+                    agg::trans_affine_scaling(0.33, 0.21));
+
+    errors += check("upscale", bicubic, 20, 15, 75, 60,
+                    agg::trans_affine_scaling(3.7, 4.0));
+
+    errors += check("flipped upscale", bilinear, 20, 15, 50, 45,
+                    agg::trans_affine_scaling(2.5, -3.0) *
+                    agg::trans_affine_translation(0, 45));
+
+    if(errors)
+    {
+        printf("%u errors\n", errors);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,329 @@
+// polygon_bool against the scanline boolean algebra on random polygons.
+// The pixels that no edge of A or B comes near are fully in or out of
+// both, there the result of sbool is exact and the rendered result of
+// polygon_bool must be the same.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_scanline_boolean_algebra.h"
+#include "agg_pixfmt_gray.h"
+#include "agg_path_storage.h"
+#include "agg_polygon_bool.h"
+
+typedef agg::pixfmt_gray8 pixfmt;
+typedef agg::renderer_base<pixfmt> renderer_base;
+typedef agg::renderer_scanline_aa_solid<renderer_base> renderer_solid;
+
+enum
+{
+    frame_size = 512,
+    max_diff   = 2
+};
+
+//----------------------------------------------------------------------------
+class image
+{
+public:
+    image() :
+        m_buf(frame_size * frame_size),
+        m_rbuf(&m_buf[0], frame_size, frame_size, frame_size),
+        m_pixf(m_rbuf),
+        m_rb(m_pixf),
+        m_ren(m_rb)
+    {
+        m_ren.color(agg::gray8(255));
+    }
+
+    void clear() { memset(&m_buf[0], 0, m_buf.size()); }
+
+    renderer_solid& ren() { return m_ren; }
+    agg::int8u operator [] (unsigned i) const { return m_buf[i]; }
+
+private:
+    agg::pod_array<agg::int8u> m_buf;
+    agg::rendering_buffer      m_rbuf;
+    pixfmt                     m_pixf;
+    renderer_base              m_rb;
+    renderer_solid             m_ren;
+};
+
+//----------------------------------------------------------------------------
+// The pixels near the edges, where the coverage of the shapes isn't
+// exact, also with the even-odd rule where the edges cross.
+class edge_mask
+{
+public:
+    edge_mask() : m_mask(frame_size * frame_size) {}
+
+    void clear() { memset(&m_mask[0], 0, m_mask.size()); }
+
+    bool operator [] (unsigned i) const { return m_mask[i] != 0; }
+
+    void add_path(agg::path_storage& ps)
+    {
+        double x, y;
+        double x0 = 0, y0 = 0;
+        double x1 = 0, y1 = 0;
+        unsigned cmd;
+        ps.rewind(0);
+        while(!agg::is_stop(cmd = ps.vertex(&x, &y)))
+        {
+            if(agg::is_move_to(cmd))
+            {
+                x0 = x1 = x;
+                y0 = y1 = y;
+            }
+            else if(agg::is_vertex(cmd))
+            {
+                add_edge(x1, y1, x, y);
+                x1 = x;
+                y1 = y;
+            }
+            else if(agg::is_close(cmd))
+            {
+                add_edge(x1, y1, x0, y0);
+                x1 = x0;
+                y1 = y0;
+            }
+        }
+    }
+
+private:
+    // The pixels along the edge with a step under a pixel and their
+    // neighbours
+    void add_edge(double x1, double y1, double x2, double y2)
+    {
+        unsigned n = unsigned(agg::calc_distance(x1, y1, x2, y2) * 2) + 1;
+        unsigned i;
+        for(i = 0; i <= n; i++)
+        {
+            int x = int(floor(x1 + (x2 - x1) * i / n));
+            int y = int(floor(y1 + (y2 - y1) * i / n));
+            int dx, dy;
+            for(dy = -1; dy <= 1; dy++)
+            {
+                for(dx = -1; dx <= 1; dx++)
+                {
+                    if(x + dx < 0 || x + dx >= frame_size) continue;
+                    if(y + dy < 0 || y + dy >= frame_size) continue;
+                    m_mask[(y + dy) * frame_size + x + dx] = 1;
+                }
+            }
+        }
+    }
+
+    agg::pod_array<agg::int8u> m_mask;
+};
+
+//----------------------------------------------------------------------------
+static double random_value(double a, double b)
+{
+    return a + (b - a) * (rand() / (RAND_MAX + 1.0));
+}
+
+// A star shaped contour, simple
+static void add_star(agg::path_storage& ps, double cx, double cy)
+{
+    unsigned n = 3 + rand() % 10;
+    double angles[16];
+    unsigned i, j;
+    for(i = 0; i < n; i++) angles[i] = random_value(0, 2 * agg::pi);
+    for(i = 1; i < n; i++)
+    {
+        for(j = i; j > 0 && angles[j - 1] > angles[j]; j--)
+        {
+            double t = angles[j]; angles[j] = angles[j - 1]; angles[j - 1] = t;
+        }
+    }
+    for(i = 0; i < n; i++)
+    {
+        double r = random_value(20, 200);
+        double x = cx + r * cos(angles[i]);
+        double y = cy + r * sin(angles[i]);
+        if(i) ps.line_to(x, y);
+        else  ps.move_to(x, y);
+    }
+    ps.close_polygon();
+}
+
+// Random vertices, self-intersecting. With a step the vertices are on
+// a coarse grid, which gives many collinear and overlapping edges.
+static void add_random(agg::path_storage& ps, double step)
+{
+    unsigned n = 3 + rand() % 8;
+    unsigned i;
+    for(i = 0; i < n; i++)
+    {
+        double x = random_value(20, 480);
+        double y = random_value(20, 480);
+        if(step > 0)
+        {
+            x = floor(x / step) * step;
+            y = floor(y / step) * step;
+        }
+        if(i) ps.line_to(x, y);
+        else  ps.move_to(x, y);
+    }
+    ps.close_polygon();
+}
+
+static void add_polygon(agg::path_storage& ps, const double* xy, unsigned n)
+{
+    unsigned i;
+    ps.move_to(xy[0], xy[1]);
+    for(i = 1; i < n; i++) ps.line_to(xy[i * 2], xy[i * 2 + 1]);
+    ps.close_polygon();
+}
+
+//----------------------------------------------------------------------------
+static const char* op_name(unsigned op)
+{
+    static const char* names[] = { "or", "and", "xor", "a-b", "b-a" };
+    return names[op];
+}
+
+static const agg::sbool_op_e sbool_ops[] =
+{
+    agg::sbool_or,
+    agg::sbool_and,
+    agg::sbool_xor,
+    agg::sbool_a_minus_b,
+    agg::sbool_b_minus_a
+};
+
+//----------------------------------------------------------------------------
+// All the operations on a and b, returns the number of failed ones
+static unsigned check(const char* name, agg::path_storage& a, agg::path_storage& b)
+{
+    static edge_mask edges;
+    static image img_ref;
+    static image img_res;
+
+    agg::rasterizer_scanline_aa<> ras1;
+    agg::rasterizer_scanline_aa<> ras2;
+    agg::scanline_u8 sl;
+    agg::scanline_u8 sl1;
+    agg::scanline_u8 sl2;
+    ras1.filling_rule(agg::fill_even_odd);
+    ras2.filling_rule(agg::fill_even_odd);
+
+    edges.clear();
+    edges.add_path(a);
+    edges.add_path(b);
+
+    unsigned errors = 0;
+    unsigned op;
+    for(op = 0; op < 5; op++)
+    {
+        img_ref.clear();
+        ras1.reset();
+        ras1.add_path(a);
+        ras2.reset();
+        ras2.add_path(b);
+        agg::sbool_combine_shapes_aa(sbool_ops[op], ras1, ras2, sl1, sl2, sl,
+                                     img_ref.ren());
+
+        agg::polygon_bool pb;
+        pb.add_path(0, a);
+        pb.add_path(1, b);
+        pb.execute(agg::polygon_bool_op_e(op));
+        img_res.clear();
+        ras1.reset();
+        ras1.add_path(pb);
+        agg::render_scanlines(ras1, sl, img_res.ren());
+
+        unsigned num_diff = 0;
+        unsigned i;
+        for(i = 0; i < frame_size * frame_size; i++)
+        {
+            if(edges[i]) continue;
+            if(abs(int(img_ref[i]) - int(img_res[i])) > max_diff) ++num_diff;
+        }
+        if(num_diff)
+        {
+            printf("%s, %s: %u pixels differ\n", name, op_name(op), num_diff);
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+
+//----------------------------------------------------------------------------
+int main()
+{
+    srand(1);
+    unsigned errors = 0;
+    unsigned i;
+    char name[64];
+
+    // The rightmost vertex of A was snapped beyond the unsnapped limit
+    // of A-B, the result was empty
+    {
+        static const double xy_a[] =
+        {
+            337.824, 198.924, 132.41, 272.508, 117.085, 98.7954
+        };
+        static const double xy_b[] =
+        {
+            156.553, 141.71, 166.263, 312.881, 0.773338, 221.537,
+            43.32, 92.7948, 121.048, 109.697
+        };
+        agg::path_storage a;
+        agg::path_storage b;
+        add_polygon(a, xy_a, 3);
+        add_polygon(b, xy_b, 5);
+        errors += check("triangle and pentagon", a, b);
+    }
+
+    for(i = 0; i < 200; i++)
+    {
+        agg::path_storage a;
+        agg::path_storage b;
+        add_star(a, random_value(100, 400), random_value(100, 400));
+        add_star(b, random_value(100, 400), random_value(100, 400));
+        if(i & 1) add_star(b, random_value(100, 400), random_value(100, 400));
+        sprintf(name, "stars %u", i);
+        errors += check(name, a, b);
+    }
+
+    for(i = 0; i < 200; i++)
+    {
+        agg::path_storage a;
+        agg::path_storage b;
+        double step = (i & 1) ? 20.0 : 0.0;
+        add_random(a, step);
+        add_random(b, step);
+        sprintf(name, "random %u", i);
+        errors += check(name, a, b);
+    }
+
+    // The same polygon twice, all the edges overlap, and the polygon
+    // moved a little, some of them do
+    for(i = 0; i < 100; i++)
+    {
+        agg::path_storage a;
+        add_random(a, 0.0);
+        add_star(a, random_value(100, 400), random_value(100, 400));
+        agg::path_storage b;
+        b.concat_path(a);
+        if(i & 1) b.translate_all_paths(20.0, 0.0);
+        sprintf(name, "same %u", i);
+        errors += check(name, a, b);
+    }
+
+    if(errors)
+    {
+        printf("%u errors\n", errors);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
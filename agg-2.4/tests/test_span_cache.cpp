@@ -0,0 +1,205 @@
+// span_cache: the frames rendered through the cache must be the same as
+// the ones rendered by the span generator itself, also after key() is
+// given another matrix or version, and when the cache overflows. The
+// repeated frames must be copied from the cache.
+
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_span_allocator.h"
+#include "agg_span_interpolator_linear.h"
+#include "agg_span_gradient.h"
+#include "agg_span_cache.h"
+#include "agg_pixfmt_rgba.h"
+#include "agg_ellipse.h"
+
+typedef agg::pixfmt_rgba32                                          pixfmt;
+typedef agg::renderer_base<pixfmt>                                  renderer_base;
+typedef agg::span_interpolator_linear<>                             interpolator_type;
+typedef agg::gradient_linear_color<agg::rgba8>                      color_func_type;
+typedef agg::span_gradient<agg::rgba8,
+                           interpolator_type,
+                           agg::gradient_radial_d,
+                           color_func_type>                         span_gradient_type;
+typedef agg::span_cache<span_gradient_type>                         span_cache_type;
+
+enum
+{
+    frame_width  = 300,
+    frame_height = 200
+};
+
+//----------------------------------------------------------------------------
+class image
+{
+public:
+    image() :
+        m_buf(frame_width * frame_height * 4),
+        m_rbuf(&m_buf[0], frame_width, frame_height, frame_width * 4),
+        m_pixf(m_rbuf),
+        m_rb(m_pixf)
+    {
+    }
+
+    void clear() { m_rb.clear(agg::rgba8(255, 255, 255)); }
+
+    renderer_base& rb() { return m_rb; }
+
+    bool operator == (const image& img) const
+    {
+        return memcmp(&m_buf[0], &img.m_buf[0], m_buf.size()) == 0;
+    }
+
+private:
+    agg::pod_array<agg::int8u> m_buf;
+    agg::rendering_buffer      m_rbuf;
+    pixfmt                     m_pixf;
+    renderer_base              m_rb;
+};
+
+//----------------------------------------------------------------------------
+// The gradient fill with its own transformations and colors
+class gradient
+{
+public:
+    gradient() :
+        m_inter(m_mtx_inv),
+        m_span_gen(m_inter, m_gradient_func, m_color_func, 0, 150)
+    {
+        m_color_func.colors(agg::rgba8(255, 0, 0), agg::rgba8(0, 0, 255));
+    }
+
+    void matrix(const agg::trans_affine& mtx)
+    {
+        m_mtx = mtx;
+        m_mtx_inv = mtx;
+        m_mtx_inv.invert();
+    }
+
+    void colors(const agg::rgba8& c1, const agg::rgba8& c2)
+    {
+        m_color_func.colors(c1, c2);
+    }
+
+    const agg::trans_affine& matrix()   const { return m_mtx; }
+    span_gradient_type&      span_gen()       { return m_span_gen; }
+
+private:
+    agg::trans_affine      m_mtx;
+    agg::trans_affine      m_mtx_inv;
+    interpolator_type      m_inter;
+    agg::gradient_radial_d m_gradient_func;
+    color_func_type        m_color_func;
+    span_gradient_type     m_span_gen;
+};
+
+//----------------------------------------------------------------------------
+// The same shapes in every frame: a few ellipses, overlapping and
+// clipped by the frame
+template<class SpanGenerator>
+static void render_frame(image& img, SpanGenerator& span_gen)
+{
+    agg::rasterizer_scanline_aa<> ras;
+    agg::scanline_u8 sl;
+    agg::span_allocator<agg::rgba8> span_alloc;
+
+    img.clear();
+    unsigned i;
+    for(i = 0; i < 5; i++)
+    {
+        agg::ellipse e(40.0 + i * 60.0, 30.0 + i * 40.0, 70.0, 45.0 + i * 5.0, 64);
+        ras.reset();
+        ras.add_path(e);
+        agg::render_scanlines_aa(ras, sl, img.rb(), span_alloc, span_gen);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Renders the frame with the cache and the generator itself and compares
+static unsigned check_frame(const char* name, span_cache_type& cache, gradient& grad)
+{
+    static image img_ref;
+    static image img_res;
+    render_frame(img_ref, grad.span_gen());
+    render_frame(img_res, cache);
+    if(img_ref == img_res) return 0;
+    printf("%s: the frames differ\n", name);
+    return 1;
+}
+
+
+//----------------------------------------------------------------------------
+int main()
+{
+    unsigned errors = 0;
+    unsigned version = 0;
+    unsigned misses;
+
+    gradient grad;
+    grad.matrix(agg::trans_affine_translation(150.0, 100.0));
+    span_cache_type cache(grad.span_gen());
+
+    // The first frame fills the cache, the second one is copied from it
+    cache.key(grad.matrix(), version);
+    errors += check_frame("first frame", cache, grad);
+    if(cache.hits() != 0 || cache.misses() == 0)
+    {
+        printf("first frame: %u hits, %u misses\n", cache.hits(), cache.misses());
+        ++errors;
+    }
+    misses = cache.misses();
+
+    cache.key(grad.matrix(), version);
+    errors += check_frame("second frame", cache, grad);
+    if(cache.hits() != misses || cache.misses() != misses)
+    {
+        printf("second frame: %u hits, %u misses\n", cache.hits(), cache.misses());
+        ++errors;
+    }
+
+    // Another matrix
+    grad.matrix(agg::trans_affine_scaling(1.5, 0.75) *
+                agg::trans_affine_rotation(0.3) *
+                agg::trans_affine_translation(120.0, 90.0));
+    cache.key(grad.matrix(), version);
+    errors += check_frame("new matrix", cache, grad);
+    if(cache.misses() != misses * 2)
+    {
+        printf("new matrix: the cache isn't cleared\n");
+        ++errors;
+    }
+
+    // Other colors, the cache knows about them only by the version
+    grad.colors(agg::rgba8(0, 160, 0), agg::rgba8(250, 250, 0));
+    cache.key(grad.matrix(), version);
+    if(check_frame("new colors, same version", cache, grad) == 0)
+    {
+        printf("new colors, same version: the spans aren't cached\n");
+        ++errors;
+    }
+    cache.key(grad.matrix(), ++version);
+    errors += check_frame("new colors", cache, grad);
+
+    // A small cache is cleared while the frame is rendered
+    span_cache_type small_cache(grad.span_gen(), 1000);
+    small_cache.key(grad.matrix(), version);
+    errors += check_frame("small cache", small_cache, grad);
+    errors += check_frame("small cache, second frame", small_cache, grad);
+    if(small_cache.num_colors() > 1000)
+    {
+        printf("small cache: %u colors\n", small_cache.num_colors());
+        ++errors;
+    }
+
+    if(errors)
+    {
+        printf("%u errors\n", errors);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}